@@ -0,0 +1,887 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: registration, measurement, reporting and baseline comparison for the
+* SCIPACK microbenchmarks
+* LICS: MIT License
+*/
+
+#define _GNU_SOURCE //sched_setaffinity, CPU_SET
+
+#include "bench.h"
+
+#include <sched.h>      //sched_setaffinity
+#include <stdbool.h>    //cycles_stats
+#include <stdlib.h>     //malloc, realloc, qsort, strtod, strtoull
+#include <stdio.h>      //puts, printf, fprintf, fflush
+#include <string.h>     //memcpy, strcmp, strstr, strncpy, strrchr
+#include <unistd.h>     //sysconf, readlink
+
+/*******************************************************************************
+Command line options, all optional
+
+    --format text|csv|json  report format, text is printed as results arrive
+    --output FILE           write the csv or json report to FILE, not stdout
+    --baseline FILE         compare against a CSV report from an earlier run
+    --threshold X           relative median change that counts, default 0.05
+    --filter STR            only run cases whose name contains STR
+    --pin CPU               pin the benchmark thread to one logical CPU
+    --counters on|off       hardware counter pass after each case, default on
+    --list                  print the case names and exit
+*/
+
+enum bench_format
+{
+    BENCH_TEXT = 0,
+    BENCH_CSV = 1,
+    BENCH_JSON = 2,
+};
+
+static struct
+{
+    enum bench_format format;
+    int pin;
+    const char *output;
+    const char *baseline;
+    const char *filter;
+    double threshold;
+    int list;
+    int counters;
+} options = {BENCH_TEXT, -1, NULL, NULL, NULL, 0.05, 0, 1};
+
+/*******************************************************************************
+Every ANALYZE call becomes one result. Costs are in cycles per repetition, and
+so are the hardware events, where bit k of counters marks event k as counted.
+*/
+
+#define BENCH_NAME 64
+#define BENCH_LABEL 160
+#define BENCH_LINE 1024
+
+struct bench_result
+{
+    char module[BENCH_NAME];
+    char name[BENCH_NAME];
+    char label[BENCH_LABEL];
+    size_t param;
+    size_t sims;
+    size_t iterations;
+    size_t elements;
+    size_t element_size;
+    double min;
+    double median;
+    double mad;
+    double max;
+    double events[SPK_COUNTER_EVENTS];
+    unsigned int counters;
+    char padding[4];
+};
+
+static struct bench_result *results = NULL;
+static size_t result_count = 0;
+static size_t result_capacity = 0;
+
+static const char *current_module = "";
+static const char *current_name = "";
+static int module_printed = 0;
+static size_t current_param = 0;
+static size_t current_elements = 0;
+static size_t current_element_size = 0;
+static spk_counters pending;
+static size_t pending_repetitions = 0;
+static int total = 0;
+
+static unsigned long long *scratch = NULL;
+static size_t scratch_size = 0;
+
+//text goes where the user reads it, away from a machine readable stdout
+static FILE *info = NULL;
+
+/******************************************************************************/
+
+static void Fail(const char *message)
+{
+    fprintf(stderr, "benchmarks: %s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+/*******************************************************************************
+Gather statistical measures from an input array of raw clock ticks, where each
+array element represents the results of a single simulation. Due to operating
+system interference, we use median and median absolute deviation instead of
+average and standard deviation. This avoids data pollution due to OS preemption.
+*/
+
+#define ULLCAST(x) *((const unsigned long long *) (x))
+#define ULLSIZE sizeof(unsigned long long)
+
+static int ullcmp(const void *a, const void *b)
+{
+    unsigned long long num1 = ULLCAST(a), num2 = ULLCAST(b);
+    
+    if (num1 < num2) return -1;
+    else if (num1 == num2) return 0;
+    else return 1;
+}
+
+//returns true on error
+static bool cycles_stats
+(
+    const unsigned long long *data,
+    const size_t n,
+    unsigned long long *median,
+    unsigned long long *mad,
+    unsigned long long *min,
+    unsigned long long *max
+)
+{
+    //don't mess with the underlying array in case we need the original order
+    unsigned long long *datacpy = malloc(n * ULLSIZE);
+    if (!datacpy) return true;
+    memcpy(datacpy, data, n * ULLSIZE);
+    
+    //first three measures are derived via quick sort
+    qsort(datacpy, n, ULLSIZE, ullcmp);
+    *median = datacpy[n/2];
+    *min = datacpy[0];
+    *max = datacpy[n - 1];
+    
+    //now get the median absolute deviation
+    //long long cast okay, ticks don't get large enough on microbenchmarks
+    for (size_t i = 0; i < n; i++)
+    {
+        long long tmp = (long long) datacpy[i] - (long long) *median;
+        datacpy[i] = (unsigned long long) (tmp >= 0 ? tmp : -tmp);
+    }
+    
+    qsort(datacpy, n, ULLSIZE, ullcmp);
+    *mad = datacpy[n/2];
+    
+    free(datacpy);
+    return false;
+}
+
+/*******************************************************************************
+Set up TSC timer, establish reference frequency. Calibration is cached in a
+tsc_cache file next to the benchmarks executable, found through /proc/self/exe,
+so repeated runs on one machine agree exactly wherever they are started from.
+Without /proc the timer calibrates on every run.
+*/
+
+static const char *TscCache(void)
+{
+    static const char name[] = "tsc_cache";
+    static char path[4096];
+    
+    const ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - sizeof(name));
+    if (len <= 0 || (size_t) len >= sizeof(path) - sizeof(name)) return NULL;
+    
+    path[len] = '\0';
+    
+    char *slash = strrchr(path, '/');
+    if (slash == NULL) return NULL;
+    
+    memcpy(slash + 1, name, sizeof(name));
+    
+    return path;
+}
+
+/******************************************************************************/
+
+static void timer_setup(void)
+{
+    static const char *sources[] = {"uncalibrated", "cpuid", "regression", "cache"};
+    
+    int error = spk_TimerCalibrate(TscCache());
+    unsigned long long freq = spk_TimerGetFrequency();
+    
+    fprintf(info, "Estimated TSC Frequency: %4.2f GHz (%s)\n", (double) freq / 1.0E9, sources[spk_TimerGetSource()]);
+    fprintf(info, "Timer Overhead: %llu cycles, subtracted\n", spk_TimerOverhead(SPK_TIMER_SERIALIZE));
+    
+    if (error == SPK_ERROR_FILEIO) fprintf(info, "Note: TSC frequency cache could not be written\n");
+}
+
+/*******************************************************************************
+Counters are optional, most virtual machines do not expose a PMU at all
+*/
+
+static void counters_setup(void)
+{
+    if (!options.counters) return;
+    
+    if (spk_CountersOpen())
+    {
+        options.counters = 0;
+        fputs("Hardware Counters: unavailable\n", info);
+        return;
+    }
+    
+    fputs("Hardware Counters:", info);
+    
+    for (int i = 0; i < SPK_COUNTER_EVENTS; i++)
+    {
+        if (spk_CountersAvailable() & (1U << i)) fprintf(info, " %s", spk_CountersName((enum spk_counter_event) i));
+    }
+    
+    fputs("\n", info);
+}
+
+/******************************************************************************/
+
+static void Pin(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((size_t) cpu, &set);
+    
+    if (sched_setaffinity(0, sizeof(set), &set)) Fail("could not pin to the requested cpu");
+    
+    fprintf(info, "Pinned To CPU: %d\n", cpu);
+}
+
+/******************************************************************************/
+
+static void Usage(void)
+{
+    fputs("usage: benchmarks [--format text|csv|json] [--output FILE] [--baseline FILE]\n", stderr);
+    fputs("                  [--threshold X] [--filter STR] [--pin CPU] [--counters on|off]\n", stderr);
+    fputs("                  [--list]\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+/******************************************************************************/
+
+void bench_Begin(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        
+        if (strcmp(arg, "--list") == 0)
+        {
+            options.list = 1;
+            continue;
+        }
+        
+        if (!value) Usage();
+        i++;
+        
+        if (strcmp(arg, "--format") == 0)
+        {
+            if (strcmp(value, "text") == 0) options.format = BENCH_TEXT;
+            else if (strcmp(value, "csv") == 0) options.format = BENCH_CSV;
+            else if (strcmp(value, "json") == 0) options.format = BENCH_JSON;
+            else Usage();
+        }
+        else if (strcmp(arg, "--output") == 0) options.output = value;
+        else if (strcmp(arg, "--baseline") == 0) options.baseline = value;
+        else if (strcmp(arg, "--filter") == 0) options.filter = value;
+        else if (strcmp(arg, "--threshold") == 0) options.threshold = strtod(value, NULL);
+        else if (strcmp(arg, "--pin") == 0) options.pin = atoi(value);
+        else if (strcmp(arg, "--counters") == 0)
+        {
+            if (strcmp(value, "on") == 0) options.counters = 1;
+            else if (strcmp(value, "off") == 0) options.counters = 0;
+            else Usage();
+        }
+        else Usage();
+    }
+    
+    if (options.format == BENCH_TEXT && options.output) Usage();
+    
+    info = options.format == BENCH_TEXT ? stdout : stderr;
+    
+    if (options.list) return;
+    
+    fputs("SCIPACK Benchmarks - Copyright (C) 2021, Biren Patel\n\n", info);
+    fprintf(info, "Compile Date: %s\n", __DATE__);
+    fprintf(info, "Compile Time: %s\n", __TIME__);
+    
+    if (options.pin >= 0) Pin(options.pin);
+    
+    timer_setup();
+    counters_setup();
+}
+
+/******************************************************************************/
+
+void bench_Module(const char *module)
+{
+    current_module = module;
+    module_printed = 0;
+}
+
+/*******************************************************************************
+Case names drop the common function prefix, so the filter and reports read as
+generator_sisd_pcg64_insecure_next rather than benchmark_generator_...
+*/
+
+static const char *CaseName(const char *function)
+{
+    static const char prefix[] = "benchmark_";
+    
+    if (strncmp(function, prefix, sizeof(prefix) - 1) == 0) return function + sizeof(prefix) - 1;
+    
+    return function;
+}
+
+/******************************************************************************/
+
+static bool Selected(const char *name)
+{
+    if (options.filter && !strstr(name, options.filter)) return false;
+    
+    if (options.list)
+    {
+        printf("%s/%s\n", current_module, name);
+        return false;
+    }
+    
+    //module headings only for modules with at least one selected case
+    if (!module_printed) fprintf(info, "\n### %s ###\n", current_module);
+    module_printed = 1;
+    
+    current_name = name;
+    
+    return true;
+}
+
+/******************************************************************************/
+
+void bench_Run(const char *name, bench_function function)
+{
+    name = CaseName(name);
+    if (!Selected(name)) return;
+    
+    current_param = 0;
+    bench_Throughput(0, 0);
+    function();
+    total += 1;
+}
+
+/******************************************************************************/
+
+void bench_Sweep(const char *name, bench_sweep function, const size_t *params, size_t count)
+{
+    name = CaseName(name);
+    if (!Selected(name)) return;
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        current_param = params[i];
+        bench_Throughput(0, 0);
+        function(params[i]);
+    }
+    
+    current_param = 0;
+    total += 1;
+}
+
+/******************************************************************************/
+
+void bench_Cell(const char *name, bench_cell function, const void *ctx, const size_t *params, size_t count)
+{
+    if (!Selected(name)) return;
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        current_param = params[i];
+        bench_Throughput(0, 0);
+        function(ctx, params[i]);
+    }
+    
+    current_param = 0;
+    total += 1;
+}
+
+/******************************************************************************/
+
+void bench_Throughput(size_t elements, size_t element_size)
+{
+    current_elements = elements;
+    current_element_size = element_size;
+}
+
+/******************************************************************************/
+
+size_t bench_Sims(size_t sim_limit, unsigned long long warmup)
+{
+    if (sim_limit != BENCH_AUTO) return sim_limit;
+    
+    const unsigned long long fit = BENCH_BUDGET_CYCLES / (warmup ? warmup : 1);
+    
+    if (fit < BENCH_MIN_SIMS) return BENCH_MIN_SIMS;
+    if (fit > MASSIVE_SIM) return MASSIVE_SIM;
+    
+    return (size_t) fit;
+}
+
+/******************************************************************************/
+
+size_t bench_Counted(size_t sims)
+{
+    return options.counters ? (sims + 7) / 8 : 0;
+}
+
+/******************************************************************************/
+
+void bench_Count(const spk_counters *counters, size_t repetitions)
+{
+    pending = *counters;
+    pending_repetitions = counters->available ? repetitions : 0;
+}
+
+/******************************************************************************/
+
+unsigned long long *bench_Buffer(size_t n)
+{
+    if (n > scratch_size)
+    {
+        free(scratch);
+        scratch = malloc(n * ULLSIZE);
+        if (!scratch) Fail("malloc failure during benchmarks");
+        scratch_size = n;
+    }
+    
+    return scratch;
+}
+
+/*******************************************************************************
+Throughput columns. The footprint is the smallest cache level that holds the
+output of one repetition, so cache resident and DRAM bound points are told apart
+even when the cache sizes differ between machines.
+*/
+
+static double Nanoseconds(double cycles)
+{
+    return cycles * 1e9 / (double) spk_TimerGetFrequency();
+}
+
+/******************************************************************************/
+
+static double CyclesPerElement(const struct bench_result *r)
+{
+    return r->elements ? r->median / (double) r->elements : 0.0;
+}
+
+/******************************************************************************/
+
+static double Gigabytes(const struct bench_result *r)
+{
+    const double ns = Nanoseconds(r->median);
+    
+    return r->elements && ns > 0.0 ? (double) (r->elements * r->element_size) / ns : 0.0;
+}
+
+/*******************************************************************************
+Counter columns, IPC and the effective clock ratio of core to reference cycles,
+then branch, L1D, and LLC misses per thousand instructions. Negative when the
+events involved were not counted.
+*/
+
+enum bench_metric
+{
+    BENCH_IPC = 0,
+    BENCH_CLOCK = 1,
+    BENCH_BRANCH_MPKI = 2,
+    BENCH_L1D_MPKI = 3,
+    BENCH_LLC_MPKI = 4,
+    BENCH_METRICS = 5,
+};
+
+static const char *metric_names[BENCH_METRICS] = {"ipc", "clock_ratio", "branch_mpki", "l1d_mpki", "llc_mpki"};
+
+static double Metric(const struct bench_result *r, enum bench_metric metric)
+{
+    static const enum spk_counter_event ratios[BENCH_METRICS][2] =
+    {
+        [BENCH_IPC]         = {SPK_COUNTER_INSTRUCTIONS, SPK_COUNTER_CYCLES},
+        [BENCH_CLOCK]       = {SPK_COUNTER_CYCLES, SPK_COUNTER_REF_CYCLES},
+        [BENCH_BRANCH_MPKI] = {SPK_COUNTER_BRANCH_MISSES, SPK_COUNTER_INSTRUCTIONS},
+        [BENCH_L1D_MPKI]    = {SPK_COUNTER_L1D_MISSES, SPK_COUNTER_INSTRUCTIONS},
+        [BENCH_LLC_MPKI]    = {SPK_COUNTER_LLC_MISSES, SPK_COUNTER_INSTRUCTIONS}
+    };
+    
+    const enum spk_counter_event a = ratios[metric][0];
+    const enum spk_counter_event b = ratios[metric][1];
+    const unsigned int needed = (1U << a) | (1U << b);
+    
+    if ((r->counters & needed) != needed || r->events[b] <= 0.0) return -1.0;
+    
+    return r->events[a] / r->events[b] * (metric >= BENCH_BRANCH_MPKI ? 1000.0 : 1.0);
+}
+
+/******************************************************************************/
+
+static const char *Footprint(const struct bench_result *r)
+{
+    static const int levels[3] = {_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE};
+    static const char *names[3] = {"L1", "L2", "L3"};
+    
+    if (r->elements == 0) return "";
+    
+    const double bytes = (double) (r->elements * r->element_size);
+    
+    for (int i = 0; i < 3; i++)
+    {
+        const long size = sysconf(levels[i]);
+        if (size > 0 && bytes <= (double) size) return names[i];
+    }
+    
+    return "DRAM";
+}
+
+/******************************************************************************/
+
+static void PrintText(const struct bench_result *r)
+{
+    spk_timer_result min_tr = spk_TimerElapsedTime((unsigned long long) r->min);
+    spk_timer_result med_tr = spk_TimerElapsedTime((unsigned long long) r->median);
+    spk_timer_result max_tr = spk_TimerElapsedTime((unsigned long long) r->max);
+    spk_timer_result mad_tr = spk_TimerElapsedTime((unsigned long long) r->mad);
+    
+    if (r->param) fprintf(info, "\n%s [%zu], ", r->label, r->param);
+    else fprintf(info, "\n%s, ", r->label);
+    
+    fprintf(info, "%zu sims x %zu iterations, per iteration:\n", r->sims, r->iterations);
+    fprintf(info, "    min:  %-8.2f %-3s  %12.1f cycles\n", min_tr.elapsed, min_tr.symbol, r->min);
+    fprintf(info, "    med:  %-8.2f %-3s  %12.1f cycles\n", med_tr.elapsed, med_tr.symbol, r->median);
+    fprintf(info, "    max:  %-8.2f %-3s  %12.1f cycles\n", max_tr.elapsed, max_tr.symbol, r->max);
+    fprintf(info, "    mad:  %-8.2f %-3s  %12.1f cycles\n", mad_tr.elapsed, mad_tr.symbol, r->mad);
+    
+    if (r->elements)
+    {
+        fprintf(info, "    rate: %.3f cycles/element, %.2f GB/s, %s\n", CyclesPerElement(r), Gigabytes(r), Footprint(r));
+    }
+    
+    if (r->counters)
+    {
+        fputs("    pmc: ", info);
+        
+        for (int i = 0; i < BENCH_METRICS; i++)
+        {
+            const double value = Metric(r, (enum bench_metric) i);
+            if (value >= 0.0) fprintf(info, " %s %.3f", metric_names[i], value);
+        }
+        
+        fputs("\n", info);
+    }
+    
+    fflush(info);
+}
+
+/******************************************************************************/
+
+static void Copy(char *dest, const char *src, size_t size)
+{
+    strncpy(dest, src, size - 1);
+    dest[size - 1] = '\0';
+}
+
+/******************************************************************************/
+
+void bench_Record(const char *testname, const unsigned long long *data, size_t n, size_t iterations)
+{
+    unsigned long long med = 0;
+    unsigned long long mad = 0;
+    unsigned long long min = 0;
+    unsigned long long max = 0;
+    
+    if (n == 0) return;
+    if (cycles_stats(data, n, &med, &mad, &min, &max)) Fail("cycles statistics failure");
+    
+    if (result_count == result_capacity)
+    {
+        result_capacity = result_capacity ? 2 * result_capacity : 64;
+        results = realloc(results, result_capacity * sizeof(struct bench_result));
+        if (!results) Fail("realloc failure during benchmarks");
+    }
+    
+    struct bench_result *r = &results[result_count++];
+    const double scale = 1.0 / (double) iterations;
+    
+    Copy(r->module, current_module, BENCH_NAME);
+    Copy(r->name, current_name, BENCH_NAME);
+    Copy(r->label, testname, BENCH_LABEL);
+    r->param = current_param;
+    r->sims = n;
+    r->iterations = iterations;
+    r->elements = current_elements;
+    r->element_size = current_element_size;
+    r->min = (double) min * scale;
+    r->median = (double) med * scale;
+    r->mad = (double) mad * scale;
+    r->max = (double) max * scale;
+    r->counters = pending_repetitions ? pending.available : 0;
+    
+    for (int i = 0; i < SPK_COUNTER_EVENTS; i++)
+    {
+        r->events[i] = pending_repetitions ? (double) pending.value[i] / (double) pending_repetitions : 0.0;
+    }
+    
+    pending_repetitions = 0;
+    
+    if (options.format == BENCH_TEXT) PrintText(r);
+    else if (r->elements)
+    {
+        fprintf(info, "%s/%s [%zu]: %.3f cycles/element, %.2f GB/s, %s\n", r->name, r->label, r->param,
+            CyclesPerElement(r), Gigabytes(r), Footprint(r));
+    }
+    else fprintf(info, "%s/%s [%zu]: %.1f cycles\n", r->name, r->label, r->param, r->median);
+}
+
+/*******************************************************************************
+CSV follows RFC 4180, labels are quoted since most of them contain commas
+*/
+
+static void WriteCSVField(FILE *stream, const char *text)
+{
+    fputc('"', stream);
+    
+    for (; *text; text++)
+    {
+        if (*text == '"') fputc('"', stream);
+        fputc(*text, stream);
+    }
+    
+    fputc('"', stream);
+}
+
+/******************************************************************************/
+
+static void WriteJSONString(FILE *stream, const char *text)
+{
+    fputc('"', stream);
+    
+    for (; *text; text++)
+    {
+        if (*text == '"' || *text == '\\') fputc('\\', stream);
+        
+        if ((unsigned char) *text < 0x20) fprintf(stream, "\\u%04x", (unsigned int) *text);
+        else fputc(*text, stream);
+    }
+    
+    fputc('"', stream);
+}
+
+/******************************************************************************/
+
+static void WriteCSV(FILE *stream)
+{
+    fputs("module,case,label,param,sims,iterations,min,median,mad,max,median_ns,", stream);
+    fputs("elements,element_size,cycles_per_element,gb_per_s,footprint", stream);
+    
+    for (int k = 0; k < BENCH_METRICS; k++) fprintf(stream, ",%s", metric_names[k]);
+    
+    fputc('\n', stream);
+    
+    for (size_t i = 0; i < result_count; i++)
+    {
+        const struct bench_result *r = &results[i];
+        
+        WriteCSVField(stream, r->module);
+        fputc(',', stream);
+        WriteCSVField(stream, r->name);
+        fputc(',', stream);
+        WriteCSVField(stream, r->label);
+        fprintf(stream, ",%zu,%zu,%zu,%.2f,%.2f,%.2f,%.2f,%.3f", r->param, r->sims,
+            r->iterations, r->min, r->median, r->mad, r->max, Nanoseconds(r->median));
+        fprintf(stream, ",%zu,%zu,%.4f,%.3f,%s", r->elements, r->element_size,
+            CyclesPerElement(r), Gigabytes(r), Footprint(r));
+            
+        //uncounted metrics are left empty
+        for (int k = 0; k < BENCH_METRICS; k++)
+        {
+            const double value = Metric(r, (enum bench_metric) k);
+            
+            if (value >= 0.0) fprintf(stream, ",%.4f", value);
+            else fputc(',', stream);
+        }
+        
+        fputc('\n', stream);
+    }
+}
+
+/******************************************************************************/
+
+static void WriteJSON(FILE *stream)
+{
+    fprintf(stream, "{\n  \"tsc_hz\": %llu,\n  \"overhead_cycles\": %llu,\n  \"results\": [",
+        spk_TimerGetFrequency(), spk_TimerOverhead(SPK_TIMER_SERIALIZE));
+        
+    for (size_t i = 0; i < result_count; i++)
+    {
+        const struct bench_result *r = &results[i];
+        
+        fputs(i ? ",\n    {\"module\": " : "\n    {\"module\": ", stream);
+        WriteJSONString(stream, r->module);
+        fputs(", \"case\": ", stream);
+        WriteJSONString(stream, r->name);
+        fputs(", \"label\": ", stream);
+        WriteJSONString(stream, r->label);
+        fprintf(stream, ", \"param\": %zu, \"sims\": %zu, \"iterations\": %zu", r->param, r->sims, r->iterations);
+        fprintf(stream, ", \"min\": %.2f, \"median\": %.2f, \"mad\": %.2f, \"max\": %.2f", r->min, r->median, r->mad, r->max);
+        fprintf(stream, ", \"median_ns\": %.3f", Nanoseconds(r->median));
+        fprintf(stream, ", \"elements\": %zu, \"element_size\": %zu", r->elements, r->element_size);
+        fprintf(stream, ", \"cycles_per_element\": %.4f, \"gb_per_s\": %.3f", CyclesPerElement(r), Gigabytes(r));
+        fprintf(stream, ", \"footprint\": \"%s\"", Footprint(r));
+        
+        for (int k = 0; k < BENCH_METRICS; k++)
+        {
+            const double value = Metric(r, (enum bench_metric) k);
+            
+            if (value >= 0.0) fprintf(stream, ", \"%s\": %.4f", metric_names[k], value);
+            else fprintf(stream, ", \"%s\": null", metric_names[k]);
+        }
+        
+        fputc('}', stream);
+    }
+    
+    fputs("\n  ]\n}\n", stream);
+}
+
+/*******************************************************************************
+Split one CSV record into at most max fields in place, undoing the quoting
+*/
+
+static size_t SplitCSV(char *line, char **fields, size_t max)
+{
+    size_t count = 0;
+    char *read = line;
+    
+    while (count < max)
+    {
+        char *write = read;
+        fields[count++] = write;
+        
+        if (*read == '"')
+        {
+            read++;
+            
+            while (*read && !(read[0] == '"' && read[1] != '"'))
+            {
+                if (read[0] == '"') read++;
+                *write++ = *read++;
+            }
+            
+            if (*read == '"') read++;
+        }
+        
+        while (*read && *read != ',' && *read != '\n' && *read != '\r') *write++ = *read++;
+        
+        const char end = *read;
+        *write = '\0';
+        
+        if (end != ',') break;
+        read++;
+    }
+    
+    return count;
+}
+
+/*******************************************************************************
+A change counts when the median moves by more than the threshold and by more
+than the larger of the two MADs, so noisy cases need a bigger move to be flagged
+*/
+
+static int Compare(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "benchmarks: could not open baseline %s\n", path);
+        return EXIT_FAILURE;
+    }
+    
+    char line[BENCH_LINE];
+    char *fields[24];
+    int regressions = 0;
+    int improvements = 0;
+    int matched = 0;
+    
+    fprintf(info, "\n### baseline comparison against %s, threshold %.1f%% ###\n", path, 100.0 * options.threshold);
+    
+    while (fgets(line, sizeof(line), file))
+    {
+        //reports from before the throughput columns have 11 fields
+        if (SplitCSV(line, fields, 24) < 11) continue;
+        if (strcmp(fields[0], "module") == 0) continue;
+        
+        const size_t param = (size_t) strtoull(fields[3], NULL, 10);
+        const double base = strtod(fields[7], NULL);
+        const double base_mad = strtod(fields[8], NULL);
+        
+        for (size_t i = 0; i < result_count; i++)
+        {
+            const struct bench_result *r = &results[i];
+            
+            if (r->param != param) continue;
+            if (strcmp(r->name, fields[1]) || strcmp(r->label, fields[2])) continue;
+            
+            const double delta = r->median - base;
+            const double noise = r->mad > base_mad ? r->mad : base_mad;
+            const double relative = base > 0.0 ? delta / base : 0.0;
+            const char *verdict = "same";
+            
+            if (relative > options.threshold && delta > noise)
+            {
+                verdict = "REGRESSION";
+                regressions++;
+            }
+            else if (-relative > options.threshold && -delta > noise)
+            {
+                verdict = "improved";
+                improvements++;
+            }
+            
+            fprintf(info, "%-10s %+7.1f%%  %10.1f -> %10.1f cycles  %s/%s [%zu]\n",
+                verdict, 100.0 * relative, base, r->median, r->name, r->label, r->param);
+                
+            matched++;
+            break;
+        }
+    }
+    
+    fclose(file);
+    
+    fprintf(info, "\n%d compared, %d regressions, %d improvements\n", matched, regressions, improvements);
+    
+    return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/******************************************************************************/
+
+int bench_End(void)
+{
+    int status = EXIT_SUCCESS;
+    
+    if (options.list) return status;
+    
+    fprintf(info, "\nfinished. %d benchmarks executed.\n", total);
+    
+    if (options.format != BENCH_TEXT)
+    {
+        FILE *stream = options.output ? fopen(options.output, "w") : stdout;
+        
+        if (!stream)
+        {
+            fprintf(stderr, "benchmarks: could not open %s\n", options.output);
+            status = EXIT_FAILURE;
+        }
+        else
+        {
+            if (options.format == BENCH_CSV) WriteCSV(stream);
+            else WriteJSON(stream);
+            
+            if (stream != stdout && fclose(stream)) status = EXIT_FAILURE;
+        }
+    }
+    
+    if (options.baseline && Compare(options.baseline) != EXIT_SUCCESS) status = EXIT_FAILURE;
+    
+    free(results);
+    free(scratch);
+    spk_CountersClose();
+    
+    return status;
+}
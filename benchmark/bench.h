@@ -0,0 +1,244 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: registration, measurement, reporting and baseline comparison for the
+* SCIPACK microbenchmarks
+* LICS: MIT License
+*/
+
+#ifndef SPK_BENCH_H
+#define SPK_BENCH_H
+
+#include "scipack.h"
+
+#include <stddef.h> //size_t
+
+/*******************************************************************************
+Preset simulation size options. Sweeps also use them as problem sizes.
+*/
+
+#define TINY_SIM    10
+#define SMALL_SIM   100
+#define MEDIUM_SIM  1000
+#define LARGE_SIM   10000
+#define MASSIVE_SIM 100000
+
+/*******************************************************************************
+* NAME: BENCH_AUTO
+* DESC: pass as instr_limit to ANALYZE to double the inner repetitions until one
+* simulation takes at least BENCH_TARGET_CYCLES, results are always reported per
+* repetition so automatic and fixed counts compare directly. Pass as sim_limit
+* to run as many simulations as fit in BENCH_BUDGET_CYCLES judging by the warm
+* up, but at least BENCH_MIN_SIMS and at most MASSIVE_SIM
+*******************************************************************************/
+#define BENCH_AUTO 0
+#define BENCH_TARGET_CYCLES 10000ULL
+#define BENCH_MAX_ITERATIONS ((size_t) 1 << 24)
+#define BENCH_BUDGET_CYCLES 200000000ULL
+#define BENCH_MIN_SIMS ((size_t) 5)
+
+/*******************************************************************************
+* NAME: BENCH_SIMS_FOR
+* DESC: simulations for a sweep point doing n units of work each, enough to keep
+* about 1e8 units in total without going outside TINY_SIM to MASSIVE_SIM
+*******************************************************************************/
+#define BENCH_SIMS_FOR(n)                                                      \
+        ((n) >= 100000000 / TINY_SIM ? TINY_SIM :                              \
+        (100000000 / (n) > MASSIVE_SIM ? MASSIVE_SIM : 100000000 / (n)))
+
+/*******************************************************************************
+* NAME: bench functions
+* DESC: a plain benchmark takes no arguments, a sweep receives each of its
+* parameters in turn, and a cell also receives the context it was run with so
+* that one function can cover a whole table of cases. Any of them may call
+* ANALYZE any number of times
+*******************************************************************************/
+typedef void (*bench_function)(void);
+typedef void (*bench_sweep)(size_t param);
+typedef void (*bench_cell)(const void *ctx, size_t param);
+
+/*******************************************************************************
+* NAME: bench_Begin
+* DESC: parse the command line, pin the thread, calibrate the TSC, and open the
+* hardware counters where the machine has them
+* NOTE: exits with a usage message on bad arguments, see bench.c for options
+*******************************************************************************/
+void bench_Begin(int argc, char **argv);
+
+/*******************************************************************************
+* NAME: bench_Module
+* DESC: label the cases run from here on
+*******************************************************************************/
+void bench_Module(const char *module);
+
+/*******************************************************************************
+* NAME: bench_Run, bench_Sweep
+* DESC: run a registered case, or just list it under --list. Both skip cases
+* whose name does not contain the --filter string
+*******************************************************************************/
+void bench_Run(const char *name, bench_function function);
+void bench_Sweep(const char *name, bench_sweep function, const size_t *params, size_t count);
+
+/*******************************************************************************
+* NAME: bench_Cell
+* DESC: bench_Sweep for a cell function, ctx is passed through untouched
+* NOTE: the name is copied into each result, it only has to outlive this call
+*******************************************************************************/
+void bench_Cell(const char *name, bench_cell function, const void *ctx, const size_t *params, size_t count);
+
+/*******************************************************************************
+* NAME: bench_Throughput
+* DESC: declare that each repetition of the following ANALYZE calls produces
+* the given number of elements of the given size, which adds cycles per element,
+* GB/s, and the smallest cache level that holds the output to the report
+* NOTE: reset to none at the start of every case and every sweep point
+*******************************************************************************/
+void bench_Throughput(size_t elements, size_t element_size);
+
+/*******************************************************************************
+* NAME: bench_End
+* DESC: write the CSV or JSON report and compare against the baseline
+* OUTP: EXIT_SUCCESS, or EXIT_FAILURE when the baseline comparison found a
+* regression or the report could not be written
+*******************************************************************************/
+int bench_End(void);
+
+/*******************************************************************************
+* NAME: bench_Buffer
+* DESC: scratch space for n raw cycle counts, owned by the framework
+*******************************************************************************/
+unsigned long long *bench_Buffer(size_t n);
+
+/*******************************************************************************
+* NAME: bench_Record
+* DESC: summarize the n net cycle counts of one ANALYZE call, each covering the
+* given number of repetitions, under the running case and parameter
+*******************************************************************************/
+void bench_Record(const char *testname, const unsigned long long *data, size_t n, size_t iterations);
+
+/*******************************************************************************
+* NAME: bench_Counted
+* DESC: simulations to repeat for the hardware counter pass that follows the
+* timed simulations, an eighth of them rounded up or zero if counters are off
+*******************************************************************************/
+size_t bench_Counted(size_t sims);
+
+/*******************************************************************************
+* NAME: bench_Count
+* DESC: attach the events counted over the given number of repetitions to the
+* result of the next bench_Record
+*******************************************************************************/
+void bench_Count(const spk_counters *counters, size_t repetitions);
+
+/*******************************************************************************
+* NAME: bench_Sims
+* DESC: simulation count for ANALYZE, resolving BENCH_AUTO from the net cycles
+* of one warm up simulation
+*******************************************************************************/
+size_t bench_Sims(size_t sim_limit, unsigned long long warmup);
+
+/*******************************************************************************
+Microbenchmarking core function. Execute "test" across "sim_limit" total
+simulations where test repeats itself "instr_limit" times within a single
+simulation, either of which may be BENCH_AUTO. "testname" labels the result.
+Also include a rough and small warm up period which mimics one simulation of
+the test loop, and which is timed to size the automatic counts. Hardware
+counters are read in a separate pass so their system calls never land inside a
+timed simulation.
+*/
+
+#define ANALYZE(testname, test, sim_limit, instr_limit)                        \
+do                                                                             \
+{                                                                              \
+    size_t bench_iters = (size_t) (instr_limit);                               \
+    unsigned long long bench_warmup = 0;                                       \
+                                                                               \
+    {                                                                          \
+        spk_TimerStart();                                                      \
+                                                                               \
+        for (size_t j = 0; j < (bench_iters ? bench_iters : 1); j++)           \
+        {                                                                      \
+            (test);                                                            \
+            __asm__ volatile ("");                                             \
+        }                                                                      \
+                                                                               \
+        spk_TimerStop();                                                       \
+        bench_warmup = spk_TimerElapsedNetCycles();                            \
+    }                                                                          \
+                                                                               \
+    if (bench_iters == BENCH_AUTO)                                             \
+    {                                                                          \
+        bench_iters = 1;                                                       \
+                                                                               \
+        while (bench_iters < BENCH_MAX_ITERATIONS)                             \
+        {                                                                      \
+            spk_TimerStart();                                                  \
+                                                                               \
+            for (size_t j = 0; j < bench_iters; j++)                           \
+            {                                                                  \
+                (test);                                                        \
+                __asm__ volatile ("");                                         \
+            }                                                                  \
+                                                                               \
+            spk_TimerStop();                                                   \
+                                                                               \
+            bench_warmup = spk_TimerElapsedNetCycles();                        \
+            if (bench_warmup >= BENCH_TARGET_CYCLES) break;                    \
+            bench_iters *= 2;                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    const size_t bench_sims = bench_Sims((size_t) (sim_limit), bench_warmup);  \
+    unsigned long long *bench_data = bench_Buffer(bench_sims);                 \
+                                                                               \
+    for (size_t i = 0; i < bench_sims; i++)                                    \
+    {                                                                          \
+        spk_TimerStart();                                                      \
+                                                                               \
+        for (size_t j = 0; j < bench_iters; j++)                               \
+        {                                                                      \
+            (test);                                                            \
+            __asm__ volatile ("");                                             \
+        }                                                                      \
+                                                                               \
+        spk_TimerStop();                                                       \
+                                                                               \
+        bench_data[i] = spk_TimerElapsedNetCycles();                           \
+    }                                                                          \
+                                                                               \
+    const size_t bench_counted = bench_Counted(bench_sims) * bench_iters;      \
+                                                                               \
+    if (bench_counted)                                                         \
+    {                                                                          \
+        spk_counters bench_pmc;                                                \
+        spk_CountersBegin(&bench_pmc);                                         \
+                                                                               \
+        for (size_t j = 0; j < bench_counted; j++)                             \
+        {                                                                      \
+            (test);                                                            \
+            __asm__ volatile ("");                                             \
+        }                                                                      \
+                                                                               \
+        spk_CountersEnd(&bench_pmc);                                           \
+        bench_Count(&bench_pmc, bench_counted);                                \
+    }                                                                          \
+                                                                               \
+    bench_Record(testname, bench_data, bench_sims, bench_iters);               \
+}                                                                              \
+while (0)                                                                      \
+
+/*******************************************************************************
+Unity-style benchmarking API.
+*/
+
+#define BENCHMARKS_BEGIN(argc, argv) bench_Begin(argc, argv)
+
+#define BENCHMARKS_MODULE(str) bench_Module(str)
+
+#define RUN_BENCHMARK(x) bench_Run(#x, x)
+
+#define RUN_SWEEP(x, params)                                                   \
+        bench_Sweep(#x, x, params, sizeof(params) / sizeof(params[0]))
+
+#define BENCHMARKS_END() return bench_End()
+
+#endif
@@ -4,190 +4,284 @@
 * LICS: MIT License
 */
 
-#include "scipack.h"
+#include "bench.h"
 
-#include <stdbool.h>    //cycles_stats
+#include <math.h>       //ldexp
+#include <stdint.h>     //SIZE_MAX, UINT64_MAX
 #include <stdlib.h>     //malloc, size_t
-#include <stdio.h>      //puts, printf, fprintf, fflush
-#include <string.h>     //memcpy
+#include <stdio.h>      //fprintf, snprintf
 
 /*******************************************************************************
-Gather statistical measures from an input array of raw clock ticks, where each
-array element represents the results of a single simulation. Due to operating
-system interference, we use median and median absolute deviation instead of
-average and standard deviation. This avoids data pollution due to OS preemption.
+Problem sizes for the fill sweeps, from a handful of words to a buffer well past
+the L2 cache
 */
 
-#define ULLCAST(x) *((const unsigned long long *) (x))
-#define ULLSIZE sizeof(unsigned long long)
+static const size_t fill_sizes[] = {TINY_SIM, SMALL_SIM, MEDIUM_SIM, LARGE_SIM, MASSIVE_SIM};
 
-static int ullcmp(const void *a, const void *b)
+/******************************************************************************/
+
+void benchmark_generator_sisd_pcg64_insecure_next(void)
 {
-    unsigned long long num1 = ULLCAST(a), num2 = ULLCAST(b);
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "pcg64 insecure malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
     
-    if (num1 < num2) return -1;
-    else if (num1 == num2) return 0;
-    else return 1;
+    char *testname = "PCG 64-bit insecure next, fill 1000 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
+    
+    spk_GeneratorDelete(rng);
 }
 
-//returns true on error
-static bool cycles_stats
-(
-    const unsigned long long *data,
-    const size_t n,
-    unsigned long long *median,
-    unsigned long long *mad,
-    unsigned long long *min,
-    unsigned long long *max
-)
+/******************************************************************************/
+
+void benchmark_generator_sisd_xorshift64_next(void)
 {
-    //don't mess with the underlying array in case we need the original order
-    unsigned long long *datacpy = malloc(n * ULLSIZE);
-    if (!datacpy) return true;
-    memcpy(datacpy, data, n * ULLSIZE);
+    int error = 0;
     
-    //first three measures are derived via quick sort
-    qsort(datacpy, n, ULLSIZE, ullcmp);
-    *median = datacpy[n/2];
-    *min = datacpy[0];
-    *max = datacpy[n - 1];
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "xsh64 init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
     
-    //now get the median absolute deviation
-    //long long cast okay, ticks don't get large enough on microbenchmarks
-    for (size_t i = 0; i < n; i++) 
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
     {
-        long long tmp = (long long) datacpy[i] - (long long) *median;
-        datacpy[i] = (unsigned long long) (tmp >= 0 ? tmp : -tmp);
+        fprintf(stderr, "xsh64 malloc failure\n");
+        exit(EXIT_FAILURE);
     }
     
-    qsort(datacpy, n, ULLSIZE, ullcmp);
-    *mad = datacpy[n/2];
+    char *testname = "Xorshift 64-bit next, fill 1000 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
     
-    free(datacpy);
-    return false;    
+    spk_GeneratorDelete(rng);
 }
 
-/*******************************************************************************
-Set up TSC timer, establish reference frequency. This take a long time so we
-let the user know whats happening before the benchmarks start to roll out.
-TODO: pthreads implementation for progress bar
-*/
+/******************************************************************************/
 
-static void timer_setup(void)
+void benchmark_generator_sisd_xoshiro256_next(void)
 {
-    printf("Estimating TSC Frequency...");
-    fflush(stdout);
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_XOSHIRO256, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "xoshiro256 init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "xoshiro256 malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
     
-    unsigned long long freq = spk_TimerGetFrequency();
+    char *testname = "xoshiro256++ next, fill 1000 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
     
-    printf("\r                            ");
-    printf("\rEstimated TSC Frequency: %4.2f GHz\n", (double) freq / 1.0E9);
+    free(buffer);
+    spk_GeneratorDelete(rng);
 }
 
-/*******************************************************************************
-Unity-style benchmarking API.
-*/
+/******************************************************************************/
 
-#define BENCHMARKS_BEGIN()                                                     \
-        system("clear");                                                       \
-        puts("SCIPACK Benchmarks - Copyright (C) 2021, Biren Patel\n");        \
-        printf("Compile Date: %s\n", __DATE__);                                \
-        printf("Compile Time: %s\n", __TIME__);                                \
-        timer_setup()
+void benchmark_generator_sisd_xoroshiro128_next(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_XOROSHIRO128, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "xoroshiro128 init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "xoroshiro128 malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *testname = "xoroshiro128+ next, fill 1000 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
 
-#define BENCHMARKS_MODULE(str) puts("\n### " str " ###")
+/******************************************************************************/
 
-static int total = 0;
+void benchmark_generator_sisd_rdrand_next(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_RDRAND, 0);
+    
+    //no hardware generator on this cpu, nothing to measure
+    if (error == SPK_ERROR_RDRAND)
+    {
+        fprintf(stderr, "rdrand unavailable on this cpu, skipped\n");
+        return;
+    }
+    
+    if (error)
+    {
+        fprintf(stderr, "rdrand init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(100 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "rdrand malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    //the hardware is orders of magnitude slower than the PRNGs, keep it short
+    char *testname = "hardware rdseed/rdrand next, fill 100 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 100), SMALL_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
 
-#define RUN_BENCHMARK(x) (*x)(); total += 1
+/******************************************************************************/
 
-#define BENCHMARKS_END()                                                       \
-        printf("\nfinished. %d benchmarks executed.\n", total);                \
-        return EXIT_SUCCESS
+void benchmark_generator_sisd_pcg64_insecure_bias(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "pcg64 insecure malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *testname = "PCG 64-bit insecure bias, fill 1000 element buffer";
+    ANALYZE(testname, rng->bias(rng, buffer, 1000, .003, 8), MASSIVE_SIM, 1);
+    
+    spk_GeneratorDelete(rng);
+}
 
+/******************************************************************************/
 
-/*******************************************************************************
-Preset simulation size options
-*/
+void benchmark_generator_sisd_pcg64_insecure_bias_program(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    spk_bias_program program;
+    error = spk_BiasProgramInit(&program, .3, 12);
+    
+    if (error)
+    {
+        fprintf(stderr, "bias program init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "pcg64 insecure malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *testname = "PCG 64-bit insecure bias program, fill 1000 element buffer";
+    ANALYZE(testname, spk_GeneratorBias(rng, buffer, 1000, &program), MASSIVE_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
 
-#define TINY_SIM    10
-#define SMALL_SIM   100
-#define MEDIUM_SIM  1000
-#define LARGE_SIM   10000
-#define MASSIVE_SIM 100000
+/******************************************************************************/
 
-/*******************************************************************************
-Microbenchmarking core function. Execute "test" across "sim_limit" total
-simulations where test repeats itself "instr_limit" times within a single
-simulation. "testname" is printed to the console. Also include a rough and small
-warm up period which mimics the test loop with 10x iterations.
-*/
+void benchmark_generator_sisd_pcg64_insecure_next_small(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t buffer[16];
+    
+    char *testname = "PCG 64-bit insecure next, fill 16 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 16), MASSIVE_SIM, 1);
+    
+    spk_GeneratorDelete(rng);
+}
 
-#define ANALYZE(testname, test, sim_limit, instr_limit)                        \
-do                                                                             \
-{                                                                              \
-    int error = 0;                                                             \
-                                                                               \
-    unsigned long long med = 0;                                                \
-    unsigned long long mad = 0;                                                \
-    unsigned long long min = 0;                                                \
-    unsigned long long max = 0;                                                \
-                                                                               \
-    unsigned long long *data = malloc(sim_limit * ULLSIZE);                    \
-                                                                               \
-    if (!data)                                                                 \
-    {                                                                          \
-        fprintf(stderr, "malloc failure during benchmarks\n");                 \
-        exit(EXIT_FAILURE);                                                    \
-    }                                                                          \
-                                                                               \
-    for (size_t j = 0; j < instr_limit; j++)                                   \
-    {                                                                          \
-        (test);                                                                \
-        __asm__ volatile ("");                                                 \
-    }                                                                          \
-                                                                               \
-    for (size_t i = 0; i < sim_limit; i++)                                     \
-    {                                                                          \
-        spk_TimerStart();                                                      \
-                                                                               \
-        for (size_t j = 0; j < instr_limit; j++)                               \
-        {                                                                      \
-            (test);                                                            \
-            __asm__ volatile ("");                                             \
-        }                                                                      \
-                                                                               \
-        spk_TimerStop();                                                       \
-                                                                               \
-        data[i] = spk_TimerElapsedCycles();                                    \
-    }                                                                          \
-                                                                               \
-    error = cycles_stats(data, sim_limit, &med, &mad, &min, &max);             \
-                                                                               \
-    if (error)                                                                 \
-    {                                                                          \
-        fprintf(stderr, "cycles statistics failure\n");                        \
-    }                                                                          \
-                                                                               \
-    spk_timer_result med_tr = spk_TimerElapsedTime(med);                       \
-    spk_timer_result mad_tr = spk_TimerElapsedTime(mad);                       \
-    spk_timer_result min_tr = spk_TimerElapsedTime(min);                       \
-    spk_timer_result max_tr = spk_TimerElapsedTime(max);                       \
-                                                                               \
-    printf("\n%s, %d iterations:\n", testname, instr_limit);                   \
-    printf("    min:  %-6.2f %s\n", min_tr.elapsed, min_tr.symbol);            \
-    printf("    med:  %-6.2f %s\n", med_tr.elapsed, med_tr.symbol);            \
-    printf("    max:  %-6.2f %s\n", max_tr.elapsed, max_tr.symbol);            \
-    printf("    mad:  %-6.2f %s\n", mad_tr.elapsed, mad_tr.symbol);            \
-                                                                               \
-    free(data);                                                                \
-}                                                                              \
-while (0)                                                                      \
+/******************************************************************************/
 
+void benchmark_generator_inline_pcg64_insecure_next_small(void)
+{
+    int error = 0;
+    
+    spk_pcg64i pcg;
+    error = spk_PCG64iInit(&pcg, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "inline pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t buffer[16];
+    
+    char *testname = "Inline PCG 64-bit insecure fill, fill 16 element buffer";
+    ANALYZE(testname, spk_PCG64iFill(&pcg, buffer, 16), MASSIVE_SIM, 1);
+}
 
 /******************************************************************************/
 
-void benchmark_generator_sisd_pcg64_insecure_next(void)
+void benchmark_generator_buffer_pcg64_insecure_scalar_next(void)
 {
     int error = 0;
     
@@ -200,14 +294,49 @@ void benchmark_generator_sisd_pcg64_insecure_next(void)
         exit(EXIT_FAILURE);
     }
     
+    spk_generator_buffer buf;
+    error = spk_BufferNew(&buf, rng, SPK_BUFFER_DEFAULT);
+    
+    if (error)
+    {
+        fprintf(stderr, "buffer init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    volatile uint64_t sink = 0;
+    
+    char *testname = "Buffered PCG 64-bit insecure scalar pop";
+    ANALYZE(testname, sink = spk_BufferNext(buf), MASSIVE_SIM, BENCH_AUTO);
+    
+    (void) sink;
+    
+    spk_BufferDelete(buf);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_generator_simd_pcg64_insecure_x4_next(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64ix4, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure x4 init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
     uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
     if (!buffer)
     {
-        fprintf(stderr, "pcg64 insecure malloc failure\n");
+        fprintf(stderr, "pcg64 insecure x4 malloc failure\n");
         exit(EXIT_FAILURE);
     }
     
-    char *testname = "PCG 64-bit insecure next, fill 1000 element buffer";
+    char *testname = "PCG 64-bit insecure 4 lanes next, fill 1000 element buffer";
     ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
     
     spk_GeneratorDelete(rng);
@@ -215,27 +344,27 @@ void benchmark_generator_sisd_pcg64_insecure_next(void)
 
 /******************************************************************************/
 
-void benchmark_generator_sisd_xorshift64_next(void)
+void benchmark_generator_simd_pcg64_insecure_x8_next(void)
 {
     int error = 0;
     
     struct spk_generator *rng;
-    error = spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 0);
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64ix8, 0);
     
     if (error)
     {
-        fprintf(stderr, "xsh64 init failure: code %d\n", error);
+        fprintf(stderr, "pcg64 insecure x8 init failure: code %d\n", error);
         exit(EXIT_FAILURE);
     }
     
     uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
     if (!buffer)
     {
-        fprintf(stderr, "xsh64 malloc failure\n");
+        fprintf(stderr, "pcg64 insecure x8 malloc failure\n");
         exit(EXIT_FAILURE);
     }
     
-    char *testname = "Xorshift 64-bit next, fill 1000 element buffer";
+    char *testname = "PCG 64-bit insecure 8 lanes next, fill 1000 element buffer";
     ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
     
     spk_GeneratorDelete(rng);
@@ -243,40 +372,657 @@ void benchmark_generator_sisd_xorshift64_next(void)
 
 /******************************************************************************/
 
-void benchmark_generator_sisd_pcg64_insecure_bias(void)
+void benchmark_generator_simd_xoshiro256_x4_next(void)
 {
     int error = 0;
     
     struct spk_generator *rng;
-    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_XOSHIRO256x4, 0);
     
     if (error)
     {
-        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        fprintf(stderr, "xoshiro256 x4 init failure: code %d\n", error);
         exit(EXIT_FAILURE);
     }
     
     uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
     if (!buffer)
     {
-        fprintf(stderr, "pcg64 insecure malloc failure\n");
+        fprintf(stderr, "xoshiro256 x4 malloc failure\n");
         exit(EXIT_FAILURE);
     }
     
-    char *testname = "PCG 64-bit insecure bias, fill 1000 element buffer";
-    ANALYZE(testname, rng->bias(rng, buffer, 1000, .003, 8), MASSIVE_SIM, 1);
+    char *testname = "xoshiro256++ 4 lanes next, fill 1000 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
     
+    free(buffer);
     spk_GeneratorDelete(rng);
 }
 
 /******************************************************************************/
 
-int main(void)
-{    
-    BENCHMARKS_BEGIN();
+void benchmark_generator_simd_philox4x32_next(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PHILOX4x32, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "philox4x32 init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "philox4x32 malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *testname = "Philox4x32-10 counter-based next, fill 1000 element buffer";
+    ANALYZE(testname, rng->next(rng->state, buffer, 1000), MASSIVE_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+A billion-sample style reduction, scaled down to 2^24 doubles so that it still
+far exceeds the last level cache. The fill version writes the whole array and
+reads it back, the stream version keeps one 16 KiB block in L1.
+*/
+
+#define REDUCTION_SIZE ((size_t) 1 << 24)
+
+//four accumulators, otherwise the add latency hides the memory traffic
+static int SumBlock(const void *block, size_t n, void *ctx)
+{
+    const double *u = block;
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    
+    for (; i + 4 <= n; i += 4)
+    {
+        for (size_t k = 0; k < 4; k++) acc[k] += u[i + k];
+    }
+    
+    for (; i < n; i++) acc[0] += u[i];
+    
+    *(double *) ctx += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    
+    return 0;
+}
+
+static void FillThenSum(spk_generator rng, double *buffer, double *sum)
+{
+    rng->unid(rng, buffer, REDUCTION_SIZE);
+    SumBlock(buffer, REDUCTION_SIZE, sum);
+}
+
+void benchmark_generator_fill_then_sum_unid(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_DEFAULT, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "default generator init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    double *buffer = malloc(REDUCTION_SIZE * sizeof(double));
+    if (!buffer)
+    {
+        fprintf(stderr, "fill then sum malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    double sum = 0.0;
+    
+    char *testname = "Default generator unid fill then sum, 2^24 doubles";
+    ANALYZE(testname, FillThenSum(rng, buffer, &sum), TINY_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_generator_stream_sum_unid(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_DEFAULT, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "default generator init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    spk_stream_method method = {.kind = SPK_STREAM_UNID};
+    double sum = 0.0;
+    
+    char *testname = "Default generator unid streamed into sum, 2^24 doubles";
+    ANALYZE(testname, spk_GeneratorStream(rng, &method, REDUCTION_SIZE, 0, SumBlock, &sum), TINY_SIM, 1);
+    
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+The same reduction as a one dimensional integral of the identity, so the values
+go through the compensated moments kernel instead of a plain sum, with the
+parallel version spread over every online core
+*/
+
+static void Identity(const double *x, double *fx, size_t n, size_t dim, void *ctx)
+{
+    (void) dim;
+    (void) ctx;
+    
+    for (size_t i = 0; i < n; i++) fx[i] = x[i];
+}
+
+void benchmark_montecarlo_integrate_unid(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_DEFAULT, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "default generator init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    double estimate = 0.0;
+    double std_error = 0.0;
+    
+    char *testname = "Default generator unid integrated serially, 2^24 points";
+    ANALYZE(testname, spk_MCIntegrate(rng, Identity, NULL, 1, REDUCTION_SIZE, &estimate, &std_error), TINY_SIM, 1);
+    
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_montecarlo_integrate_parallel_unid(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_DEFAULT, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "default generator init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    double estimate = 0.0;
+    double std_error = 0.0;
+    
+    char *testname = "Default generator unid integrated on all cores, 2^24 points";
+    ANALYZE(testname, spk_MCIntegrateParallel(rng, Identity, NULL, 1, REDUCTION_SIZE, &estimate, &std_error), TINY_SIM, 1);
+    
+    spk_ParallelDelete();
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_continuous_normal_pcg64_insecure(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    double *buffer = malloc(1000 * sizeof(double));
+    if (!buffer)
+    {
+        fprintf(stderr, "normal malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *testname = "Ziggurat normal via PCG 64-bit insecure, fill 1000 element buffer";
+    ANALYZE(testname, spk_Normal(rng, buffer, 1000, 0.0, 1.0), MASSIVE_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_continuous_exponential_pcg64_insecure(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    double *buffer = malloc(1000 * sizeof(double));
+    if (!buffer)
+    {
+        fprintf(stderr, "exponential malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *testname = "Ziggurat exponential via PCG 64-bit insecure, fill 1000 element buffer";
+    ANALYZE(testname, spk_Exponential(rng, buffer, 1000, 1.0), MASSIVE_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_discrete_alias_pcg64_insecure(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    double *weights = malloc(10000 * sizeof(double));
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!weights || !buffer)
+    {
+        fprintf(stderr, "discrete malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    for (size_t i = 0; i < 10000; i++) weights[i] = (double) (1 + i % 7);
+    
+    spk_discrete table;
+    error = spk_DiscreteNew(&table, weights, 10000);
+    
+    if (error)
+    {
+        fprintf(stderr, "discrete init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    char *testname = "Alias table with 10000 outcomes, fill 1000 element buffer";
+    ANALYZE(testname, spk_DiscreteSample(rng, table, buffer, 1000), MASSIVE_SIM, 1);
+    
+    spk_DiscreteDelete(table);
+    free(weights);
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_discrete_binomial_pcg64_insecure(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "binomial malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *popcount = "Binomial 300 trials p = 0.25 via bias popcount, fill 1000 element buffer";
+    ANALYZE(popcount, spk_Binomial(rng, buffer, 1000, 300, 0.25), MASSIVE_SIM, 1);
+    
+    char *btpe = "Binomial 1000 trials p = 0.3 via BTPE, fill 1000 element buffer";
+    ANALYZE(btpe, spk_Binomial(rng, buffer, 1000, 1000, 0.3), MASSIVE_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+/*******************************************************************************
+Baseline for the shuffle benchmark, one call to the rand method per step.
+*******************************************************************************/
+static void NaiveShuffle(spk_generator rng, uint64_t *buffer, size_t n)
+{
+    for (size_t i = n - 1; i > 0; i--)
+    {
+        uint64_t j = 0;
+        rng->rand(rng, &j, 1, 0, i);
+        
+        const uint64_t tmp = buffer[i];
+        buffer[i] = buffer[j];
+        buffer[j] = tmp;
+    }
+}
+
+/******************************************************************************/
+
+void benchmark_discrete_shuffle_pcg64_insecure(void)
+{
+    int error = 0;
+    
+    struct spk_generator *rng;
+    error = spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "pcg64 insecure init failure: code %d\n", error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(1000 * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "shuffle malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    for (size_t i = 0; i < 1000; i++) buffer[i] = i;
+    
+    char *naive = "Fisher-Yates via rand method per step, shuffle 1000 element buffer";
+    ANALYZE(naive, NaiveShuffle(rng, buffer, 1000), MASSIVE_SIM, 1);
+    
+    char *batched = "spk_Shuffle, shuffle 1000 element buffer";
+    ANALYZE(batched, spk_Shuffle(rng, buffer, 1000, sizeof(uint64_t)), MASSIVE_SIM, 1);
+    
+    char *floyd = "spk_SampleWithoutReplacement via Floyd, 1000 of 2^40 indices";
+    ANALYZE(floyd, spk_SampleWithoutReplacement(rng, 1000, (uint64_t) 1 << 40, buffer), MASSIVE_SIM, 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Fill sweeps. Each point reuses one generator and one buffer of the largest size
+so that only n changes between points.
+*/
+
+static void SweepNext(int identifier, const char *testname, size_t n)
+{
+    spk_generator rng;
+    int error = spk_GeneratorNew(&rng, identifier, 0);
+    
+    if (error)
+    {
+        fprintf(stderr, "%s init failure: code %d\n", testname, error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(n * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "%s malloc failure\n", testname);
+        exit(EXIT_FAILURE);
+    }
+    
+    ANALYZE(testname, rng->next(rng->state, buffer, n), BENCH_SIMS_FOR(n), 1);
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void benchmark_sweep_xoshiro256_next(size_t n)
+{
+    SweepNext(SPK_GENERATOR_XOSHIRO256, "xoshiro256++ next, fill n element buffer", n);
+}
+
+/******************************************************************************/
+
+void benchmark_sweep_pcg64_insecure_x8_next(size_t n)
+{
+    SweepNext(SPK_GENERATOR_PCG64ix8, "PCG 64-bit insecure x8 next, fill n element buffer", n);
+}
+
+/******************************************************************************/
+
+void benchmark_sweep_xoshiro256_x4_next(size_t n)
+{
+    SweepNext(SPK_GENERATOR_XOSHIRO256x4, "xoshiro256++ x4 next, fill n element buffer", n);
+}
+
+/******************************************************************************/
+
+void benchmark_sweep_philox4x32_next(size_t n)
+{
+    SweepNext(SPK_GENERATOR_PHILOX4x32, "Philox4x32-10 next, fill n element buffer", n);
+}
+
+/*******************************************************************************
+Generator matrix. Every engine runs every method at every size, reported per
+element and in GB/s of output. 1 and 16 elements measure call overhead, 1K stays
+in L1, 64K in L2, and 16M words are larger than most L3 caches so the output
+streams to DRAM. RDRAND stops at 1K, larger fills would take minutes, and bias
+with exp of 16 or more stops at 64K since it is compute bound long before that.
+
+The rand shapes cover a small range, a power of two, the full word where no
+reduction is needed, and 2^63 + 1 values where about half of all draws are
+rejected. Bias uses p = 3 / 2^exp so that all exp bits of p are significant.
+*/
+
+static const size_t matrix_sizes[] = {1, 16, 1024, 65536, 16777216};
+
+struct matrix_engine
+{
+    const char *name;
+    size_t max_size;
+    int identifier;
+    char padding[4];
+};
+
+static const struct matrix_engine matrix_engines[] =
+{
+    {"pcg64i",          SIZE_MAX,   SPK_GENERATOR_PCG64i,         {0}},
+    {"xsh64",           SIZE_MAX,   SPK_GENERATOR_XSH64,          {0}},
+    {"xoshiro256",      SIZE_MAX,   SPK_GENERATOR_XOSHIRO256,     {0}},
+    {"xoroshiro128",    SIZE_MAX,   SPK_GENERATOR_XOROSHIRO128,   {0}},
+    {"pcg64ix4",        SIZE_MAX,   SPK_GENERATOR_PCG64ix4,       {0}},
+    {"pcg64ix8",        SIZE_MAX,   SPK_GENERATOR_PCG64ix8,       {0}},
+    {"xoshiro256x4",    SIZE_MAX,   SPK_GENERATOR_XOSHIRO256x4,   {0}},
+    {"philox4x32",      SIZE_MAX,   SPK_GENERATOR_PHILOX4x32,     {0}},
+    {"rdrand",          1024,       SPK_GENERATOR_RDRAND,         {0}},
+};
+
+enum matrix_kind
+{
+    MATRIX_NEXT,
+    MATRIX_RAND,
+    MATRIX_BIAS,
+    MATRIX_UNID,
+    MATRIX_UNIF,
+};
+
+struct matrix_method
+{
+    const char *name;
+    uint64_t min;
+    uint64_t max;
+    size_t max_size;
+    enum matrix_kind kind;
+    int exp;
+};
+
+static const struct matrix_method matrix_methods[] =
+{
+    {"next",            0,  0,                      SIZE_MAX,   MATRIX_NEXT,    0},
+    {"rand_small",      0,  9,                      SIZE_MAX,   MATRIX_RAND,    0},
+    {"rand_pow2",       0,  255,                    SIZE_MAX,   MATRIX_RAND,    0},
+    {"rand_full",       0,  UINT64_MAX,             SIZE_MAX,   MATRIX_RAND,    0},
+    {"rand_worst",      0,  (uint64_t) 1 << 63,     SIZE_MAX,   MATRIX_RAND,    0},
+    {"bias_exp1",       0,  0,                      SIZE_MAX,   MATRIX_BIAS,    1},
+    {"bias_exp2",       0,  0,                      SIZE_MAX,   MATRIX_BIAS,    2},
+    {"bias_exp4",       0,  0,                      SIZE_MAX,   MATRIX_BIAS,    4},
+    {"bias_exp8",       0,  0,                      SIZE_MAX,   MATRIX_BIAS,    8},
+    {"bias_exp16",      0,  0,                      65536,      MATRIX_BIAS,    16},
+    {"bias_exp32",      0,  0,                      65536,      MATRIX_BIAS,    32},
+    {"bias_exp64",      0,  0,                      65536,      MATRIX_BIAS,    64},
+    {"unid",            0,  0,                      SIZE_MAX,   MATRIX_UNID,    0},
+    {"unif",            0,  0,                      SIZE_MAX,   MATRIX_UNIF,    0},
+};
+
+struct matrix_cell
+{
+    const struct matrix_engine *engine;
+    const struct matrix_method *method;
+    char label[64];
+};
+
+/******************************************************************************/
+
+static void MatrixCell(const void *ctx, size_t n)
+{
+    const struct matrix_cell *cell = ctx;
+    const struct matrix_method *method = cell->method;
+    
+    if (n > cell->engine->max_size || n > method->max_size) return;
+    
+    spk_generator rng;
+    int error = spk_GeneratorNew(&rng, cell->engine->identifier, 0);
+    
+    //no hardware generator on this cpu, nothing to measure
+    if (error == SPK_ERROR_RDRAND) return;
+    
+    if (error)
+    {
+        fprintf(stderr, "%s init failure: code %d\n", cell->engine->name, error);
+        exit(EXIT_FAILURE);
+    }
+    
+    uint64_t *buffer = malloc(n * sizeof(uint64_t));
+    if (!buffer)
+    {
+        fprintf(stderr, "%s matrix malloc failure\n", cell->engine->name);
+        exit(EXIT_FAILURE);
+    }
+    
+    const double p = ldexp(method->exp == 1 ? 1.0 : 3.0, -method->exp);
+    
+    switch (method->kind)
+    {
+        case MATRIX_NEXT:
+            bench_Throughput(n, sizeof(uint64_t));
+            ANALYZE(cell->label, rng->next(rng->state, buffer, n), BENCH_AUTO, BENCH_AUTO);
+            break;
+            
+        case MATRIX_RAND:
+            bench_Throughput(n, sizeof(uint64_t));
+            ANALYZE(cell->label, rng->rand(rng, buffer, n, method->min, method->max), BENCH_AUTO, BENCH_AUTO);
+            break;
+            
+        case MATRIX_BIAS:
+            bench_Throughput(n, sizeof(uint64_t));
+            ANALYZE(cell->label, rng->bias(rng, buffer, n, p, method->exp), BENCH_AUTO, BENCH_AUTO);
+            break;
+            
+        case MATRIX_UNID:
+            bench_Throughput(n, sizeof(double));
+            ANALYZE(cell->label, rng->unid(rng, (double *) buffer, n), BENCH_AUTO, BENCH_AUTO);
+            break;
+            
+        case MATRIX_UNIF:
+            bench_Throughput(n, sizeof(float));
+            ANALYZE(cell->label, rng->unif(rng, (float *) buffer, n), BENCH_AUTO, BENCH_AUTO);
+            break;
+    }
+    
+    free(buffer);
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Cases are named matrix_<method>_<engine>, so --filter matrix_rand_worst picks
+one method across all engines and --filter _philox4x32 one engine
+*/
+
+static void RunMatrix(void)
+{
+    const size_t engines = sizeof(matrix_engines) / sizeof(matrix_engines[0]);
+    const size_t methods = sizeof(matrix_methods) / sizeof(matrix_methods[0]);
+    const size_t sizes = sizeof(matrix_sizes) / sizeof(matrix_sizes[0]);
+    
+    for (size_t m = 0; m < methods; m++)
+    {
+        for (size_t e = 0; e < engines; e++)
+        {
+            struct matrix_cell cell = {&matrix_engines[e], &matrix_methods[m], {0}};
+            char name[64];
+            
+            snprintf(name, sizeof(name), "matrix_%s_%s", matrix_methods[m].name, matrix_engines[e].name);
+            snprintf(cell.label, sizeof(cell.label), "%s %s", matrix_engines[e].name, matrix_methods[m].name);
+            
+            bench_Cell(name, MatrixCell, &cell, matrix_sizes, sizes);
+        }
+    }
+}
+
+/******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    BENCHMARKS_BEGIN(argc, argv);
         BENCHMARKS_MODULE("psuedo random number generators");
             RUN_BENCHMARK(benchmark_generator_sisd_pcg64_insecure_next);
             RUN_BENCHMARK(benchmark_generator_sisd_xorshift64_next);
+            RUN_BENCHMARK(benchmark_generator_sisd_xoshiro256_next);
+            RUN_BENCHMARK(benchmark_generator_sisd_xoroshiro128_next);
+            RUN_BENCHMARK(benchmark_generator_sisd_rdrand_next);
             RUN_BENCHMARK(benchmark_generator_sisd_pcg64_insecure_bias);
+            RUN_BENCHMARK(benchmark_generator_sisd_pcg64_insecure_bias_program);
+            RUN_BENCHMARK(benchmark_generator_sisd_pcg64_insecure_next_small);
+            RUN_BENCHMARK(benchmark_generator_inline_pcg64_insecure_next_small);
+            RUN_BENCHMARK(benchmark_generator_buffer_pcg64_insecure_scalar_next);
+            RUN_BENCHMARK(benchmark_generator_simd_pcg64_insecure_x4_next);
+            RUN_BENCHMARK(benchmark_generator_simd_pcg64_insecure_x8_next);
+            RUN_BENCHMARK(benchmark_generator_simd_xoshiro256_x4_next);
+            RUN_BENCHMARK(benchmark_generator_simd_philox4x32_next);
+            RUN_BENCHMARK(benchmark_generator_fill_then_sum_unid);
+            RUN_BENCHMARK(benchmark_generator_stream_sum_unid);
+            RUN_BENCHMARK(benchmark_montecarlo_integrate_unid);
+            RUN_BENCHMARK(benchmark_montecarlo_integrate_parallel_unid);
+        BENCHMARKS_MODULE("fill size sweeps");
+            RUN_SWEEP(benchmark_sweep_xoshiro256_next, fill_sizes);
+            RUN_SWEEP(benchmark_sweep_pcg64_insecure_x8_next, fill_sizes);
+            RUN_SWEEP(benchmark_sweep_xoshiro256_x4_next, fill_sizes);
+            RUN_SWEEP(benchmark_sweep_philox4x32_next, fill_sizes);
+        BENCHMARKS_MODULE("generator matrix");
+            RunMatrix();
+        BENCHMARKS_MODULE("probability distributions");
+            RUN_BENCHMARK(benchmark_continuous_normal_pcg64_insecure);
+            RUN_BENCHMARK(benchmark_continuous_exponential_pcg64_insecure);
+            RUN_BENCHMARK(benchmark_discrete_alias_pcg64_insecure);
+            RUN_BENCHMARK(benchmark_discrete_binomial_pcg64_insecure);
+            RUN_BENCHMARK(benchmark_discrete_shuffle_pcg64_insecure);
     BENCHMARKS_END();
 }
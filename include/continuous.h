@@ -0,0 +1,49 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Continuous probability distributions built on the generator interface
+* NOTE: Link with -lm when this submodule is used
+* LICS: MIT License
+*/
+
+#ifndef SPK_CONTINUOUS_H
+#define SPK_CONTINUOUS_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+
+/*******************************************************************************
+* NAME: spk_Normal
+* DESC: normal variates with mean mu and standard deviation sigma
+* OUTP: scipack error code
+* @ sigma : zero is allowed and fills dest with mu
+* NOTE: 256 layer Ziggurat of Marsaglia and Tsang, one raw word per variate on
+* roughly 99% of draws
+*******************************************************************************/
+int spk_Normal
+(
+    spk_generator rng,
+    double *dest,
+    const size_t n,
+    const double mu,
+    const double sigma
+);
+
+/*******************************************************************************
+* NAME: spk_Exponential
+* DESC: exponential variates with rate lambda, i.e. mean 1 / lambda
+* OUTP: scipack error code
+* @ lambda : strictly positive
+* NOTE: 256 layer Ziggurat of Marsaglia and Tsang, one raw word per variate on
+* roughly 99% of draws
+*******************************************************************************/
+int spk_Exponential
+(
+    spk_generator rng,
+    double *dest,
+    const size_t n,
+    const double lambda
+);
+
+#endif
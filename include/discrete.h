@@ -0,0 +1,136 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Discrete probability distributions built on the generator interface
+* NOTE: Link with -lm when this submodule is used
+* LICS: MIT License
+*/
+
+#ifndef SPK_DISCRETE_H
+#define SPK_DISCRETE_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+
+/*******************************************************************************
+* DESC: largest number of outcomes accepted by spk_DiscreteNew
+*******************************************************************************/
+#define SPK_DISCRETE_MAX            ((size_t) 1 << 32)
+
+/*******************************************************************************
+* NAME: struct spk_discrete
+* DESC: Walker alias table for a categorical distribution, built with Vose's
+* numerically stable O(n) method
+* @ entries : one packed word per column, the high 32 bits are the acceptance
+* threshold and the low 32 bits are the alias outcome
+* @ outcomes : number of outcomes the table was built from
+* @ shift : 64 - log2 of the column count
+* NOTE: the column count is the outcome count rounded up to a power of two, the
+* padding columns have zero probability and always resolve to their alias. This
+* lets the top bits of a raw word pick the column exactly, with no modulo bias,
+* and leaves the bits below them for the threshold.
+*******************************************************************************/
+typedef struct spk_discrete *spk_discrete;
+
+struct spk_discrete
+{
+    uint64_t *entries;
+    size_t outcomes;
+    uint64_t shift;
+};
+
+/*******************************************************************************
+* NAME: spk_DiscreteNew
+* DESC: build an alias table from n non-negative weights
+* OUTP: scipack error code
+* @ weights : finite and non-negative, need not sum to one but may not sum to 0
+* @ n : 1 to SPK_DISCRETE_MAX outcomes
+*******************************************************************************/
+int spk_DiscreteNew(spk_discrete *table, const double *weights, const size_t n);
+
+/*******************************************************************************
+* NAME: spk_DiscreteDelete
+* DESC: release system resources
+*******************************************************************************/
+void spk_DiscreteDelete(spk_discrete table);
+
+/*******************************************************************************
+* NAME: spk_DiscreteSample
+* DESC: fill dest with outcome indices 0 to table->outcomes - 1
+* OUTP: scipack error code
+* NOTE: O(1) per sample, exactly one raw word from the next method per output
+*******************************************************************************/
+int spk_DiscreteSample
+(
+    spk_generator rng,
+    const spk_discrete table,
+    uint64_t *dest,
+    const size_t n
+);
+
+/*******************************************************************************
+* DESC: largest trial count accepted by spk_Binomial, beyond this the counts are
+* no longer exact in double precision
+*******************************************************************************/
+#define SPK_BINOMIAL_MAX            ((uint64_t) 1 << 53)
+
+/*******************************************************************************
+* NAME: spk_Binomial
+* DESC: fill dest with the number of successes in trials Bernoulli(p) trials
+* OUTP: scipack error code
+* @ trials : 0 to SPK_BINOMIAL_MAX
+* @ p : probability of success on [0, 1]
+* NOTE: when p has few significant bits, e.g. 1/2 or 3/8, and the trial count is
+* small, each output is a popcount over ceil(trials / 64) words from the bias
+* machinery. Otherwise np < 30 uses inversion and np >= 30 uses BTPE from
+* Kachitvichyanukul and Schmeiser, both on uniforms drawn via next.
+*******************************************************************************/
+int spk_Binomial
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t trials,
+    const double p
+);
+
+/*******************************************************************************
+* NAME: spk_Shuffle
+* DESC: permute count elements of the given byte size in place, uniformly over
+* all count! orderings
+* OUTP: scipack error code
+* NOTE: Fisher-Yates driven by Lemire's multiply-shift on raw words pulled from
+* next in blocks, the division behind the rejection threshold only runs on the
+* rare step where the low product falls below the range
+*******************************************************************************/
+int spk_Shuffle(spk_generator rng, void *base, const size_t count, const size_t size);
+
+/*******************************************************************************
+* DESC: population to sample ratio at or below which spk_SampleWithoutReplacement
+* shuffles a materialized copy of the population instead of using Floyd
+*******************************************************************************/
+#define SPK_SAMPLE_DENSE            4
+
+/*******************************************************************************
+* NAME: spk_SampleWithoutReplacement
+* DESC: fill dest with k distinct indices drawn uniformly from 0 to N - 1, every
+* ordered k-tuple is equally likely
+* OUTP: scipack error code
+* @ k : 0 to N
+* NOTE: dense requests, N <= SPK_SAMPLE_DENSE * k, partially shuffle a scratch
+* copy of the population. Otherwise Floyd's algorithm draws the subset with k
+* bounded integers and a hash set of roughly 2k words, it never touches the
+* population so N may be as large as UINT64_MAX. The subset is then shuffled
+* in dest so that its order is uniform as well.
+*******************************************************************************/
+int spk_SampleWithoutReplacement
+(
+    spk_generator rng,
+    const size_t k,
+    const uint64_t N,
+    uint64_t *dest
+);
+
+#endif
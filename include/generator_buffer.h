@@ -0,0 +1,140 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Buffered wrapper around any generator for cheap scalar draws
+* NOTE: Low level subroutines only, use probability module for high level API
+* LICS: MIT License
+*/
+
+#ifndef SPK_GENERATOR_BUFFER_H
+#define SPK_GENERATOR_BUFFER_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+#include <string.h> //memcpy
+
+/*******************************************************************************
+* DESC: valid ring capacities in raw words
+* NOTE: the capacity must also be a multiple of SPK_BUFFER_ALIGN / 8 words so
+* that every refill is a whole number of lanes for the SIMD generators
+*******************************************************************************/
+#define SPK_BUFFER_MIN              256
+#define SPK_BUFFER_MAX              4096
+#define SPK_BUFFER_DEFAULT          1024
+#define SPK_BUFFER_ALIGN            64
+
+/*******************************************************************************
+* NAME: struct spk_generator_buffer
+* DESC: cache aligned ring of pre-generated words, refilled in bulk via next
+* @ data : capacity raw words aligned to SPK_BUFFER_ALIGN bytes
+* @ position : index of the next unread word, capacity when the ring is empty
+* @ capacity : total words per refill
+* @ rng : the wrapped generator, which the buffer does not own
+* @ error : first error returned by a refill, SPK_ERROR_SUCCESS until then
+* NOTE: rng must outlive the buffer and should not be drawn from directly while
+* the buffer is in use, otherwise the two streams overlap
+* NOTE: words popped after a failed refill are zero, check error after a batch
+* of draws and discard the batch if it is set
+*******************************************************************************/
+typedef struct spk_generator_buffer *spk_generator_buffer;
+
+struct spk_generator_buffer
+{
+    uint64_t *data;
+    size_t position;
+    size_t capacity;
+    spk_generator rng;
+    int error;
+    char padding[4];
+};
+
+/*******************************************************************************
+* NAME: spk_BufferNew
+* DESC: wrap a generator in a buffer, the first refill happens on the first pop
+* OUTP: scipack error code
+* @ capacity : SPK_BUFFER_MIN to SPK_BUFFER_MAX words, multiple of 8
+*******************************************************************************/
+int spk_BufferNew(spk_generator_buffer *buf, spk_generator rng, size_t capacity);
+
+/*******************************************************************************
+* NAME: spk_BufferDelete
+* DESC: release system resources, the wrapped generator is left untouched
+*******************************************************************************/
+void spk_BufferDelete(spk_generator_buffer buf);
+
+/*******************************************************************************
+* NAME: spk_BufferRefill
+* DESC: overwrite the whole ring with fresh output and rewind it
+* OUTP: scipack error code, also recorded in buf->error if it is the first
+* NOTE: unread words are discarded, pop functions call this automatically
+*******************************************************************************/
+int spk_BufferRefill(spk_generator_buffer buf);
+
+/*******************************************************************************
+* NAME: spk_BufferNext
+* DESC: pop one raw word
+*******************************************************************************/
+static inline uint64_t spk_BufferNext(spk_generator_buffer buf)
+{
+    if (buf->position == buf->capacity) spk_BufferRefill(buf);
+    
+    return buf->data[buf->position++];
+}
+
+/*******************************************************************************
+* NAME: spk_BufferRand
+* DESC: pop one bounded random integer in [min, max] inclusive
+* NOTE: Lemire's multiply-shift with rejection, the threshold division is only
+* computed on the rare occasion that the low product falls below the range
+* NOTE: not guaranteed to match the sequence produced by the rand method
+*******************************************************************************/
+static inline uint64_t spk_BufferRand
+(
+    spk_generator_buffer buf,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    __extension__ typedef unsigned __int128 spk_buffer_uint128;
+    
+    const uint64_t range = max - min;
+    
+    //same edge cases as the rand method, a single value needs no draws
+    if (range == UINT64_MAX) return spk_BufferNext(buf);
+    if (range == 0) return min;
+    
+    const uint64_t ceiling = range + 1;
+    spk_buffer_uint128 product = (spk_buffer_uint128) spk_BufferNext(buf) * ceiling;
+    
+    if ((uint64_t) product < ceiling)
+    {
+        const uint64_t threshold = -ceiling % ceiling;
+        
+        //zeroed words after a failed refill would never clear the threshold
+        while ((uint64_t) product < threshold && !buf->error)
+        {
+            product = (spk_buffer_uint128) spk_BufferNext(buf) * ceiling;
+        }
+    }
+    
+    return min + (uint64_t) (product >> 64);
+}
+
+/*******************************************************************************
+* NAME: spk_BufferUnid
+* DESC: pop one uniform variate of type double in [0, 1)
+* NOTE: same exponent injection of the top 52 bits as the unid method
+*******************************************************************************/
+static inline double spk_BufferUnid(spk_generator_buffer buf)
+{
+    const uint64_t bits = (spk_BufferNext(buf) >> 12) | 0x3FF0000000000000ULL;
+    double result = 0.0;
+    
+    memcpy(&result, &bits, sizeof(double));
+    
+    return result - 1.0;
+}
+
+#endif
@@ -0,0 +1,236 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Header-inline SISD generators for small fills inside tight loops
+* NOTE: Opt-in fast path, the generic interface lives in generator_sisd.h
+* LICS: MIT License
+*/
+
+#ifndef SPK_GENERATOR_INLINE_H
+#define SPK_GENERATOR_INLINE_H
+
+#include "scipack_config.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+
+/*******************************************************************************
+* NAME: struct spk_pcg64i, struct spk_xsh64
+* DESC: concrete generator states which callers may keep on the stack
+* NOTE: identical layout to the state[] member of the matching spk_generator, so
+* (spk_pcg64i *) rng->state is valid for a SPK_GENERATOR_PCG64i generator
+*******************************************************************************/
+typedef struct spk_pcg64i
+{
+    uint64_t state;
+    uint64_t increment;
+} spk_pcg64i;
+
+typedef struct spk_xsh64
+{
+    uint64_t state;
+} spk_xsh64;
+
+/*******************************************************************************
+* NAME: struct spk_xoshiro256, struct spk_xoroshiro128
+* DESC: concrete states for xoshiro256++ and xoroshiro128+, same layout rule
+*******************************************************************************/
+typedef struct spk_xoshiro256
+{
+    uint64_t s[4];
+} spk_xoshiro256;
+
+typedef struct spk_xoroshiro128
+{
+    uint64_t s[2];
+} spk_xoroshiro128;
+
+/*******************************************************************************
+* NAME: spk_PCG64iInit, spk_XSH64Init, spk_Xoshiro256Init, spk_Xoroshiro128Init
+* DESC: seed a concrete generator exactly as spk_GeneratorNew would
+* OUTP: scipack error code
+* @ seed : pass zero for non-deterministic seeding
+*******************************************************************************/
+int spk_PCG64iInit(spk_pcg64i *pcg, uint64_t seed);
+int spk_XSH64Init(spk_xsh64 *xsh, uint64_t seed);
+int spk_Xoshiro256Init(spk_xoshiro256 *xos, uint64_t seed);
+int spk_Xoroshiro128Init(spk_xoroshiro128 *xor, uint64_t seed);
+
+/*******************************************************************************
+* NAME: spk_Xoshiro256Jump, spk_Xoshiro256LongJump
+* DESC: advance xoshiro256++ by 2^128 or 2^192 steps
+* NOTE: Vigna's jump and long_jump, giving 2^128 streams of 2^128 words or 2^64
+* streams of 2^192 words for parallel work. spk_GeneratorJump covers any delta.
+*******************************************************************************/
+void spk_Xoshiro256Jump(spk_xoshiro256 *xos);
+void spk_Xoshiro256LongJump(spk_xoshiro256 *xos);
+
+/*******************************************************************************
+* NAME: spk_Xoroshiro128Jump, spk_Xoroshiro128LongJump
+* DESC: advance xoroshiro128+ by 2^64 or 2^96 steps
+*******************************************************************************/
+void spk_Xoroshiro128Jump(spk_xoroshiro128 *xor);
+void spk_Xoroshiro128LongJump(spk_xoroshiro128 *xor);
+
+/*******************************************************************************
+The following functions are originally Copyright 2014 Melissa O'Neill, which is
+licensed under the Apache License, Version 2.0. PCG was licensed under the
+Apache License, Version 2.0 (the "License"); You may obtain a copy of the
+License at http://www.apache.org/licenses/LICENSE-2.0
+
+This is the default insecure 64-bit output PCG denoted commonly as
+pcg_output_rxs_m_xs_64_64. The modifications from the original source written
+by Melissa O'Neill are listed alongside the generic wrapper in generator_sisd.c.
+
+All credit for the design, theory, and innovations of the PCG family is due to
+Melissa O'Neill, you can find a copy of the original source at her website,
+https://www.pcg-random.org/
+*******************************************************************************/
+
+/*******************************************************************************
+* NAME: spk_PCG64iNext
+* DESC: advance the generator by one step
+* OUTP: one raw 64-bit word
+*******************************************************************************/
+static inline uint64_t spk_PCG64iNext(spk_pcg64i *pcg)
+{
+    const uint64_t state = pcg->state;
+    uint64_t permuted_state = 0;
+    
+    //permute the current state
+    permuted_state = state >> 59ULL;
+    permuted_state += 5ULL;
+    permuted_state = state >> permuted_state;
+    permuted_state ^= state;
+    permuted_state *= 0xAEF17502108EF2D9ULL;
+    permuted_state ^= (permuted_state >> 43ULL);
+    
+    //update internal state
+    pcg->state = state * 0x5851F42D4C957F2DULL + pcg->increment;
+    
+    return permuted_state;
+}
+
+/*******************************************************************************
+* NAME: spk_PCG64iFill
+* DESC: equivalent to n calls to spk_PCG64iNext
+* NOTE: the state is held in a local across the loop, so the compiler need not
+* assume that dest aliases the generator and reload it on every iteration
+*******************************************************************************/
+static inline void spk_PCG64iFill(spk_pcg64i *pcg, uint64_t *dest, const size_t n)
+{
+    spk_pcg64i local = *pcg;
+    
+    for (size_t i = 0; i < n; i++) dest[i] = spk_PCG64iNext(&local);
+    
+    pcg->state = local.state;
+}
+
+/*******************************************************************************
+* NAME: spk_XSH64Next
+* DESC: advance the xorshift 64-bit generator by George Marsaglia by one step
+* OUTP: one raw 64-bit word
+*******************************************************************************/
+static inline uint64_t spk_XSH64Next(spk_xsh64 *xsh)
+{
+    uint64_t state = xsh->state;
+    
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    
+    xsh->state = state;
+    
+    return state;
+}
+
+/*******************************************************************************
+* NAME: spk_XSH64Fill
+* DESC: equivalent to n calls to spk_XSH64Next
+*******************************************************************************/
+static inline void spk_XSH64Fill(spk_xsh64 *xsh, uint64_t *dest, const size_t n)
+{
+    spk_xsh64 local = *xsh;
+    
+    for (size_t i = 0; i < n; i++) dest[i] = spk_XSH64Next(&local);
+    
+    xsh->state = local.state;
+}
+
+/*******************************************************************************
+The following functions are adapted from the public domain reference code by
+David Blackman and Sebastiano Vigna, "Scrambled Linear Pseudorandom Number
+Generators" (2021), see https://prng.di.unimi.it/. The xoroshiro128+ shifts are
+the 2018 revision (24, 16, 37) rather than the original (55, 14, 36).
+*******************************************************************************/
+
+/*******************************************************************************
+* NAME: spk_Xoshiro256Next
+* DESC: advance the xoshiro256++ generator by one step
+* OUTP: one raw 64-bit word
+*******************************************************************************/
+static inline uint64_t spk_Xoshiro256Next(spk_xoshiro256 *xos)
+{
+    uint64_t *s = xos->s;
+    
+    const uint64_t sum = s[0] + s[3];
+    const uint64_t result = ((sum << 23) | (sum >> 41)) + s[0];
+    const uint64_t t = s[1] << 17;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    
+    return result;
+}
+
+/*******************************************************************************
+* NAME: spk_Xoshiro256Fill
+* DESC: equivalent to n calls to spk_Xoshiro256Next
+*******************************************************************************/
+static inline void spk_Xoshiro256Fill(spk_xoshiro256 *xos, uint64_t *dest, const size_t n)
+{
+    spk_xoshiro256 local = *xos;
+    
+    for (size_t i = 0; i < n; i++) dest[i] = spk_Xoshiro256Next(&local);
+    
+    *xos = local;
+}
+
+/*******************************************************************************
+* NAME: spk_Xoroshiro128Next
+* DESC: advance the xoroshiro128+ generator by one step
+* OUTP: one raw 64-bit word
+* NOTE: the lowest bits are weak linear functions of the state, which doesn't
+* matter for unid and unif since they keep the top bits only
+*******************************************************************************/
+static inline uint64_t spk_Xoroshiro128Next(spk_xoroshiro128 *xor)
+{
+    const uint64_t s0 = xor->s[0];
+    uint64_t s1 = xor->s[1];
+    
+    const uint64_t result = s0 + s1;
+    
+    s1 ^= s0;
+    xor->s[0] = ((s0 << 24) | (s0 >> 40)) ^ s1 ^ (s1 << 16);
+    xor->s[1] = (s1 << 37) | (s1 >> 27);
+    
+    return result;
+}
+
+/*******************************************************************************
+* NAME: spk_Xoroshiro128Fill
+* DESC: equivalent to n calls to spk_Xoroshiro128Next
+*******************************************************************************/
+static inline void spk_Xoroshiro128Fill(spk_xoroshiro128 *xor, uint64_t *dest, const size_t n)
+{
+    spk_xoroshiro128 local = *xor;
+    
+    for (size_t i = 0; i < n; i++) dest[i] = spk_Xoroshiro128Next(&local);
+    
+    *xor = local;
+}
+
+#endif
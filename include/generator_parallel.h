@@ -0,0 +1,90 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Multithreaded bulk fills over a persistent library-owned thread pool
+* NOTE: Link with -pthread when this submodule is used
+* LICS: MIT License
+*/
+
+#ifndef SPK_GENERATOR_PARALLEL_H
+#define SPK_GENERATOR_PARALLEL_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+
+/*******************************************************************************
+* DESC: parallel fill granularity in output elements
+* @ SPK_PARALLEL_CHUNK : next, unid, and unif spans are whole multiples of this
+* @ SPK_PARALLEL_RAND_CHUNK : rand values drawn from each substream
+* @ SPK_PARALLEL_RAND_STRIDE : raw words between consecutive rand substreams
+*******************************************************************************/
+#define SPK_PARALLEL_CHUNK          ((size_t) 1 << 16)
+#define SPK_PARALLEL_RAND_CHUNK     ((size_t) 1 << 20)
+#define SPK_PARALLEL_RAND_STRIDE    ((uint64_t) 1 << 40)
+
+/*******************************************************************************
+* NAME: struct spk_fill_method
+* DESC: which generator method to run in parallel, and its arguments
+* @ min : lower bound for SPK_FILL_RAND, ignored otherwise
+* @ max : upper bound for SPK_FILL_RAND, ignored otherwise
+* @ kind : method selector, dest must point to the matching element type
+*******************************************************************************/
+enum spk_fill_kind
+{
+    SPK_FILL_NEXT       = 0,    /* uint64_t, identical to the serial stream   */
+    SPK_FILL_UNID       = 1,    /* double, identical to the serial stream     */
+    SPK_FILL_UNIF       = 2,    /* float, identical to the serial stream      */
+    SPK_FILL_RAND       = 3,    /* uint64_t, one substream per rand chunk     */
+};
+
+typedef struct spk_fill_method
+{
+    uint64_t min;
+    uint64_t max;
+    enum spk_fill_kind kind;
+    char padding[4];
+} spk_fill_method;
+
+/*******************************************************************************
+* NAME: spk_ParallelInit
+* DESC: start the thread pool, or restart it with a different size
+* OUTP: scipack error code
+* @ threads : total threads including the caller, zero for all online cores
+* NOTE: optional, the first parallel fill starts a default pool on demand
+*******************************************************************************/
+int spk_ParallelInit(size_t threads);
+
+/*******************************************************************************
+* NAME: spk_ParallelDelete
+* DESC: join all pool threads and release system resources
+*******************************************************************************/
+void spk_ParallelDelete(void);
+
+/*******************************************************************************
+* NAME: spk_GeneratorFillParallel
+* DESC: run a generator method over dest across the thread pool
+* OUTP: scipack error code
+* NOTE: SPK_FILL_RAND DOES NOT MATCH THE SERIAL rand METHOD. Chunk c of
+* SPK_PARALLEL_RAND_CHUNK values is drawn from a copy of rng jumped
+* c * SPK_PARALLEL_RAND_STRIDE = c * 2^40 words ahead, so the output is
+* deterministic and independent of the thread count but is a different stream.
+* Call rng->rand serially where the serial values are needed.
+* NOTE: next, unid, and unif write exactly what the serial method would write
+* and leave rng in the same state. Each worker takes a copy of rng jumped ahead
+* to the start of its span. rand leaves rng at the start of the chunk after its
+* last one.
+* NOTE: fills from several threads at once are run one after another
+* NOTE: SPK_GENERATOR_RDRAND is accepted and simply draws on every core at once,
+* if any span fails the call returns SPK_ERROR_RDRAND and dest is incomplete
+*******************************************************************************/
+int spk_GeneratorFillParallel
+(
+    spk_generator rng,
+    void *dest,
+    const size_t n,
+    const spk_fill_method *method
+);
+
+#endif
@@ -0,0 +1,130 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Pre-generated random pools on disk, replayed through a memory mapping
+* NOTE: Link with -pthread when this submodule is used
+* LICS: MIT License
+*/
+
+#ifndef SPK_GENERATOR_POOL_H
+#define SPK_GENERATOR_POOL_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+
+/*******************************************************************************
+* DESC: a generator whose output is read from a pool file instead of computed
+* @ SPK_GENERATOR_POOL : created only by spk_GeneratorPoolOpen, never by New
+* NOTE: spk_GeneratorJump skips delta elements and spk_GeneratorAt reads words
+* by their index in the source stream, see spk_GeneratorPoolOpen
+* NOTE: there is no state to split or serialize, Split, ArrayNew and Serialize
+* reject the identifier, reopen the file to replay it from the start
+*******************************************************************************/
+#define SPK_GENERATOR_POOL          0xA40
+
+/*******************************************************************************
+* DESC: pool file layout, all header fields little-endian
+* @ SPK_POOL_VERSION : layout revision, checked on open
+* @ SPK_POOL_HEADER : bytes before the first element, a whole cache line
+* NOTE: the header is the 4 byte magic "SPKP", the layout revision, the
+* SPK_MAJOR, SPK_MINOR, and SPK_PATCH of the writer in one byte each, then the
+* source identifier and the kind as 32-bit fields, then the seed, the position
+* and the element count as 64-bit fields. The rest of the line is zero.
+* NOTE: elements are 8 bytes each in host order, which on x86-64 is also
+* little-endian, so the file can be mapped and read in place
+*******************************************************************************/
+#define SPK_POOL_VERSION            1
+#define SPK_POOL_HEADER             ((size_t) 64)
+
+/*******************************************************************************
+* NAME: enum spk_pool_kind
+* DESC: what the elements of a pool are
+*******************************************************************************/
+enum spk_pool_kind
+{
+    SPK_POOL_NEXT       = 0,    /* uint64_t raw words, every method available */
+    SPK_POOL_UNID       = 1,    /* double uniforms, only unid is available    */
+};
+
+/*******************************************************************************
+* NAME: struct spk_pool_info
+* DESC: the header of an open pool and how far it has been read
+* @ seed : seed of the source generator, the drawn one if the writer was given 0
+* @ position : source stream index in words of the first element
+* @ count : total elements in the pool
+* @ cursor : elements consumed so far, the next element is position + cursor
+* @ identifier : the SPK_GENERATOR_* value of the source generator
+* @ kind : element type of the pool
+*******************************************************************************/
+typedef struct spk_pool_info
+{
+    uint64_t seed;
+    uint64_t position;
+    uint64_t count;
+    uint64_t cursor;
+    int identifier;
+    enum spk_pool_kind kind;
+} spk_pool_info;
+
+/*******************************************************************************
+* NAME: spk_GeneratorPoolWrite
+* DESC: write count elements of a generator stream to a new pool file at path
+* OUTP: scipack error code, SPK_ERROR_FILEIO if the file cannot be written
+* @ seed : pass zero to draw a seed as spk_GeneratorNew does, the header records
+* the draw
+* @ position : words of the stream to skip before the first element
+* @ kind : raw words from next or doubles from unid
+* NOTE: the elements are exactly what next or unid would write after a jump of
+* position words and are filled with spk_GeneratorFillParallel straight into a
+* shared mapping of the file, see spk_ParallelInit for the thread count
+* NOTE: space is reserved up front so a full disk fails here and not as SIGBUS.
+* The header goes in last, and a file that is incomplete is removed.
+*******************************************************************************/
+int spk_GeneratorPoolWrite
+(
+    const char *path,
+    int identifier,
+    uint64_t seed,
+    uint64_t position,
+    size_t count,
+    enum spk_pool_kind kind
+);
+
+/*******************************************************************************
+* NAME: spk_GeneratorPoolOpen
+* DESC: map a pool file read-only and serve it through the generator interface
+* OUTP: scipack error code, SPK_ERROR_FORMAT if the file is not a valid pool
+* NOTE: the mapping is advised MADV_SEQUENTIAL, so the kernel reads ahead of the
+* cursor and every method is a copy out of the page cache
+* NOTE: a raw pool of a SISD generator replays its next, rand, bias, unid and
+* unif calls exactly. A unid pool only accepts unid, the others return
+* SPK_ERROR_ARGBOUNDS.
+* NOTE: a request for more elements than remain returns SPK_ERROR_EXHAUSTED and
+* consumes nothing, except rand and bias whose consumption is only known as they
+* go, those stop at the end with the pool drained
+* NOTE: the samplers of the probability module pass these errors back from their
+* block refills, and a spk_generator_buffer records them in its error field
+* NOTE: release with spk_GeneratorDelete, which also unmaps the file
+*******************************************************************************/
+int spk_GeneratorPoolOpen(spk_generator *rng, const char *path);
+
+/*******************************************************************************
+* NAME: spk_GeneratorPoolInfo
+* DESC: read back the header and cursor of an open pool
+* OUTP: scipack error code, SPK_ERROR_ARGBOUNDS if rng is not a pool
+*******************************************************************************/
+int spk_GeneratorPoolInfo(const spk_generator rng, spk_pool_info *info);
+
+/*******************************************************************************
+* NAME: spk_GeneratorPoolView
+* DESC: zero-copy alternative to the methods, point into the mapping directly
+* OUTP: scipack error code, SPK_ERROR_EXHAUSTED if fewer than n elements remain
+* @ view : the next n elements as uint64_t for raw pools or double for unid
+* pools, valid and read-only until the pool is deleted
+* NOTE: the cursor advances past the n elements as if they had been copied
+*******************************************************************************/
+int spk_GeneratorPoolView(spk_generator rng, const void **view, const size_t n);
+
+#endif
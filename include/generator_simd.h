@@ -0,0 +1,43 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Subroutines for SIMD psuedo random number generation
+* NOTE: Low level subroutines only, use probability module for high level API
+* LICS: MIT License
+*/
+
+#ifndef SPK_GENERATOR_SIMD_H
+#define SPK_GENERATOR_SIMD_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+/*******************************************************************************
+* DESC: list of available SIMD random number generators
+* @ SPK_GENERATOR_PCG64ix4 : four independent PCG 64-bit insecure lanes
+* @ SPK_GENERATOR_PCG64ix8 : eight independent PCG 64-bit insecure lanes
+* @ SPK_GENERATOR_XOSHIRO256x4 : four xoshiro256++ lanes, 2^192 steps apart
+* NOTE: lanes are interleaved in the output, lane k writes dest[k + i * lanes]
+* NOTE: a fill which is not a multiple of the lane count discards the excess,
+* which includes the last block of a rand, bias, unid or unif call. Many small
+* calls waste up to lanes - 1 words each, use spk_generator_buffer for those.
+* NOTE: these share the struct spk_generator interface in generator_sisd.h
+*******************************************************************************/
+#define SPK_GENERATOR_PCG64ix4      0x340
+#define SPK_GENERATOR_PCG64ix8      0x440
+#define SPK_GENERATOR_XOSHIRO256x4  0x840
+
+/*******************************************************************************
+* DESC: counter-based random number generators
+* @ SPK_GENERATOR_PHILOX4x32 : Philox4x32-10 by Salmon, Moraes, Dror and Shaw
+* NOTE: the output is not interleaved. Word i of the stream is half of the block
+* Philox(key, {i / 2, stream}), so next is a pure function of the key and the
+* position, jumps are O(1), and spk_GeneratorAt reads any word without replay.
+* NOTE: the state[] member holds four words, the key, the stream, the block
+* counter and the word offset within the block. The first two can be assigned
+* directly to give entity i its own stream under a shared key.
+* NOTE: eight blocks are computed per AVX2 iteration, there is no partial lane
+* group to discard
+*******************************************************************************/
+#define SPK_GENERATOR_PHILOX4x32    0x540
+
+#endif
@@ -17,11 +17,30 @@
 * DESC: list of available random number generators
 * @ SPK_GENERATOR_PCG64i : PCG 64-bit insecure by Melissa O'Neill
 * @ SPK_GENERATOR_XSH64 : Xorshift 64-bit by George Marsaglia
+* @ SPK_GENERATOR_XOSHIRO256 : xoshiro256++ by David Blackman and Sebastiano Vigna
+* @ SPK_GENERATOR_XOROSHIRO128 : xoroshiro128+ by Blackman and Vigna
+* @ SPK_GENERATOR_RDRAND : hardware entropy, RDSEED where the CPU has it and
+* RDRAND otherwise, see spk_GeneratorNew
+* NOTE: RDRAND is meant for seeding and key material, it costs hundreds of
+* cycles per word and RDSEED often costs thousands
+* NOTE: XSH64 fails linearity tests in its low bits and is kept for reference,
+* xoroshiro128+ has weak low bits too but is the fastest source for unid/unif
+* NOTE: the default is PCG64i, changing it would change the stream of every
+* caller that asks for SPK_GENERATOR_DEFAULT. See ./benchmark for the speed of
+* each engine on the machine at hand.
 *******************************************************************************/
 #define SPK_GENERATOR_PCG64i        0x140
 #define SPK_GENERATOR_XSH64         0x240
+#define SPK_GENERATOR_XOSHIRO256    0x640
+#define SPK_GENERATOR_XOROSHIRO128  0x740
+#define SPK_GENERATOR_RDRAND        0x940
 #define SPK_GENERATOR_DEFAULT       SPK_GENERATOR_PCG64i
 
+/*******************************************************************************
+* DESC: alignment in bytes of each generator laid out by spk_GeneratorArrayNew
+*******************************************************************************/
+#define SPK_GENERATOR_ALIGN         64
+
 /*******************************************************************************
 * NAME: struct spk_generator
 * DESC: abstract interface between some generator and the end user
@@ -29,7 +48,11 @@
 * @ rand : bounded random integers in [L, H] inclusive
 * @ bias : iid biased bits with probability p = N/2^M, M <= 64, 0 < n < 2^m
 * @ unid : uniform variates of type double along the unit interval
+* @ unif : uniform variates of type float, two per raw word
+* @ identifier : the SPK_GENERATOR_* value this generator was created with
 * @ state : internal generator state
+* NOTE: rand returns SPK_ERROR_ARGBOUNDS for L > H and bias for p outside [0, 1)
+* or M outside [1, 64], unless the checks are off, see spk_SetChecking
 *******************************************************************************/
 typedef struct spk_generator *spk_generator;
 
@@ -67,22 +90,321 @@ struct spk_generator
         const size_t n
     );
     
+    int (*unif)
+    (
+        spk_generator rng,
+        float *dest,
+        const size_t n
+    );
+    
+    int identifier;
+    char padding[4];
+    
     uint64_t state[];
 };
 
+/*******************************************************************************
+* NAME: struct spk_bias_program
+* DESC: precompiled bias method for a fixed probability p = N/2^M
+* @ bitcode : AND (0) and OR (1) instructions, executed from LSB to MSB
+* @ limit : total instructions, which is also the raw words per output word
+* @ kind : fast path selected when the program is compiled
+* NOTE: build once with spk_BiasProgramInit, run with spk_GeneratorBias
+*******************************************************************************/
+enum spk_bias_kind
+{
+    SPK_BIAS_ZERO       = 0,    /* p collapses to zero at this resolution     */
+    SPK_BIAS_COPY       = 1,    /* p = 1/2, raw output is already unbiased    */
+    SPK_BIAS_GENERAL    = 2,    /* branch-free AND/OR accumulator             */
+};
+
+typedef struct spk_bias_program
+{
+    uint64_t bitcode;
+    int limit;
+    enum spk_bias_kind kind;
+} spk_bias_program;
+
 /*******************************************************************************
 * NAME: spk_GeneratorNew
 * DESC: initialize and seed some pseudo random number generator
 * OUTP: scipack error code
 * @ identifier : see list of available generators
-* @ seed : pass zero for non-deterministic seeding
+* @ seed : pass zero for non-deterministic seeding, from RDRAND or from
+* getrandom(2) on CPUs without it
+* NOTE: SPK_GENERATOR_RDRAND ignores the seed, every method draws directly from
+* the on-chip DRNG and returns SPK_ERROR_RDRAND if it stays empty after retries
 *******************************************************************************/
 int spk_GeneratorNew(spk_generator *rng, int identifier, uint64_t seed);
 
 /*******************************************************************************
 * NAME: spk_GeneratorDelete
 * DESC: release system resources
+* NOTE: only for generators from spk_GeneratorNew, spk_GeneratorSplit,
+* spk_GeneratorDeserialize or spk_GeneratorPoolOpen
 *******************************************************************************/
 void spk_GeneratorDelete(spk_generator rng);
 
+/*******************************************************************************
+* NAME: spk_GeneratorSize
+* DESC: bytes of storage required by a generator, interface and state included
+* OUTP: zero if the identifier is not a known generator
+*******************************************************************************/
+size_t spk_GeneratorSize(int identifier);
+
+/*******************************************************************************
+* NAME: spk_GeneratorInit
+* DESC: initialize and seed a generator in caller provided storage
+* OUTP: scipack error code
+* @ mem : at least spk_GeneratorSize(identifier) bytes, 8 byte aligned or better
+* @ seed : pass zero for non-deterministic seeding, from RDRAND or from
+* getrandom(2) on CPUs without it
+* NOTE: the generator is (spk_generator) mem, the caller owns and frees mem
+*******************************************************************************/
+int spk_GeneratorInit(void *mem, int identifier, uint64_t seed);
+
+/*******************************************************************************
+* NAME: spk_GeneratorArrayNew
+* DESC: allocate n generators contiguously, one per SPK_GENERATOR_ALIGN stride
+* OUTP: scipack error code
+* @ out : n generators, out[i] starts i * floor((2^64 - 1) / n) words ahead
+* NOTE: the substreams are laid out exactly as by spk_GeneratorSplit
+* NOTE: release all n at once with spk_GeneratorArrayDelete on the same out
+*******************************************************************************/
+int spk_GeneratorArrayNew(spk_generator out[], size_t n, int identifier, uint64_t seed);
+
+/*******************************************************************************
+* NAME: spk_GeneratorArrayDelete
+* DESC: release the block behind an array from spk_GeneratorArrayNew
+*******************************************************************************/
+void spk_GeneratorArrayDelete(spk_generator arr[]);
+
+/*******************************************************************************
+* NAME: struct spk_seed_sequence
+* DESC: cheap source of distinct seeds for mass generator creation
+* @ state : splitmix64 counter, advanced by the golden gamma on every draw
+* NOTE: a sequence holds no system resources and may live on the stack
+*******************************************************************************/
+typedef struct spk_seed_sequence
+{
+    uint64_t state;
+} spk_seed_sequence;
+
+/*******************************************************************************
+* NAME: spk_SeedSequenceInit
+* DESC: start a seed sequence
+* OUTP: scipack error code
+* @ entropy : pass zero to draw a single word from RDRAND or getrandom instead
+*******************************************************************************/
+int spk_SeedSequenceInit(spk_seed_sequence *seq, uint64_t entropy);
+
+/*******************************************************************************
+* NAME: spk_SeedSequenceNext
+* DESC: draw the next seed, which is never zero
+*******************************************************************************/
+uint64_t spk_SeedSequenceNext(spk_seed_sequence *seq);
+
+/*******************************************************************************
+* NAME: spk_GeneratorNewFromSequence, spk_GeneratorInitFromSequence
+* DESC: equivalent to spk_GeneratorNew or spk_GeneratorInit with the next seed
+* OUTP: scipack error code
+* NOTE: seq is advanced once per generator and no rdrand instructions are issued
+*******************************************************************************/
+int spk_GeneratorNewFromSequence
+(
+    spk_generator *rng,
+    int identifier,
+    spk_seed_sequence *seq
+);
+
+int spk_GeneratorInitFromSequence
+(
+    void *mem,
+    int identifier,
+    spk_seed_sequence *seq
+);
+
+/*******************************************************************************
+* DESC: serialized generator layout, all fields little-endian
+* @ SPK_GENERATOR_SERIAL_VERSION : layout revision, checked on load
+* @ SPK_GENERATOR_SERIAL_HEADER : bytes before the state words of one generator
+* NOTE: one generator is the 4 byte magic "SPKG", the layout revision, the
+* SPK_MAJOR, SPK_MINOR, and SPK_PATCH of the writer in one byte each, then the
+* identifier and the state word count as 32-bit fields, then the state words
+* NOTE: an array is the 4 byte magic "SPKA", the same four version bytes and a
+* 64-bit generator count, followed by that many records of one generator each.
+* Records have a fixed size, every field is 8 byte aligned relative to the
+* start, and a single record can be passed to spk_GeneratorDeserialize.
+*******************************************************************************/
+#define SPK_GENERATOR_SERIAL_VERSION    1
+#define SPK_GENERATOR_SERIAL_HEADER     ((size_t) 16)
+
+/*******************************************************************************
+* NAME: spk_GeneratorSerializedSize
+* DESC: bytes needed to serialize one generator of the given identifier
+* OUTP: zero if the identifier is not a known generator
+*******************************************************************************/
+size_t spk_GeneratorSerializedSize(int identifier);
+
+/*******************************************************************************
+* NAME: spk_GeneratorSerialize
+* DESC: snapshot the state of rng into dest
+* OUTP: scipack error code
+* @ capacity : bytes available at dest, at least spk_GeneratorSerializedSize
+*******************************************************************************/
+int spk_GeneratorSerialize(const spk_generator rng, unsigned char *dest, size_t capacity);
+
+/*******************************************************************************
+* NAME: spk_GeneratorDeserialize
+* DESC: allocate a generator which continues exactly where the snapshot stopped
+* OUTP: scipack error code, SPK_ERROR_FORMAT if src is truncated or malformed or
+* was written with a different layout revision
+* NOTE: release with spk_GeneratorDelete
+*******************************************************************************/
+int spk_GeneratorDeserialize(spk_generator *rng, const unsigned char *src, size_t size);
+
+/*******************************************************************************
+* NAME: spk_GeneratorArraySerializedSize
+* DESC: bytes needed to serialize n generators of the given identifier
+* OUTP: zero if the identifier is not a known generator or on overflow
+*******************************************************************************/
+size_t spk_GeneratorArraySerializedSize(int identifier, size_t n);
+
+/*******************************************************************************
+* NAME: spk_GeneratorArraySerialize
+* DESC: snapshot n generators into one contiguous buffer
+* OUTP: scipack error code
+* NOTE: every generator must have the same identifier, e.g. from ArrayNew
+*******************************************************************************/
+int spk_GeneratorArraySerialize
+(
+    const spk_generator arr[],
+    size_t n,
+    unsigned char *dest,
+    size_t capacity
+);
+
+/*******************************************************************************
+* NAME: spk_GeneratorArrayDeserialize
+* DESC: restore n generators from an array snapshot in one aligned block
+* OUTP: scipack error code
+* @ n : must equal the count stored in the snapshot
+* NOTE: laid out exactly as by spk_GeneratorArrayNew, release with
+* spk_GeneratorArrayDelete
+*******************************************************************************/
+int spk_GeneratorArrayDeserialize
+(
+    spk_generator out[],
+    size_t n,
+    const unsigned char *src,
+    size_t size
+);
+
+/*******************************************************************************
+* NAME: spk_BiasProgramInit
+* DESC: compile p and exp into a bias program, same arguments as the bias method
+* OUTP: scipack error code
+*******************************************************************************/
+int spk_BiasProgramInit(spk_bias_program *program, const double p, const int exp);
+
+/*******************************************************************************
+* NAME: spk_GeneratorBias
+* DESC: run a precompiled bias program, equivalent to rng->bias
+* OUTP: scipack error code
+* NOTE: argument validation and bitcode decoding happen once in the init call
+*******************************************************************************/
+int spk_GeneratorBias
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const spk_bias_program *program
+);
+
+/*******************************************************************************
+* NAME: spk_GeneratorRandUnchecked
+* DESC: rng->rand without the per-call check of its bounds, min must be <= max
+* OUTP: scipack error code
+* NOTE: this and spk_GeneratorBias are the unchecked variants of the methods.
+* next, unid and unif have no per-call checks, the methods are already the fast
+* path, see spk_SetChecking to turn the checks off for every method at once.
+*******************************************************************************/
+int spk_GeneratorRandUnchecked
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+);
+
+/*******************************************************************************
+* NAME: spk_GeneratorJump
+* DESC: advance the generator as if next had been called to fill delta words
+* OUTP: scipack error code
+* NOTE: runs in O(log delta) for all generators
+* NOTE: a no-op for SPK_GENERATOR_RDRAND, which has no stream to advance
+* NOTE: skips delta elements of a SPK_GENERATOR_POOL, stopping at its end
+*******************************************************************************/
+int spk_GeneratorJump(spk_generator rng, uint64_t delta);
+
+/*******************************************************************************
+* NAME: spk_GeneratorAt
+* DESC: fill dest with words index to index + n - 1 of a counter-based stream
+* OUTP: scipack error code
+* NOTE: the generator state is not modified and the index is absolute, i.e. it
+* is counted from block 0 regardless of how much has been drawn so far
+* NOTE: sequential generators return SPK_ERROR_ARGBOUNDS, use a jumped copy
+* NOTE: a raw SPK_GENERATOR_POOL answers for indices of its source stream that
+* lie within the pool, and returns SPK_ERROR_ARGBOUNDS otherwise
+*******************************************************************************/
+int spk_GeneratorAt
+(
+    const spk_generator rng,
+    uint64_t index,
+    uint64_t *dest,
+    const size_t n
+);
+
+/*******************************************************************************
+* NAME: spk_GeneratorSplit
+* DESC: carve the stream of rng into k disjoint substreams of equal length
+* OUTP: scipack error code
+* @ out : k new generators, out[i] starts i * floor((2^64 - 1) / k) words ahead
+* NOTE: rng is unchanged and out[0] is a copy of it
+* NOTE: each of out[] must be released with spk_GeneratorDelete
+*******************************************************************************/
+int spk_GeneratorSplit(spk_generator rng, size_t k, spk_generator out[]);
+
+
+/*******************************************************************************
+* DESC: instruction set levels chosen at runtime from CPUID
+* @ SPK_ISA_SISD : baseline x86-64, scalar and SSE2 kernels
+* @ SPK_ISA_AVX2 : 256-bit kernels
+* @ SPK_ISA_AVX512 : 512-bit kernels, needs the AVX-512 F, DQ and VL subsets
+* @ SPK_ISA_NATIVE : argument to spk_GeneratorSetISA that lifts the cap
+* NOTE: every level produces bit-identical output, only the speed differs
+*******************************************************************************/
+#define SPK_ISA_SISD                0
+#define SPK_ISA_AVX2                1
+#define SPK_ISA_AVX512              2
+#define SPK_ISA_NATIVE              -1
+
+/*******************************************************************************
+* NAME: spk_GeneratorISA
+* DESC: level that generators created from now on will use
+* OUTP: the best SPK_ISA_* level of this CPU, limited by spk_GeneratorSetISA
+*******************************************************************************/
+int spk_GeneratorISA(void);
+
+/*******************************************************************************
+* NAME: spk_GeneratorSetISA
+* DESC: cap the level picked by spk_GeneratorNew and spk_GeneratorInit
+* OUTP: scipack error code
+* @ isa : SPK_ISA_* level, SPK_ERROR_ARGBOUNDS if this CPU does not support it
+* NOTE: for testing and benchmarking, generators that already exist keep their
+* next method and the cap applies to the whole process
+*******************************************************************************/
+int spk_GeneratorSetISA(int isa);
+
 #endif
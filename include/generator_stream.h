@@ -0,0 +1,84 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Cache-blocked streaming of generator output into a caller callback
+* NOTE: Low level subroutines only, use probability module for high level API
+* LICS: MIT License
+*/
+
+#ifndef SPK_GENERATOR_STREAM_H
+#define SPK_GENERATOR_STREAM_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+
+/*******************************************************************************
+* DESC: block sizes in output elements and scratch alignment in bytes
+* @ SPK_STREAM_DEFAULT : 2048 elements, 16 KiB of doubles, half of a typical L1d
+* @ SPK_STREAM_MULTIPLE : every block is a whole number of SIMD lane groups, for
+* unif too, so that no lanes are discarded between blocks
+*******************************************************************************/
+#define SPK_STREAM_DEFAULT          ((size_t) 2048)
+#define SPK_STREAM_MULTIPLE         ((size_t) 16)
+#define SPK_STREAM_ALIGN            64
+
+/*******************************************************************************
+* NAME: struct spk_stream_method
+* DESC: which generator method fills each block, and its arguments
+* @ min : lower bound for SPK_STREAM_RAND, ignored otherwise
+* @ max : upper bound for SPK_STREAM_RAND, ignored otherwise
+* @ p : probability for SPK_STREAM_BIAS, ignored otherwise
+* @ exp : resolution 2^-exp for SPK_STREAM_BIAS, ignored otherwise
+* @ kind : method selector, the callback sees blocks of the matching type
+*******************************************************************************/
+enum spk_stream_kind
+{
+    SPK_STREAM_NEXT     = 0,    /* uint64_t, identical to one large next      */
+    SPK_STREAM_UNID     = 1,    /* double, identical to one large unid        */
+    SPK_STREAM_UNIF     = 2,    /* float, identical to one large unif         */
+    SPK_STREAM_RAND     = 3,    /* uint64_t, same distribution as rand        */
+    SPK_STREAM_BIAS     = 4,    /* uint64_t, same distribution as bias        */
+};
+
+typedef struct spk_stream_method
+{
+    uint64_t min;
+    uint64_t max;
+    double p;
+    int exp;
+    enum spk_stream_kind kind;
+} spk_stream_method;
+
+/*******************************************************************************
+* NAME: spk_stream_callback
+* DESC: consumer of one block, called in stream order from the calling thread
+* OUTP: zero to continue, anything else stops the stream
+* @ block : n elements of the method type, only valid until the callback returns
+* @ ctx : the pointer passed to spk_GeneratorStream
+*******************************************************************************/
+typedef int (*spk_stream_callback)(const void *block, size_t n, void *ctx);
+
+/*******************************************************************************
+* NAME: spk_GeneratorStream
+* DESC: generate total elements one block at a time and hand each block to the
+* callback before the next one is produced
+* OUTP: scipack error code, or the nonzero callback return that stopped it
+* @ block : elements per block, zero for SPK_STREAM_DEFAULT, else a multiple of
+* SPK_STREAM_MULTIPLE
+* NOTE: a single scratch buffer of block elements is reused for every block, so
+* memory use is constant in total and the block is still in cache when the
+* callback reads it. The last block may be short.
+*******************************************************************************/
+int spk_GeneratorStream
+(
+    spk_generator rng,
+    const spk_stream_method *method,
+    const size_t total,
+    size_t block,
+    spk_stream_callback callback,
+    void *ctx
+);
+
+#endif
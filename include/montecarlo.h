@@ -0,0 +1,86 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Monte Carlo integration that fuses generation with accumulation
+* NOTE: Link with -lm and -pthread when this submodule is used
+* LICS: MIT License
+*/
+
+#ifndef SPK_MONTECARLO_H
+#define SPK_MONTECARLO_H
+
+#include "scipack_config.h"
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+
+/*******************************************************************************
+* DESC: integration granularity in points
+* @ SPK_MC_BLOCK : points per integrand call, a block of coordinates stays in L1
+* or L2 for dimensions up to a few dozen
+* @ SPK_MC_CHUNK : points per chunk, the unit of work handed to each thread
+* @ SPK_MC_CHUNKS : chunk limit, past SPK_MC_CHUNK * SPK_MC_CHUNKS points the
+* chunks grow instead so that the per chunk partial sums stay small
+*******************************************************************************/
+#define SPK_MC_BLOCK                ((size_t) 256)
+#define SPK_MC_CHUNK                ((size_t) 1 << 16)
+#define SPK_MC_CHUNKS               ((size_t) 4096)
+
+/*******************************************************************************
+* NAME: spk_mc_integrand
+* DESC: evaluate the integrand at a block of points
+* @ x : n points of dim coordinates each, point i starts at x + i * dim
+* @ fx : write the integrand value at point i to fx[i]
+* @ ctx : the pointer passed to spk_MCIntegrate
+* NOTE: one call per block keeps the indirect call off the per point path, a
+* loop over the block in the callback is free to inline and vectorize
+*******************************************************************************/
+typedef void (*spk_mc_integrand)(const double *x, double *fx, size_t n, size_t dim, void *ctx);
+
+/*******************************************************************************
+* NAME: spk_MCIntegrate
+* DESC: estimate the integral of f over the unit hypercube [0, 1)^dim from n
+* points, i.e. the mean of f at n uniform points
+* OUTP: scipack error code
+* @ n : at least 2, so that the standard error is defined
+* @ estimate : the sample mean of f
+* @ std_error : the standard error of the estimate, sqrt(s^2 / n)
+* NOTE: coordinates are drawn with unid, one raw word each, one block at a time,
+* and the values of f are reduced with compensated sums while still in cache.
+* Nothing proportional to n is ever written to memory.
+* NOTE: rng finishes in the same state as after a unid call for n * dim values
+* NOTE: the result is bit for bit the same as spk_MCIntegrateParallel on any
+* number of threads, and the same on every instruction set level
+*******************************************************************************/
+int spk_MCIntegrate
+(
+    spk_generator rng,
+    spk_mc_integrand f,
+    void *ctx,
+    const size_t dim,
+    const size_t n,
+    double *estimate,
+    double *std_error
+);
+
+/*******************************************************************************
+* NAME: spk_MCIntegrateParallel
+* DESC: spk_MCIntegrate spread over the thread pool of generator_parallel.h
+* OUTP: scipack error code
+* NOTE: every chunk is integrated with a copy of rng jumped to the start of its
+* points, so f is called from several threads at once and must be reentrant. f
+* must not run parallel fills or integrations of its own.
+* NOTE: the chunk partial sums are combined in chunk order, which is why the
+* result does not depend on the thread count
+*******************************************************************************/
+int spk_MCIntegrateParallel
+(
+    spk_generator rng,
+    spk_mc_integrand f,
+    void *ctx,
+    const size_t dim,
+    const size_t n,
+    double *estimate,
+    double *std_error
+);
+
+#endif
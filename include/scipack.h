@@ -16,10 +16,25 @@
 * Module A: psuedo random number generation
 *******************************************************************************/
 #include "generator_sisd.h"
+#include "generator_simd.h"
+#include "generator_inline.h"
+#include "generator_buffer.h"
+#include "generator_parallel.h"
+#include "generator_stream.h"
+#include "generator_pool.h"
 
 /*******************************************************************************
 * Module B: high resolution timing
 *******************************************************************************/
 #include "timer.h"
+#include "timer_probe.h"
+#include "timer_counters.h"
+
+/*******************************************************************************
+* Module C: probability distributions
+*******************************************************************************/
+#include "continuous.h"
+#include "discrete.h"
+#include "montecarlo.h"
 
 #endif
@@ -7,6 +7,8 @@
 #ifndef SPK_CONFIG_H
 #define SPK_CONFIG_H
 
+#include <stdarg.h> //va_list
+
 /*******************************************************************************
 * version info
 *******************************************************************************/
@@ -31,16 +33,13 @@
     #error "SCIPACK requires a GNU C compiler"
 #endif
 
-//submodules: generator_sisd (seeding), timer (rdrand guarantees a constant TSC)
-#ifndef __RDRND__
-    #error "SCIPACK requires x86 RDRAND instruction"
-#endif
-
 //submodules: timer (fence instructions)
 #ifndef __SSE2__
     #error "SCIPACK requires SSE2 instruction set"
 #endif
 
+//RDRAND, RDSEED, AVX2 and AVX-512 are detected at runtime, see spk_GeneratorISA
+
 /*******************************************************************************
 * Library error codes
 *******************************************************************************/
@@ -49,17 +48,87 @@
 #define SPK_ERROR_STDMALLOC         1       /* stdlib malloc fail             */
 #define SPK_ERROR_STDCALLOC         2       /* stdlib calloc fail             */
 #define SPK_ERROR_STDREALLOC        3       /* stdlib realloc fail            */
-#define SPK_ERROR_RDRAND            4       /* rdrand retry loop fail         */
+#define SPK_ERROR_RDRAND            4       /* rdrand or getrandom fail       */
 #define SPK_ERROR_ARGBOUNDS         5       /* fx argument is out of bounds   */
+#define SPK_ERROR_PTHREAD           6       /* pthread thread creation fail   */
+#define SPK_ERROR_FORMAT            7       /* malformed serialized data      */
+#define SPK_ERROR_TIMER             8       /* tsc calibration clock fail     */
+#define SPK_ERROR_FILEIO            9       /* stdio file open or write fail  */
+#define SPK_ERROR_COUNTERS          10      /* perf_event_open counters fail  */
+#define SPK_ERROR_EXHAUSTED         11      /* random pool has been used up   */
 #define SPK_ERROR_UNDEFINED         999     /* no error has been set          */
 
-//TODO: function to fetch verbose error description
+/*******************************************************************************
+* NAME: spk_ErrorString
+* DESC: short description of a scipack error code
+* OUTP: static string, never NULL, "unknown error code" for anything unlisted
+*******************************************************************************/
+const char *spk_ErrorString(int error);
+
+/*******************************************************************************
+* Argument checking
+*******************************************************************************/
+
+/*******************************************************************************
+* DESC: compile time switch for per-call argument checks in the generator methods
+* @ SPK_CHECKED : 1 by default, build with -DSPK_CHECKED=0 (make CHECKED=0) to
+* compile the checks out of the library altogether
+* NOTE: the checks stay cheap when compiled in, a predicted branch on a global
+* flag and the comparison itself, and they only guard arguments whose validity
+* cannot be assumed, such as rand bounds and bias probabilities
+*******************************************************************************/
+#ifndef SPK_CHECKED
+    #define SPK_CHECKED 1
+#endif
+
+/*******************************************************************************
+* NAME: spk_SetChecking
+* DESC: turn the per-call argument checks on or off at runtime
+* OUTP: the previous setting
+* @ enabled : nonzero to check, zero to trust the caller, on by default
+* NOTE: set it once before any generator threads start, it is a plain global
+* NOTE: with checks off an invalid argument is undefined behavior. The validate
+* once entry points, e.g. spk_BiasProgramInit, always check.
+*******************************************************************************/
+int spk_SetChecking(int enabled);
 
 /*******************************************************************************
 * Logging mechanism
 *******************************************************************************/
 
-//TODO: generic scipack callback to allow struct hooks
-//TODO: dummy callback when end user does not hook in a logger
+/*******************************************************************************
+* NAME: spk_logger
+* DESC: callback for failures detected inside scipack
+* @ ctx : the pointer passed to spk_SetLogger
+* @ error : the scipack error code about to be returned
+* @ where : the public function the caller called, e.g. "spk_Normal", or the
+* method for struct spk_generator, e.g. "spk_generator->rand"
+* @ format : printf format of the details, args holds its arguments
+* NOTE: nothing is formatted unless the logger does it, e.g. with vsnprintf, so
+* a logger that only counts or filters errors costs no string work
+* NOTE: called from the failing thread, it must be thread safe if the library
+* is used from several threads, and it must not call back into the generator
+*******************************************************************************/
+typedef void (*spk_logger)
+(
+    void *ctx,
+    int error,
+    const char *where,
+    const char *format,
+    va_list args
+);
+
+/*******************************************************************************
+* NAME: spk_SetLogger
+* DESC: install a logger, or pass NULL to go back to the default of no logging
+* NOTE: set it before any generator threads start, it is a plain global
+*******************************************************************************/
+void spk_SetLogger(spk_logger logger, void *ctx);
+
+/*******************************************************************************
+* NAME: spk_LogStderr
+* DESC: ready made logger, one line per failure on stderr, ctx is unused
+*******************************************************************************/
+void spk_LogStderr(void *ctx, int error, const char *where, const char *format, va_list args);
 
-#endif
\ No newline at end of file
+#endif
@@ -23,6 +23,35 @@ enum spk_timer_resolution
     SPK_TIMER_NANOSECONDS    = 3,
 };
 
+/*******************************************************************************
+* NAME: enum spk_timer_source
+* DESC: how the TSC frequency in use was obtained, see spk_TimerCalibrate
+*******************************************************************************/
+enum spk_timer_source
+{
+    SPK_TIMER_UNCALIBRATED   = 0,
+    SPK_TIMER_CPUID          = 1,
+    SPK_TIMER_REGRESSION     = 2,
+    SPK_TIMER_CACHE          = 3,
+};
+
+/*******************************************************************************
+* NAME: enum spk_timer_fence
+* DESC: how strictly the timed region is fenced off from the code around it
+* @ SPK_TIMER_SERIALIZE : MFENCE+LFENCE+RDTSC to start, RDTSCP+LFENCE to stop,
+* pending stores drain before the clock starts. Use for latency
+* @ SPK_TIMER_LFENCE : LFENCE+RDTSC+LFENCE to start, LFENCE+RDTSC to stop,
+* instructions cannot cross the reads but stores may still be in flight
+* @ SPK_TIMER_UNFENCED : bare RDTSC at both ends, the cheapest but out of order
+* execution can move work across the reads. Use for long throughput loops
+*******************************************************************************/
+enum spk_timer_fence
+{
+    SPK_TIMER_SERIALIZE      = 0,
+    SPK_TIMER_LFENCE         = 1,
+    SPK_TIMER_UNFENCED       = 2,
+};
+
 /*******************************************************************************
 * NAME: spk_TimerStart
 * DESC: fence instructions and record the initial time stamp counter
@@ -34,7 +63,7 @@ enum spk_timer_resolution
         _mm_mfence();                                                          \
         _mm_lfence();                                                          \
         spk_tsc_start = __rdtsc()
-        
+
 /*******************************************************************************
 * NAME: spk_TimerStop
 * DESC: record the terminating time stamp counter with a fence
@@ -42,7 +71,7 @@ enum spk_timer_resolution
 #define spk_TimerStop()                                                        \
         spk_tsc_end = __rdtscp(&spk_tsc_dummy);                                \
         _mm_lfence()
-        
+
 /*******************************************************************************
 * NAME: spk_TimerElapsedCycles
 * DESC: the total elapsed cycles (ticks) between spk_TimerStart and spk_TimerStop
@@ -50,6 +79,123 @@ enum spk_timer_resolution
 *******************************************************************************/
 #define spk_TimerElapsedCycles() (spk_tsc_end - spk_tsc_start)
 
+/*******************************************************************************
+* NAME: spk_TimerElapsedNetCycles
+* DESC: spk_TimerElapsedCycles less the overhead of an empty start and stop
+* OUTP: unsigned long long
+*******************************************************************************/
+#define spk_TimerElapsedNetCycles()                                            \
+        spk_TimerNet(spk_TimerElapsedCycles(), SPK_TIMER_SERIALIZE)
+
+/*******************************************************************************
+* NAME: struct spk_timer
+* DESC: reusable timer object, unlike the macros above any number of them can be
+* live in one scope and they can be nested or stored in other structures
+* @ start : time stamp counter recorded by spk_TimerBegin
+* @ cycles : elapsed cycles recorded by the most recent spk_TimerEnd
+*******************************************************************************/
+typedef struct spk_timer
+{
+    unsigned long long start;
+    unsigned long long cycles;
+} spk_timer;
+
+/*******************************************************************************
+* NAME: spk_TimerBeginAs
+* DESC: record the initial time stamp counter with the given fencing
+* NOTE: pass a constant fence so that the switch folds away when inlined
+*******************************************************************************/
+static inline void spk_TimerBeginAs(spk_timer *timer, enum spk_timer_fence fence)
+{
+    switch (fence)
+    {
+        case SPK_TIMER_SERIALIZE:
+            _mm_mfence();
+            _mm_lfence();
+            timer->start = __rdtsc();
+            break;
+            
+        case SPK_TIMER_LFENCE:
+            _mm_lfence();
+            timer->start = __rdtsc();
+            _mm_lfence();
+            break;
+            
+        default:
+            timer->start = __rdtsc();
+            break;
+    }
+}
+
+/*******************************************************************************
+* NAME: spk_TimerEndAs
+* DESC: record the terminating time stamp counter with the given fencing
+* OUTP: elapsed cycles since spk_TimerBeginAs, which are also stored in the timer
+* NOTE: use the same fence as the matching spk_TimerBeginAs
+*******************************************************************************/
+static inline unsigned long long spk_TimerEndAs(spk_timer *timer, enum spk_timer_fence fence)
+{
+    unsigned int dummy = 0;
+    unsigned long long end = 0;
+    
+    switch (fence)
+    {
+        case SPK_TIMER_SERIALIZE:
+            end = __rdtscp(&dummy);
+            _mm_lfence();
+            break;
+            
+        case SPK_TIMER_LFENCE:
+            _mm_lfence();
+            end = __rdtsc();
+            break;
+            
+        default:
+            end = __rdtsc();
+            break;
+    }
+    
+    timer->cycles = end - timer->start;
+    
+    return timer->cycles;
+}
+
+/*******************************************************************************
+* NAME: spk_TimerBegin
+* DESC: same fences and time stamp counter read as spk_TimerStart
+*******************************************************************************/
+static inline void spk_TimerBegin(spk_timer *timer)
+{
+    spk_TimerBeginAs(timer, SPK_TIMER_SERIALIZE);
+}
+
+/*******************************************************************************
+* NAME: spk_TimerEnd
+* DESC: same serializing read and fence as spk_TimerStop
+* OUTP: elapsed cycles since spk_TimerBegin, which are also stored in the timer
+*******************************************************************************/
+static inline unsigned long long spk_TimerEnd(spk_timer *timer)
+{
+    return spk_TimerEndAs(timer, SPK_TIMER_SERIALIZE);
+}
+
+/*******************************************************************************
+* NAME: spk_TimerOverhead
+* DESC: cycles reported for an empty timed region under the given fencing
+* OUTP: the minimum over a thousand empty regions, measured on first call per
+* fence and cached after that
+* NOTE: the minimum rather than the median so that subtracting it never eats
+* into the cost of the timed work itself
+*******************************************************************************/
+unsigned long long spk_TimerOverhead(enum spk_timer_fence fence);
+
+/*******************************************************************************
+* NAME: spk_TimerNet
+* DESC: subtract spk_TimerOverhead(fence) from cycles measured with that fence
+* OUTP: net cycles, clamped at zero
+*******************************************************************************/
+unsigned long long spk_TimerNet(unsigned long long cycles, enum spk_timer_fence fence);
+
 /*******************************************************************************
 * NAME: struct spk_timer_result
 * DESC: returned by spk_TimerElapsedTime
@@ -67,7 +213,8 @@ typedef struct spk_timer_result
 /*******************************************************************************
 * NAME: spk_TimerElapsedTime
 * DESC: convert total elapsed cycles to an estimated elapsed wall time
-* OUTP: struct spk_timer_result
+* OUTP: struct spk_timer_result, with elapsed NaN in seconds if the timer could
+* not be calibrated
 * NOTE: Typically called as spk_TimerElapsedTime(spk_TimerElapsedCycles())
 *******************************************************************************/
 spk_timer_result spk_TimerElapsedTime(unsigned long long cycles);
@@ -75,9 +222,29 @@ spk_timer_result spk_TimerElapsedTime(unsigned long long cycles);
 /*******************************************************************************
 * NAME: spk_TimerGetFrequency
 * DESC: Get the estimated frequency of the underlying time stamp counter
-* OUTP: in units Hertz
-* NOTE: On first call, this function may take > 10 seconds to execute
+* OUTP: in units Hertz, or 0 if the calibration failed
+* NOTE: On first call, this function calibrates via spk_TimerCalibrate(NULL)
 *******************************************************************************/
 unsigned long long spk_TimerGetFrequency(void);
 
+/*******************************************************************************
+* NAME: spk_TimerCalibrate
+* DESC: (re)estimate the TSC frequency used by the timer submodule
+* OUTP: SPK_ERROR_SUCCESS, SPK_ERROR_TIMER, or SPK_ERROR_FILEIO
+* @ cache : path of a frequency cache file, or NULL to skip the cache
+* NOTE: CPUID leaves 0x15 and 0x16 are used when the CPU reports them. Otherwise
+* the frequency is read from the cache if the CPU model is listed, and failing
+* that the TSC is regressed against CLOCK_MONOTONIC_RAW for about 50 ms and the
+* result is appended to the cache. SPK_ERROR_FILEIO means only the cache write
+* failed, the new frequency is still in use. Both errors are logged.
+*******************************************************************************/
+int spk_TimerCalibrate(const char *cache);
+
+/*******************************************************************************
+* NAME: spk_TimerGetSource
+* DESC: how the TSC frequency currently in use was obtained
+* OUTP: SPK_TIMER_UNCALIBRATED before the first calibration
+*******************************************************************************/
+enum spk_timer_source spk_TimerGetSource(void);
+
 #endif
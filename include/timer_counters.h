@@ -0,0 +1,123 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Hardware performance counters via perf_event_open alongside the TSC
+* LICS: MIT License
+*/
+
+#ifndef SPK_TIMER_COUNTERS_H
+#define SPK_TIMER_COUNTERS_H
+
+#include "scipack_config.h"
+
+/*******************************************************************************
+* NAME: enum spk_counter_event
+* DESC: the events opened by spk_CountersOpen, all counted in user space only
+* @ SPK_COUNTER_CYCLES : core clock cycles, which scale with the clock frequency
+* @ SPK_COUNTER_REF_CYCLES : reference cycles at a constant rate, usually the
+* TSC rate, so cycles per reference cycle is the effective clock ratio
+* @ SPK_COUNTER_INSTRUCTIONS : instructions retired
+* @ SPK_COUNTER_BRANCH_MISSES : mispredicted branches retired
+* @ SPK_COUNTER_L1D_MISSES : L1 data cache read misses
+* @ SPK_COUNTER_LLC_MISSES : last level cache misses
+*******************************************************************************/
+enum spk_counter_event
+{
+    SPK_COUNTER_CYCLES           = 0,
+    SPK_COUNTER_REF_CYCLES       = 1,
+    SPK_COUNTER_INSTRUCTIONS     = 2,
+    SPK_COUNTER_BRANCH_MISSES    = 3,
+    SPK_COUNTER_L1D_MISSES       = 4,
+    SPK_COUNTER_LLC_MISSES       = 5,
+    SPK_COUNTER_EVENTS           = 6,
+};
+
+/*******************************************************************************
+* NAME: struct spk_counters
+* DESC: counter object in the style of struct spk_timer
+* @ start : raw counter values recorded by spk_CountersBegin
+* @ value : events counted between spk_CountersBegin and spk_CountersEnd
+* @ available : bit k is set if event k was counted, see spk_CountersAvailable
+*******************************************************************************/
+typedef struct spk_counters
+{
+    unsigned long long start[SPK_COUNTER_EVENTS];
+    unsigned long long value[SPK_COUNTER_EVENTS];
+    unsigned int available;
+    char padding[4];
+} spk_counters;
+
+/*******************************************************************************
+* NAME: spk_CountersOpen
+* DESC: open every event the kernel and processor support as one group on the
+* calling thread, so that they are always scheduled and counted together
+* OUTP: SPK_ERROR_COUNTERS if no event could be opened, which is the usual case
+* in virtual machines without a virtual PMU or when perf_event_paranoid forbids
+* it. Events that fail on their own are left out but the rest still count
+* NOTE: counts only the calling thread. Opening twice is a no-op
+*******************************************************************************/
+int spk_CountersOpen(void);
+
+/*******************************************************************************
+* NAME: spk_CountersClose
+* DESC: release the events opened by spk_CountersOpen
+*******************************************************************************/
+void spk_CountersClose(void);
+
+/*******************************************************************************
+* NAME: spk_CountersAvailable
+* DESC: bit mask of the events that spk_CountersOpen could open, zero if closed
+*******************************************************************************/
+unsigned int spk_CountersAvailable(void);
+
+/*******************************************************************************
+* NAME: spk_CountersBegin
+* DESC: record the initial counter values, one read system call for the group
+* NOTE: costs on the order of a microsecond, so time with the TSC and count in a
+* separate pass when the region is short
+*******************************************************************************/
+void spk_CountersBegin(spk_counters *counters);
+
+/*******************************************************************************
+* NAME: spk_CountersEnd
+* DESC: record the events counted since spk_CountersBegin into value
+* OUTP: scipack error code, SPK_ERROR_COUNTERS if the read failed in which case
+* nothing is available
+*******************************************************************************/
+int spk_CountersEnd(spk_counters *counters);
+
+/*******************************************************************************
+* NAME: spk_CountersRatio
+* DESC: value of event a over value of event b, for example instructions over
+* cycles for IPC or branch misses over instructions
+* OUTP: negative if either event is unavailable or b counted zero
+*******************************************************************************/
+double spk_CountersRatio(const spk_counters *counters, enum spk_counter_event a, enum spk_counter_event b);
+
+/*******************************************************************************
+* NAME: spk_CountersName
+* DESC: short lowercase name of an event for reports, such as "branch_misses"
+*******************************************************************************/
+const char *spk_CountersName(enum spk_counter_event event);
+
+/*******************************************************************************
+* NAME: spk_CountersStart
+* DESC: counterpart of spk_TimerStart, declares a counter object in scope
+*******************************************************************************/
+#define spk_CountersStart()                                                    \
+        spk_counters spk_pmc;                                                  \
+        spk_CountersBegin(&spk_pmc)
+
+/*******************************************************************************
+* NAME: spk_CountersStop
+* DESC: counterpart of spk_TimerStop
+*******************************************************************************/
+#define spk_CountersStop() spk_CountersEnd(&spk_pmc)
+
+/*******************************************************************************
+* NAME: spk_CountersElapsed
+* DESC: events counted between spk_CountersStart and spk_CountersStop
+* OUTP: unsigned long long, zero if the event is unavailable
+*******************************************************************************/
+#define spk_CountersElapsed(event) (spk_pmc.value[(event)])
+
+#endif
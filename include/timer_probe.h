@@ -0,0 +1,128 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Named TSC probes accumulated per thread for permanent hot-path timing
+* LICS: MIT License
+*/
+
+#ifndef SPK_TIMER_PROBE_H
+#define SPK_TIMER_PROBE_H
+
+#include "scipack_config.h"
+#include "timer.h"
+
+#include <stdio.h> //FILE
+
+/*******************************************************************************
+* DESC: registry limits
+* @ SPK_PROBE_MAX : probes per process, ids run from 0 to SPK_PROBE_MAX - 1
+* @ SPK_PROBE_BUCKETS : histogram bucket k counts samples in [2^k, 2^(k+1))
+* cycles, and bucket 0 also counts samples of zero cycles
+* @ SPK_PROBE_NAME : name capacity including the null terminator
+*******************************************************************************/
+#define SPK_PROBE_MAX               64
+#define SPK_PROBE_BUCKETS           64
+#define SPK_PROBE_NAME              32
+
+/*******************************************************************************
+* NAME: struct spk_probe_stats
+* DESC: one probe summed over every thread that recorded to it
+* @ name : null-terminated name given to spk_ProbeRegister
+* @ count : number of samples
+* @ total : sum of all samples in cycles
+* @ min : smallest sample, zero if count is zero
+* @ max : largest sample
+* @ histogram : log2 histogram of the samples, see SPK_PROBE_BUCKETS
+*******************************************************************************/
+typedef struct spk_probe_stats
+{
+    char name[SPK_PROBE_NAME];
+    unsigned long long count;
+    unsigned long long total;
+    unsigned long long min;
+    unsigned long long max;
+    unsigned long long histogram[SPK_PROBE_BUCKETS];
+} spk_probe_stats;
+
+/*******************************************************************************
+* NAME: spk_probe_enabled
+* DESC: nonzero while probes record, read inline by spk_ProbeBegin
+* NOTE: read only, use spk_ProbeEnable to change it. Probes start out disabled
+*******************************************************************************/
+extern int spk_probe_enabled;
+
+/*******************************************************************************
+* NAME: spk_ProbeEnable
+* DESC: turn recording on or off for every probe in every thread
+*******************************************************************************/
+void spk_ProbeEnable(int enabled);
+
+/*******************************************************************************
+* NAME: spk_ProbeRegister
+* DESC: look up a probe by name, creating it on first use
+* OUTP: SPK_ERROR_ARGBOUNDS if the name is empty, does not fit SPK_PROBE_NAME,
+* or the registry already holds SPK_PROBE_MAX probes
+* @ id : receives the probe id, the same name always gives the same id
+* NOTE: takes a lock, so register once up front or cache the id in a static
+*******************************************************************************/
+int spk_ProbeRegister(const char *name, int *id);
+
+/*******************************************************************************
+* NAME: spk_ProbeRecord
+* DESC: add one sample of the given number of cycles to the calling thread's
+* counters for probe id, a no-op while probes are disabled or if id is invalid
+* NOTE: lock-free, each thread only ever writes its own counters. The first
+* sample on a thread allocates that thread's counters, if the allocation fails
+* the thread records nothing
+*******************************************************************************/
+void spk_ProbeRecord(int id, unsigned long long cycles);
+
+/*******************************************************************************
+* NAME: spk_ProbeBegin
+* DESC: start a timer for a probe, skipping the fences while probes are disabled
+*******************************************************************************/
+static inline void spk_ProbeBegin(spk_timer *timer)
+{
+    if (spk_probe_enabled) spk_TimerBegin(timer);
+    else timer->start = 0;
+}
+
+/*******************************************************************************
+* NAME: spk_ProbeEnd
+* DESC: stop a timer started by spk_ProbeBegin and record it against probe id,
+* net of spk_TimerOverhead(SPK_TIMER_SERIALIZE)
+* NOTE: When probes were disabled at spk_ProbeBegin this is a single branch
+*******************************************************************************/
+static inline void spk_ProbeEnd(int id, spk_timer *timer)
+{
+    if (timer->start != 0)
+    {
+        spk_ProbeRecord(id, spk_TimerNet(spk_TimerEnd(timer), SPK_TIMER_SERIALIZE));
+    }
+}
+
+/*******************************************************************************
+* NAME: spk_ProbeSnapshot
+* DESC: sum every thread's counters for the registered probes, in id order
+* OUTP: scipack error code
+* @ dest : receives up to capacity probes
+* @ count : receives the number of registered probes, which may exceed capacity
+* NOTE: counters are read while other threads may still be writing them, so a
+* snapshot can be a few samples out of step between fields but never torn
+*******************************************************************************/
+int spk_ProbeSnapshot(spk_probe_stats *dest, size_t capacity, size_t *count);
+
+/*******************************************************************************
+* NAME: spk_ProbeDump
+* DESC: print a snapshot of every registered probe as a text table
+* NOTE: cycles only, divide by spk_TimerGetFrequency for wall time
+*******************************************************************************/
+void spk_ProbeDump(FILE *stream);
+
+/*******************************************************************************
+* NAME: spk_ProbeReset
+* DESC: zero the counters of every probe in every thread, names and ids remain
+* NOTE: samples recorded concurrently with a reset may survive it
+*******************************************************************************/
+void spk_ProbeReset(void);
+
+#endif
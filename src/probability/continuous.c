@@ -0,0 +1,744 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: subroutines for continuous probability distributions
+* LICS: MIT License
+*/
+
+#include "continuous.h"
+#include "probability_internal.h"
+#include "scipack_internal.h"
+
+#include <assert.h>
+#include <math.h> //exp, log1p
+#include <stdint.h> //uint64_t
+#include <string.h> //memcpy
+
+/*******************************************************************************
+Prototypes
+*******************************************************************************/
+static inline double Signed(const double x, const uint64_t word);
+static double NormalSlow(struct spki_source *src, uint64_t word);
+static double ExponentialSlow(struct spki_source *src, uint64_t word);
+
+/*******************************************************************************
+Ziggurat tables for George Marsaglia and Wai Wan Tsang, "The Ziggurat Method for
+Generating Random Variables" (2000), extended from 128 to 256 layers and from 32
+to 52 and 53 bit integers so that a single raw word drives the whole fast path.
+
+The tables were generated offline with Marsaglia's zigset recursion. Layer i has
+right edge x[i], with x[N - 1] = R the start of the tail and layer 0 the base
+strip whose pseudo width V / f(R) includes the tail area V - R f(R).
+
+    k[i] = 2^B * x[i - 1] / x[i]    fast path acceptance threshold
+    w[i] = x[i] / 2^B               integer to abscissa scaling
+    f[i] = f(x[i])                  unnormalized density at the layer edge
+
+The normal uses f(x) = exp(-x^2 / 2), R = 3.654152885361009, B = 52, and the
+exponential uses f(x) = exp(-x), R = 7.697117470131487, B = 53. Each table is
+2 KB, so all six stay resident in L1 across a bulk fill.
+*******************************************************************************/
+#define NORMAL_R        3.654152885361009
+#define EXPONENTIAL_R   7.697117470131487
+
+static const uint64_t normal_k[256] =
+{
+    0x000EF33D8025EF64ULL, 0x0000000000000000ULL, 0x000C08BE98FBC661ULL, 0x000DA354FABD8128ULL,
+    0x000E51F67EC1EEDDULL, 0x000EB255E9D3F776ULL, 0x000EEF4B817ECAB3ULL, 0x000F19470AFA44A7ULL,
+    0x000F37ED61FFCB13ULL, 0x000F4F4695612558ULL, 0x000F61A5E41BA395ULL, 0x000F707A755396A3ULL,
+    0x000F7CB2EC284499ULL, 0x000F86F10C6357D1ULL, 0x000F8FA6578325DDULL, 0x000F9724C74DD0DAULL,
+    0x000F9DA907DBF507ULL, 0x000FA360F581FA71ULL, 0x000FA86FDE5B4BF7ULL, 0x000FACF160D354DBULL,
+    0x000FB0FB6718B90EULL, 0x000FB49F8D5374C5ULL, 0x000FB7EC2366FE77ULL, 0x000FBAECE9A1E50CULL,
+    0x000FBDAB9D040BEEULL, 0x000FC03060FF6C57ULL, 0x000FC2821037A248ULL, 0x000FC4A67AE25BD1ULL,
+    0x000FC6A2977AEE2FULL, 0x000FC87AA92896A4ULL, 0x000FCA325E4BDE85ULL, 0x000FCBCCE902231AULL,
+    0x000FCD4D12F839C4ULL, 0x000FCEB54D8FEC99ULL, 0x000FD007BF1DC930ULL, 0x000FD1464DD6C4E5ULL,
+    0x000FD272A8E2F450ULL, 0x000FD38E4FF0C91EULL, 0x000FD49A9990B479ULL, 0x000FD598B8920F53ULL,
+    0x000FD689C08E99ECULL, 0x000FD76EA9C8E831ULL, 0x000FD848547B08E8ULL, 0x000FD9178BAD2C8BULL,
+    0x000FD9DD07A7ADD2ULL, 0x000FDA9970105E8BULL, 0x000FDB4D5DC02E1FULL, 0x000FDBF95C5BFCD1ULL,
+    0x000FDC9DEBB99A7DULL, 0x000FDD3B8118729DULL, 0x000FDDD288342F90ULL, 0x000FDE6364369F63ULL,
+    0x000FDEEE708D514FULL, 0x000FDF7401A6B42EULL, 0x000FDFF46599ED3FULL, 0x000FE06FE4BC24F2ULL,
+    0x000FE0E6C225A259ULL, 0x000FE1593C28B84CULL, 0x000FE1C78CBC3F99ULL, 0x000FE231E9DB1CA9ULL,
+    0x000FE29885DA1B92ULL, 0x000FE2FB8FB54186ULL, 0x000FE35B33558D4AULL, 0x000FE3B799D0002AULL,
+    0x000FE410E99EAD7EULL, 0x000FE46746D47734ULL, 0x000FE4BAD34C095BULL, 0x000FE50BAED29524ULL,
+    0x000FE559F74EBC76ULL, 0x000FE5A5C8E41211ULL, 0x000FE5EF3E138689ULL, 0x000FE6366FD91078ULL,
+    0x000FE67B75C6D578ULL, 0x000FE6BE661E11AAULL, 0x000FE6FF55E5F4F2ULL, 0x000FE73E5900A702ULL,
+    0x000FE77B823E9E39ULL, 0x000FE7B6E37070A1ULL, 0x000FE7F08D774243ULL, 0x000FE8289053F08CULL,
+    0x000FE85EFB35173AULL, 0x000FE893DC840864ULL, 0x000FE8C741F0CEBCULL, 0x000FE8F9387D4EF6ULL,
+    0x000FE929CC879B1DULL, 0x000FE95909D388EBULL, 0x000FE986FB939AA1ULL, 0x000FE9B3AC714865ULL,
+    0x000FE9DF2694B6D5ULL, 0x000FEA0973ABE67BULL, 0x000FEA329CF166A4ULL, 0x000FEA5AAB32952DULL,
+    0x000FEA81A6D57419ULL, 0x000FEAA797DE1CEFULL, 0x000FEACC85F3D91FULL, 0x000FEAF07865E63CULL,
+    0x000FEB13762FEC12ULL, 0x000FEB3585FE2A4BULL, 0x000FEB56AE3162B4ULL, 0x000FEB76F4E284F9ULL,
+    0x000FEB965FE62013ULL, 0x000FEBB4F4CF9D7CULL, 0x000FEBD2B8F449CFULL, 0x000FEBEFB16E2E3DULL,
+    0x000FEC0BE31EBDE8ULL, 0x000FEC2752B15A14ULL, 0x000FEC42049DAFD3ULL, 0x000FEC5BFD29F196ULL,
+    0x000FEC75406CEEF4ULL, 0x000FEC8DD2500CB4ULL, 0x000FECA5B6911F10ULL, 0x000FECBCF0C427FEULL,
+    0x000FECD38454FB15ULL, 0x000FECE97488C8B3ULL, 0x000FECFEC47F91B7ULL, 0x000FED1377358528ULL,
+    0x000FED278F844903ULL, 0x000FED3B10242F4CULL, 0x000FED4DFBAD586EULL, 0x000FED605498C3DDULL,
+    0x000FED721D414FE8ULL, 0x000FED8357E4A982ULL, 0x000FED9406A42CC8ULL, 0x000FEDA42B85B704ULL,
+    0x000FEDB3C8746AB3ULL, 0x000FEDC2DF416652ULL, 0x000FEDD171A46E52ULL, 0x000FEDDF813C8AD3ULL,
+    0x000FEDED0F90997FULL, 0x000FEDFA1E0FD414ULL, 0x000FEE06AE124BC4ULL, 0x000FEE12C0D95A06ULL,
+    0x000FEE1E579006E0ULL, 0x000FEE29734B6524ULL, 0x000FEE34150AE4BBULL, 0x000FEE3E3DB89B3CULL,
+    0x000FEE47EE2982F3ULL, 0x000FEE51271DB086ULL, 0x000FEE59E9407F41ULL, 0x000FEE623528B42DULL,
+    0x000FEE6A0B5897F1ULL, 0x000FEE716C3E077AULL, 0x000FEE7858327B81ULL, 0x000FEE7ECF7B06B9ULL,
+    0x000FEE84D2484AB2ULL, 0x000FEE8A60B66343ULL, 0x000FEE8F7ACCC851ULL, 0x000FEE94207E25DAULL,
+    0x000FEE9851A829EBULL, 0x000FEE9C0E13485BULL, 0x000FEE9F557273F4ULL, 0x000FEEA22762CCAEULL,
+    0x000FEEA4836B42ABULL, 0x000FEEA668FC2D70ULL, 0x000FEEA7D76ED6F9ULL, 0x000FEEA8CE04FA0AULL,
+    0x000FEEA94BE8333CULL, 0x000FEEA95029640FULL, 0x000FEEA8D9C0075EULL, 0x000FEEA7E7897654ULL,
+    0x000FEEA678481D24ULL, 0x000FEEA48AA29E83ULL, 0x000FEEA21D22E4DAULL, 0x000FEE9F2E352025ULL,
+    0x000FEE9BBC26AF2EULL, 0x000FEE97C524F2E3ULL, 0x000FEE93473C0A39ULL, 0x000FEE8E40557515ULL,
+    0x000FEE88AE369C79ULL, 0x000FEE828E7F3DFDULL, 0x000FEE7BDEA7B888ULL, 0x000FEE749BFF37FFULL,
+    0x000FEE6CC3A9BD5EULL, 0x000FEE64529E007FULL, 0x000FEE5B45A32889ULL, 0x000FEE51994E57B6ULL,
+    0x000FEE474A0006CFULL, 0x000FEE3C53E12C4FULL, 0x000FEE30B2E02AD7ULL, 0x000FEE2462AD8204ULL,
+    0x000FEE175EB83C59ULL, 0x000FEE09A22A1447ULL, 0x000FEDFB27E349CBULL, 0x000FEDEBEA76216CULL,
+    0x000FEDDBE422047DULL, 0x000FEDCB0ECE39D3ULL, 0x000FEDB964042CF4ULL, 0x000FEDA6DCE938C9ULL,
+    0x000FED937237E98DULL, 0x000FED7F1C38A836ULL, 0x000FED69D2B9C02BULL, 0x000FED538D06ADFFULL,
+    0x000FED3C41DEA422ULL, 0x000FED23E76A2FD7ULL, 0x000FED0A732FE643ULL, 0x000FECEFDA07FE34ULL,
+    0x000FECD4100EB7B8ULL, 0x000FECB708956EB4ULL, 0x000FEC98B61230C1ULL, 0x000FEC790A0DA978ULL,
+    0x000FEC57F50F31FDULL, 0x000FEC356686C961ULL, 0x000FEC114CB4B334ULL, 0x000FEBEB948E6FD0ULL,
+    0x000FEBC429A0B691ULL, 0x000FEB9AF5EE0CDCULL, 0x000FEB6FE1C98542ULL, 0x000FEB42D3AD1F9EULL,
+    0x000FEB13B00B2D4BULL, 0x000FEAE2591A02E9ULL, 0x000FEAAEAE992257ULL, 0x000FEA788D8EE326ULL,
+    0x000FEA3FCFFD73E5ULL, 0x000FEA044C8DD9F6ULL, 0x000FE9C5D62F563AULL, 0x000FE9843BA947A3ULL,
+    0x000FE93F471D4729ULL, 0x000FE8F6BD76C5D6ULL, 0x000FE8AA5DC4E8E6ULL, 0x000FE859E07AB1EAULL,
+    0x000FE804F690A940ULL, 0x000FE7AB488233BFULL, 0x000FE74C751F6AA6ULL, 0x000FE6E8102AA202ULL,
+    0x000FE67DA0B6ABD8ULL, 0x000FE60C9F38307EULL, 0x000FE5947338F742ULL, 0x000FE51470977280ULL,
+    0x000FE48BD436F458ULL, 0x000FE3F9BFFD1E37ULL, 0x000FE35D35EEB19BULL, 0x000FE2B5122FE4FDULL,
+    0x000FE20003995557ULL, 0x000FE13C82788314ULL, 0x000FE068C4EE67AFULL, 0x000FDF82B02B71A9ULL,
+    0x000FDE87C57EFEAAULL, 0x000FDD7509C63BFDULL, 0x000FDC46E529BF13ULL, 0x000FDAF8F82E0282ULL,
+    0x000FD985E1B2BA75ULL, 0x000FD7E6EF48CF03ULL, 0x000FD613ADBD650BULL, 0x000FD40149E2F011ULL,
+    0x000FD1A1A7B4C7ACULL, 0x000FCEE204761F9EULL, 0x000FCBA8D85E11B1ULL, 0x000FC7D26ECD2D23ULL,
+    0x000FC32B2F1E22EDULL, 0x000FBD6581C0B83AULL, 0x000FB606C4005434ULL, 0x000FAC40582A2873ULL,
+    0x000F9E971E014597ULL, 0x000F89FA48A41DFBULL, 0x000F66C5F7F0302CULL, 0x000F1A5A4B331C4AULL
+};
+
+static const double normal_w[256] =
+{
+    8.68362706080131701e-16, 4.77933017572754885e-17, 6.35435241740514521e-17,
+    7.45487048124761000e-17, 8.32936681579302947e-17, 9.06806040505942312e-17,
+    9.71486007656771254e-17, 1.02947503142409724e-16, 1.08234302884476445e-16,
+    1.13114701961089987e-16, 1.17663594570228891e-16, 1.21936172787143313e-16,
+    1.25974399146370607e-16, 1.29810998862640020e-16, 1.33472037368240932e-16,
+    1.36978648425711737e-16, 1.40348230012423574e-16, 1.43595294520569233e-16,
+    1.46732087423644022e-16, 1.49769046683910220e-16, 1.52715150035961856e-16,
+    1.55578181694607541e-16, 1.58364940092908755e-16, 1.61081401752749205e-16,
+    1.63732852039698433e-16, 1.66323990584208230e-16, 1.68859017086765841e-16,
+    1.71341701765596459e-16, 1.73775443658648495e-16, 1.76163319230009886e-16,
+    1.78508123169767199e-16, 1.80812402857991424e-16, 1.83078487648267428e-16,
+    1.85308513886180091e-16, 1.87504446393738743e-16, 1.89668097007747522e-16,
+    1.91801140648386124e-16, 1.93905129306250963e-16, 1.95981504266288145e-16,
+    1.98031606831281616e-16, 2.00056687762733177e-16, 2.02057915620716416e-16,
+    2.04036384154801995e-16, 2.05993118874036965e-16, 2.07929082904140074e-16,
+    2.09845182223703418e-16, 2.11742270357603345e-16, 2.13621152594498582e-16,
+    2.15482589785814482e-16, 2.17327301775643576e-16, 2.19155970504272610e-16,
+    2.20969242822353102e-16, 2.22767733047895436e-16, 2.24552025294143454e-16,
+    2.26322675592856688e-16, 2.28080213834501608e-16, 2.29825145544246691e-16,
+    2.31557953510407840e-16, 2.33279099280043364e-16, 2.34989024534709354e-16,
+    2.36688152357915791e-16, 2.38376888404542188e-16, 2.40055621981350381e-16,
+    2.41724727046750006e-16, 2.43384563137110089e-16, 2.45035476226149343e-16,
+    2.46677799523270350e-16, 2.48311854216108620e-16, 2.49937950162045193e-16,
+    2.51556386532965737e-16, 2.53167452417135778e-16, 2.54771427381694368e-16,
+    2.56368581998939585e-16, 2.57959178339286625e-16, 2.59543470433516922e-16,
+    2.61121704706701791e-16, 2.62694120385972417e-16, 2.64260949884118853e-16,
+    2.65822419160830582e-16, 2.67378748063236231e-16, 2.68930150647261493e-16,
+    2.70476835481199420e-16, 2.72019005932773108e-16, 2.73556860440867810e-16,
+    2.75090592773016566e-16, 2.76620392269638884e-16, 2.78146444075954262e-16,
+    2.79668929362422857e-16, 2.81188025534501926e-16, 2.82703906432447775e-16,
+    2.84216742521840459e-16, 2.85726701075459952e-16, 2.87233946347097797e-16,
+    2.88738639737847995e-16, 2.90240939955384036e-16, 2.91741003166694356e-16,
+    2.93238983144718016e-16, 2.94735031409293292e-16, 2.96229297362806451e-16,
+    2.97721928420902743e-16, 2.99213070138601159e-16, 3.00702866332132955e-16,
+    3.02191459196806053e-16, 3.03678989421180086e-16, 3.05165596297821824e-16,
+    3.06651417830895402e-16, 3.08136590840829668e-16, 3.09621251066292204e-16,
+    3.11105533263689248e-16, 3.12589571304399843e-16, 3.14073498269944617e-16,
+    3.15557446545280064e-16, 3.17041547910402853e-16, 3.18525933630440649e-16,
+    3.20010734544401138e-16, 3.21496081152744705e-16, 3.22982103703941558e-16,
+    3.24468932280169778e-16, 3.25956696882307838e-16, 3.27445527514370672e-16,
+    3.28935554267536968e-16, 3.30426907403912839e-16, 3.31919717440175234e-16,
+    3.33414115231237246e-16, 3.34910232054077845e-16, 3.36408199691876508e-16,
+    3.37908150518594980e-16, 3.39410217584148914e-16, 3.40914534700312604e-16,
+    3.42421236527501816e-16, 3.43930458662583134e-16, 3.45442337727858402e-16,
+    3.46957011461378353e-16, 3.48474618808741371e-16, 3.49995300016538100e-16,
+    3.51519196727607441e-16, 3.53046452078274009e-16, 3.54577210797743572e-16,
+    3.56111619309838843e-16, 3.57649825837265051e-16, 3.59191980508602995e-16,
+    3.60738235468235138e-16, 3.62288744989419152e-16, 3.63843665590734439e-16,
+    3.65403156156136996e-16, 3.66967378058870090e-16, 3.68536495289491352e-16,
+    3.70110674588289786e-16, 3.71690085582382199e-16, 3.73274900927794254e-16,
+    3.74865296456848721e-16, 3.76461451331202721e-16, 3.78063548200895890e-16,
+    3.79671773369794327e-16, 3.81286316967837640e-16, 3.82907373130524170e-16,
+    3.84535140186095759e-16, 3.86169820850914730e-16, 3.87811622433558475e-16,
+    3.89460757048192374e-16, 3.91117441837820296e-16, 3.92781899208053907e-16,
+    3.94454357072087416e-16, 3.96135049107613198e-16, 3.97824215026467914e-16,
+    3.99522100857856157e-16, 4.01228959246062612e-16, 4.02945049763632497e-16,
+    4.04670639241074699e-16, 4.06406002114224694e-16, 4.08151420790493479e-16,
+    4.09907186035326249e-16, 4.11673597380302126e-16, 4.13450963554423107e-16,
+    4.15239602940268292e-16, 4.17039844056831045e-16, 4.18852026071010687e-16,
+    4.20676499339901018e-16, 4.22513625986204444e-16, 4.24363780509307352e-16,
+    4.26227350434779415e-16, 4.28104737005311272e-16, 4.29996355916382885e-16,
+    4.31902638100262599e-16, 4.33824030562278785e-16, 4.35760997273684605e-16,
+    4.37714020125858451e-16, 4.39683599951051842e-16, 4.41670257615420053e-16,
+    4.43674535190656431e-16, 4.45696997211204011e-16, 4.47738232024753091e-16,
+    4.49798853244554672e-16, 4.51879501313005580e-16, 4.53980845187003105e-16,
+    4.56103584156741911e-16, 4.58248449810956371e-16, 4.60416208163114986e-16,
+    4.62607661954784272e-16, 4.64823653154320442e-16, 4.67065065671262862e-16,
+    4.69332828309332693e-16, 4.71627917983835031e-16, 4.73951363232586617e-16,
+    4.76304248053313639e-16, 4.78687716104872186e-16, 4.81102975314741622e-16,
+    4.83551302941152417e-16, 4.86034051145081097e-16, 4.88552653135360245e-16,
+    4.91108629959526857e-16, 4.93703598024033356e-16, 4.96339277440398627e-16,
+    4.99017501309182147e-16, 5.01740226071808946e-16, 5.04509543081872749e-16,
+    5.07327691573354108e-16, 5.10197073234156086e-16, 5.13120268630678275e-16,
+    5.16100055774322726e-16, 5.19139431175769761e-16, 5.22241633800023330e-16,
+    5.25410172417759535e-16, 5.28648856950494216e-16, 5.31961834533839742e-16,
+    5.35353631181649392e-16, 5.38829200133405024e-16, 5.42393978220170938e-16,
+    5.46053951907477745e-16, 5.49815735089281115e-16, 5.53686661246787305e-16,
+    5.57674893292657352e-16, 5.61789555355541370e-16, 5.66040892008242020e-16,
+    5.70440462129138711e-16, 5.75001376891989425e-16, 5.79738594572459266e-16,
+    5.84669289345547802e-16, 5.89813317647789844e-16, 5.95193814964144317e-16,
+    6.00837969627190734e-16, 6.06778040933344753e-16, 6.13052720872527962e-16,
+    6.19708989458162457e-16, 6.26804696330128242e-16, 6.34412240712750401e-16,
+    6.42623965954805442e-16, 6.51560331734499160e-16, 6.61382788509766218e-16,
+    6.72315046250558466e-16, 6.84680341756425679e-16, 6.98971833638761798e-16,
+    7.15999493483066224e-16, 7.37242430179879694e-16, 7.65893637080557177e-16,
+    8.11384933765648419e-16
+};
+
+static const double normal_f[256] =
+{
+    1.00000000000000000e+00, 9.77101701267673373e-01, 9.59879091800108109e-01,
+    9.45198953442300871e-01, 9.32060075959231571e-01, 9.19991505039348012e-01,
+    9.08726440052131768e-01, 8.98095921898344307e-01, 8.87984660755834154e-01,
+    8.78309655808918066e-01, 8.69008688036857713e-01, 8.60033621196332199e-01,
+    8.51346258458678617e-01, 8.42915653112204843e-01, 8.34716292986884101e-01,
+    8.26726833946222039e-01, 8.18929191603702922e-01, 8.11307874312656718e-01,
+    8.03849483170964718e-01, 7.96542330422959299e-01, 7.89376143566024924e-01,
+    7.82341832654802727e-01, 7.75431304981187397e-01, 7.68637315798486487e-01,
+    7.61953346836795498e-01, 7.55373506507096448e-01, 7.48892447219157154e-01,
+    7.42505296340151388e-01, 7.36207598126862983e-01, 7.29995264561476453e-01,
+    7.23864533468630444e-01, 7.17811932630722183e-01, 7.11834248878248643e-01,
+    7.05928501332754532e-01, 7.00091918136511837e-01, 6.94321916126116934e-01,
+    6.88616083004672030e-01, 6.82972161644995079e-01, 6.77388036218773748e-01,
+    6.71861719897082432e-01, 6.66391343908750433e-01, 6.60975147776663441e-01,
+    6.55611470579697597e-01, 6.50298743110817035e-01, 6.45035480820822626e-01,
+    6.39820277453056807e-01, 6.34651799287623830e-01, 6.29528779924836912e-01,
+    6.24450015547026727e-01, 6.19414360605834546e-01, 6.14420723888914111e-01,
+    6.09468064925773656e-01, 6.04555390697467998e-01, 5.99681752619125596e-01,
+    5.94846243767987670e-01, 5.90047996332826230e-01, 5.85286179263371786e-01,
+    5.80559996100791453e-01, 5.75868682972354273e-01, 5.71211506735253782e-01,
+    5.66587763256165000e-01, 5.61996775814525118e-01, 5.57437893618766611e-01,
+    5.52910490425832957e-01, 5.48413963255266368e-01, 5.43947731190026706e-01,
+    5.39511234256952577e-01, 5.35103932380457947e-01, 5.30725304403662279e-01,
+    5.26374847171684590e-01, 5.22052074672321953e-01, 5.17756517229756463e-01,
+    5.13487720747327181e-01, 5.09245245995748164e-01, 5.05028667943468457e-01,
+    5.00837575126149126e-01, 4.96671569052490103e-01, 4.92530263643868815e-01,
+    4.88413284705458306e-01, 4.84320269426683603e-01, 4.80250865909047031e-01,
+    4.76204732719506141e-01, 4.72181538467730422e-01, 4.68180961405693874e-01,
+    4.64202689048174633e-01, 4.60246417812843200e-01, 4.56311852678716767e-01,
+    4.52398706861848965e-01, 4.48506701507203398e-01, 4.44635565395739785e-01,
+    4.40785034665804376e-01, 4.36954852547985995e-01, 4.33144769112652761e-01,
+    4.29354541029441927e-01, 4.25583931338022414e-01, 4.21832709229496339e-01,
+    4.18100649837848615e-01, 4.14387534040891625e-01, 4.10693148270188657e-01,
+    4.07017284329473761e-01, 4.03359739221114844e-01, 3.99720314980197555e-01,
+    3.96098818515832729e-01, 3.92495061459315842e-01, 3.88908860018788938e-01,
+    3.85340034840077450e-01, 3.81788410873393769e-01, 3.78253817245619295e-01,
+    3.74736087137891249e-01, 3.71235057668239554e-01, 3.67750569779032588e-01,
+    3.64282468129004056e-01, 3.60830600989648032e-01, 3.57394820145780501e-01,
+    3.53974980800076777e-01, 3.50570941481406106e-01, 3.47182563956793644e-01,
+    3.43809713146850715e-01, 3.40452257044521867e-01, 3.37110066637006045e-01,
+    3.33783015830718455e-01, 3.30470981379163586e-01, 3.27173842813601401e-01,
+    3.23891482376391093e-01, 3.20623784956905356e-01, 3.17370638029913610e-01,
+    3.14131931596337177e-01, 3.10907558126286510e-01, 3.07697412504292056e-01,
+    3.04501391976649993e-01, 3.01319396100803050e-01, 2.98151326696685481e-01,
+    2.94997087799961810e-01, 2.91856585617095210e-01, 2.88729728482182924e-01,
+    2.85616426815501756e-01, 2.82516593083707579e-01, 2.79430141761637940e-01,
+    2.76356989295668320e-01, 2.73297054068577072e-01, 2.70250256365875463e-01,
+    2.67216518343561471e-01, 2.64195763997261190e-01, 2.61187919132721214e-01,
+    2.58192911337619235e-01, 2.55210669954661962e-01, 2.52241126055942233e-01,
+    2.49284212418528578e-01, 2.46339863501263995e-01, 2.43408015422750479e-01,
+    2.40488605940500838e-01, 2.37581574431238340e-01, 2.34686861872330260e-01,
+    2.31804410824338891e-01, 2.28934165414680535e-01, 2.26076071322380528e-01,
+    2.23230075763917818e-01, 2.20396127480152332e-01, 2.17574176724331519e-01,
+    2.14764175251174000e-01, 2.11966076307030599e-01, 2.09179834621125493e-01,
+    2.06405406397881241e-01, 2.03642749310335436e-01, 2.00891822494657174e-01,
+    1.98152586545775666e-01, 1.95425003514134804e-01, 1.92709036903589648e-01,
+    1.90004651670465458e-01, 1.87311814223800804e-01, 1.84630492426799853e-01,
+    1.81960655599523125e-01, 1.79302274522848221e-01, 1.76655321443735552e-01,
+    1.74019770081839359e-01, 1.71395595637506504e-01, 1.68782774801212093e-01,
+    1.66181285764482628e-01, 1.63591108232366278e-01, 1.61012223437511648e-01,
+    1.58444614155924840e-01, 1.55888264724479753e-01, 1.53343161060263300e-01,
+    1.50809290681846148e-01, 1.48286642732574941e-01, 1.45775208005994417e-01,
+    1.43274978973513822e-01, 1.40785949814445061e-01, 1.38308116448551094e-01,
+    1.35841476571254116e-01, 1.33386029691669517e-01, 1.30941777173644719e-01,
+    1.28508722279999904e-01, 1.26086870220186276e-01, 1.23676228201596905e-01,
+    1.21276805484790626e-01, 1.18888613442910379e-01, 1.16511665625611230e-01,
+    1.14145977827838779e-01, 1.11791568163838437e-01, 1.09448457146812048e-01,
+    1.07116667774683996e-01, 1.04796225622487207e-01, 1.02487158941935344e-01,
+    1.00189498768810101e-01, 9.79032790388625895e-02, 9.56285367130090824e-02,
+    9.33653119126910958e-02, 9.11136480663738285e-02, 8.88735920682759695e-02,
+    8.66451944505581412e-02, 8.44285095703535410e-02, 8.22235958132029876e-02,
+    8.00305158146631529e-02, 7.78493367020961224e-02, 7.56801303589271779e-02,
+    7.35229737139813794e-02, 7.13779490588904719e-02, 6.92451443970068248e-02,
+    6.71246538277885663e-02, 6.50165779712429531e-02, 6.29210244377582245e-02,
+    6.08381083495400168e-02, 5.87679529209339246e-02, 5.67106901062030822e-02,
+    5.46664613248890943e-02, 5.26354182767923770e-02, 5.06177238609479413e-02,
+    4.86135532158686948e-02, 4.66230949019305271e-02, 4.46465522512946023e-02,
+    4.26841449164746117e-02, 4.07361106559410852e-02, 3.88027074045262377e-02,
+    3.68842156885674025e-02, 3.49809414617161737e-02, 3.30932194585786196e-02,
+    3.12214171919203282e-02, 2.93659397581333866e-02, 2.75272356696031478e-02,
+    2.57058040085489450e-02, 2.39022033057959098e-02, 2.21170627073088988e-02,
+    2.03510962300445380e-02, 1.86051212757246710e-02, 1.68800831525431870e-02,
+    1.51770883079353370e-02, 1.34974506017398899e-02, 1.18427578579079103e-02,
+    1.02149714397014868e-02, 8.61658276939874894e-03, 7.05087547137324151e-03,
+    5.52240329925101064e-03, 4.03797259336303744e-03, 2.60907274610216403e-03,
+    1.26028593049859797e-03
+};
+
+static const uint64_t exponential_k[256] =
+{
+    0x001C5214272497FBULL, 0x0000000000000000ULL, 0x00137D5BD79F91AEULL, 0x00186EF58E40837BULL,
+    0x001A9BB7320F58B8ULL, 0x001BD127F719A9CAULL, 0x001C951D0F88A88FULL, 0x001D1BFE2D5C697CULL,
+    0x001D7E5BD56B3C9AULL, 0x001DC934DD174845ULL, 0x001E0409DFACB3FFULL, 0x001E337B71D48A52ULL,
+    0x001E5A8B177CC6B3ULL, 0x001E7B42096F1124ULL, 0x001E970DAF08B91FULL, 0x001EAEF5B14EFA0AULL,
+    0x001EC3BD07B46D90ULL, 0x001ED5F6F087A10FULL, 0x001EE614AE6E5CFCULL, 0x001EF46ECA362293ULL,
+    0x001F014B76DDD9D1ULL, 0x001F0CE313A79B67ULL, 0x001F176369F1FBBDULL, 0x001F20F20C452953ULL,
+    0x001F29AE1951AC06ULL, 0x001F31B18FB95879ULL, 0x001F39125157C40BULL, 0x001F3FE2EB6E6C1BULL,
+    0x001F463332D78B94ULL, 0x001F4C10BF1D3C7DULL, 0x001F51874C5C3566ULL, 0x001F56A109C3EEDDULL,
+    0x001F5B66D9099B91ULL, 0x001F5FE08210D26CULL, 0x001F6414DD445933ULL, 0x001F6809F6859823ULL,
+    0x001F6BC52A2B047AULL, 0x001F6F4B3D32E66FULL, 0x001F72A07190F2A1ULL, 0x001F75C8974D0B2DULL,
+    0x001F78C71B045E05ULL, 0x001F7B9F1241412AULL, 0x001F7E534607A0B0ULL, 0x001F80E63BE21252ULL,
+    0x001F835A3DAD926EULL, 0x001F85B16056BA14ULL, 0x001F87ED89B24358ULL, 0x001F8A10759375E5ULL,
+    0x001F8C1BBA3D3A8EULL, 0x001F8E10CC45D123ULL, 0x001F8FF102013EE7ULL, 0x001F91BD968359A8ULL,
+    0x001F9377AC47B098ULL, 0x001F95204F8B6595ULL, 0x001F96B878633945ULL, 0x001F98410C96893EULL,
+    0x001F99BAE146BB26ULL, 0x001F9B26BC697FA1ULL, 0x001F9C85561B7216ULL, 0x001F9DD759CFD89AULL,
+    0x001F9F1D6761A25EULL, 0x001FA0581409374DULL, 0x001FA187EB3A33C3ULL, 0x001FA2AD6F6BC581ULL,
+    0x001FA3C91ACE0704ULL, 0x001FA4DB5FEE6B20ULL, 0x001FA5E4AA4D09F6ULL, 0x001FA6E55EE467F9ULL,
+    0x001FA7DDDCA51F36ULL, 0x001FA8CE7CE6A8E4ULL, 0x001FA9B793CE605BULL, 0x001FAA9970ADB8C1ULL,
+    0x001FAB745E588298ULL, 0x001FAC48A37405E8ULL, 0x001FAD1682BFA04BULL, 0x001FADDE3B578320ULL,
+    0x001FAEA008F21DC8ULL, 0x001FAF5C2418B0D9ULL, 0x001FB012C25B7A69ULL, 0x001FB0C41681E049ULL,
+    0x001FB17050B6F24FULL, 0x001FB2179EB2968CULL, 0x001FB2BA2BDFA89BULL, 0x001FB358217F4E66ULL,
+    0x001FB3F1A6C9BE58ULL, 0x001FB486E10CAD21ULL, 0x001FB517F3C79445ULL, 0x001FB5A500C5FDF2ULL,
+    0x001FB62E2837FE9DULL, 0x001FB6B388C9014FULL, 0x001FB7353FB507DBULL, 0x001FB7B368DC7DE9ULL,
+    0x001FB82E1ED6BA49ULL, 0x001FB8A57B034834ULL, 0x001FB919959A0FB1ULL, 0x001FB98A85BA7240ULL,
+    0x001FB9F861796F61ULL, 0x001FBA633DEEE2C0ULL, 0x001FBACB2F41EC4FULL, 0x001FBB3048B4917CULL,
+    0x001FBB929CAEA519ULL, 0x001FBBF23CC802D4ULL, 0x001FBC4F39D229C9ULL, 0x001FBCA9A3E1410BULL,
+    0x001FBD018A548FD0ULL, 0x001FBD56FBDE72CEULL, 0x001FBDAA068BD69BULL, 0x001FBDFAB7CB3F71ULL,
+    0x001FBE491C73650DULL, 0x001FBE9540C9698EULL, 0x001FBEDF3086B156ULL, 0x001FBF26F6DE61A1ULL,
+    0x001FBF6C9E828B0EULL, 0x001FBFB031A904EFULL, 0x001FBFF1BA0FFDDBULL, 0x001FC031410245B2ULL,
+    0x001FC06ECF5B54DDULL, 0x001FC0AA6D8B1451ULL, 0x001FC0E4239969B1ULL, 0x001FC11BF9298A8DULL,
+    0x001FC151F57D196AULL, 0x001FC1861F770F71ULL, 0x001FC1B87D9E74DAULL, 0x001FC1E91620EA68ULL,
+    0x001FC217EED50603ULL, 0x001FC2450D3C8422ULL, 0x001FC27076864FE5ULL, 0x001FC29A2F906332ULL,
+    0x001FC2C23CE98069ULL, 0x001FC2E8A2D2C6D6ULL, 0x001FC30D6541230FULL, 0x001FC33087DE9C30ULL,
+    0x001FC3520E0B7EE7ULL, 0x001FC371FADF6719ULL, 0x001FC390512A28A7ULL, 0x001FC3AD13749819ULL,
+    0x001FC3C844013368ULL, 0x001FC3E1E4CCAB5EULL, 0x001FC3F9F78E4DC7ULL, 0x001FC4107DB85080ULL,
+    0x001FC4257877FD87ULL, 0x001FC438E8B5BFE4ULL, 0x001FC44ACF151147ULL, 0x001FC45B2BF44805ULL,
+    0x001FC469FF6C4520ULL, 0x001FC477495001CFULL, 0x001FC483092BFBD6ULL, 0x001FC48D3E458011ULL,
+    0x001FC495E799D236ULL, 0x001FC49D03DD30CCULL, 0x001FC4A29179B44EULL, 0x001FC4A68E8E0816ULL,
+    0x001FC4A8F8EBFBA6ULL, 0x001FC4A9CE16EAB9ULL, 0x001FC4A90B41FA4CULL, 0x001FC4A6AD4E28B9ULL,
+    0x001FC4A2B0C82E8EULL, 0x001FC49D11E62DFBULL, 0x001FC495CC852E0EULL, 0x001FC48CDC265ED9ULL,
+    0x001FC4823BEC2391ULL, 0x001FC475E696DEFEULL, 0x001FC467D6817E9AULL, 0x001FC458059DC04FULL,
+    0x001FC4466D702E37ULL, 0x001FC433070BCBB0ULL, 0x001FC41DCB0D6E24ULL, 0x001FC406B196BC0DULL,
+    0x001FC3EDB248CB76ULL, 0x001FC3D2C43E5953ULL, 0x001FC3B5DE0591CAULL, 0x001FC396F5996162ULL,
+    0x001FC376005A45A9ULL, 0x001FC352F3069387ULL, 0x001FC32DC1B2282EULL, 0x001FC3065FBD789DULL,
+    0x001FC2DCBFCBF278ULL, 0x001FC2B0D3B99FB2ULL, 0x001FC2828C8FFD04ULL, 0x001FC251DA79F177ULL,
+    0x001FC21EACB6D3B2ULL, 0x001FC1E8F18C676BULL, 0x001FC1B09637BB51ULL, 0x001FC17586DCCD23ULL,
+    0x001FC137AE74D6CBULL, 0x001FC0F6F6BB2428ULL, 0x001FC0B348184DB8ULL, 0x001FC06C898BB004ULL,
+    0x001FC022A092F378ULL, 0x001FBFD5710F72CBULL, 0x001FBF84DD2948A1ULL, 0x001FBF30C52FC61EULL,
+    0x001FBED907770CD9ULL, 0x001FBE7D80327DEDULL, 0x001FBE1E094BA626ULL, 0x001FBDBA7A354419ULL,
+    0x001FBD52A7B9F839ULL, 0x001FBCE663C6202DULL, 0x001FBC757D2C4DF7ULL, 0x001FBBFFBF63B7BCULL,
+    0x001FBB84F23FE6B4ULL, 0x001FBB04D9A0D19FULL, 0x001FBA7F351A70BFULL, 0x001FB9F3BF92B62AULL,
+    0x001FB9622ED4AC0EULL, 0x001FB8CA33174A28ULL, 0x001FB82B76765B64ULL, 0x001FB7859C5B896DULL,
+    0x001FB6D840D555A5ULL, 0x001FB622F7D96954ULL, 0x001FB5654C6F37F2ULL, 0x001FB49EBFBF69E3ULL,
+    0x001FB3CEC803E758ULL, 0x001FB2F4CF539C51ULL, 0x001FB21032442865ULL, 0x001FB1203E5A9615ULL,
+    0x001FB0243042E1D3ULL, 0x001FAF1B31C479B8ULL, 0x001FAE045767E116ULL, 0x001FACDE9DBF2D84ULL,
+    0x001FABA8E640061CULL, 0x001FAA61F399FF38ULL, 0x001FA908656F66B3ULL, 0x001FA79AB3508D4EULL,
+    0x001FA61726D1F224ULL, 0x001FA47BD48BEA11ULL, 0x001FA2C693C5C0A6ULL, 0x001FA0F4F47DF327ULL,
+    0x001F9F04336BBE1CULL, 0x001F9CF12B79F9CEULL, 0x001F9AB84415ABD6ULL, 0x001F98555B782FCBULL,
+    0x001F95C3ABD03F8BULL, 0x001F92FDA9CEF204ULL, 0x001F8FFCDA9AE42FULL, 0x001F8CB99E73860BULL,
+    0x001F892AEC479619ULL, 0x001F8545F904DBA1ULL, 0x001F80FDC33603AEULL, 0x001F7C427839E939ULL,
+    0x001F7700A3582ADFULL, 0x001F71200F1A2430ULL, 0x001F6A8234B73540ULL, 0x001F630000A8E27CULL,
+    0x001F5A66904FE3D9ULL, 0x001F50724ECE1187ULL, 0x001F44C7665C6FF1ULL, 0x001F36E5A38A59BAULL,
+    0x001F261434503423ULL, 0x001F113E047B042EULL, 0x001EF6AEFA57CC02ULL, 0x001ED38CA188153CULL,
+    0x001EA2A61E122DD2ULL, 0x001E5961C78B26A1ULL, 0x001DDDF62BAC0BDCULL, 0x001CDB4DD9E4E8F7ULL
+};
+
+static const double exponential_w[256] =
+{
+    9.65574006320967010e-16, 7.08901424447713489e-18, 1.16394124970784482e-17,
+    1.52439151238535131e-17, 1.83328488575186126e-17, 2.10896510948984666e-17,
+    2.36112807786646290e-17, 2.59559577233263970e-17, 2.81617355421822821e-17,
+    3.02550413034080988e-17, 3.22550825485491659e-17, 3.41763234020280968e-17,
+    3.60299697875157385e-17, 3.78249077688618801e-17, 3.95683219811357450e-17,
+    4.12661177819150301e-17, 4.29232180845766313e-17, 4.45437774329712805e-17,
+    4.61313398149759312e-17, 4.76889572527872204e-17, 4.92192804374175374e-17,
+    5.07246290451666304e-17, 5.22070470280593261e-17, 5.36683466173121578e-17,
+    5.51101437284789460e-17, 5.65338867325225809e-17, 5.79408800486516159e-17,
+    5.93323036522115070e-17, 6.07092293285921217e-17, 6.20726343117505845e-17,
+    6.34234128031478370e-17, 6.47623857596769893e-17, 6.60903092578082030e-17,
+    6.74078816788399926e-17, 6.87157499119495880e-17, 7.00145147341495025e-17,
+    7.13047354967154202e-17, 7.25869342242543233e-17, 7.38615992139246504e-17,
+    7.51291882073429513e-17, 7.63901311956129052e-17, 7.76448329080821546e-17,
+    7.88936750274006300e-17, 8.01370181668563567e-17, 8.13752036405185469e-17,
+    8.26085550522004438e-17, 8.38373797254906301e-17, 8.50619699939516664e-17,
+    8.62826043679387885e-17, 8.74995485922587317e-17, 8.87130566069987022e-17,
+    8.99233714222490475e-17, 9.11307259160738906e-17, 9.23353435639120022e-17,
+    9.35374391065847571e-17, 9.47372191632223347e-17, 9.59348827946722083e-17,
+    9.71306220223068432e-17, 9.83246223065861531e-17, 9.95170629892411789e-17,
+    1.00708117702519411e-16, 1.01897954748558783e-16, 1.03086737451631029e-16,
+    1.04274624485707171e-16, 1.05461770179545438e-16, 1.06648324801278775e-16,
+    1.07834434824281674e-16, 1.09020243175921391e-16, 1.10205889470643686e-16,
+    1.11391510228705169e-16, 1.12577239081741724e-16, 1.13763206966253002e-16,
+    1.14949542305985042e-16, 1.16136371184105524e-16, 1.17323817505987853e-16,
+    1.18512003153349823e-16, 1.19701048130429001e-16, 1.20891070702820643e-16,
+    1.22082187529552336e-16, 1.23274513788922871e-16, 1.24468163298592234e-16,
+    1.25663248630370463e-16, 1.26859881220120021e-16, 1.28058171473154859e-16,
+    1.29258228865491507e-16, 1.30460162041282116e-16, 1.31664078906736144e-16,
+    1.32870086720816655e-16, 1.34078292182978188e-16, 1.35288801518195470e-16,
+    1.36501720559517406e-16, 1.37717154828365429e-16, 1.38935209612783404e-16,
+    1.40155990043833871e-16, 1.41379601170324940e-16, 1.42606148032042669e-16,
+    1.43835735731654872e-16, 1.45068469505444351e-16, 1.46304454793022884e-16,
+    1.47543797306170204e-16, 1.48786603096937376e-16, 1.50032978625148193e-16,
+    1.51283030825428194e-16, 1.52536867173886535e-16, 1.53794595754573427e-16,
+    1.55056325325831202e-16, 1.56322165386657016e-16, 1.57592226243190633e-16,
+    1.58866619075441188e-16, 1.60145456004364199e-16, 1.61428850159400170e-16,
+    1.62716915746585132e-16, 1.64009768117343680e-16, 1.65307523838075354e-16,
+    1.66610300760645648e-16, 1.67918218093894106e-16, 1.69231396476273224e-16,
+    1.70549958049733759e-16, 1.71874026534973744e-16, 1.73203727308171193e-16,
+    1.74539187479323532e-16, 1.75880535972319075e-16, 1.77227903606870364e-16,
+    1.78581423182442780e-16, 1.79941229564315693e-16, 1.81307459771919304e-16,
+    1.82680253069594178e-16, 1.84059751059927537e-16, 1.85446097779825503e-16,
+    1.86839439799487653e-16, 1.88239926324457392e-16, 1.89647709300929662e-16,
+    1.91062943524505471e-16, 1.92485786752592027e-16, 1.93916399820657390e-16,
+    1.95354946762558188e-16, 1.96801594935170841e-16, 1.98256515147568835e-16,
+    1.99719881795000941e-16, 2.01191872997940003e-16, 2.02672670746486192e-16,
+    2.04162461050425068e-16, 2.05661434095257805e-16, 2.07169784404539549e-16,
+    2.08687711008881669e-16, 2.10215417621994779e-16, 2.11753112824172919e-16,
+    2.13301010253643088e-16, 2.14859328806231339e-16, 2.16428292843825331e-16,
+    2.18008132412143089e-16, 2.19599083468351612e-16, 2.21201388119113985e-16,
+    2.22815294869682297e-16, 2.24441058884694954e-16, 2.26078942261381321e-16,
+    2.27729214315925903e-16, 2.29392151883794787e-16, 2.31068039634884835e-16,
+    2.32757170404416817e-16, 2.34459845540558993e-16, 2.36176375269840459e-16,
+    2.37907079081490582e-16, 2.39652286131925116e-16, 2.41412335670691944e-16,
+    2.43187577489288063e-16, 2.44978372394369391e-16, 2.46785092706991095e-16,
+    2.48608122789647295e-16, 2.50447859603017630e-16, 2.52304713294483479e-16,
+    2.54179107820642852e-16, 2.56071481606238558e-16, 2.57982288242114424e-16,
+    2.59911997225035878e-16, 2.61861094742453509e-16, 2.63830084505555172e-16,
+    2.65819488634245304e-16, 2.67829848598013210e-16, 2.69861726217009488e-16,
+    2.71915704728042296e-16, 2.73992389920641781e-16, 2.76092411348821814e-16,
+    2.78216423624703611e-16, 2.80365107800758201e-16, 2.82539172848085075e-16,
+    2.84739357238877017e-16, 2.86966430642041228e-16, 2.89221195741858872e-16,
+    2.91504490190588532e-16, 2.93817188707061929e-16, 2.96160205334605536e-16,
+    2.98534495873063347e-16, 3.00941060501320535e-16, 3.03380946608558915e-16,
+    3.05855251854544562e-16, 3.08365127481589376e-16, 3.10911781903484862e-16,
+    3.13496484599724441e-16, 3.16120570346768555e-16, 3.18785443822029145e-16,
+    3.21492584620737422e-16, 3.24243552731002701e-16, 3.27039994518281483e-16,
+    3.29883649277285606e-16, 3.32776356417224333e-16, 3.35720063355381501e-16,
+    3.38716834204607462e-16, 3.41768859352620498e-16, 3.44878466045399088e-16,
+    3.48048130103800780e-16, 3.51280488922354395e-16, 3.54578355922535491e-16,
+    3.57944736660483811e-16, 3.61382846821962068e-16, 3.64896132376510165e-16,
+    3.68488292209617895e-16, 3.72163303608076393e-16, 3.75925451041681169e-16,
+    3.79779358766942856e-16, 3.83730027878976638e-16, 3.87782878560844700e-16,
+    3.91943798431197910e-16, 3.96219198078732375e-16, 4.00616075105708945e-16,
+    4.05142088295711946e-16, 4.09805643890360732e-16, 4.14615996429144791e-16,
+    4.19583367207394077e-16, 4.24719084182492542e-16, 4.30035748166800959e-16,
+    4.35547431469448942e-16, 4.41269916903660633e-16, 4.47220987426046674e-16,
+    4.53420779856636696e-16, 4.59892220490646298e-16, 4.66661566471200530e-16,
+    4.73759085326302056e-16, 4.81219917282976450e-16, 4.89085182739273449e-16,
+    4.97403423619246336e-16, 5.06232507214468133e-16, 5.15642182887860262e-16,
+    5.25717580202279253e-16, 5.36564097711253734e-16, 5.48314403425921864e-16,
+    5.61138745467567238e-16, 5.75260648150384247e-16, 5.90981764165261083e-16,
+    6.08723141618141353e-16, 6.29097903487805995e-16, 6.53049205356454074e-16,
+    6.82139307902942561e-16, 7.19244496608985460e-16, 7.70609535003258585e-16,
+    8.54551703858451257e-16
+};
+
+static const double exponential_f[256] =
+{
+    1.00000000000000000e+00, 9.38143680857766116e-01, 9.00469929922605772e-01,
+    8.71704332378680502e-01, 8.47785500621842547e-01, 8.26993296641161280e-01,
+    8.08421651521309959e-01, 7.91527636970945303e-01, 7.75956852038684475e-01,
+    7.61463388848563794e-01, 7.47868621983946102e-01, 7.35038092430246204e-01,
+    7.22867659592457246e-01, 7.11274760804016415e-01, 7.00192655081777748e-01,
+    6.89566496116111760e-01, 6.79350572263839103e-01, 6.69506316731034890e-01,
+    6.60000841078143274e-01, 6.50805833413745316e-01, 6.41896716426468728e-01,
+    6.33251994213595126e-01, 6.24852738702919575e-01, 6.16682180914484235e-01,
+    6.08725382078920241e-01, 6.00968966364550661e-01, 5.93400901691070959e-01,
+    5.86010318476623659e-01, 5.78787358602217750e-01, 5.71723048664214750e-01,
+    5.64809192911804647e-01, 5.58038282262006580e-01, 5.51403416540074409e-01,
+    5.44898237671886165e-01, 5.38516872002321234e-01, 5.32253880262514967e-01,
+    5.26104213983103253e-01, 5.20063177367728446e-01, 5.14126393814254290e-01,
+    5.08289776410159044e-01, 5.02549501840873991e-01, 4.96901987241085585e-01,
+    4.91343869593577953e-01, 4.85871987341439382e-01, 4.80483363930017449e-01,
+    4.75175193036949106e-01, 4.69944825283539924e-01, 4.64789756250014063e-01,
+    4.59707615641733292e-01, 4.54696157474218599e-01, 4.49753251162365364e-01,
+    4.44876873414165930e-01, 4.40065100841978141e-01, 4.35316103215267536e-01,
+    4.30628137288096291e-01, 4.25999541142678129e-01, 4.21428728997266522e-01,
+    4.16914186432658818e-01, 4.12454465996822950e-01, 4.08048183151699884e-01,
+    4.03694012530203317e-01, 3.99390684474909552e-01, 3.95136981832973966e-01,
+    3.90931736984486133e-01, 3.86773829083831788e-01, 3.82662181495708908e-01,
+    3.78595759409284749e-01, 3.74573567615610836e-01, 3.70594648434859342e-01,
+    3.66658079781232049e-01, 3.62762973354540108e-01, 3.58908472948476442e-01,
+    3.55093752866518397e-01, 3.51318016437218494e-01, 3.47580494621376246e-01,
+    3.43880444704245725e-01, 3.40217149066527280e-01, 3.36589914028428694e-01,
+    3.32998068761563848e-01, 3.29440964263894909e-01, 3.25917972393318434e-01,
+    3.22428484955855021e-01, 3.18971912844726646e-01, 3.15547685226901797e-01,
+    3.12155248773955840e-01, 3.08794066934339806e-01, 3.05463619244373152e-01,
+    3.02163400675479699e-01, 2.98892921015371127e-01, 2.95651704281053695e-01,
+    2.92439288161688127e-01, 2.89255223489476299e-01, 2.86099073736878373e-01,
+    2.82970414538585235e-01, 2.79868833236780246e-01, 2.76793928448327509e-01,
+    2.73745309652615953e-01, 2.70722596798875725e-01, 2.67725419931863218e-01,
+    2.64753418834883236e-01, 2.61806242689186619e-01, 2.58883549748842479e-01,
+    2.55985007030244183e-01, 2.53110290015460815e-01, 2.50259082368696095e-01,
+    2.47431075665163869e-01, 2.44625969131730708e-01, 2.41843469398718175e-01,
+    2.39083290262292442e-01, 2.36345152456905239e-01, 2.33628783437281190e-01,
+    2.30933917169477476e-01, 2.28260293930568930e-01, 2.25607660116538433e-01,
+    2.22975768057976698e-01, 2.20364375843218108e-01, 2.17773247148561250e-01,
+    2.15202151075241488e-01, 2.12650861992843110e-01, 2.10119159388855115e-01,
+    2.07606827724090892e-01, 2.05113656293708507e-01, 2.02639439093581758e-01,
+    2.00183974691785921e-01, 1.97747066104975389e-01, 1.95328520679441592e-01,
+    1.92928149976651503e-01, 1.90545769663077402e-01, 1.88181199404138105e-01,
+    1.85834262762082675e-01, 1.83504787097654748e-01, 1.81192603475385322e-01,
+    1.78897546572369032e-01, 1.76619454590387304e-01, 1.74358169171247551e-01,
+    1.72113535315215754e-01, 1.69885401302424993e-01, 1.67673618617149134e-01,
+    1.65478041874836529e-01, 1.63298528751803923e-01, 1.61134939917495723e-01,
+    1.58987138969219427e-01, 1.56854992369271945e-01, 1.54738369384376323e-01,
+    1.52637142027352568e-01, 1.50551185000951077e-01, 1.48480375643779416e-01,
+    1.46424593878258985e-01, 1.44383722160550232e-01, 1.42357645432389046e-01,
+    1.40346251074780659e-01, 1.38349428863499796e-01, 1.36367070926349782e-01,
+    1.34399071702135886e-01, 1.32445327901311055e-01, 1.30505738468255611e-01,
+    1.28580204545154286e-01, 1.26668629437438035e-01, 1.24770918580759616e-01,
+    1.22886979509475039e-01, 1.21016721826605944e-01, 1.19160057175260015e-01,
+    1.17316899211489106e-01, 1.15487163578568267e-01, 1.13670767882680185e-01,
+    1.11867631669993348e-01, 1.10077676405123573e-01, 1.08300825450973109e-01,
+    1.06537004049942069e-01, 1.04786139306511705e-01, 1.03048160171200359e-01,
+    1.01322997425897385e-01, 9.96105836705819675e-02, 9.79108533114381174e-02,
+    9.62237425503797567e-02, 9.45491893760038449e-02, 9.28871335559925820e-02,
+    9.12375166309902091e-02, 8.96002819099838976e-02, 8.79753744672222282e-02,
+    8.63627411407099088e-02, 8.47623305323220999e-02, 8.31740930095873354e-02,
+    8.15979807091933157e-02, 8.00339475422767593e-02, 7.84819492015641912e-02,
+    7.69419431704392032e-02, 7.54138887340180114e-02, 7.38977469923252639e-02,
+    7.23934808756701437e-02, 7.09010551623340951e-02, 6.94204364986918815e-02,
+    6.79515934219006024e-02, 6.64944963853046217e-02, 6.50491177867194154e-02,
+    6.36154319997738193e-02, 6.21934154085083055e-02, 6.07830464454477554e-02,
+    5.93843056333891867e-02, 5.79971756311703709e-02, 5.66216412837133726e-02,
+    5.52576896766683173e-02, 5.39053101960181372e-02, 5.25644945930444918e-02,
+    5.12352370550998373e-02, 4.99175342826806631e-02, 4.86113855733545028e-02,
+    4.73167929131572754e-02, 4.60337610761516122e-02, 4.47622977329204322e-02,
+    4.35024135688660205e-02, 4.22541224132947507e-02, 4.10174413803940166e-02,
+    3.97923910233539888e-02, 3.85789955030553938e-02, 3.73772827729405427e-02,
+    3.61872847819132357e-02, 3.50090376973798620e-02, 3.38425821508574060e-02,
+    3.26879635089432213e-02, 3.15452321728779059e-02, 3.04144439104514948e-02,
+    2.92956602246228770e-02, 2.81889487639646989e-02, 2.70943837809424354e-02,
+    2.60120466451214220e-02, 2.49420264197195464e-02, 2.38844205115464857e-02,
+    2.28393354063740929e-02, 2.18068875042729676e-02, 2.07872040725680246e-02,
+    1.97804243380001639e-02, 1.87867007446869544e-02, 1.78062004109027852e-02,
+    1.68391068260318640e-02, 1.58856218399655649e-02, 1.49459680116840205e-02,
+    1.40203914031752676e-02, 1.31091649312487738e-02, 1.22125924262496081e-02,
+    1.13310135978292575e-02, 1.04648101810250645e-02, 9.61441364249771176e-03,
+    8.78031498580488304e-03, 7.96307743801333810e-03, 7.16335318363166360e-03,
+    6.38190593731623006e-03, 5.61964220720289828e-03, 4.87765598354015974e-03,
+    4.15729512083190273e-03, 3.46026477783533673e-03, 2.78879879357281975e-03,
+    2.14596774371794653e-03, 1.53629978030089039e-03, 9.67269282326748228e-04,
+    4.54134353841298139e-04
+};
+
+/*******************************************************************************
+Bit 8 of a normal word is the sign. It is a coin toss that the branch predictor
+can't learn, so it is moved straight into the sign bit of the result.
+*******************************************************************************/
+static inline double Signed(const double x, const uint64_t word)
+{
+    uint64_t bits = 0;
+    double y = 0.0;
+    
+    memcpy(&bits, &x, sizeof(double));
+    bits ^= (word & 0x100) << 55;
+    memcpy(&y, &bits, sizeof(double));
+    
+    return y;
+}
+
+/*******************************************************************************
+The low 8 bits of a normal word select the layer, bit 8 is the sign, and the top
+52 bits are the magnitude. Those ranges are disjoint, so the layer choice, the
+sign and the abscissa are independent. The slow path finishes a draw that failed
+the rectangle test, either in the wedge or in the tail beyond R which is sampled
+with Marsaglia's 1964 method.
+*******************************************************************************/
+static double NormalSlow(struct spki_source *src, uint64_t word)
+{
+    for (;;)
+    {
+        const size_t layer = word & 0xFF;
+        const uint64_t bits = word >> 12;
+        const double x = (double) bits * normal_w[layer];
+        
+        if (bits < normal_k[layer]) return Signed(x, word);
+        
+        if (layer == 0)
+        {
+            for (;;)
+            {
+                const double tail = -log1p(-spki_Uniform(spki_SourceDraw(src))) / NORMAL_R;
+                const double y = -log1p(-spki_Uniform(spki_SourceDraw(src)));
+                
+                if (y + y > tail * tail || src->error) return Signed(NORMAL_R + tail, word);
+            }
+        }
+        
+        const double f_lo = normal_f[layer];
+        const double f_hi = normal_f[layer - 1];
+        
+        if (f_lo + spki_Uniform(spki_SourceDraw(src)) * (f_hi - f_lo) < exp(-0.5 * x * x))
+        {
+            return Signed(x, word);
+        }
+        
+        word = spki_SourceDraw(src);
+        if (src->error) return 0.0;
+    }
+}
+
+/*******************************************************************************
+The low 8 bits of an exponential word select the layer and the top 53 bits are
+the abscissa. The exponential is memoryless, so the tail beyond R is just R plus
+a fresh draw.
+*******************************************************************************/
+static double ExponentialSlow(struct spki_source *src, uint64_t word)
+{
+    for (;;)
+    {
+        const size_t layer = word & 0xFF;
+        const uint64_t bits = word >> 11;
+        const double x = (double) bits * exponential_w[layer];
+        
+        if (bits < exponential_k[layer]) return x;
+        
+        if (layer == 0) return EXPONENTIAL_R - log1p(-spki_Uniform(spki_SourceDraw(src)));
+        
+        const double f_lo = exponential_f[layer];
+        const double f_hi = exponential_f[layer - 1];
+        
+        if (f_lo + spki_Uniform(spki_SourceDraw(src)) * (f_hi - f_lo) < exp(-x)) return x;
+        
+        word = spki_SourceDraw(src);
+        if (src->error) return 0.0;
+    }
+}
+
+/*******************************************************************************
+The fast path keeps its own cursor into the word block in registers and only
+syncs with the source when a draw is rejected and the slow path takes over.
+*******************************************************************************/
+int spk_Normal
+(
+    spk_generator rng,
+    double *dest,
+    const size_t n,
+    const double mu,
+    const double sigma
+)
+{
+    assert(rng);
+    assert(dest);
+    
+    if (!(sigma >= 0.0) || !isfinite(mu) || !isfinite(sigma))
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_Normal", "mu %g and sigma %g", mu, sigma);
+    }
+    
+    struct spki_source src;
+    spki_SourceInit(&src, rng);
+    
+    size_t position = 0;
+    size_t count = 0;
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        if (position == count)
+        {
+            src.remaining = n - i;
+            if (spki_SourceRefill(&src)) return src.error;
+            position = 0;
+            count = src.count;
+        }
+        
+        const uint64_t word = src.words[position++];
+        const size_t layer = word & 0xFF;
+        const uint64_t bits = word >> 12;
+        
+        double z = Signed((double) bits * normal_w[layer], word);
+        
+        if (bits >= normal_k[layer])
+        {
+            src.remaining = n - i;
+            src.position = position;
+            src.count = count;
+            
+            z = NormalSlow(&src, word);
+            if (src.error) return src.error;
+            
+            position = src.position;
+            count = src.count;
+        }
+        
+        dest[i] = mu + sigma * z;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_Exponential
+(
+    spk_generator rng,
+    double *dest,
+    const size_t n,
+    const double lambda
+)
+{
+    assert(rng);
+    assert(dest);
+    
+    if (!(lambda > 0.0) || !isfinite(lambda))
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_Exponential", "lambda %g is not positive and finite", lambda);
+    }
+    
+    const double scale = 1.0 / lambda;
+    
+    struct spki_source src;
+    spki_SourceInit(&src, rng);
+    
+    size_t position = 0;
+    size_t count = 0;
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        if (position == count)
+        {
+            src.remaining = n - i;
+            if (spki_SourceRefill(&src)) return src.error;
+            position = 0;
+            count = src.count;
+        }
+        
+        const uint64_t word = src.words[position++];
+        const size_t layer = word & 0xFF;
+        const uint64_t bits = word >> 11;
+        
+        double x = (double) bits * exponential_w[layer];
+        
+        if (bits >= exponential_k[layer])
+        {
+            src.remaining = n - i;
+            src.position = position;
+            src.count = count;
+            
+            x = ExponentialSlow(&src, word);
+            if (src.error) return src.error;
+            
+            position = src.position;
+            count = src.count;
+        }
+        
+        dest[i] = scale * x;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
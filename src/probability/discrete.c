@@ -0,0 +1,796 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: subroutines for discrete probability distributions
+* LICS: MIT License
+*/
+
+#define _POSIX_C_SOURCE 200112L //posix_memalign under -std=c99
+
+#include "discrete.h"
+#include "probability_internal.h"
+#include "scipack_internal.h"
+
+#include <assert.h>
+#include <inttypes.h> //PRIu64
+#include <math.h> //isfinite, exp, log, sqrt, floor
+#include <stdlib.h> //malloc, free, posix_memalign
+#include <string.h> //memcpy
+
+/*******************************************************************************
+Prototypes
+*******************************************************************************/
+static int BuildAlias(uint64_t *entries, const double *weights, size_t n, size_t columns, double total);
+static inline uint64_t Pack(double probability, size_t column, size_t alias);
+static void CountRunsSISD(uint64_t *dest, const uint64_t *bits, const size_t outputs, const size_t words, const uint64_t tail, const uint64_t trials, const int flip);
+static void CountRunsPOPCNT(uint64_t *dest, const uint64_t *bits, const size_t outputs, const size_t words, const uint64_t tail, const uint64_t trials, const int flip);
+static int BinomialPopcount(spk_generator rng, uint64_t *dest, size_t n, uint64_t trials, const spk_bias_program *program, int flip);
+struct binomial;
+
+static void BinomialSetup(struct binomial *b, uint64_t trials, double p);
+static uint64_t BinomialInversion(struct spki_source *src, const struct binomial *b);
+static uint64_t BinomialBTPE(struct spki_source *src, const struct binomial *b);
+static inline double Stirling(double x);
+
+static inline uint64_t Bounded(struct spki_source *src, const uint64_t ceiling);
+static inline void Swap(unsigned char *a, unsigned char *b, const size_t size);
+static int FisherYates(struct spki_source *src, unsigned char *base, size_t count, size_t size);
+static int SampleDense(struct spki_source *src, size_t k, uint64_t N, uint64_t *dest);
+static int SampleFloyd(struct spki_source *src, size_t k, uint64_t N, uint64_t *dest);
+
+/*******************************************************************************
+Columns whose scaled probability rounds up to 2^32 can't be stored in 32 bits,
+but a full column doesn't need a threshold at all. Pointing its alias back at
+itself gives the same outcome on both sides of the comparison.
+*******************************************************************************/
+static inline uint64_t Pack(double probability, size_t column, size_t alias)
+{
+    const double scaled = probability * 4294967296.0;
+    
+    if (scaled >= 4294967296.0) return ((uint64_t) UINT32_MAX << 32) | column;
+    if (scaled <= 0.0) return alias;
+    
+    return ((uint64_t) scaled << 32) | alias;
+}
+
+/*******************************************************************************
+Vose, "A Linear Algorithm for Generating Random Numbers with a Given Distribution"
+(1991). Each column is scaled so that the average is 1, then every column below
+1 is topped up from one above 1. Both work lists share one array, small columns
+grow up from the bottom and large columns grow down from the top.
+*******************************************************************************/
+static int BuildAlias
+(
+    uint64_t *entries,
+    const double *weights,
+    size_t n,
+    size_t columns,
+    double total
+)
+{
+    double *scaled = malloc(columns * sizeof(double));
+    uint32_t *work = malloc(columns * sizeof(uint32_t));
+    
+    if (!scaled || !work)
+    {
+        free(scaled);
+        free(work);
+        return SPK_ERROR_STDMALLOC;
+    }
+    
+    size_t small = 0;
+    size_t large = columns;
+    
+    for (size_t i = 0; i < columns; i++)
+    {
+        scaled[i] = i < n ? weights[i] * ((double) columns / total) : 0.0;
+        
+        if (scaled[i] < 1.0) work[small++] = (uint32_t) i;
+        else work[--large] = (uint32_t) i;
+    }
+    
+    //small indices occupy [0, small) and large indices occupy [large, columns)
+    size_t next_small = 0;
+    
+    while (next_small < small && large < columns)
+    {
+        const size_t s = work[next_small++];
+        const size_t l = work[large];
+        
+        entries[s] = Pack(scaled[s], s, l);
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        
+        //a large column that drops below 1 moves onto the small list
+        if (scaled[l] < 1.0)
+        {
+            large++;
+            work[small++] = (uint32_t) l;
+        }
+    }
+    
+    //whatever is left is 1 up to rounding error
+    while (next_small < small)
+    {
+        const size_t s = work[next_small++];
+        entries[s] = Pack(1.0, s, s);
+    }
+    
+    while (large < columns)
+    {
+        const size_t l = work[large++];
+        entries[l] = Pack(1.0, l, l);
+    }
+    
+    free(scaled);
+    free(work);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_DiscreteNew(spk_discrete *table, const double *weights, const size_t n)
+{
+    assert(table);
+    assert(weights);
+    
+    const char *where = "spk_DiscreteNew";
+    
+    if (n == 0 || n > SPK_DISCRETE_MAX) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "%zu outcomes", n);
+    
+    double total = 0.0;
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!(weights[i] >= 0.0) || !isfinite(weights[i]))
+        {
+            return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "weight %zu is %g", i, weights[i]);
+        }
+        
+        total += weights[i];
+    }
+    
+    if (!(total > 0.0) || !isfinite(total)) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "weights sum to %g", total);
+    
+    //at least two columns so that the shift stays below 64
+    uint64_t shift = 63;
+    size_t columns = 2;
+    
+    while (columns < n)
+    {
+        columns <<= 1;
+        shift--;
+    }
+    
+    *table = malloc(sizeof(struct spk_discrete));
+    if (!(*table)) return SPK_ERROR_STDMALLOC;
+    
+    void *entries = NULL;
+    
+    if (posix_memalign(&entries, 64, columns * sizeof(uint64_t)))
+    {
+        free(*table);
+        *table = NULL;
+        return SPK_ERROR_STDMALLOC;
+    }
+    
+    int error = BuildAlias(entries, weights, n, columns, total);
+    
+    if (error)
+    {
+        free(entries);
+        free(*table);
+        *table = NULL;
+        return error;
+    }
+    
+    (*table)->entries = entries;
+    (*table)->outcomes = n;
+    (*table)->shift = shift;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+void spk_DiscreteDelete(spk_discrete table)
+{
+    if (table) free(table->entries);
+    free(table);
+}
+
+/*******************************************************************************
+The top bits of each raw word select the column and the 32 bits right below them
+are the uniform threshold, so the column and the coin flip are independent and
+both exactly uniform. Words are drawn in blocks that fit in L1 next to the hot
+part of the table.
+*******************************************************************************/
+#define BLOCK ((size_t) 256)
+
+int spk_DiscreteSample
+(
+    spk_generator rng,
+    const spk_discrete table,
+    uint64_t *dest,
+    const size_t n
+)
+{
+    assert(rng);
+    assert(table);
+    assert(dest);
+    
+    const uint64_t *entries = table->entries;
+    const uint64_t shift = table->shift;
+    uint64_t words[BLOCK];
+    
+    for (size_t i = 0; i < n; i += BLOCK)
+    {
+        const size_t count = n - i < BLOCK ? n - i : BLOCK;
+        
+        int error = rng->next(rng->state, words, count);
+        if (error) return error;
+        
+        for (size_t j = 0; j < count; j++)
+        {
+            const uint64_t column = words[j] >> shift;
+            const uint64_t entry = entries[column];
+            const uint32_t coin = (uint32_t) (words[j] >> (shift - 32));
+            
+            dest[i + j] = coin < (uint32_t) (entry >> 32) ? column : entry & UINT32_MAX;
+        }
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+The popcount path is only worth it while the bias program is short, since each
+output costs ceil(trials / 64) words times one raw word per instruction. Past
+this many raw words per output the uniform based methods are cheaper.
+*******************************************************************************/
+#define POPCOUNT_WORDS ((uint64_t) 12)
+
+/*******************************************************************************
+Each output owns a contiguous run of biased words, and the bits past the last
+trial of the final word are masked off before the popcount. The library is built
+for baseline x86-64, where __builtin_popcountll is a libgcc call, so the count is
+compiled twice and the POPCNT copy is used whenever the CPU has the instruction.
+*******************************************************************************/
+static inline __attribute__((always_inline)) void CountRuns
+(
+    uint64_t *dest,
+    const uint64_t *bits,
+    const size_t outputs,
+    const size_t words,
+    const uint64_t tail,
+    const uint64_t trials,
+    const int flip
+)
+{
+    for (size_t j = 0; j < outputs; j++)
+    {
+        const uint64_t *run = bits + j * words;
+        uint64_t count = (uint64_t) __builtin_popcountll(run[words - 1] & tail);
+        
+        for (size_t k = 0; k < words - 1; k++)
+        {
+            count += (uint64_t) __builtin_popcountll(run[k]);
+        }
+        
+        dest[j] = flip ? trials - count : count;
+    }
+}
+
+static void CountRunsSISD(uint64_t *dest, const uint64_t *bits, const size_t outputs, const size_t words, const uint64_t tail, const uint64_t trials, const int flip)
+{
+    CountRuns(dest, bits, outputs, words, tail, trials, flip);
+}
+
+static __attribute__((target("popcnt"))) void CountRunsPOPCNT(uint64_t *dest, const uint64_t *bits, const size_t outputs, const size_t words, const uint64_t tail, const uint64_t trials, const int flip)
+{
+    CountRuns(dest, bits, outputs, words, tail, trials, flip);
+}
+
+/******************************************************************************/
+
+static int BinomialPopcount
+(
+    spk_generator rng,
+    uint64_t *dest,
+    size_t n,
+    uint64_t trials,
+    const spk_bias_program *program,
+    int flip
+)
+{
+    const size_t words = (size_t) ((trials + 63) / 64);
+    const size_t per_block = BLOCK / words;
+    const uint64_t tail = trials % 64 ? ((uint64_t) 1 << (trials % 64)) - 1 : UINT64_MAX;
+    const int popcnt = __builtin_cpu_supports("popcnt");
+    uint64_t bits[BLOCK];
+    
+    for (size_t i = 0; i < n; i += per_block)
+    {
+        const size_t outputs = n - i < per_block ? n - i : per_block;
+        
+        int error = spk_GeneratorBias(rng, bits, outputs * words, program);
+        if (error) return error;
+        
+        if (popcnt) CountRunsPOPCNT(dest + i, bits, outputs, words, tail, trials, flip);
+        else CountRunsSISD(dest + i, bits, outputs, words, tail, trials, flip);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Constants for the uniform based methods. They depend only on the trial count and
+p, so they are computed once per call rather than once per output.
+*******************************************************************************/
+struct binomial
+{
+    //shared, with p <= 1/2 and s = p / q and t = (n + 1) s
+    double n;
+    double p;
+    double q;
+    double s;
+    double t;
+    
+    //inversion
+    double qn;
+    double bound;
+    
+    //BTPE
+    double npq;
+    double m;
+    double p1;
+    double p2;
+    double p3;
+    double p4;
+    double xm;
+    double xl;
+    double xr;
+    double c;
+    double lambda_l;
+    double lambda_r;
+};
+
+/******************************************************************************/
+
+static void BinomialSetup(struct binomial *b, uint64_t trials, double p)
+{
+    b->n = (double) trials;
+    b->p = p;
+    b->q = 1.0 - p;
+    b->s = p / b->q;
+    b->t = (b->n + 1.0) * b->s;
+    
+    const double np = b->n * p;
+    
+    b->qn = exp(b->n * log1p(-p));
+    b->bound = fmin(b->n, np + 10.0 * sqrt(np * b->q + 1.0));
+    
+    const double fm = np + p;
+    
+    b->npq = np * b->q;
+    b->m = floor(fm);
+    b->p1 = floor(2.195 * sqrt(b->npq) - 4.6 * b->q) + 0.5;
+    b->xm = b->m + 0.5;
+    b->xl = b->xm - b->p1;
+    b->xr = b->xm + b->p1;
+    b->c = 0.134 + 20.5 / (15.3 + b->m);
+    
+    double a = (fm - b->xl) / (fm - b->xl * p);
+    b->lambda_l = a * (1.0 + 0.5 * a);
+    a = (b->xr - fm) / (b->xr * b->q);
+    b->lambda_r = a * (1.0 + 0.5 * a);
+    
+    b->p2 = b->p1 * (1.0 + b->c + b->c);
+    b->p3 = b->p2 + b->c / b->lambda_l;
+    b->p4 = b->p3 + b->c / b->lambda_r;
+}
+
+/*******************************************************************************
+Sequential search of the CDF from zero, with a 10 sigma bound past which the
+search restarts rather than running into the underflowed far tail. Only used for
+np < 30, so the expected number of steps is small and q^n can't underflow.
+*******************************************************************************/
+static uint64_t BinomialInversion(struct spki_source *src, const struct binomial *b)
+{
+    double x = 0.0;
+    double px = b->qn;
+    double u = spki_Uniform(spki_SourceDraw(src));
+    
+    while (u > px)
+    {
+        x += 1.0;
+        
+        if (x > b->bound)
+        {
+            if (src->error) return 0;
+            
+            x = 0.0;
+            px = b->qn;
+            u = spki_Uniform(spki_SourceDraw(src));
+        }
+        else
+        {
+            u -= px;
+            px *= b->t / x - b->s;
+        }
+    }
+    
+    return (uint64_t) x;
+}
+
+/******************************************************************************/
+
+static inline double Stirling(double x)
+{
+    const double xx = x * x;
+    
+    return (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / xx) / xx) / xx) / xx) / x / 166320.0;
+}
+
+/*******************************************************************************
+Kachitvichyanukul and Schmeiser, "Binomial Random Variate Generation" (1988).
+The density is covered by a triangle, two parallelograms and two exponential
+tails. Most draws land in the triangle and are accepted with two uniforms and
+no transcendental calls, the rest are squeezed and only rarely need the full
+Stirling series acceptance test.
+*******************************************************************************/
+static uint64_t BinomialBTPE(struct spki_source *src, const struct binomial *b)
+{
+    for (;;)
+    {
+        const double u = spki_Uniform(spki_SourceDraw(src)) * b->p4;
+        double v = spki_Uniform(spki_SourceDraw(src));
+        double y = 0.0;
+        
+        if (src->error) return 0;
+        
+        //triangle, accept immediately
+        if (u <= b->p1) return (uint64_t) floor(b->xm - b->p1 * v + u);
+        
+        if (u <= b->p2)
+        {
+            //parallelograms
+            const double x = b->xl + (u - b->p1) / b->c;
+            v = v * b->c + 1.0 - fabs(b->m - x + 0.5) / b->p1;
+            if (v > 1.0) continue;
+            y = floor(x);
+        }
+        else if (u <= b->p3)
+        {
+            //left exponential tail
+            if (v == 0.0) continue;
+            y = floor(b->xl + log(v) / b->lambda_l);
+            if (y < 0.0) continue;
+            v = v * (u - b->p2) * b->lambda_l;
+        }
+        else
+        {
+            //right exponential tail
+            if (v == 0.0) continue;
+            y = floor(b->xr - log(v) / b->lambda_r);
+            if (y > b->n) continue;
+            v = v * (u - b->p3) * b->lambda_r;
+        }
+        
+        const double k = fabs(y - b->m);
+        
+        if (k <= 20.0 || k >= b->npq / 2.0 - 1.0)
+        {
+            //explicit evaluation of f(y) / f(m) by recursion
+            double f = 1.0;
+            
+            if (b->m < y)
+            {
+                for (double i = b->m + 1.0; i <= y; i += 1.0) f *= b->t / i - b->s;
+            }
+            else if (b->m > y)
+            {
+                for (double i = y + 1.0; i <= b->m; i += 1.0) f /= b->t / i - b->s;
+            }
+            
+            if (v <= f) return (uint64_t) y;
+            continue;
+        }
+        
+        //squeeze on log f(y) / f(m) using a normal approximation
+        const double rho = (k / b->npq) * ((k * (k / 3.0 + 0.625) + 1.0 / 6.0) / b->npq + 0.5);
+        const double bound = -k * k / (2.0 * b->npq);
+        const double log_v = log(v);
+        
+        if (log_v < bound - rho) return (uint64_t) y;
+        if (log_v > bound + rho) continue;
+        
+        //final acceptance test with the Stirling series
+        const double x1 = y + 1.0;
+        const double f1 = b->m + 1.0;
+        const double z = b->n + 1.0 - b->m;
+        const double w = b->n - y + 1.0;
+        
+        const double limit = b->xm * log(f1 / x1)
+                           + (b->n - b->m + 0.5) * log(z / w)
+                           + (y - b->m) * log(w * b->p / (x1 * b->q))
+                           + Stirling(f1) + Stirling(z) - Stirling(x1) - Stirling(w);
+                           
+        if (log_v <= limit) return (uint64_t) y;
+    }
+}
+
+/*******************************************************************************
+Every method works on min(p, 1 - p) and flips the count afterwards, which keeps
+the bias programs short and BTPE in the regime it was designed for.
+*******************************************************************************/
+int spk_Binomial
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t trials,
+    const double p
+)
+{
+    assert(rng);
+    assert(dest);
+    
+    if (!(p >= 0.0 && p <= 1.0) || trials > SPK_BINOMIAL_MAX)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_Binomial", "trials %" PRIu64 " and p %g", trials, p);
+    }
+    
+    const int flip = p > 0.5;
+    const double r = flip ? 1.0 - p : p;
+    
+    if (trials == 0 || r == 0.0)
+    {
+        for (size_t i = 0; i < n; i++) dest[i] = flip ? trials : 0;
+        return SPK_ERROR_SUCCESS;
+    }
+    
+    //r is a double on (0, 1/2], so at 64 bits the program is exact for r >= 2^-11
+    spk_bias_program program;
+    int error = spk_BiasProgramInit(&program, r, 64);
+    if (error) return error;
+    
+    const uint64_t words = (trials + 63) / 64;
+    
+    if (program.kind != SPK_BIAS_ZERO && words * (uint64_t) program.limit <= POPCOUNT_WORDS)
+    {
+        return BinomialPopcount(rng, dest, n, trials, &program, flip);
+    }
+    
+    struct binomial b;
+    BinomialSetup(&b, trials, r);
+    
+    const int inversion = b.n * r < 30.0;
+    
+    struct spki_source src;
+    spki_SourceInit(&src, rng);
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        src.remaining = n - i;
+        
+        const uint64_t count = inversion ? BinomialInversion(&src, &b) : BinomialBTPE(&src, &b);
+        if (src.error) return src.error;
+        
+        dest[i] = flip ? trials - count : count;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Lemire's nearly divisionless bounded integer on [0, ceiling), ceiling >= 1. The
+rand method can't be used here because every step has a different range, and
+one call per step would pay the dispatch and the rejection setup each time.
+*******************************************************************************/
+static inline uint64_t Bounded(struct spki_source *src, const uint64_t ceiling)
+{
+    __extension__ typedef unsigned __int128 uint128;
+    
+    uint128 product = (uint128) spki_SourceDraw(src) * ceiling;
+    
+    if ((uint64_t) product < ceiling)
+    {
+        const uint64_t threshold = -ceiling % ceiling;
+        
+        while ((uint64_t) product < threshold && !src->error)
+        {
+            product = (uint128) spki_SourceDraw(src) * ceiling;
+        }
+    }
+    
+    return (uint64_t) (product >> 64);
+}
+
+/*******************************************************************************
+Word sized elements are by far the most common, give them a branch of their own
+so the compiler can swap through registers rather than a byte loop.
+*******************************************************************************/
+static inline void Swap(unsigned char *a, unsigned char *b, const size_t size)
+{
+    if (size == sizeof(uint64_t))
+    {
+        uint64_t x, y;
+        memcpy(&x, a, sizeof(uint64_t));
+        memcpy(&y, b, sizeof(uint64_t));
+        memcpy(a, &y, sizeof(uint64_t));
+        memcpy(b, &x, sizeof(uint64_t));
+    }
+    else if (size == sizeof(uint32_t))
+    {
+        uint32_t x, y;
+        memcpy(&x, a, sizeof(uint32_t));
+        memcpy(&y, b, sizeof(uint32_t));
+        memcpy(a, &y, sizeof(uint32_t));
+        memcpy(b, &x, sizeof(uint32_t));
+    }
+    else
+    {
+        unsigned char tmp[64];
+        
+        for (size_t done = 0; done < size; done += sizeof(tmp))
+        {
+            const size_t chunk = size - done < sizeof(tmp) ? size - done : sizeof(tmp);
+            
+            memcpy(tmp, a + done, chunk);
+            memcpy(a + done, b + done, chunk);
+            memcpy(b + done, tmp, chunk);
+        }
+    }
+}
+
+/*******************************************************************************
+Durstenfeld's backward Fisher-Yates. Each step owes one output, so the source
+refills in blocks of min(remaining steps, block size) and a shuffle of n items
+pulls about n - 1 words in total.
+*******************************************************************************/
+static int FisherYates(struct spki_source *src, unsigned char *base, size_t count, size_t size)
+{
+    for (size_t i = count - 1; i > 0; i--)
+    {
+        src->remaining = i;
+        
+        const size_t j = (size_t) Bounded(src, (uint64_t) i + 1);
+        if (src->error) return src->error;
+        
+        if (j != i) Swap(base + i * size, base + j * size, size);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_Shuffle(spk_generator rng, void *base, const size_t count, const size_t size)
+{
+    assert(rng);
+    
+    if (size == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_Shuffle", "zero byte elements");
+    if (count < 2) return SPK_ERROR_SUCCESS;
+    
+    assert(base);
+    
+    struct spki_source src;
+    spki_SourceInit(&src, rng);
+    
+    return FisherYates(&src, base, count, size);
+}
+
+/*******************************************************************************
+The first k steps of a forward Fisher-Yates over the whole population. The
+prefix is a uniformly ordered sample and the rest of the pool is never needed.
+*******************************************************************************/
+static int SampleDense(struct spki_source *src, size_t k, uint64_t N, uint64_t *dest)
+{
+    if (N > SIZE_MAX / sizeof(uint64_t)) return SPK_ERROR_STDMALLOC;
+    
+    uint64_t *pool = malloc((size_t) N * sizeof(uint64_t));
+    if (!pool) return SPK_ERROR_STDMALLOC;
+    
+    for (uint64_t i = 0; i < N; i++) pool[i] = i;
+    
+    for (size_t i = 0; i < k; i++)
+    {
+        src->remaining = k - i;
+        
+        const size_t j = i + (size_t) Bounded(src, N - i);
+        if (src->error) break;
+        
+        dest[i] = pool[j];
+        pool[j] = pool[i];
+    }
+    
+    free(pool);
+    
+    return src->error;
+}
+
+/*******************************************************************************
+Floyd's algorithm from Bentley's Programming Pearls. Step j draws t on [0, j]
+and keeps t if it is new, otherwise j itself, which can't have been chosen yet.
+The set is open addressed with linear probing at a load factor of at most 1/2,
+slots hold index + 1 so that zero means empty, and Fibonacci hashing spreads
+runs of consecutive indices. Floyd fixes the subset but not its order, which
+is skewed towards large indices late in dest, so a final shuffle fixes that.
+*******************************************************************************/
+static int SampleFloyd(struct spki_source *src, size_t k, uint64_t N, uint64_t *dest)
+{
+    unsigned shift = 63;
+    size_t slots = 2;
+    
+    while (slots / 2 < k)
+    {
+        if (slots > SIZE_MAX / 2 / sizeof(uint64_t)) return SPK_ERROR_STDMALLOC;
+        slots <<= 1;
+        shift--;
+    }
+    
+    uint64_t *set = calloc(slots, sizeof(uint64_t));
+    if (!set) return SPK_ERROR_STDMALLOC;
+    
+    const size_t mask = slots - 1;
+    
+    for (size_t m = 0; m < k; m++)
+    {
+        const uint64_t j = N - k + m;
+        
+        src->remaining = 2 * k - m;
+        
+        uint64_t pick = Bounded(src, j + 1);
+        if (src->error) break;
+        
+        size_t slot = (size_t) ((pick * 0x9E3779B97F4A7C15ULL) >> shift);
+        
+        while (set[slot] != 0 && set[slot] != pick + 1) slot = (slot + 1) & mask;
+        
+        //pick was already chosen, j is larger than every earlier draw so it is free
+        if (set[slot] != 0)
+        {
+            pick = j;
+            slot = (size_t) ((pick * 0x9E3779B97F4A7C15ULL) >> shift);
+            
+            while (set[slot] != 0) slot = (slot + 1) & mask;
+        }
+        
+        set[slot] = pick + 1;
+        dest[m] = pick;
+    }
+    
+    free(set);
+    
+    if (src->error) return src->error;
+    
+    return FisherYates(src, (unsigned char *) dest, k, sizeof(uint64_t));
+}
+
+/******************************************************************************/
+
+int spk_SampleWithoutReplacement
+(
+    spk_generator rng,
+    const size_t k,
+    const uint64_t N,
+    uint64_t *dest
+)
+{
+    assert(rng);
+    
+    if (k > N)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_SampleWithoutReplacement", "k %zu exceeds N %" PRIu64, k, N);
+    }
+    if (k == 0) return SPK_ERROR_SUCCESS;
+    
+    assert(dest);
+    
+    struct spki_source src;
+    spki_SourceInit(&src, rng);
+    
+    if (N / SPK_SAMPLE_DENSE < k) return SampleDense(&src, k, N, dest);
+    
+    return SampleFloyd(&src, k, N, dest);
+}
@@ -0,0 +1,203 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: compensated moment kernels for the Monte Carlo reductions, one per ISA
+* LICS: MIT License
+*/
+
+#include "probability_internal.h"
+#include "scipack_internal.h"
+
+#include <immintrin.h> //sse2, avx2, avx512
+#include <stddef.h> //size_t
+
+/*******************************************************************************
+Kahan step shared by the scalar tail of every moments kernel. The compensation
+holds the negated low part lost by the last add, so a lane is worth sum - carry.
+The library is compiled in ISO C mode, which keeps GCC from contracting the
+steps into FMAs and from reassociating them, either of which undoes the scheme.
+*******************************************************************************/
+static inline void Kahan(double *sum, double *carry, const double value)
+{
+    const double y = value - *carry;
+    const double t = *sum + y;
+    
+    *carry = (t - *sum) - y;
+    *sum = t;
+}
+
+static inline void MomentsTail(double *acc, const double *x, const double shift, size_t j, const size_t n)
+{
+    for (; j < n; j++)
+    {
+        const size_t k = j % SPKI_MOMENTS_LANES;
+        const double d = x[j] - shift;
+        
+        Kahan(acc + k, acc + SPKI_MOMENTS_LANES + k, d);
+        Kahan(acc + 2 * SPKI_MOMENTS_LANES + k, acc + 3 * SPKI_MOMENTS_LANES + k, d * d);
+    }
+}
+
+/*******************************************************************************
+The eight moment lanes are four xmm pairs here, two ymm registers in AVX2, and
+one zmm register in AVX-512, each lane doing the same scalar Kahan sequence.
+*******************************************************************************/
+static inline void KahanSSE2(__m128d *sum, __m128d *carry, const __m128d value)
+{
+    const __m128d y = _mm_sub_pd(value, *carry);
+    const __m128d t = _mm_add_pd(*sum, y);
+    
+    *carry = _mm_sub_pd(_mm_sub_pd(t, *sum), y);
+    *sum = t;
+}
+
+static void MomentsSISD(double *acc, const double *x, const double shift, const size_t n)
+{
+    const __m128d offset = _mm_set1_pd(shift);
+    __m128d sum[4], carry[4], square[4], square_carry[4];
+    
+    for (size_t k = 0; k < 4; k++)
+    {
+        sum[k] = _mm_loadu_pd(acc + 2 * k);
+        carry[k] = _mm_loadu_pd(acc + SPKI_MOMENTS_LANES + 2 * k);
+        square[k] = _mm_loadu_pd(acc + 2 * SPKI_MOMENTS_LANES + 2 * k);
+        square_carry[k] = _mm_loadu_pd(acc + 3 * SPKI_MOMENTS_LANES + 2 * k);
+    }
+    
+    size_t j = 0;
+    
+    for (; j + 8 <= n; j += 8)
+    {
+        for (size_t k = 0; k < 4; k++)
+        {
+            const __m128d d = _mm_sub_pd(_mm_loadu_pd(x + j + 2 * k), offset);
+            
+            KahanSSE2(&sum[k], &carry[k], d);
+            KahanSSE2(&square[k], &square_carry[k], _mm_mul_pd(d, d));
+        }
+    }
+    
+    for (size_t k = 0; k < 4; k++)
+    {
+        _mm_storeu_pd(acc + 2 * k, sum[k]);
+        _mm_storeu_pd(acc + SPKI_MOMENTS_LANES + 2 * k, carry[k]);
+        _mm_storeu_pd(acc + 2 * SPKI_MOMENTS_LANES + 2 * k, square[k]);
+        _mm_storeu_pd(acc + 3 * SPKI_MOMENTS_LANES + 2 * k, square_carry[k]);
+    }
+    
+    MomentsTail(acc, x, shift, j, n);
+}
+
+/******************************************************************************/
+
+static inline __attribute__((target("avx2"))) void KahanAVX2(__m256d *sum, __m256d *carry, const __m256d value)
+{
+    const __m256d y = _mm256_sub_pd(value, *carry);
+    const __m256d t = _mm256_add_pd(*sum, y);
+    
+    *carry = _mm256_sub_pd(_mm256_sub_pd(t, *sum), y);
+    *sum = t;
+}
+
+static __attribute__((target("avx2"))) void MomentsAVX2(double *acc, const double *x, const double shift, const size_t n)
+{
+    const __m256d offset = _mm256_set1_pd(shift);
+    __m256d sum[2], carry[2], square[2], square_carry[2];
+    
+    for (size_t k = 0; k < 2; k++)
+    {
+        sum[k] = _mm256_loadu_pd(acc + 4 * k);
+        carry[k] = _mm256_loadu_pd(acc + SPKI_MOMENTS_LANES + 4 * k);
+        square[k] = _mm256_loadu_pd(acc + 2 * SPKI_MOMENTS_LANES + 4 * k);
+        square_carry[k] = _mm256_loadu_pd(acc + 3 * SPKI_MOMENTS_LANES + 4 * k);
+    }
+    
+    size_t j = 0;
+    
+    for (; j + 8 <= n; j += 8)
+    {
+        for (size_t k = 0; k < 2; k++)
+        {
+            const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + j + 4 * k), offset);
+            
+            KahanAVX2(&sum[k], &carry[k], d);
+            KahanAVX2(&square[k], &square_carry[k], _mm256_mul_pd(d, d));
+        }
+    }
+    
+    for (size_t k = 0; k < 2; k++)
+    {
+        _mm256_storeu_pd(acc + 4 * k, sum[k]);
+        _mm256_storeu_pd(acc + SPKI_MOMENTS_LANES + 4 * k, carry[k]);
+        _mm256_storeu_pd(acc + 2 * SPKI_MOMENTS_LANES + 4 * k, square[k]);
+        _mm256_storeu_pd(acc + 3 * SPKI_MOMENTS_LANES + 4 * k, square_carry[k]);
+    }
+    
+    MomentsTail(acc, x, shift, j, n);
+}
+
+/******************************************************************************/
+
+static inline __attribute__((target("avx512f,avx512dq,avx512vl"))) void KahanAVX512(__m512d *sum, __m512d *carry, const __m512d value)
+{
+    const __m512d y = _mm512_sub_pd(value, *carry);
+    const __m512d t = _mm512_add_pd(*sum, y);
+    
+    *carry = _mm512_sub_pd(_mm512_sub_pd(t, *sum), y);
+    *sum = t;
+}
+
+static __attribute__((target("avx512f,avx512dq,avx512vl"))) void MomentsAVX512(double *acc, const double *x, const double shift, const size_t n)
+{
+    const __m512d offset = _mm512_set1_pd(shift);
+    
+    __m512d sum = _mm512_loadu_pd(acc);
+    __m512d carry = _mm512_loadu_pd(acc + SPKI_MOMENTS_LANES);
+    __m512d square = _mm512_loadu_pd(acc + 2 * SPKI_MOMENTS_LANES);
+    __m512d square_carry = _mm512_loadu_pd(acc + 3 * SPKI_MOMENTS_LANES);
+    
+    size_t j = 0;
+    
+    for (; j + 8 <= n; j += 8)
+    {
+        const __m512d d = _mm512_sub_pd(_mm512_loadu_pd(x + j), offset);
+        
+        KahanAVX512(&sum, &carry, d);
+        KahanAVX512(&square, &square_carry, _mm512_mul_pd(d, d));
+    }
+    
+    _mm512_storeu_pd(acc, sum);
+    _mm512_storeu_pd(acc + SPKI_MOMENTS_LANES, carry);
+    _mm512_storeu_pd(acc + 2 * SPKI_MOMENTS_LANES, square);
+    _mm512_storeu_pd(acc + 3 * SPKI_MOMENTS_LANES, square_carry);
+    
+    MomentsTail(acc, x, shift, j, n);
+}
+
+/*******************************************************************************
+One kernel per level, indexed by SPK_ISA_*, so that spk_GeneratorSetISA caps the
+reductions together with the generators that feed them
+*******************************************************************************/
+static const spki_moments_kernel kernels[3] = {MomentsSISD, MomentsAVX2, MomentsAVX512};
+
+spki_moments_kernel spki_MomentsKernel(void)
+{
+    return kernels[spki_ISA()];
+}
+
+/*******************************************************************************
+The fold runs the same scalar Kahan sums over the lanes on every level
+*******************************************************************************/
+void spki_MomentsFold(const double *acc, double sums[2])
+{
+    for (size_t m = 0; m < 2; m++)
+    {
+        const double *lanes = acc + m * 2 * SPKI_MOMENTS_LANES;
+        double sum = 0.0;
+        double carry = 0.0;
+        
+        for (size_t k = 0; k < SPKI_MOMENTS_LANES; k++) Kahan(&sum, &carry, lanes[k]);
+        for (size_t k = 0; k < SPKI_MOMENTS_LANES; k++) Kahan(&sum, &carry, -lanes[SPKI_MOMENTS_LANES + k]);
+        
+        sums[m] = sum - carry;
+    }
+}
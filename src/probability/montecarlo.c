@@ -0,0 +1,293 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: subroutines for fused Monte Carlo integration
+* LICS: MIT License
+*/
+
+#define _POSIX_C_SOURCE 200112L //posix_memalign under -std=c99
+
+#include "montecarlo.h"
+#include "probability_internal.h"
+#include "scipack_internal.h"
+
+#include <assert.h>
+#include <math.h> //sqrt
+#include <stdint.h> //uint64_t, UINT64_MAX
+#include <stdlib.h> //free, posix_memalign
+#include <string.h> //memcpy
+
+/*******************************************************************************
+The points are cut into chunks whose size depends on n alone. Each chunk draws
+its coordinates one block at a time into a small scratch buffer, converts them
+in place with the unid kernel, evaluates f over the block, and folds the values
+into eight lanes of Kahan sums with the moments kernel. The block is overwritten
+by the next one while it is still in cache, so the only memory traffic is the
+scratch buffer and one partial result per chunk.
+
+Each chunk sums f - shift and its square, with the shift set to the first value
+of f in the chunk. Any value near the mean works, and a random one is within a
+standard deviation or so, which keeps the sum of squares from cancelling when
+the mean is large next to the spread. The chunk partials are then combined with
+the exact decomposition of the sum of squared deviations into within and between
+chunk terms, again with compensated sums and always in chunk order.
+*******************************************************************************/
+#define COPY_WORDS ((size_t) 64)
+#define SCRATCH_ALIGN 64
+
+struct mc_chunk
+{
+    double count;
+    double shift;
+    double sum;
+    double square;
+};
+
+struct mc_job
+{
+    spk_generator rng;
+    spk_mc_integrand f;
+    void *ctx;
+    struct mc_chunk *chunks;
+    size_t dim;
+    size_t n;
+    size_t span;
+    size_t size;
+    int error;
+    char padding[4];
+};
+
+/*******************************************************************************
+Prototypes
+*******************************************************************************/
+static inline void Kahan(double *sum, double *carry, const double value);
+static size_t Span(const size_t n);
+static int Chunk(struct mc_job *job, spk_generator rng, size_t task);
+static void ChunkTask(void *context, size_t task);
+static void Combine(const struct mc_job *job, size_t chunks, double *estimate, double *std_error);
+static int Integrate(spk_generator rng, struct mc_job *job, int parallel, double *estimate, double *std_error);
+
+/******************************************************************************/
+
+static inline void Kahan(double *sum, double *carry, const double value)
+{
+    const double y = value - *carry;
+    const double t = *sum + y;
+    
+    *carry = (t - *sum) - y;
+    *sum = t;
+}
+
+/*******************************************************************************
+Points per chunk, a whole number of blocks so that only the last block of the
+last chunk is short, and no more than SPK_MC_CHUNKS chunks however large n is
+*******************************************************************************/
+static size_t Span(const size_t n)
+{
+    if (n / SPK_MC_CHUNK < SPK_MC_CHUNKS) return SPK_MC_CHUNK;
+    
+    const size_t span = n / SPK_MC_CHUNKS + 1;
+    
+    return (span + SPK_MC_BLOCK - 1) / SPK_MC_BLOCK * SPK_MC_BLOCK;
+}
+
+/******************************************************************************/
+
+static int Chunk(struct mc_job *job, spk_generator rng, size_t task)
+{
+    const size_t start = task * job->span;
+    const size_t points = job->n - start < job->span ? job->n - start : job->span;
+    
+    void *scratch = NULL;
+    
+    if (posix_memalign(&scratch, SCRATCH_ALIGN, SPK_MC_BLOCK * (job->dim + 1) * sizeof(double)))
+    {
+        return SPK_ERROR_STDMALLOC;
+    }
+    
+    double *x = scratch;
+    double *fx = x + SPK_MC_BLOCK * job->dim;
+    
+    const spki_moments_kernel moments = spki_MomentsKernel();
+    double acc[SPKI_MOMENTS_WORDS] = {0.0};
+    double shift = 0.0;
+    int error = SPK_ERROR_SUCCESS;
+    
+    for (size_t i = 0; i < points; i += SPK_MC_BLOCK)
+    {
+        const size_t m = points - i < SPK_MC_BLOCK ? points - i : SPK_MC_BLOCK;
+        
+        error = rng->unid(rng, x, m * job->dim);
+        if (error) break;
+        
+        job->f(x, fx, m, job->dim, job->ctx);
+        
+        if (i == 0) shift = fx[0];
+        moments(acc, fx, shift, m);
+    }
+    
+    free(scratch);
+    
+    double sums[2] = {0.0, 0.0};
+    spki_MomentsFold(acc, sums);
+    
+    job->chunks[task] = (struct mc_chunk) {(double) points, shift, sums[0], sums[1]};
+    
+    return error;
+}
+
+/*******************************************************************************
+Thread pool task, the private copy of the generator lives on the worker's stack
+exactly as in the parallel fills
+*******************************************************************************/
+static void ChunkTask(void *context, size_t task)
+{
+    struct mc_job *job = context;
+    uint64_t copy[COPY_WORDS];
+    spk_generator local = (spk_generator) copy;
+    
+    memcpy(copy, job->rng, job->size);
+    spk_GeneratorJump(local, (uint64_t) (task * job->span) * job->dim);
+    
+    const int error = Chunk(job, local, task);
+    if (error) __atomic_store_n(&job->error, error, __ATOMIC_RELAXED);
+}
+
+/******************************************************************************/
+
+static void Combine(const struct mc_job *job, size_t chunks, double *estimate, double *std_error)
+{
+    double total = 0.0;
+    double carry = 0.0;
+    
+    for (size_t c = 0; c < chunks; c++)
+    {
+        Kahan(&total, &carry, job->chunks[c].count * job->chunks[c].shift);
+        Kahan(&total, &carry, job->chunks[c].sum);
+    }
+    
+    const double mean = (total - carry) / (double) job->n;
+    
+    double squares = 0.0;
+    carry = 0.0;
+    
+    for (size_t c = 0; c < chunks; c++)
+    {
+        const struct mc_chunk *chunk = job->chunks + c;
+        
+        const double within = chunk->square - chunk->sum * chunk->sum / chunk->count;
+        const double between = chunk->shift + chunk->sum / chunk->count - mean;
+        
+        Kahan(&squares, &carry, within > 0.0 ? within : 0.0);
+        Kahan(&squares, &carry, chunk->count * between * between);
+    }
+    
+    squares -= carry;
+    
+    *estimate = mean;
+    *std_error = sqrt(squares / (double) (job->n - 1) / (double) job->n);
+}
+
+/*******************************************************************************
+Both entry points share the checks and the chunking and differ only in who runs
+the chunks. The serial path runs them in order on rng itself, which draws the
+same words the jumped copies would.
+*******************************************************************************/
+static int Integrate
+(
+    spk_generator rng,
+    struct mc_job *job,
+    int parallel,
+    double *estimate,
+    double *std_error
+)
+{
+    const char *where = parallel ? "spk_MCIntegrateParallel" : "spk_MCIntegrate";
+    const size_t dim_limit = (SIZE_MAX / sizeof(double)) / SPK_MC_BLOCK - 1;
+    
+    if (job->dim == 0 || job->dim > dim_limit || job->n < 2 || (uint64_t) job->n > UINT64_MAX / job->dim)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "dim %zu and n %zu", job->dim, job->n);
+    }
+    
+    if (parallel)
+    {
+        job->size = spk_GeneratorSize(rng->identifier);
+        
+        if (job->size == 0 || job->size > COPY_WORDS * sizeof(uint64_t))
+        {
+            return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "generator %d cannot be copied", rng->identifier);
+        }
+    }
+    
+    job->span = Span(job->n);
+    
+    const size_t chunks = (job->n + job->span - 1) / job->span;
+    
+    job->chunks = malloc(chunks * sizeof(struct mc_chunk));
+    if (!job->chunks) return SPK_ERROR_STDMALLOC;
+    
+    if (parallel)
+    {
+        const int error = spki_ParallelRun(ChunkTask, job, chunks, where);
+        if (error) job->error = error;
+        
+        //leave rng where the serial call would have left it
+        if (!job->error) spk_GeneratorJump(rng, (uint64_t) job->n * job->dim);
+    }
+    else
+    {
+        for (size_t c = 0; c < chunks && !job->error; c++) job->error = Chunk(job, rng, c);
+    }
+    
+    if (!job->error) Combine(job, chunks, estimate, std_error);
+    
+    free(job->chunks);
+    
+    return job->error;
+}
+
+/******************************************************************************/
+
+int spk_MCIntegrate
+(
+    spk_generator rng,
+    spk_mc_integrand f,
+    void *ctx,
+    const size_t dim,
+    const size_t n,
+    double *estimate,
+    double *std_error
+)
+{
+    assert(rng);
+    assert(f);
+    assert(estimate);
+    assert(std_error);
+    
+    struct mc_job job = {rng, f, ctx, NULL, dim, n, 0, 0, SPK_ERROR_SUCCESS, {0}};
+    
+    return Integrate(rng, &job, 0, estimate, std_error);
+}
+
+/******************************************************************************/
+
+int spk_MCIntegrateParallel
+(
+    spk_generator rng,
+    spk_mc_integrand f,
+    void *ctx,
+    const size_t dim,
+    const size_t n,
+    double *estimate,
+    double *std_error
+)
+{
+    assert(rng);
+    assert(f);
+    assert(estimate);
+    assert(std_error);
+    
+    struct mc_job job = {rng, f, ctx, NULL, dim, n, 0, 0, SPK_ERROR_SUCCESS, {0}};
+    
+    return Integrate(rng, &job, 1, estimate, std_error);
+}
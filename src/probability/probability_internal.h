@@ -0,0 +1,135 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Private subroutines shared between the probability submodules
+* NOTE: Not part of the public API, do not install with ./include
+* LICS: MIT License
+*/
+
+#ifndef SPK_PROBABILITY_INTERNAL_H
+#define SPK_PROBABILITY_INTERNAL_H
+
+#include "generator_sisd.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+#include <string.h> //memcpy, memset
+
+/*******************************************************************************
+* NAME: struct spki_source
+* DESC: block of raw words pulled from next for samplers that use a variable
+* number of words per output
+* @ rng : the generator being drawn from
+* @ remaining : outputs still owed by the caller, including the current one
+* @ position : index of the next unread word
+* @ count : valid words in the block
+* @ error : first failure of next, sticky, zero while the words are good
+* NOTE: every refill is sized to the outstanding outputs, so as long as each
+* output consumes at least one word there is nothing left over when a call
+* returns and a split fill draws exactly what one large fill would
+* NOTE: next fails for the hardware generator and for an exhausted or raw-less
+* pool. Every rejection loop checks error so that it unwinds instead of spinning
+* on the stand-in words, and every sampler returns it.
+*******************************************************************************/
+#define SPKI_SOURCE_BLOCK ((size_t) 256)
+
+struct spki_source
+{
+    spk_generator rng;
+    size_t remaining;
+    size_t position;
+    size_t count;
+    int error;
+    char padding[4];
+    uint64_t words[SPKI_SOURCE_BLOCK];
+};
+
+/*******************************************************************************
+* NAME: spki_SourceInit
+* DESC: an empty source on rng, the first draw refills it
+* NOTE: the word block is left uninitialized, zeroing it would cost as much as
+* filling it and every word is written by a refill before it is read
+*******************************************************************************/
+static inline void spki_SourceInit(struct spki_source *src, spk_generator rng)
+{
+    src->rng = rng;
+    src->remaining = 0;
+    src->position = 0;
+    src->count = 0;
+    src->error = SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+* NAME: spki_SourceRefill
+* DESC: replace the block with min(remaining, block size) fresh words, min 1
+* OUTP: scipack error code, also recorded in src->error
+* NOTE: a failed block is zeroed so that nothing reads uninitialized words
+*******************************************************************************/
+static inline int spki_SourceRefill(struct spki_source *src)
+{
+    src->count = src->remaining < SPKI_SOURCE_BLOCK ? src->remaining : SPKI_SOURCE_BLOCK;
+    if (src->count == 0) src->count = 1;
+    
+    src->position = 0;
+    
+    const int error = src->rng->next(src->rng->state, src->words, src->count);
+    
+    if (error)
+    {
+        memset(src->words, 0, src->count * sizeof(uint64_t));
+        if (!src->error) src->error = error;
+    }
+    
+    return error;
+}
+
+/*******************************************************************************
+* NAME: spki_SourceDraw
+* DESC: pop one raw word, refilling first if the block is spent
+*******************************************************************************/
+static inline uint64_t spki_SourceDraw(struct spki_source *src)
+{
+    if (src->position == src->count) spki_SourceRefill(src);
+    
+    return src->words[src->position++];
+}
+
+/*******************************************************************************
+* NAME: spki_Uniform
+* DESC: same exponent injection as the unid method
+* OUTP: a double on [0, 1), so log1p(-u) is always finite
+*******************************************************************************/
+static inline double spki_Uniform(const uint64_t word)
+{
+    const uint64_t bits = (word >> 12) | 0x3FF0000000000000ULL;
+    double u = 0.0;
+    
+    memcpy(&u, &bits, sizeof(double));
+    
+    return u - 1.0;
+}
+
+/*******************************************************************************
+* NAME: spki_moments_kernel, spki_MomentsKernel
+* DESC: add x - shift and its square to the running Kahan sums in acc
+* OUTP: the kernel for spki_ISA
+*******************************************************************************/
+typedef void (*spki_moments_kernel)(double *acc, const double *x, const double shift, const size_t n);
+
+spki_moments_kernel spki_MomentsKernel(void);
+
+/*******************************************************************************
+* NAME: spki_MomentsFold
+* DESC: moments kernel accumulator layout, and the fold of its lanes into sums
+* @ acc : SPKI_MOMENTS_LANES sums, then their compensations, then the same pair
+* for the squares, zeroed before the first kernel call
+* @ sums : on return sums[0] is the sum of x - shift and sums[1] of its square
+* NOTE: element j of a kernel call always lands in lane j % SPKI_MOMENTS_LANES
+* whatever the ISA, so every level of the kernel rounds identically. Only the
+* last call on a given acc may have n that is not a multiple of the lane count.
+*******************************************************************************/
+#define SPKI_MOMENTS_LANES ((size_t) 8)
+#define SPKI_MOMENTS_WORDS (4 * SPKI_MOMENTS_LANES)
+
+void spki_MomentsFold(const double *acc, double sums[2]);
+
+#endif
@@ -0,0 +1,87 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: subroutines for buffered scalar random number generation
+* LICS: MIT License
+*/
+
+#define _POSIX_C_SOURCE 200112L //posix_memalign under -std=c99
+
+#include "generator_buffer.h"
+#include "scipack_internal.h"
+
+#include <assert.h>
+#include <stdlib.h> //malloc, free, posix_memalign, size_t
+#include <string.h> //memset
+
+/*******************************************************************************
+Allocate the ring separately from the struct so that the words start on a cache
+line boundary and each refill streams whole lines. The ring starts out empty so
+that the wrapped generator is not advanced until the first pop.
+*******************************************************************************/
+int spk_BufferNew(spk_generator_buffer *buf, spk_generator rng, size_t capacity)
+{
+    assert(buf);
+    assert(rng);
+    
+    if (capacity < SPK_BUFFER_MIN || capacity > SPK_BUFFER_MAX)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_BufferNew", "capacity %zu outside [%d, %d]", capacity, SPK_BUFFER_MIN, SPK_BUFFER_MAX);
+    }
+    
+    if (capacity % (SPK_BUFFER_ALIGN / sizeof(uint64_t)) != 0)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_BufferNew", "capacity %zu is not a whole number of cache lines", capacity);
+    }
+    
+    *buf = malloc(sizeof(struct spk_generator_buffer));
+    if (!(*buf)) return SPK_ERROR_STDMALLOC;
+    
+    void *data = NULL;
+    
+    if (posix_memalign(&data, SPK_BUFFER_ALIGN, capacity * sizeof(uint64_t)))
+    {
+        free(*buf);
+        *buf = NULL;
+        return SPK_ERROR_STDMALLOC;
+    }
+    
+    (*buf)->data = data;
+    (*buf)->position = capacity;
+    (*buf)->capacity = capacity;
+    (*buf)->rng = rng;
+    (*buf)->error = SPK_ERROR_SUCCESS;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Free a buffer, the wrapped generator belongs to the caller
+*******************************************************************************/
+void spk_BufferDelete(spk_generator_buffer buf)
+{
+    if (buf) free(buf->data);
+    free(buf);
+}
+
+/*******************************************************************************
+The next methods can fail, RDRAND when the hardware runs dry and pools when they
+are exhausted or hold no raw words. The pop functions return scalars with no room
+for an error code, so a failed refill zeroes the ring and records the first error
+in the buffer instead, where the caller checks it once after a batch of draws.
+*******************************************************************************/
+int spk_BufferRefill(spk_generator_buffer buf)
+{
+    assert(buf);
+    
+    const int error = buf->rng->next(buf->rng->state, buf->data, buf->capacity);
+    
+    if (error)
+    {
+        memset(buf->data, 0, buf->capacity * sizeof(uint64_t));
+        if (!buf->error) buf->error = error;
+    }
+    
+    buf->position = 0;
+    
+    return error;
+}
@@ -0,0 +1,381 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: runtime CPU feature detection and per-ISA conversion kernels
+* LICS: MIT License
+*/
+
+#include "generator_sisd.h"
+#include "generator_internal.h"
+
+#include <cpuid.h> //__get_cpuid, __get_cpuid_count
+#include <immintrin.h> //sse2, avx2, avx512
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+#include <string.h> //memcpy
+
+/*******************************************************************************
+The library is built for baseline x86-64 and every routine that needs more than
+SSE2 carries a target attribute, so one libscipack.a runs on any 64-bit x86 CPU.
+CPUID is read once, on the first call that needs it, and the result is cached in
+a single word. The READY bit tells an unset cache apart from a CPU that has none
+of the features. Threads that race through the first call all compute the same
+word, so relaxed atomics are enough.
+
+AVX state must also be enabled by the OS, which is what the XCR0 check is for.
+Bits 1 and 2 are the SSE and AVX registers, bits 5 to 7 are the opmask and the
+upper halves of the zmm registers.
+*******************************************************************************/
+#define FEATURE_READY 0x80000000U
+
+#define XCR0_AVX ((uint64_t) 0x06)
+#define XCR0_AVX512 ((uint64_t) 0xE6)
+
+static unsigned int feature_cache = 0;
+static int isa_cap = SPK_ISA_AVX512;
+
+/******************************************************************************/
+
+static uint64_t ReadXCR0(void)
+{
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    
+    __asm__ __volatile__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+    
+    return lo | ((uint64_t) hi << 32);
+}
+
+/******************************************************************************/
+
+static unsigned int DetectFeatures(void)
+{
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    
+    unsigned int features = FEATURE_READY;
+    uint64_t xcr0 = 0;
+    
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return features;
+    
+    if ((ecx >> 30) & 0x1) features |= SPKI_CPU_RDRAND;
+    if ((ecx >> 23) & 0x1) features |= SPKI_CPU_POPCNT;
+    
+    //osxsave and avx, without both xgetbv itself is not available
+    const int avx = ((ecx >> 27) & 0x1) && ((ecx >> 28) & 0x1);
+    if (avx) xcr0 = ReadXCR0();
+    
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return features;
+    
+    if ((ebx >> 18) & 0x1) features |= SPKI_CPU_RDSEED;
+    
+    if (avx && (xcr0 & XCR0_AVX) == XCR0_AVX && ((ebx >> 5) & 0x1))
+    {
+        features |= SPKI_CPU_AVX2;
+    }
+    
+    //foundation, doubleword and quadword, vector length
+    const unsigned int avx512 = (1U << 16) | (1U << 17) | (1U << 31);
+    
+    if ((features & SPKI_CPU_AVX2) && (xcr0 & XCR0_AVX512) == XCR0_AVX512 && (ebx & avx512) == avx512)
+    {
+        features |= SPKI_CPU_AVX512;
+    }
+    
+    return features;
+}
+
+/******************************************************************************/
+
+unsigned int spki_CPUFeatures(void)
+{
+    unsigned int features = __atomic_load_n(&feature_cache, __ATOMIC_RELAXED);
+    
+    if (!features)
+    {
+        features = DetectFeatures();
+        __atomic_store_n(&feature_cache, features, __ATOMIC_RELAXED);
+    }
+    
+    return features;
+}
+
+/******************************************************************************/
+
+static int NativeISA(void)
+{
+    const unsigned int features = spki_CPUFeatures();
+    
+    if (features & SPKI_CPU_AVX512) return SPK_ISA_AVX512;
+    if (features & SPKI_CPU_AVX2) return SPK_ISA_AVX2;
+    
+    return SPK_ISA_SISD;
+}
+
+/******************************************************************************/
+
+int spki_ISA(void)
+{
+    const int native = NativeISA();
+    const int cap = __atomic_load_n(&isa_cap, __ATOMIC_RELAXED);
+    
+    return native < cap ? native : cap;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorISA(void)
+{
+    return spki_ISA();
+}
+
+/******************************************************************************/
+
+int spk_GeneratorSetISA(int isa)
+{
+    if (isa == SPK_ISA_NATIVE) isa = SPK_ISA_AVX512;
+    else if (isa < SPK_ISA_SISD || isa > NativeISA())
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorSetISA", "level %d is not available here", isa);
+    }
+    
+    __atomic_store_n(&isa_cap, isa, __ATOMIC_RELAXED);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Scalar tails of the unid and unif kernels, see spki_Unid in generator_internal.h
+for the exponent injection. They carry no target of their own, so every kernel
+below may inline them.
+*******************************************************************************/
+static inline void UnidTail(double *dest, size_t j, const size_t n)
+{
+    for (; j < n; j++)
+    {
+        uint64_t raw = 0;
+        double variate = 0.0;
+        
+        memcpy(&raw, dest + j, sizeof(raw));
+        raw = (raw >> 12) | 0x3FF0000000000000ULL;
+        memcpy(&variate, &raw, sizeof(variate));
+        
+        dest[j] = variate - 1.0;
+    }
+}
+
+static inline void UnifTail(float *dest, const uint64_t *raw, size_t j, const size_t count)
+{
+    for (; j < count; j++)
+    {
+        uint32_t half = (uint32_t) (raw[j / 2] >> (32 * (j & 1)));
+        float variate = 0.0f;
+        
+        half = (half >> 9) | 0x3F800000U;
+        memcpy(&variate, &half, sizeof(variate));
+        
+        dest[j] = variate - 1.0f;
+    }
+}
+
+/*******************************************************************************
+Baseline kernels, SSE2 is part of x86-64 so these need no target.
+*******************************************************************************/
+static void UnidSISD(double *dest, const size_t n)
+{
+    const __m128i exponent = _mm_set1_epi64x(0x3FF0000000000000LL);
+    const __m128d one = _mm_set1_pd(1.0);
+    
+    size_t j = 0;
+    
+    for (; j + 2 <= n; j += 2)
+    {
+        __m128i raw = _mm_loadu_si128((const __m128i *) (dest + j));
+        raw = _mm_or_si128(_mm_srli_epi64(raw, 12), exponent);
+        _mm_storeu_pd(dest + j, _mm_sub_pd(_mm_castsi128_pd(raw), one));
+    }
+    
+    UnidTail(dest, j, n);
+}
+
+static void UnifSISD(float *dest, const uint64_t *raw, const size_t count)
+{
+    const __m128i exponent = _mm_set1_epi32(0x3F800000);
+    const __m128 one = _mm_set1_ps(1.0f);
+    
+    size_t j = 0;
+    
+    for (; j + 4 <= count; j += 4)
+    {
+        __m128i halves = _mm_loadu_si128((const __m128i *) (raw + j / 2));
+        halves = _mm_or_si128(_mm_srli_epi32(halves, 9), exponent);
+        _mm_storeu_ps(dest + j, _mm_sub_ps(_mm_castsi128_ps(halves), one));
+    }
+    
+    UnifTail(dest, raw, j, count);
+}
+
+static void BiasSISD(uint64_t *dest, const uint64_t *data, const uint64_t *op, const size_t limit, const size_t outputs)
+{
+    const size_t groups = (outputs + 3) / 4;
+    
+    for (size_t g = 0; g < groups; g++)
+    {
+        const uint64_t *operand = data + g * 4 * limit;
+        uint64_t RAX[4];
+        
+        for (size_t k = 0; k < 4; k++) RAX[k] = operand[k];
+        
+        for (size_t PC = 1; PC < limit; PC++)
+        {
+            const uint64_t *column = operand + PC * 4;
+            
+            for (size_t k = 0; k < 4; k++)
+            {
+                RAX[k] = (RAX[k] & column[k]) | (op[PC] & (RAX[k] | column[k]));
+            }
+        }
+        
+        const size_t count = outputs - g * 4 < 4 ? outputs - g * 4 : 4;
+        memcpy(dest + g * 4, RAX, count * sizeof(uint64_t));
+    }
+}
+
+/******************************************************************************/
+
+static __attribute__((target("avx2"))) void UnidAVX2(double *dest, const size_t n)
+{
+    const __m256i exponent = _mm256_set1_epi64x(0x3FF0000000000000LL);
+    const __m256d one = _mm256_set1_pd(1.0);
+    
+    size_t j = 0;
+    
+    for (; j + 4 <= n; j += 4)
+    {
+        __m256i raw = _mm256_loadu_si256((const __m256i *) (dest + j));
+        raw = _mm256_or_si256(_mm256_srli_epi64(raw, 12), exponent);
+        _mm256_storeu_pd(dest + j, _mm256_sub_pd(_mm256_castsi256_pd(raw), one));
+    }
+    
+    UnidTail(dest, j, n);
+}
+
+static __attribute__((target("avx2"))) void UnifAVX2(float *dest, const uint64_t *raw, const size_t count)
+{
+    const __m256i exponent = _mm256_set1_epi32(0x3F800000);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    
+    size_t j = 0;
+    
+    for (; j + 8 <= count; j += 8)
+    {
+        __m256i halves = _mm256_loadu_si256((const __m256i *) (raw + j / 2));
+        halves = _mm256_or_si256(_mm256_srli_epi32(halves, 9), exponent);
+        _mm256_storeu_ps(dest + j, _mm256_sub_ps(_mm256_castsi256_ps(halves), one));
+    }
+    
+    UnifTail(dest, raw, j, count);
+}
+
+static __attribute__((target("avx2"))) void BiasAVX2(uint64_t *dest, const uint64_t *data, const uint64_t *op, const size_t limit, const size_t outputs)
+{
+    const size_t groups = (outputs + 3) / 4;
+    
+    for (size_t g = 0; g < groups; g++)
+    {
+        const uint64_t *operand = data + g * 4 * limit;
+        __m256i RAX = _mm256_loadu_si256((const __m256i *) operand);
+        
+        for (size_t PC = 1; PC < limit; PC++)
+        {
+            const __m256i column = _mm256_loadu_si256((const __m256i *) (operand + PC * 4));
+            const __m256i mask = _mm256_set1_epi64x((long long) op[PC]);
+            
+            RAX = _mm256_or_si256(_mm256_and_si256(RAX, column), _mm256_and_si256(mask, _mm256_or_si256(RAX, column)));
+        }
+        
+        uint64_t out[4];
+        const size_t count = outputs - g * 4 < 4 ? outputs - g * 4 : 4;
+        
+        _mm256_storeu_si256((__m256i *) out, RAX);
+        memcpy(dest + g * 4, out, count * sizeof(uint64_t));
+    }
+}
+
+/*******************************************************************************
+The bias step (RAX & data) | (op & (RAX | data)) is the bitwise majority of its
+three inputs, so AVX-512 evaluates it as a single vpternlogq with truth table
+0xE8, and the partial last group is a masked store.
+*******************************************************************************/
+
+static __attribute__((target("avx512f,avx512dq,avx512vl"))) void UnidAVX512(double *dest, const size_t n)
+{
+    const __m512i exponent = _mm512_set1_epi64(0x3FF0000000000000LL);
+    const __m512d one = _mm512_set1_pd(1.0);
+    
+    size_t j = 0;
+    
+    for (; j + 8 <= n; j += 8)
+    {
+        __m512i raw = _mm512_loadu_si512((const void *) (dest + j));
+        raw = _mm512_or_si512(_mm512_srli_epi64(raw, 12), exponent);
+        _mm512_storeu_pd(dest + j, _mm512_sub_pd(_mm512_castsi512_pd(raw), one));
+    }
+    
+    UnidTail(dest, j, n);
+}
+
+static __attribute__((target("avx512f,avx512dq,avx512vl"))) void UnifAVX512(float *dest, const uint64_t *raw, const size_t count)
+{
+    const __m512i exponent = _mm512_set1_epi32(0x3F800000);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    
+    size_t j = 0;
+    
+    for (; j + 16 <= count; j += 16)
+    {
+        __m512i halves = _mm512_loadu_si512((const void *) (raw + j / 2));
+        halves = _mm512_or_si512(_mm512_srli_epi32(halves, 9), exponent);
+        _mm512_storeu_ps(dest + j, _mm512_sub_ps(_mm512_castsi512_ps(halves), one));
+    }
+    
+    UnifTail(dest, raw, j, count);
+}
+
+static __attribute__((target("avx512f,avx512dq,avx512vl"))) void BiasAVX512(uint64_t *dest, const uint64_t *data, const uint64_t *op, const size_t limit, const size_t outputs)
+{
+    const size_t groups = (outputs + 3) / 4;
+    
+    for (size_t g = 0; g < groups; g++)
+    {
+        const uint64_t *operand = data + g * 4 * limit;
+        __m256i RAX = _mm256_loadu_si256((const __m256i *) operand);
+        
+        for (size_t PC = 1; PC < limit; PC++)
+        {
+            const __m256i column = _mm256_loadu_si256((const __m256i *) (operand + PC * 4));
+            const __m256i mask = _mm256_set1_epi64x((long long) op[PC]);
+            
+            RAX = _mm256_ternarylogic_epi64(RAX, column, mask, 0xE8);
+        }
+        
+        const size_t count = outputs - g * 4 < 4 ? outputs - g * 4 : 4;
+        _mm256_mask_storeu_epi64(dest + g * 4, (__mmask8) ((1U << count) - 1), RAX);
+    }
+}
+
+/*******************************************************************************
+One table per level, indexed by SPK_ISA_*.
+*******************************************************************************/
+static const struct spki_kernels kernels[3] =
+{
+    {UnidSISD, UnifSISD, BiasSISD},
+    {UnidAVX2, UnifAVX2, BiasAVX2},
+    {UnidAVX512, UnifAVX512, BiasAVX512},
+};
+
+const struct spki_kernels *spki_Kernels(void)
+{
+    return &kernels[spki_ISA()];
+}
@@ -0,0 +1,499 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Private subroutines shared between the random number submodules
+* NOTE: Not part of the public API, do not install with ./include
+* LICS: MIT License
+*/
+
+#ifndef SPK_GENERATOR_INTERNAL_H
+#define SPK_GENERATOR_INTERNAL_H
+
+#include "generator_sisd.h"
+#include "scipack_internal.h"
+
+#include <inttypes.h> //PRIu64
+#include <math.h> //ldexp
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+#include <string.h> //memcpy
+
+/*******************************************************************************
+* NAME: spki_next, spki_uint128
+* DESC: signature of the struct spk_generator next method, and a 128-bit word
+*******************************************************************************/
+typedef int (*spki_next)(uint64_t *, uint64_t *, const size_t);
+
+__extension__ typedef unsigned __int128 spki_uint128;
+
+/*******************************************************************************
+* NAME: spki_Hash
+* DESC: splitmix64 mixing function, overwrites value with the hashed output
+* OUTP: the hashed value
+*******************************************************************************/
+uint64_t spki_Hash(uint64_t *value);
+
+/*******************************************************************************
+* NAME: spki_EntropyRetry
+* DESC: fetch one random word for seeding, retry up to limit times on underflow
+* OUTP: scipack error code, SPK_ERROR_RDRAND if no entropy could be had
+* NOTE: RDRAND where the CPU has it, getrandom(2) otherwise
+*******************************************************************************/
+int spki_EntropyRetry(uint64_t *x, size_t limit);
+
+/*******************************************************************************
+* NAME: struct spki_kernels, spki_Kernels
+* DESC: conversion kernels behind spki_Unid, spki_Unif and spki_Bias
+* @ unid : convert n raw words in place into doubles on [0, 1)
+* @ unif : convert the 32-bit halves of raw into count floats on [0, 1)
+* @ bias : run a bias program over the groups of data, see spki_Bias
+* OUTP: the kernel table for spki_ISA
+*******************************************************************************/
+struct spki_kernels
+{
+    void (*unid)(double *dest, const size_t n);
+    void (*unif)(float *dest, const uint64_t *raw, const size_t count);
+    void (*bias)(uint64_t *dest, const uint64_t *data, const uint64_t *op, const size_t limit, const size_t outputs);
+};
+
+const struct spki_kernels *spki_Kernels(void);
+
+/*******************************************************************************
+* NAME: spki_AdvancePCG64i
+* DESC: jump the underlying PCG linear congruential state ahead by delta steps
+*******************************************************************************/
+void spki_AdvancePCG64i(uint64_t *state, const uint64_t increment, uint64_t delta);
+
+/*******************************************************************************
+* NAME: spki_AdvanceXoshiro256
+* DESC: jump a xoshiro256++ state ahead by delta steps
+*******************************************************************************/
+void spki_AdvanceXoshiro256(uint64_t *state, uint64_t delta);
+
+/*******************************************************************************
+* NAME: struct pcg64ix4, struct pcg64ix8
+* DESC: generator_simd lane states, all lane states then all lane increments
+*******************************************************************************/
+struct pcg64ix4
+{
+    uint64_t state[4];
+    uint64_t increment[4];
+};
+
+struct pcg64ix8
+{
+    uint64_t state[8];
+    uint64_t increment[8];
+};
+
+/*******************************************************************************
+* NAME: struct xoshiro256x4
+* DESC: generator_simd lane states, s[j][k] is state word j of lane k
+*******************************************************************************/
+struct xoshiro256x4
+{
+    uint64_t s[4][4];
+};
+
+/*******************************************************************************
+* NAME: struct philox4x32
+* DESC: generator_simd counter-based state, see SPK_GENERATOR_PHILOX4x32
+* @ key : Philox key words 0 and 1 in the low and high halves
+* @ stream : counter words 2 and 3 in the low and high halves
+* @ block : counter words 0 and 1 of the next block, one block is two words
+* @ offset : 1 if the first word of block has already been consumed, else 0
+*******************************************************************************/
+struct philox4x32
+{
+    uint64_t key;
+    uint64_t stream;
+    uint64_t block;
+    uint64_t offset;
+};
+
+/*******************************************************************************
+* NAME: struct spki_pool
+* DESC: generator_pool state, a read-only mapping of a pool file
+* @ map : start of the mapping, which is the start of the header
+* @ length : bytes mapped, the whole file
+* @ data : first element, words or doubles depending on kind
+* @ cursor : elements consumed, data[cursor] is the next one
+* @ source : identifier of the generator that wrote the pool
+* NOTE: generator_sisd jumps, reads and unmaps pools through these fields, so
+* that the lifecycle functions need no link dependency on generator_pool
+*******************************************************************************/
+struct spki_pool
+{
+    void *map;
+    size_t length;
+    const uint64_t *data;
+    uint64_t count;
+    uint64_t cursor;
+    uint64_t position;
+    uint64_t seed;
+    int source;
+    int kind;
+};
+
+/*******************************************************************************
+* NAME: spki_InitPCG64ix4, spki_InitPCG64ix8, spki_InitPhilox4x32, ...
+* DESC: in place constructors for generator_simd, see spk_GeneratorInit
+* OUTP: scipack error code
+*******************************************************************************/
+int spki_InitPCG64ix4(spk_generator rng, uint64_t seed);
+int spki_InitPCG64ix8(spk_generator rng, uint64_t seed);
+int spki_InitPhilox4x32(spk_generator rng, uint64_t seed);
+int spki_InitXoshiro256x4(spk_generator rng, uint64_t seed);
+
+/*******************************************************************************
+* NAME: spki_JumpPCG64ix4, spki_JumpPCG64ix8, spki_JumpPhilox4x32, ...
+* DESC: generator_simd jump ahead by delta output words, see spk_GeneratorJump
+*******************************************************************************/
+void spki_JumpPCG64ix4(uint64_t *state, uint64_t delta);
+void spki_JumpPCG64ix8(uint64_t *state, uint64_t delta);
+void spki_JumpPhilox4x32(uint64_t *state, uint64_t delta);
+void spki_JumpXoshiro256x4(uint64_t *state, uint64_t delta);
+
+/*******************************************************************************
+* NAME: spki_AtPhilox4x32
+* DESC: words index to index + n - 1 of the stream, see spk_GeneratorAt
+*******************************************************************************/
+void spki_AtPhilox4x32(const uint64_t *state, uint64_t index, uint64_t *dest, const size_t n);
+
+/*******************************************************************************
+* NAME: spki_Rand, spki_RandUnchecked
+* DESC: bounded random integers in [min, max] shared by every generator
+* OUTP: scipack error code
+* NOTE: next is a compile time constant at every call site and gets inlined
+* NOTE: spki_Rand checks min <= max, the unchecked body assumes it
+
+Daniel Lemire's nearly divisionless method, "Fast Random Integer Generation in
+an Interval" (2019), maps a raw word x onto [0, range) as the high half of the
+128-bit product x * range. The low half is only compared against the rejection
+threshold, and the threshold needs a division only when the low half is already
+below range, which is rare.
+
+The low half is also a fresh uniform fraction, so it can be multiplied again to
+extract another value. Following Brackett-Rozinsky and Lemire, "Batched Ranged
+Random Integer Generation" (2024), a single raw word yields k values whenever
+range^k fits in 64 bits, and the rejection test is applied only once against the
+product of the ranges. For dice rolls that is 24 values per raw word.
+
+Raw words are drawn in blocks into a stack buffer. Each refill is sized to what
+is still outstanding, and the batch never exceeds n, so that a call with n = 1
+costs one raw word and one multiply. On the SIMD generators a refill that is not
+a multiple of the lane count discards the rest of the last lane group, up to 7
+words for n = 1. Rounding the refill up would not help, because the spare words
+cannot be carried into the next call without more generator state.
+*******************************************************************************/
+#define SPKI_RAND_BLOCK ((size_t) 256)
+
+static inline int spki_RandUnchecked
+(
+    spki_next next,
+    uint64_t *rng_state,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    const uint64_t ceil = max - min;
+    
+    //full range is just the raw output, and a single value needs no draws
+    if (ceil == UINT64_MAX) return next(rng_state, dest, n);
+    
+    if (ceil == 0)
+    {
+        for (size_t i = 0; i < n; i++) dest[i] = min;
+        return SPK_ERROR_SUCCESS;
+    }
+    
+    //values per raw word, bound is the product of their ranges
+    const uint64_t range = ceil + 1;
+    uint64_t bound = range;
+    size_t batch = 1;
+    
+    while (batch < n && bound <= UINT64_MAX / range)
+    {
+        bound *= range;
+        batch++;
+    }
+    
+    uint64_t threshold = 0;
+    int have_threshold = 0;
+    
+    uint64_t raw[SPKI_RAND_BLOCK];
+    size_t used = 0;
+    size_t available = 0;
+    
+    for (size_t i = 0; i < n; i += batch)
+    {
+        uint64_t values[64];
+        uint64_t leftover = 0;
+        
+        do
+        {
+            if (used == available)
+            {
+                const size_t outstanding = (n - i + batch - 1) / batch;
+                
+                available = outstanding < SPKI_RAND_BLOCK ? outstanding : SPKI_RAND_BLOCK;
+                
+                const int error = next(rng_state, raw, available);
+                if (error) return error;
+                
+                used = 0;
+            }
+            
+            leftover = raw[used++];
+            
+            for (size_t j = 0; j < batch; j++)
+            {
+                const spki_uint128 product = (spki_uint128) leftover * range;
+                values[j] = (uint64_t) (product >> 64);
+                leftover = (uint64_t) product;
+            }
+            
+            if (leftover < bound && !have_threshold)
+            {
+                threshold = (0 - bound) % bound;
+                have_threshold = 1;
+            }
+        }
+        while (leftover < threshold);
+        
+        const size_t count = n - i < batch ? n - i : batch;
+        
+        for (size_t j = 0; j < count; j++)
+        {
+            dest[i + j] = values[j] + min;
+        }
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+The rand method itself. Bounds in the wrong order would silently wrap into a
+range of almost 2^64 values, which is the one argument error rand can make.
+*******************************************************************************/
+static inline int spki_Rand
+(
+    spki_next next,
+    uint64_t *rng_state,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    if (SPKI_CHECK(min > max))
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_generator->rand", "min %" PRIu64 " exceeds max %" PRIu64, min, max);
+    }
+    
+    return spki_RandUnchecked(next, rng_state, dest, n, min, max);
+}
+
+/*******************************************************************************
+* NAME: spki_Bias
+* DESC: run a bias program shared by every generator, see spk_GeneratorBias
+* OUTP: scipack error code
+* NOTE: next is a compile time constant at every call site and gets inlined
+
+The per-bit switch of the original interpreter is replaced by a mask. An OR
+instruction has op = ~0 and an AND instruction has op = 0, then
+
+    RAX = (RAX & data) | (op & (RAX | data))
+
+evaluates either one without a branch. The mask costs a longer dependency chain
+than the branch did, so four outputs are run side by side to hide it. Within a
+group of four, instruction PC of output k reads data[PC * 4 + k]. The words are
+iid so the layout does not matter statistically, but it gives the compiler one
+contiguous 256-bit operand per instruction. The first instruction is always OR
+into zero, i.e. a copy. The group loop itself is the bias kernel of spki_Kernels,
+compiled once per instruction set level.
+*******************************************************************************/
+#define SPKI_BIAS_BLOCK ((size_t) 256)
+
+static inline int spki_Bias
+(
+    spki_next next,
+    uint64_t *rng_state,
+    uint64_t *dest,
+    const size_t n,
+    const spk_bias_program *program
+)
+{
+    switch (program->kind)
+    {
+        case SPK_BIAS_ZERO:
+            for (size_t i = 0; i < n; i++) dest[i] = 0;
+            return SPK_ERROR_SUCCESS;
+            
+        case SPK_BIAS_COPY:
+            return next(rng_state, dest, n);
+            
+        case SPK_BIAS_GENERAL:
+            break;
+    }
+    
+    const size_t limit = (size_t) program->limit;
+    const size_t width = SPKI_BIAS_BLOCK / (4 * limit) * 4;
+    
+    uint64_t op[64];
+    uint64_t data[SPKI_BIAS_BLOCK];
+    
+    for (size_t PC = 0; PC < limit; PC++)
+    {
+        op[PC] = 0 - ((program->bitcode >> PC) & 0x1);
+    }
+    
+    const struct spki_kernels *kernels = spki_Kernels();
+    
+    for (size_t i = 0; i < n; i += width)
+    {
+        const size_t outputs = n - i < width ? n - i : width;
+        const size_t groups = (outputs + 3) / 4;
+        
+        const int error = next(rng_state, data, groups * 4 * limit);
+        if (error) return error;
+        
+        kernels->bias(dest + i, data, op, limit, outputs);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+* NAME: spki_BiasCompile
+* DESC: decode p = N/2^exp into a bias program without validating p or exp
+* NOTE: the arguments must satisfy 0 <= p < 1 and 0 < exp < 65, which is checked
+* once by spk_BiasProgramInit or per call by spki_BiasMethod, see the bit trie
+* notes above spk_BiasProgramInit for the decoding itself
+*******************************************************************************/
+static inline void spki_BiasCompile(spk_bias_program *program, const double p, const int exp)
+{
+    //program instructions - shift out dummy AND instructions at head
+    const uint64_t path = (uint64_t) ldexp(p, exp);
+    const int dummy = path ? __builtin_ctzll(path) : exp;
+    
+    program->bitcode = path >> dummy;
+    program->limit = exp - dummy;
+    
+    if (path == 0)
+    {
+        program->kind = SPK_BIAS_ZERO;
+    }
+    else if (program->limit == 1)
+    {
+        program->kind = SPK_BIAS_COPY;
+    }
+    else
+    {
+        program->kind = SPK_BIAS_GENERAL;
+    }
+}
+
+/*******************************************************************************
+* NAME: spki_BiasMethod
+* DESC: the bias method shared by every generator, compile then run a program
+* OUTP: scipack error code
+* NOTE: validation is a per-call check, callers reusing p should hold a program
+* from spk_BiasProgramInit and call spk_GeneratorBias, which skips both steps
+*******************************************************************************/
+static inline int spki_BiasMethod
+(
+    spki_next next,
+    uint64_t *rng_state,
+    uint64_t *dest,
+    const size_t n,
+    const double p,
+    const int exp
+)
+{
+    if (SPKI_CHECK(!(p >= 0.0 && p < 1.0) || exp <= 0 || exp >= 65))
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_generator->bias", "p %g or exp %d outside [0, 1) and [1, 64]", p, exp);
+    }
+    
+    spk_bias_program program;
+    spki_BiasCompile(&program, p, exp);
+    
+    return spki_Bias(next, rng_state, dest, n, &program);
+}
+
+/*******************************************************************************
+* NAME: spki_Unid, spki_Unif
+* DESC: uniform variates on [0, 1) shared by every generator
+* OUTP: scipack error code
+* NOTE: next is a compile time constant at every call site and gets inlined
+
+Instead of ldexp, which is a libm call on top of a uint64 to double conversion
+that AVX2 does not have, OR the top 52 raw bits into the mantissa of 1.0. That
+is a double on [1, 2) with the exponent already in place, and subtracting 1.0
+leaves a uniform variate on [0, 1) at a resolution of 2^-52. The float variant
+does the same with the top 23 bits of each 32-bit half of a raw word.
+
+The double variant keeps the in-place trick of the original code, filling dest
+with raw words and overwriting them, but it does so one block at a time. The
+block is still in L1 when it is converted, so dest is only streamed once. The
+conversion is the unid or unif kernel of spki_Kernels, one indirect call per
+block, so that the widest registers the CPU has are used for every generator.
+*******************************************************************************/
+#define SPKI_UNIFORM_BLOCK ((size_t) 512)
+
+static inline int spki_Unid
+(
+    spki_next next,
+    uint64_t *rng_state,
+    double *dest,
+    const size_t n
+)
+{
+    const struct spki_kernels *kernels = spki_Kernels();
+    
+    for (size_t i = 0; i < n; i += SPKI_UNIFORM_BLOCK)
+    {
+        const size_t m = n - i < SPKI_UNIFORM_BLOCK ? n - i : SPKI_UNIFORM_BLOCK;
+        
+        const int error = next(rng_state, (uint64_t *) (dest + i), m);
+        if (error) return error;
+        
+        kernels->unid(dest + i, m);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static inline int spki_Unif
+(
+    spki_next next,
+    uint64_t *rng_state,
+    float *dest,
+    const size_t n
+)
+{
+    const struct spki_kernels *kernels = spki_Kernels();
+    
+    const size_t words = n / 2 + (n & 1);
+    uint64_t raw[SPKI_UNIFORM_BLOCK];
+    
+    for (size_t i = 0; i < words; i += SPKI_UNIFORM_BLOCK)
+    {
+        const size_t m = words - i < SPKI_UNIFORM_BLOCK ? words - i : SPKI_UNIFORM_BLOCK;
+        const size_t count = n - 2 * i < 2 * m ? n - 2 * i : 2 * m;
+        
+        const int error = next(rng_state, raw, m);
+        if (error) return error;
+        
+        //the low half of raw word k becomes float 2k and the high half 2k + 1
+        kernels->unif(dest + 2 * i, raw, count);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+#endif
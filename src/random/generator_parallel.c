@@ -0,0 +1,428 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: subroutines for multithreaded bulk random number generation
+* LICS: MIT License
+*/
+
+#define _POSIX_C_SOURCE 200112L //pthreads and sysconf under -std=c99
+
+#include "generator_parallel.h"
+#include "generator_internal.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h> //malloc, free, size_t
+#include <string.h> //memcpy
+#include <unistd.h> //sysconf
+
+/*******************************************************************************
+Prototypes
+*******************************************************************************/
+static void *Worker(void *arg);
+static void Drain(void);
+static int StartPool(size_t threads, const char *where);
+static void StopPool(void);
+static void RunTasks(void (*task)(void *, size_t), void *context, size_t tasks);
+
+static void FillSpan(void *context, size_t task);
+static void FillRandChunk(void *context, size_t task);
+static uint64_t WordsBefore(const spk_fill_method *method, size_t offset);
+static int RunMethod(spk_generator rng, void *dest, size_t offset, size_t n, const spk_fill_method *method);
+
+/*******************************************************************************
+The pool keeps threads - 1 workers parked on a condition variable, the caller
+is the last thread. A job is a task function plus a task count, and every thread
+claims task indices from a shared atomic counter until none are left. The caller
+then waits until every worker has checked back in, so a worker can never miss a
+generation or see a half published job.
+*******************************************************************************/
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    pthread_t *threads;
+    size_t count;
+    size_t busy;
+    size_t shutdown;
+    uint64_t generation;
+    uint64_t epoch;
+    void (*task)(void *, size_t);
+    void *context;
+    size_t tasks;
+    size_t next_task;
+} pool =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+//one job at a time, also guards pool startup and shutdown
+static pthread_mutex_t submit = PTHREAD_MUTEX_INITIALIZER;
+
+//set once any pool has been started, the pool itself may have zero workers
+static size_t pool_ready = 0;
+
+/******************************************************************************/
+
+static void Drain(void)
+{
+    for (;;)
+    {
+        const size_t i = __atomic_fetch_add(&pool.next_task, 1, __ATOMIC_RELAXED);
+        if (i >= pool.tasks) break;
+        
+        pool.task(pool.context, i);
+    }
+}
+
+/******************************************************************************/
+
+static void *Worker(void *arg)
+{
+    (void) arg;
+    
+    //a job may already be published by the time this thread first runs
+    uint64_t seen = pool.epoch;
+    
+    pthread_mutex_lock(&pool.lock);
+    
+    for (;;)
+    {
+        while (!pool.shutdown && pool.generation == seen)
+        {
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        }
+        
+        if (pool.shutdown) break;
+        
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+        
+        Drain();
+        
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.busy == 0) pthread_cond_signal(&pool.done);
+    }
+    
+    pthread_mutex_unlock(&pool.lock);
+    
+    return NULL;
+}
+
+/******************************************************************************/
+
+static void RunTasks(void (*task)(void *, size_t), void *context, size_t tasks)
+{
+    pthread_mutex_lock(&pool.lock);
+    
+    pool.task = task;
+    pool.context = context;
+    pool.tasks = tasks;
+    pool.next_task = 0;
+    pool.busy = pool.count;
+    pool.generation++;
+    
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    
+    Drain();
+    
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy) pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+/*******************************************************************************
+Start and stop must be called with the submit lock held, where names the public
+entry point that started the pool for the logger
+*******************************************************************************/
+static int StartPool(size_t threads, const char *where)
+{
+    if (threads == 0)
+    {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t) online : 1;
+    }
+    
+    pool.count = 0;
+    pool.shutdown = 0;
+    pool.threads = NULL;
+    pool.epoch = pool.generation;
+    
+    if (threads > 1)
+    {
+        pool.threads = malloc((threads - 1) * sizeof(pthread_t));
+        if (!pool.threads) return SPK_ERROR_STDMALLOC;
+    }
+    
+    for (size_t i = 0; i < threads - 1; i++)
+    {
+        if (pthread_create(&pool.threads[i], NULL, Worker, NULL))
+        {
+            StopPool();
+            return spki_Fail(SPK_ERROR_PTHREAD, where, "worker %zu of %zu could not be created", i + 1, threads - 1);
+        }
+        
+        pool.count++;
+    }
+    
+    pool_ready = 1;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static void StopPool(void)
+{
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = 1;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    
+    for (size_t i = 0; i < pool.count; i++) pthread_join(pool.threads[i], NULL);
+    
+    free(pool.threads);
+    pool.threads = NULL;
+    pool.count = 0;
+    pool_ready = 0;
+}
+
+/******************************************************************************/
+
+int spk_ParallelInit(size_t threads)
+{
+    pthread_mutex_lock(&submit);
+    
+    if (pool_ready) StopPool();
+    int error = StartPool(threads, "spk_ParallelInit");
+    
+    pthread_mutex_unlock(&submit);
+    
+    return error;
+}
+
+/******************************************************************************/
+
+void spk_ParallelDelete(void)
+{
+    pthread_mutex_lock(&submit);
+    
+    if (pool_ready) StopPool();
+    
+    pthread_mutex_unlock(&submit);
+}
+
+/*******************************************************************************
+Entry point for other modules with work of their own to spread over the pool
+*******************************************************************************/
+int spki_ParallelRun(void (*task)(void *, size_t), void *context, size_t tasks, const char *where)
+{
+    int error = SPK_ERROR_SUCCESS;
+    
+    pthread_mutex_lock(&submit);
+    
+    if (!pool_ready) error = StartPool(0, where);
+    if (!error) RunTasks(task, context, tasks);
+    
+    pthread_mutex_unlock(&submit);
+    
+    return error;
+}
+
+/*******************************************************************************
+Every worker needs a private copy of the generator to jump ahead. All of them
+are small, so the copy lives on the worker's stack. Only the hardware generator
+can fail mid fill, any failing task records its code in the shared job.
+*******************************************************************************/
+#define COPY_WORDS ((size_t) 64)
+
+struct fill_job
+{
+    spk_generator rng;
+    void *dest;
+    size_t n;
+    size_t span;
+    size_t size;
+    const spk_fill_method *method;
+    int error;
+    char padding[4];
+};
+
+/*******************************************************************************
+Raw words consumed before element offset. Spans start on multiples of the chunk
+size, which is a multiple of every lane count, so the jumped copy lands exactly
+where the serial fill would be.
+*******************************************************************************/
+static uint64_t WordsBefore(const spk_fill_method *method, size_t offset)
+{
+    if (method->kind == SPK_FILL_UNIF) return (uint64_t) (offset / 2 + offset % 2);
+    
+    return (uint64_t) offset;
+}
+
+/******************************************************************************/
+
+static int RunMethod
+(
+    spk_generator rng,
+    void *dest,
+    size_t offset,
+    size_t n,
+    const spk_fill_method *method
+)
+{
+    switch (method->kind)
+    {
+        case SPK_FILL_NEXT:
+            return rng->next(rng->state, (uint64_t *) dest + offset, n);
+            
+        case SPK_FILL_UNID:
+            return rng->unid(rng, (double *) dest + offset, n);
+            
+        case SPK_FILL_UNIF:
+            return rng->unif(rng, (float *) dest + offset, n);
+            
+        case SPK_FILL_RAND:
+            return rng->rand(rng, (uint64_t *) dest + offset, n, method->min, method->max);
+    }
+    
+    return SPK_ERROR_ARGBOUNDS;
+}
+
+/******************************************************************************/
+
+static void FillSpan(void *context, size_t task)
+{
+    struct fill_job *job = context;
+    uint64_t copy[COPY_WORDS];
+    spk_generator local = (spk_generator) copy;
+    
+    const size_t start = task * job->span;
+    const size_t count = job->n - start < job->span ? job->n - start : job->span;
+    
+    memcpy(copy, job->rng, job->size);
+    spk_GeneratorJump(local, WordsBefore(job->method, start));
+    
+    const int error = RunMethod(local, job->dest, start, count, job->method);
+    if (error) __atomic_store_n(&job->error, error, __ATOMIC_RELAXED);
+}
+
+/******************************************************************************/
+
+static void FillRandChunk(void *context, size_t task)
+{
+    struct fill_job *job = context;
+    uint64_t copy[COPY_WORDS];
+    spk_generator local = (spk_generator) copy;
+    
+    const size_t start = task * SPK_PARALLEL_RAND_CHUNK;
+    const size_t remaining = job->n - start;
+    const size_t count = remaining < SPK_PARALLEL_RAND_CHUNK ? remaining : SPK_PARALLEL_RAND_CHUNK;
+    
+    memcpy(copy, job->rng, job->size);
+    spk_GeneratorJump(local, (uint64_t) task * SPK_PARALLEL_RAND_STRIDE);
+    
+    const int error = RunMethod(local, job->dest, start, count, job->method);
+    if (error) __atomic_store_n(&job->error, error, __ATOMIC_RELAXED);
+}
+
+/*******************************************************************************
+The serial methods fix the output of next, unid, and unif, so threads get one
+contiguous span each and pay for one jump apiece. For rand the number of words
+per value depends on rejections, so there is no cheap way to find where a span
+would start, and rand is defined chunk by chunk instead.
+*******************************************************************************/
+int spk_GeneratorFillParallel
+(
+    spk_generator rng,
+    void *dest,
+    const size_t n,
+    const spk_fill_method *method
+)
+{
+    assert(rng);
+    assert(dest);
+    assert(method);
+    
+    const char *where = "spk_GeneratorFillParallel";
+    
+    if (method->kind > SPK_FILL_RAND) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "unknown method kind %d", (int) method->kind);
+    
+    const size_t size = spk_GeneratorSize(rng->identifier);
+    
+    if (size == 0 || size > COPY_WORDS * sizeof(uint64_t))
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "generator %d cannot be copied", rng->identifier);
+    }
+    
+    const size_t rand_chunks = (n + SPK_PARALLEL_RAND_CHUNK - 1) / SPK_PARALLEL_RAND_CHUNK;
+    
+    if (method->kind == SPK_FILL_RAND && rand_chunks > UINT64_MAX / SPK_PARALLEL_RAND_STRIDE)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "%zu rand values overflow the chunk strides", n);
+    }
+    
+    pthread_mutex_lock(&submit);
+    
+    if (!pool_ready)
+    {
+        int error = StartPool(0, where);
+        
+        if (error)
+        {
+            pthread_mutex_unlock(&submit);
+            return error;
+        }
+    }
+    
+    const size_t threads = pool.count + 1;
+    
+    struct fill_job job =
+    {
+        .rng = rng,
+        .dest = dest,
+        .n = n,
+        .span = 0,
+        .size = size,
+        .method = method,
+        .error = SPK_ERROR_SUCCESS
+    };
+    
+    uint64_t advance = 0;
+    
+    if (method->kind == SPK_FILL_RAND)
+    {
+        RunTasks(FillRandChunk, &job, rand_chunks);
+        advance = (uint64_t) rand_chunks * SPK_PARALLEL_RAND_STRIDE;
+    }
+    else
+    {
+        const size_t chunks = (n + SPK_PARALLEL_CHUNK - 1) / SPK_PARALLEL_CHUNK;
+        
+        if (threads == 1 || chunks <= 1)
+        {
+            job.error = RunMethod(rng, dest, 0, n, method);
+        }
+        else
+        {
+            const size_t tasks = chunks < threads ? chunks : threads;
+            job.span = (chunks + tasks - 1) / tasks * SPK_PARALLEL_CHUNK;
+            
+            RunTasks(FillSpan, &job, (n + job.span - 1) / job.span);
+            advance = WordsBefore(method, n);
+        }
+    }
+    
+    //leave rng where the serial call would have left it
+    if (advance) spk_GeneratorJump(rng, advance);
+    
+    pthread_mutex_unlock(&submit);
+    
+    //a worker can only hit a method failure such as an empty hardware DRNG
+    if (job.error) return spki_Fail(job.error, where, "%zu values are incomplete", n);
+    
+    return SPK_ERROR_SUCCESS;
+}
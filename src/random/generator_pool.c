@@ -0,0 +1,433 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: pre-generated random pools written in parallel and replayed via mmap
+* LICS: MIT License
+*/
+
+#define _GNU_SOURCE //madvise, posix_fallocate under -std=c99
+
+#include "generator_pool.h"
+#include "generator_parallel.h"
+#include "generator_internal.h"
+
+#include <assert.h>
+#include <fcntl.h> //open, posix_fallocate
+#include <stdlib.h> //malloc, free
+#include <string.h> //memcpy, memcmp, memset
+#include <sys/mman.h> //mmap, madvise, msync, munmap
+#include <sys/stat.h> //fstat
+#include <unistd.h> //close, unlink
+
+/*******************************************************************************
+Prototypes
+*******************************************************************************/
+static int NextPool(uint64_t *state, uint64_t *dest, const size_t n);
+static int RandPool(struct spk_generator *, uint64_t *, const size_t, const uint64_t, const uint64_t);
+static int BiasPool(struct spk_generator *, uint64_t *, const size_t, const double, const int);
+static int UnidPool(struct spk_generator *, double *, const size_t);
+static int UnifPool(struct spk_generator *, float *, const size_t);
+static int Exhausted(const struct spki_pool *pool, uint64_t n, const char *where);
+static int RawMissing(const char *where);
+
+/*******************************************************************************
+Header fields are written byte by byte like the serialized generators, so they
+read the same on any host. The elements are left in host order on purpose, the
+point of the file is to be mapped and copied out without a conversion pass.
+*******************************************************************************/
+#define MAGIC "SPKP"
+
+static void StoreLE(unsigned char *dest, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) dest[i] = (unsigned char) (value >> (8 * i));
+}
+
+static uint64_t LoadLE(const unsigned char *src, size_t bytes)
+{
+    uint64_t value = 0;
+    
+    for (size_t i = 0; i < bytes; i++) value |= (uint64_t) src[i] << (8 * i);
+    
+    return value;
+}
+
+/******************************************************************************/
+
+static void StoreHeader(unsigned char *dest, const spk_pool_info *info)
+{
+    memset(dest, 0, SPK_POOL_HEADER);
+    memcpy(dest, MAGIC, 4);
+    
+    dest[4] = SPK_POOL_VERSION;
+    dest[5] = SPK_MAJOR;
+    dest[6] = SPK_MINOR;
+    dest[7] = SPK_PATCH;
+    
+    StoreLE(dest + 8, (uint64_t) (uint32_t) info->identifier, 4);
+    StoreLE(dest + 12, (uint64_t) info->kind, 4);
+    StoreLE(dest + 16, info->seed, 8);
+    StoreLE(dest + 24, info->position, 8);
+    StoreLE(dest + 32, info->count, 8);
+}
+
+/*******************************************************************************
+The count has to account for the file size exactly, which catches truncated
+copies as well as files written by a build with a different element size
+*******************************************************************************/
+static int LoadHeader(const unsigned char *src, size_t length, spk_pool_info *info)
+{
+    if (length < SPK_POOL_HEADER) return SPK_ERROR_FORMAT;
+    if (memcmp(src, MAGIC, 4) != 0) return SPK_ERROR_FORMAT;
+    if (src[4] != SPK_POOL_VERSION) return SPK_ERROR_FORMAT;
+    
+    const uint64_t identifier = LoadLE(src + 8, 4);
+    const uint64_t kind = LoadLE(src + 12, 4);
+    
+    if (identifier > INT32_MAX || spk_GeneratorSize((int) identifier) == 0) return SPK_ERROR_FORMAT;
+    if (kind != SPK_POOL_NEXT && kind != SPK_POOL_UNID) return SPK_ERROR_FORMAT;
+    
+    info->identifier = (int) identifier;
+    info->kind = (enum spk_pool_kind) kind;
+    info->seed = LoadLE(src + 16, 8);
+    info->position = LoadLE(src + 24, 8);
+    info->count = LoadLE(src + 32, 8);
+    info->cursor = 0;
+    
+    const size_t elements = (length - SPK_POOL_HEADER) / sizeof(uint64_t);
+    
+    if ((length - SPK_POOL_HEADER) % sizeof(uint64_t)) return SPK_ERROR_FORMAT;
+    if (info->count != (uint64_t) elements) return SPK_ERROR_FORMAT;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+The file is sized and its blocks allocated before it is mapped, a shared mapping
+over a sparse file would otherwise raise SIGBUS on the first page the disk has
+no room for. The parallel fill then writes each span straight into the page
+cache, so there is no staging buffer and no write call per block. The header
+is stored only after the data has been flushed, a reader never accepts a file
+whose fill was interrupted, and on any failure the file is removed.
+*******************************************************************************/
+int spk_GeneratorPoolWrite
+(
+    const char *path,
+    int identifier,
+    uint64_t seed,
+    uint64_t position,
+    size_t count,
+    enum spk_pool_kind kind
+)
+{
+    assert(path);
+    
+    const char *where = "spk_GeneratorPoolWrite";
+    
+    if (kind != SPK_POOL_NEXT && kind != SPK_POOL_UNID)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "unknown pool kind %d", (int) kind);
+    }
+    
+    const size_t length = SPK_POOL_HEADER + count * sizeof(uint64_t);
+    
+    if (count == 0 || count > (SIZE_MAX - SPK_POOL_HEADER) / sizeof(uint64_t) || (uint64_t) length > (uint64_t) INT64_MAX)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "count %zu cannot be mapped", count);
+    }
+    
+    //checked here so that every failure of spk_GeneratorNew below is unlogged
+    if (spk_GeneratorSize(identifier) == 0)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "unknown generator %d", identifier);
+    }
+    
+    //the header should let the run be replayed, so a zero seed is drawn here
+    while (seed == 0)
+    {
+        int error = spki_EntropyRetry(&seed, 10);
+        if (error) return spki_Fail(error, where, "no entropy for a seed");
+    }
+    
+    spk_generator rng = NULL;
+    
+    int error = spk_GeneratorNew(&rng, identifier, seed);
+    if (error) return spki_Fail(error, where, "generator %d could not be created", identifier);
+    
+    //spk_GeneratorJump and spk_GeneratorFillParallel log their own failures
+    error = spk_GeneratorJump(rng, position);
+    
+    if (error)
+    {
+        spk_GeneratorDelete(rng);
+        return error;
+    }
+    
+    const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    
+    if (fd == -1)
+    {
+        spk_GeneratorDelete(rng);
+        return spki_Fail(SPK_ERROR_FILEIO, where, "cannot create %s", path);
+    }
+    
+    unsigned char *map = MAP_FAILED;
+    
+    if (posix_fallocate(fd, 0, (off_t) length) == 0)
+    {
+        map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    
+    if (map == MAP_FAILED)
+    {
+        error = spki_Fail(SPK_ERROR_FILEIO, where, "cannot reserve and map %zu bytes of %s", length, path);
+    }
+    else
+    {
+        const spk_fill_method method = {.kind = kind == SPK_POOL_NEXT ? SPK_FILL_NEXT : SPK_FILL_UNID};
+        const spk_pool_info info = {seed, position, (uint64_t) count, 0, identifier, kind};
+        
+        error = spk_GeneratorFillParallel(rng, map + SPK_POOL_HEADER, count, &method);
+        
+        if (!error && msync(map, length, MS_SYNC))
+        {
+            error = spki_Fail(SPK_ERROR_FILEIO, where, "cannot sync the elements of %s", path);
+        }
+        
+        if (!error)
+        {
+            StoreHeader(map, &info);
+            
+            if (msync(map, SPK_POOL_HEADER, MS_SYNC))
+            {
+                error = spki_Fail(SPK_ERROR_FILEIO, where, "cannot sync the header of %s", path);
+            }
+        }
+        
+        munmap(map, length);
+    }
+    
+    if (close(fd) && !error) error = spki_Fail(SPK_ERROR_FILEIO, where, "cannot close %s", path);
+    if (error) unlink(path);
+    
+    spk_GeneratorDelete(rng);
+    
+    return error;
+}
+
+/*******************************************************************************
+The descriptor is closed as soon as the mapping exists, the mapping holds its
+own reference to the file. Read-ahead is advised over the whole file, after
+which the kernel grows its window as the cursor keeps moving forward.
+*******************************************************************************/
+int spk_GeneratorPoolOpen(spk_generator *rng, const char *path)
+{
+    assert(rng);
+    assert(path);
+    
+    *rng = NULL;
+    
+    const int fd = open(path, O_RDONLY);
+    if (fd == -1) return spki_Fail(SPK_ERROR_FILEIO, "spk_GeneratorPoolOpen", "cannot open %s", path);
+    
+    struct stat file;
+    
+    if (fstat(fd, &file) || file.st_size < (off_t) SPK_POOL_HEADER)
+    {
+        close(fd);
+        return spki_Fail(SPK_ERROR_FORMAT, "spk_GeneratorPoolOpen", "%s is too short for a pool", path);
+    }
+    
+    const size_t length = (size_t) file.st_size;
+    void *map = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    
+    close(fd);
+    
+    if (map == MAP_FAILED) return spki_Fail(SPK_ERROR_FILEIO, "spk_GeneratorPoolOpen", "cannot map %s", path);
+    
+    spk_pool_info info;
+    
+    int error = LoadHeader(map, length, &info);
+    
+    if (error)
+    {
+        munmap(map, length);
+        return spki_Fail(error, "spk_GeneratorPoolOpen", "%s has a malformed header", path);
+    }
+    
+    *rng = malloc(sizeof(struct spk_generator) + sizeof(struct spki_pool));
+    
+    if (!(*rng))
+    {
+        munmap(map, length);
+        return SPK_ERROR_STDMALLOC;
+    }
+    
+    madvise(map, length, MADV_SEQUENTIAL);
+    
+    struct spki_pool *pool = (struct spki_pool *) (*rng)->state;
+    
+    pool->map = map;
+    pool->length = length;
+    pool->data = (const uint64_t *) (const void *) ((const unsigned char *) map + SPK_POOL_HEADER);
+    pool->count = info.count;
+    pool->cursor = 0;
+    pool->position = info.position;
+    pool->seed = info.seed;
+    pool->source = info.identifier;
+    pool->kind = info.kind;
+    
+    //hook in methods
+    (*rng)->identifier = SPK_GENERATOR_POOL;
+    (*rng)->next = NextPool;
+    (*rng)->rand = RandPool;
+    (*rng)->bias = BiasPool;
+    (*rng)->unid = UnidPool;
+    (*rng)->unif = UnifPool;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorPoolInfo(const spk_generator rng, spk_pool_info *info)
+{
+    assert(rng);
+    assert(info);
+    
+    if (rng->identifier != SPK_GENERATOR_POOL)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorPoolInfo", "generator %d is not a pool", rng->identifier);
+    }
+    
+    const struct spki_pool *pool = (const struct spki_pool *) rng->state;
+    
+    info->seed = pool->seed;
+    info->position = pool->position;
+    info->count = pool->count;
+    info->cursor = pool->cursor;
+    info->identifier = pool->source;
+    info->kind = (enum spk_pool_kind) pool->kind;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorPoolView(spk_generator rng, const void **view, const size_t n)
+{
+    assert(rng);
+    assert(view);
+    
+    if (rng->identifier != SPK_GENERATOR_POOL)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorPoolView", "generator %d is not a pool", rng->identifier);
+    }
+    
+    struct spki_pool *pool = (struct spki_pool *) rng->state;
+    
+    if (n > pool->count - pool->cursor) return Exhausted(pool, n, "spk_GeneratorPoolView");
+    
+    *view = pool->data + pool->cursor;
+    pool->cursor += n;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Running out is the one failure a correctly used pool can hit, so it is logged
+with what was asked for against what was left
+*******************************************************************************/
+static int Exhausted(const struct spki_pool *pool, uint64_t n, const char *where)
+{
+    return spki_Fail(SPK_ERROR_EXHAUSTED, where, "%" PRIu64 " elements requested, %" PRIu64 " remain",
+        n, pool->count - pool->cursor);
+}
+
+/******************************************************************************/
+
+static int RawMissing(const char *where)
+{
+    return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "a unid pool holds no raw words");
+}
+
+/*******************************************************************************
+Every method is a copy of elements from the current cursor. A raw pool feeds
+the shared spki_* layers with NextPool in place of the source generator's next,
+so the blocking, and with it the consumption of words, matches the SISD methods
+call for call. The uniform methods check the remaining count first so that a
+failed call leaves the cursor where it was.
+*******************************************************************************/
+static int NextPool(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct spki_pool *pool = (struct spki_pool *) state;
+    
+    if (pool->kind != SPK_POOL_NEXT) return RawMissing("spk_generator->next");
+    if (n > pool->count - pool->cursor) return Exhausted(pool, n, "spk_generator->next");
+    
+    memcpy(dest, pool->data + pool->cursor, n * sizeof(uint64_t));
+    pool->cursor += n;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static int RandPool
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    const struct spki_pool *pool = (const struct spki_pool *) rng->state;
+    
+    if (pool->kind != SPK_POOL_NEXT) return RawMissing("spk_generator->rand");
+    
+    return spki_Rand(NextPool, rng->state, dest, n, min, max);
+}
+
+/******************************************************************************/
+
+static int BiasPool
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const double p,
+    const int exp
+)
+{
+    const struct spki_pool *pool = (const struct spki_pool *) rng->state;
+    
+    if (pool->kind != SPK_POOL_NEXT) return RawMissing("spk_generator->bias");
+    
+    return spki_BiasMethod(NextPool, rng->state, dest, n, p, exp);
+}
+
+/******************************************************************************/
+
+static int UnidPool(struct spk_generator *rng, double *dest, const size_t n)
+{
+    struct spki_pool *pool = (struct spki_pool *) rng->state;
+    
+    if (n > pool->count - pool->cursor) return Exhausted(pool, n, "spk_generator->unid");
+    if (pool->kind == SPK_POOL_NEXT) return spki_Unid(NextPool, rng->state, dest, n);
+    
+    memcpy(dest, pool->data + pool->cursor, n * sizeof(double));
+    pool->cursor += n;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static int UnifPool(struct spk_generator *rng, float *dest, const size_t n)
+{
+    struct spki_pool *pool = (struct spki_pool *) rng->state;
+    
+    if (pool->kind != SPK_POOL_NEXT) return RawMissing("spk_generator->unif");
+    if (n / 2 + (n & 1) > pool->count - pool->cursor) return Exhausted(pool, n / 2 + (n & 1), "spk_generator->unif");
+    
+    return spki_Unif(NextPool, rng->state, dest, n);
+}
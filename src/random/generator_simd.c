@@ -0,0 +1,960 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: subroutines for SIMD psuedo random number generation
+* LICS: MIT License
+*/
+
+#include "generator_simd.h"
+#include "generator_internal.h"
+#include "generator_inline.h"
+
+#include <immintrin.h> //avx2, avx512
+#include <stddef.h> //size_t
+#include <string.h> //memcpy
+
+/*******************************************************************************
+Prototypes
+*******************************************************************************/
+static int SeedLanes(uint64_t *state, uint64_t *increment, size_t lanes, uint64_t seed);
+
+/*******************************************************************************
+Each lane is a complete pcg64i generator, so the state is just the SISD struct
+transposed into structure-of-arrays form. This keeps one __m256i register per
+four lanes for both the state and the increment. The structs themselves live in
+generator_internal.h so that generator_sisd.c can size and copy them.
+*******************************************************************************/
+#define LANES_X4 ((size_t) 4)
+#define LANES_X8 ((size_t) 8)
+
+/*******************************************************************************
+Every generator comes in one variant per SPK_ISA_* level, picked by spki_ISA in
+its init function. The library itself is built for baseline x86-64, the AVX2 and
+AVX-512 variants are compiled inside GCC target regions and are only hooked in
+when CPUID reports them. All variants of a generator produce the same stream
+bit for bit, so a checkpoint taken on one machine resumes on any other.
+
+The rand, bias, unid, and unif methods are shared with generator_sisd.c via
+generator_internal.h. They draw raw words in blocks. The full rand, unid and
+unif blocks are whole lane groups, so those only discard part of a group on the
+last block of a call, while a bias block is a multiple of four words and can
+waste half a group on PCG64ix8. A call for fewer words than there are lanes
+still pays for all of them, scalar draws belong in a spk_generator_buffer.
+METHODS stamps out the four wrappers for one next variant. Expanded inside a
+target region, the wrappers compile for that target too and the next method, a
+compile time constant, is still inlined.
+*******************************************************************************/
+#define METHODS(name)                                                          \
+static int Rand##name                                                          \
+(                                                                              \
+    struct spk_generator *rng,                                                 \
+    uint64_t *dest,                                                            \
+    const size_t n,                                                            \
+    const uint64_t min,                                                        \
+    const uint64_t max                                                         \
+)                                                                              \
+{                                                                              \
+    return spki_Rand(Next##name, rng->state, dest, n, min, max);               \
+}                                                                              \
+                                                                               \
+static int Bias##name                                                          \
+(                                                                              \
+    struct spk_generator *rng,                                                 \
+    uint64_t *dest,                                                            \
+    const size_t n,                                                            \
+    const double p,                                                            \
+    const int exp                                                              \
+)                                                                              \
+{                                                                              \
+    return spki_BiasMethod(Next##name, rng->state, dest, n, p, exp);           \
+}                                                                              \
+                                                                               \
+static int Unid##name(struct spk_generator *rng, double *dest, const size_t n) \
+{                                                                              \
+    return spki_Unid(Next##name, rng->state, dest, n);                         \
+}                                                                              \
+                                                                               \
+static int Unif##name(struct spk_generator *rng, float *dest, const size_t n)  \
+{                                                                              \
+    return spki_Unif(Next##name, rng->state, dest, n);                         \
+}
+
+#define HOOK(rng, name)                                                        \
+        do                                                                     \
+        {                                                                      \
+            (rng)->next = Next##name;                                          \
+            (rng)->rand = Rand##name;                                          \
+            (rng)->bias = Bias##name;                                          \
+            (rng)->unid = Unid##name;                                          \
+            (rng)->unif = Unif##name;                                          \
+        }                                                                      \
+        while (0)
+
+/*******************************************************************************
+Seed every lane with its own state and increment. Distinct increments select
+distinct PCG streams, so the lanes never share a sequence even when the seed is
+deterministic.
+*******************************************************************************/
+static int SeedLanes(uint64_t *state, uint64_t *increment, size_t lanes, uint64_t seed)
+{
+    for (size_t i = 0; i < lanes; i++)
+    {
+        if (seed != 0)
+        {
+            state[i] = spki_Hash(&seed);
+            increment[i] = spki_Hash(&seed);
+        }
+        else
+        {
+            int error = SPK_ERROR_UNDEFINED;
+            
+            error = spki_EntropyRetry(&state[i], 10);
+            if (error) return error;
+            
+            error = spki_EntropyRetry(&increment[i], 10);
+            if (error) return error;
+        }
+        
+        //PCG increment must be odd
+        increment[i] |= 1;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+A fill of n words advances every lane by ceil(n / lanes) steps since the excess
+of a partial lane group is discarded, so a jump does exactly the same.
+*******************************************************************************/
+void spki_JumpPCG64ix4(uint64_t *state, uint64_t delta)
+{
+    struct pcg64ix4 *pcg = (struct pcg64ix4 *) state;
+    const uint64_t steps = delta / LANES_X4 + (delta % LANES_X4 != 0);
+    
+    for (size_t i = 0; i < LANES_X4; i++)
+    {
+        spki_AdvancePCG64i(&pcg->state[i], pcg->increment[i], steps);
+    }
+}
+
+/******************************************************************************/
+
+void spki_JumpPCG64ix8(uint64_t *state, uint64_t delta)
+{
+    struct pcg64ix8 *pcg = (struct pcg64ix8 *) state;
+    const uint64_t steps = delta / LANES_X8 + (delta % LANES_X8 != 0);
+    
+    for (size_t i = 0; i < LANES_X8; i++)
+    {
+        spki_AdvancePCG64i(&pcg->state[i], pcg->increment[i], steps);
+    }
+}
+
+/*******************************************************************************
+Same ceil(n / lanes) rule as the PCG lanes. Each lane is gathered into a scalar
+state, advanced with the SISD polynomial jump, and scattered back.
+*******************************************************************************/
+void spki_JumpXoshiro256x4(uint64_t *state, uint64_t delta)
+{
+    struct xoshiro256x4 *xos = (struct xoshiro256x4 *) state;
+    const uint64_t steps = delta / LANES_X4 + (delta % LANES_X4 != 0);
+    
+    for (size_t k = 0; k < LANES_X4; k++)
+    {
+        uint64_t lane[4];
+        
+        for (size_t j = 0; j < 4; j++) lane[j] = xos->s[j][k];
+        spki_AdvanceXoshiro256(lane, steps);
+        for (size_t j = 0; j < 4; j++) xos->s[j][k] = lane[j];
+    }
+}
+
+/*******************************************************************************
+SISD variants for CPUs without AVX2. Each lane is stepped with the inline SISD
+generator from generator_inline.h, so these are also the reference against which
+the vector variants are tested. The lane group at the tail is generated in full
+and the excess words are discarded, exactly like the vector code.
+*******************************************************************************/
+static inline void FillLanesPCG64i
+(
+    uint64_t *state,
+    const uint64_t *increment,
+    const size_t lanes,
+    uint64_t *dest,
+    const size_t n
+)
+{
+    const size_t groups = (n + lanes - 1) / lanes;
+    
+    for (size_t k = 0; k < lanes; k++)
+    {
+        spk_pcg64i lane = {.state = state[k], .increment = increment[k]};
+        
+        for (size_t g = 0; g < groups; g++)
+        {
+            const uint64_t word = spk_PCG64iNext(&lane);
+            if (g * lanes + k < n) dest[g * lanes + k] = word;
+        }
+        
+        state[k] = lane.state;
+    }
+}
+
+/******************************************************************************/
+
+static inline int NextPCG64ix4SISD(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct pcg64ix4 *pcg = (struct pcg64ix4 *) state;
+    
+    FillLanesPCG64i(pcg->state, pcg->increment, LANES_X4, dest, n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static inline int NextPCG64ix8SISD(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct pcg64ix8 *pcg = (struct pcg64ix8 *) state;
+    
+    FillLanesPCG64i(pcg->state, pcg->increment, LANES_X8, dest, n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static inline int NextXoshiro256x4SISD(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct xoshiro256x4 *xos = (struct xoshiro256x4 *) state;
+    const size_t groups = (n + LANES_X4 - 1) / LANES_X4;
+    
+    for (size_t k = 0; k < LANES_X4; k++)
+    {
+        spk_xoshiro256 lane;
+        
+        for (size_t j = 0; j < 4; j++) lane.s[j] = xos->s[j][k];
+        
+        for (size_t g = 0; g < groups; g++)
+        {
+            const uint64_t word = spk_Xoshiro256Next(&lane);
+            if (g * LANES_X4 + k < n) dest[g * LANES_X4 + k] = word;
+        }
+        
+        for (size_t j = 0; j < 4; j++) xos->s[j][k] = lane.s[j];
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+METHODS(PCG64ix4SISD)
+METHODS(PCG64ix8SISD)
+METHODS(Xoshiro256x4SISD)
+
+/******************************************************************************/
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+/*******************************************************************************
+AVX2 has no 64-bit low multiply (vpmullq is AVX-512DQ), so build it from three
+32-bit vpmuludq products. The high-high product only affects bits above 64 and
+is dropped.
+*******************************************************************************/
+static inline __m256i Mul64(const __m256i a, const __m256i b)
+{
+    const __m256i a_hi = _mm256_srli_epi64(a, 32);
+    const __m256i b_hi = _mm256_srli_epi64(b, 32);
+    
+    const __m256i lo = _mm256_mul_epu32(a, b);
+    __m256i cross = _mm256_mul_epu32(a_hi, b);
+    cross = _mm256_add_epi64(cross, _mm256_mul_epu32(a, b_hi));
+    
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+/*******************************************************************************
+One step of pcg_output_rxs_m_xs_64_64 across four lanes. This is a line-by-line
+translation of NextPCG64i in generator_sisd.c (see that file for the license and
+credit to Melissa O'Neill). The data dependent shift is a single vpsrlvq.
+*******************************************************************************/
+static inline __m256i StepPCG64i(__m256i *state, const __m256i increment)
+{
+    const __m256i multiplier = _mm256_set1_epi64x((long long) 0x5851F42D4C957F2DULL);
+    const __m256i mixer = _mm256_set1_epi64x((long long) 0xAEF17502108EF2D9ULL);
+    const __m256i five = _mm256_set1_epi64x(5LL);
+    
+    const __m256i current = *state;
+    __m256i permuted_state;
+    
+    //permute the current state
+    permuted_state = _mm256_srli_epi64(current, 59);
+    permuted_state = _mm256_add_epi64(permuted_state, five);
+    permuted_state = _mm256_srlv_epi64(current, permuted_state);
+    permuted_state = _mm256_xor_si256(permuted_state, current);
+    permuted_state = Mul64(permuted_state, mixer);
+    permuted_state = _mm256_xor_si256(permuted_state, _mm256_srli_epi64(permuted_state, 43));
+    
+    //update internal state
+    *state = _mm256_add_epi64(Mul64(current, multiplier), increment);
+    
+    return permuted_state;
+}
+
+/*******************************************************************************
+Fill the buffer one lane group at a time. The eight lane variant runs two
+independent register chains so that the multiply latency of one chain is hidden
+behind the other. A partial lane group at the tail is generated in full and the
+excess words are discarded.
+*******************************************************************************/
+static inline int NextPCG64ix4AVX2(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct pcg64ix4 *pcg = (struct pcg64ix4 *) state;
+    
+    __m256i s = _mm256_loadu_si256((const __m256i *) pcg->state);
+    const __m256i inc = _mm256_loadu_si256((const __m256i *) pcg->increment);
+    
+    size_t i = 0;
+    
+    for (; i + LANES_X4 <= n; i += LANES_X4)
+    {
+        _mm256_storeu_si256((__m256i *) (dest + i), StepPCG64i(&s, inc));
+    }
+    
+    if (i < n)
+    {
+        uint64_t tail[LANES_X4];
+        _mm256_storeu_si256((__m256i *) tail, StepPCG64i(&s, inc));
+        memcpy(dest + i, tail, (n - i) * sizeof(uint64_t));
+    }
+    
+    _mm256_storeu_si256((__m256i *) pcg->state, s);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static inline int NextPCG64ix8AVX2(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct pcg64ix8 *pcg = (struct pcg64ix8 *) state;
+    
+    __m256i s_lo = _mm256_loadu_si256((const __m256i *) pcg->state);
+    __m256i s_hi = _mm256_loadu_si256((const __m256i *) (pcg->state + 4));
+    const __m256i inc_lo = _mm256_loadu_si256((const __m256i *) pcg->increment);
+    const __m256i inc_hi = _mm256_loadu_si256((const __m256i *) (pcg->increment + 4));
+    
+    size_t i = 0;
+    
+    for (; i + LANES_X8 <= n; i += LANES_X8)
+    {
+        const __m256i out_lo = StepPCG64i(&s_lo, inc_lo);
+        const __m256i out_hi = StepPCG64i(&s_hi, inc_hi);
+        
+        _mm256_storeu_si256((__m256i *) (dest + i), out_lo);
+        _mm256_storeu_si256((__m256i *) (dest + i + 4), out_hi);
+    }
+    
+    if (i < n)
+    {
+        uint64_t tail[LANES_X8];
+        _mm256_storeu_si256((__m256i *) tail, StepPCG64i(&s_lo, inc_lo));
+        _mm256_storeu_si256((__m256i *) (tail + 4), StepPCG64i(&s_hi, inc_hi));
+        memcpy(dest + i, tail, (n - i) * sizeof(uint64_t));
+    }
+    
+    _mm256_storeu_si256((__m256i *) pcg->state, s_lo);
+    _mm256_storeu_si256((__m256i *) (pcg->state + 4), s_hi);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+AVX2 has no 64-bit rotate (vprolq is AVX-512F), so it is two shifts and an OR.
+*******************************************************************************/
+static inline __m256i Rotl64(const __m256i x, const int k)
+{
+    return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+}
+
+/*******************************************************************************
+A line-by-line translation of spk_Xoshiro256Next in generator_inline.h, see that
+file for the credit to Blackman and Vigna. A partial lane group at the tail is
+generated in full and the excess words are discarded.
+*******************************************************************************/
+static inline int NextXoshiro256x4AVX2(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct xoshiro256x4 *xos = (struct xoshiro256x4 *) state;
+    
+    __m256i s0 = _mm256_loadu_si256((const __m256i *) xos->s[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i *) xos->s[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i *) xos->s[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i *) xos->s[3]);
+    
+    for (size_t i = 0; i < n; i += LANES_X4)
+    {
+        const __m256i result = _mm256_add_epi64(Rotl64(_mm256_add_epi64(s0, s3), 23), s0);
+        const __m256i t = _mm256_slli_epi64(s1, 17);
+        
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = Rotl64(s3, 45);
+        
+        if (i + LANES_X4 <= n)
+        {
+            _mm256_storeu_si256((__m256i *) (dest + i), result);
+        }
+        else
+        {
+            uint64_t tail[LANES_X4];
+            _mm256_storeu_si256((__m256i *) tail, result);
+            memcpy(dest + i, tail, (n - i) * sizeof(uint64_t));
+        }
+    }
+    
+    _mm256_storeu_si256((__m256i *) xos->s[0], s0);
+    _mm256_storeu_si256((__m256i *) xos->s[1], s1);
+    _mm256_storeu_si256((__m256i *) xos->s[2], s2);
+    _mm256_storeu_si256((__m256i *) xos->s[3], s3);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+METHODS(PCG64ix4AVX2)
+METHODS(PCG64ix8AVX2)
+METHODS(Xoshiro256x4AVX2)
+
+#pragma GCC pop_options
+
+/******************************************************************************/
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx512vl")
+
+/*******************************************************************************
+With AVX-512 all eight PCG lanes fit in one zmm register, and a masked store
+handles the partial tail group. vpmullq would do the 64-bit multiply in a single
+instruction, but it is three uops with a 15 cycle latency on Intel cores and the
+state update is one long dependency chain. The same three vpmuludq products as
+Mul64 come out ahead, matrix_next_pcg64ix8 in the benchmarks measures it.
+*******************************************************************************/
+static inline __m512i Mul64x8(const __m512i a, const __m512i b)
+{
+    const __m512i a_hi = _mm512_srli_epi64(a, 32);
+    const __m512i b_hi = _mm512_srli_epi64(b, 32);
+    
+    const __m512i lo = _mm512_mul_epu32(a, b);
+    __m512i cross = _mm512_mul_epu32(a_hi, b);
+    cross = _mm512_add_epi64(cross, _mm512_mul_epu32(a, b_hi));
+    
+    return _mm512_add_epi64(lo, _mm512_slli_epi64(cross, 32));
+}
+
+static inline __m512i StepPCG64ix8(__m512i *state, const __m512i increment)
+{
+    const __m512i multiplier = _mm512_set1_epi64((long long) 0x5851F42D4C957F2DULL);
+    const __m512i mixer = _mm512_set1_epi64((long long) 0xAEF17502108EF2D9ULL);
+    const __m512i five = _mm512_set1_epi64(5LL);
+    
+    const __m512i current = *state;
+    __m512i permuted_state;
+    
+    //permute the current state
+    permuted_state = _mm512_srli_epi64(current, 59);
+    permuted_state = _mm512_add_epi64(permuted_state, five);
+    permuted_state = _mm512_srlv_epi64(current, permuted_state);
+    permuted_state = _mm512_xor_si512(permuted_state, current);
+    permuted_state = Mul64x8(permuted_state, mixer);
+    permuted_state = _mm512_xor_si512(permuted_state, _mm512_srli_epi64(permuted_state, 43));
+    
+    //update internal state
+    *state = _mm512_add_epi64(Mul64x8(current, multiplier), increment);
+    
+    return permuted_state;
+}
+
+/******************************************************************************/
+
+static inline int NextPCG64ix8AVX512(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct pcg64ix8 *pcg = (struct pcg64ix8 *) state;
+    
+    __m512i s = _mm512_loadu_si512((const void *) pcg->state);
+    const __m512i inc = _mm512_loadu_si512((const void *) pcg->increment);
+    
+    size_t i = 0;
+    
+    for (; i + LANES_X8 <= n; i += LANES_X8)
+    {
+        _mm512_storeu_si512((void *) (dest + i), StepPCG64ix8(&s, inc));
+    }
+    
+    if (i < n)
+    {
+        const __mmask8 mask = (__mmask8) ((1U << (n - i)) - 1);
+        _mm512_mask_storeu_epi64((void *) (dest + i), mask, StepPCG64ix8(&s, inc));
+    }
+    
+    _mm512_storeu_si512((void *) pcg->state, s);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+The same xoshiro256++ lanes as the AVX2 variant, with vprolq for both rotates.
+*******************************************************************************/
+static inline int NextXoshiro256x4AVX512(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct xoshiro256x4 *xos = (struct xoshiro256x4 *) state;
+    
+    __m256i s0 = _mm256_loadu_si256((const __m256i *) xos->s[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i *) xos->s[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i *) xos->s[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i *) xos->s[3]);
+    
+    for (size_t i = 0; i < n; i += LANES_X4)
+    {
+        const __m256i result = _mm256_add_epi64(_mm256_rol_epi64(_mm256_add_epi64(s0, s3), 23), s0);
+        const __m256i t = _mm256_slli_epi64(s1, 17);
+        
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_rol_epi64(s3, 45);
+        
+        if (i + LANES_X4 <= n)
+        {
+            _mm256_storeu_si256((__m256i *) (dest + i), result);
+        }
+        else
+        {
+            const __mmask8 mask = (__mmask8) ((1U << (n - i)) - 1);
+            _mm256_mask_storeu_epi64((void *) (dest + i), mask, result);
+        }
+    }
+    
+    _mm256_storeu_si256((__m256i *) xos->s[0], s0);
+    _mm256_storeu_si256((__m256i *) xos->s[1], s1);
+    _mm256_storeu_si256((__m256i *) xos->s[2], s2);
+    _mm256_storeu_si256((__m256i *) xos->s[3], s3);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+METHODS(PCG64ix8AVX512)
+METHODS(Xoshiro256x4AVX512)
+
+#pragma GCC pop_options
+
+/*******************************************************************************
+PCG64ix4 is a single four lane chain either way, so it keeps the AVX2 variant on
+AVX-512 machines.
+*******************************************************************************/
+int spki_InitPCG64ix4(spk_generator rng, uint64_t seed)
+{
+    struct pcg64ix4 *pcg = (struct pcg64ix4 *) rng->state;
+    
+    int error = SeedLanes(pcg->state, pcg->increment, LANES_X4, seed);
+    if (error) return error;
+    
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_PCG64ix4;
+    
+    if (spki_ISA() >= SPK_ISA_AVX2) HOOK(rng, PCG64ix4AVX2);
+    else HOOK(rng, PCG64ix4SISD);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spki_InitPCG64ix8(spk_generator rng, uint64_t seed)
+{
+    struct pcg64ix8 *pcg = (struct pcg64ix8 *) rng->state;
+    
+    int error = SeedLanes(pcg->state, pcg->increment, LANES_X8, seed);
+    if (error) return error;
+    
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_PCG64ix8;
+    
+    switch (spki_ISA())
+    {
+        case SPK_ISA_AVX512:
+            HOOK(rng, PCG64ix8AVX512);
+            break;
+            
+        case SPK_ISA_AVX2:
+            HOOK(rng, PCG64ix8AVX2);
+            break;
+            
+        default:
+            HOOK(rng, PCG64ix8SISD);
+            break;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Four xoshiro256++ lanes, with state word j of every lane in one register. Lane 0
+is seeded exactly like SPK_GENERATOR_XOSHIRO256 and lane k + 1 is lane k after
+Vigna's long jump, so the lanes are guaranteed disjoint for 2^192 words each.
+*******************************************************************************/
+int spki_InitXoshiro256x4(spk_generator rng, uint64_t seed)
+{
+    struct xoshiro256x4 *xos = (struct xoshiro256x4 *) rng->state;
+    spk_xoshiro256 lane;
+    
+    int error = spk_Xoshiro256Init(&lane, seed);
+    if (error) return error;
+    
+    for (size_t k = 0; k < LANES_X4; k++)
+    {
+        if (k) spk_Xoshiro256LongJump(&lane);
+        
+        for (size_t j = 0; j < 4; j++) xos->s[j][k] = lane.s[j];
+    }
+    
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_XOSHIRO256x4;
+    
+    switch (spki_ISA())
+    {
+        case SPK_ISA_AVX512:
+            HOOK(rng, Xoshiro256x4AVX512);
+            break;
+            
+        case SPK_ISA_AVX2:
+            HOOK(rng, Xoshiro256x4AVX2);
+            break;
+            
+        default:
+            HOOK(rng, Xoshiro256x4SISD);
+            break;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Philox4x32-10 from John Salmon, Mark Moraes, Ron Dror and David Shaw, "Parallel
+Random Numbers: As Easy as 1, 2, 3" (2011), with the constants of the Random123
+reference implementation. The 4x32 variant is used rather than 4x64 because its
+32 x 32 -> 64 bit multiplies map directly onto vpmuludq, whereas AVX2 has no 64
+bit high multiply at all.
+
+A block is the 128-bit output of one counter and holds two 64-bit words, counter
+words 0 and 1 of the low word first. The key and stream are drawn once from the
+seed, so every seed selects an independent stream of 2^65 words.
+*******************************************************************************/
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_ROUNDS 10
+#define PHILOX_GROUP ((size_t) 8)
+
+/*******************************************************************************
+Scalar reference for a single block, used for the unaligned head and the tail of
+a fill that is too short for a whole group, and for every group of the SISD
+variant.
+*******************************************************************************/
+static inline void BlockPhilox4x32(uint64_t key, uint64_t stream, uint64_t block, uint64_t out[2])
+{
+    uint32_t x0 = (uint32_t) block;
+    uint32_t x1 = (uint32_t) (block >> 32);
+    uint32_t x2 = (uint32_t) stream;
+    uint32_t x3 = (uint32_t) (stream >> 32);
+    uint32_t k0 = (uint32_t) key;
+    uint32_t k1 = (uint32_t) (key >> 32);
+    
+    for (int r = 0; r < PHILOX_ROUNDS; r++)
+    {
+        const uint64_t p0 = (uint64_t) PHILOX_M0 * x0;
+        const uint64_t p1 = (uint64_t) PHILOX_M1 * x2;
+        
+        x0 = (uint32_t) (p1 >> 32) ^ x1 ^ k0;
+        x1 = (uint32_t) p1;
+        x2 = (uint32_t) (p0 >> 32) ^ x3 ^ k1;
+        x3 = (uint32_t) p0;
+        
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    
+    out[0] = x0 | ((uint64_t) x1 << 32);
+    out[1] = x2 | ((uint64_t) x3 << 32);
+}
+
+/*******************************************************************************
+Words from position (block, offset) onwards. Every word is a pure function of
+the key, stream and its position, so next and spk_GeneratorAt share this code.
+The group function fills eight consecutive blocks, it is a compile time constant
+at every call site and this body is inlined into each variant.
+*******************************************************************************/
+typedef void (*philox_group)(uint64_t, uint64_t, uint64_t, uint64_t *);
+
+static inline __attribute__((always_inline)) void FillPhilox4x32
+(
+    const struct philox4x32 *philox,
+    uint64_t block,
+    uint64_t offset,
+    uint64_t *dest,
+    size_t n,
+    philox_group group
+)
+{
+    uint64_t out[2];
+    
+    if (offset && n)
+    {
+        BlockPhilox4x32(philox->key, philox->stream, block++, out);
+        *dest++ = out[1];
+        n--;
+    }
+    
+    for (; n >= 2 * PHILOX_GROUP; n -= 2 * PHILOX_GROUP)
+    {
+        group(philox->key, philox->stream, block, dest);
+        block += PHILOX_GROUP;
+        dest += 2 * PHILOX_GROUP;
+    }
+    
+    for (; n >= 2; n -= 2)
+    {
+        BlockPhilox4x32(philox->key, philox->stream, block++, dest);
+        dest += 2;
+    }
+    
+    if (n)
+    {
+        BlockPhilox4x32(philox->key, philox->stream, block, out);
+        *dest = out[0];
+    }
+}
+
+/******************************************************************************/
+
+static inline void GroupPhilox4x32SISD(uint64_t key, uint64_t stream, uint64_t block, uint64_t *dest)
+{
+    for (size_t j = 0; j < PHILOX_GROUP; j++)
+    {
+        BlockPhilox4x32(key, stream, block + j, dest + 2 * j);
+    }
+}
+
+static void FillPhilox4x32SISD(const struct philox4x32 *philox, uint64_t block, uint64_t offset, uint64_t *dest, size_t n)
+{
+    FillPhilox4x32(philox, block, offset, dest, n, GroupPhilox4x32SISD);
+}
+
+static inline int NextPhilox4x32SISD(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct philox4x32 *philox = (struct philox4x32 *) state;
+    
+    FillPhilox4x32SISD(philox, philox->block, philox->offset, dest, n);
+    spki_JumpPhilox4x32(state, (uint64_t) n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+METHODS(Philox4x32SISD)
+
+/******************************************************************************/
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+/*******************************************************************************
+Eight consecutive blocks at once. Register Xj holds counter word j of all eight
+blocks, one per 32-bit lane. vpmuludq multiplies only the even lanes, so each
+multiply is issued twice, once as is and once shifted down by 32 bits for the
+odd lanes, and the 64-bit products are blended back into high and low halves.
+
+The carry from counter word 0 into word 1 is a lane-wise unsigned compare, done
+as a signed compare after flipping the sign bits. At the end the four registers
+are transposed so that the sixteen words come out in stream order.
+
+The AVX-512 variant reuses this group as is. Compiled for that target it gets
+the EVEX encodings, sixteen more registers and three-way XORs, which is a
+measurable gain, see matrix_next_philox4x32 in the benchmarks.
+*******************************************************************************/
+static inline void GroupPhilox4x32AVX2(uint64_t key, uint64_t stream, uint64_t block, uint64_t *dest)
+{
+    const __m256i m0 = _mm256_set1_epi64x((long long) PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi64x((long long) PHILOX_M1);
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    
+    const __m256i base = _mm256_set1_epi32((int) (uint32_t) block);
+    const __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    
+    __m256i x0 = _mm256_add_epi32(base, iota);
+    const __m256i wrapped = _mm256_cmpgt_epi32(_mm256_xor_si256(base, sign), _mm256_xor_si256(x0, sign));
+    __m256i x1 = _mm256_sub_epi32(_mm256_set1_epi32((int) (uint32_t) (block >> 32)), wrapped);
+    __m256i x2 = _mm256_set1_epi32((int) (uint32_t) stream);
+    __m256i x3 = _mm256_set1_epi32((int) (uint32_t) (stream >> 32));
+    
+    uint32_t k0 = (uint32_t) key;
+    uint32_t k1 = (uint32_t) (key >> 32);
+    
+    for (int r = 0; r < PHILOX_ROUNDS; r++)
+    {
+        const __m256i p0_even = _mm256_mul_epu32(x0, m0);
+        const __m256i p0_odd = _mm256_mul_epu32(_mm256_srli_epi64(x0, 32), m0);
+        const __m256i p1_even = _mm256_mul_epu32(x2, m1);
+        const __m256i p1_odd = _mm256_mul_epu32(_mm256_srli_epi64(x2, 32), m1);
+        
+        const __m256i lo0 = _mm256_blend_epi32(p0_even, _mm256_slli_epi64(p0_odd, 32), 0xAA);
+        const __m256i hi0 = _mm256_blend_epi32(_mm256_srli_epi64(p0_even, 32), p0_odd, 0xAA);
+        const __m256i lo1 = _mm256_blend_epi32(p1_even, _mm256_slli_epi64(p1_odd, 32), 0xAA);
+        const __m256i hi1 = _mm256_blend_epi32(_mm256_srli_epi64(p1_even, 32), p1_odd, 0xAA);
+        
+        x0 = _mm256_xor_si256(_mm256_xor_si256(hi1, x1), _mm256_set1_epi32((int) k0));
+        x1 = lo1;
+        x2 = _mm256_xor_si256(_mm256_xor_si256(hi0, x3), _mm256_set1_epi32((int) k1));
+        x3 = lo0;
+        
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    
+    //a_j = x0 | x1 << 32 and c_j = x2 | x3 << 32 are the two words of block j
+    const __m256i a_lo = _mm256_unpacklo_epi32(x0, x1);
+    const __m256i a_hi = _mm256_unpackhi_epi32(x0, x1);
+    const __m256i c_lo = _mm256_unpacklo_epi32(x2, x3);
+    const __m256i c_hi = _mm256_unpackhi_epi32(x2, x3);
+    
+    const __m256i e = _mm256_unpacklo_epi64(a_lo, c_lo);
+    const __m256i f = _mm256_unpackhi_epi64(a_lo, c_lo);
+    const __m256i g = _mm256_unpacklo_epi64(a_hi, c_hi);
+    const __m256i h = _mm256_unpackhi_epi64(a_hi, c_hi);
+    
+    _mm256_storeu_si256((__m256i *) dest, _mm256_permute2x128_si256(e, f, 0x20));
+    _mm256_storeu_si256((__m256i *) (dest + 4), _mm256_permute2x128_si256(g, h, 0x20));
+    _mm256_storeu_si256((__m256i *) (dest + 8), _mm256_permute2x128_si256(e, f, 0x31));
+    _mm256_storeu_si256((__m256i *) (dest + 12), _mm256_permute2x128_si256(g, h, 0x31));
+}
+
+static void FillPhilox4x32AVX2(const struct philox4x32 *philox, uint64_t block, uint64_t offset, uint64_t *dest, size_t n)
+{
+    FillPhilox4x32(philox, block, offset, dest, n, GroupPhilox4x32AVX2);
+}
+
+static inline int NextPhilox4x32AVX2(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct philox4x32 *philox = (struct philox4x32 *) state;
+    
+    FillPhilox4x32AVX2(philox, philox->block, philox->offset, dest, n);
+    spki_JumpPhilox4x32(state, (uint64_t) n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+METHODS(Philox4x32AVX2)
+
+#pragma GCC pop_options
+
+/******************************************************************************/
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx512vl")
+
+static void FillPhilox4x32AVX512(const struct philox4x32 *philox, uint64_t block, uint64_t offset, uint64_t *dest, size_t n)
+{
+    FillPhilox4x32(philox, block, offset, dest, n, GroupPhilox4x32AVX2);
+}
+
+static inline int NextPhilox4x32AVX512(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    struct philox4x32 *philox = (struct philox4x32 *) state;
+    
+    FillPhilox4x32AVX512(philox, philox->block, philox->offset, dest, n);
+    spki_JumpPhilox4x32(state, (uint64_t) n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+METHODS(Philox4x32AVX512)
+
+#pragma GCC pop_options
+
+/******************************************************************************/
+
+int spki_InitPhilox4x32(spk_generator rng, uint64_t seed)
+{
+    struct philox4x32 *philox = (struct philox4x32 *) rng->state;
+    
+    if (seed != 0)
+    {
+        philox->key = spki_Hash(&seed);
+        philox->stream = spki_Hash(&seed);
+    }
+    else
+    {
+        int error = SPK_ERROR_UNDEFINED;
+        
+        error = spki_EntropyRetry(&philox->key, 10);
+        if (error) return error;
+        
+        error = spki_EntropyRetry(&philox->stream, 10);
+        if (error) return error;
+    }
+    
+    philox->block = 0;
+    philox->offset = 0;
+    
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_PHILOX4x32;
+    
+    switch (spki_ISA())
+    {
+        case SPK_ISA_AVX512:
+            HOOK(rng, Philox4x32AVX512);
+            break;
+            
+        case SPK_ISA_AVX2:
+            HOOK(rng, Philox4x32AVX2);
+            break;
+            
+        default:
+            HOOK(rng, Philox4x32SISD);
+            break;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+The position is a 65-bit word index split into a block and a one bit offset, so
+the jump is a single add with the carry out of the offset folded into the block.
+*******************************************************************************/
+void spki_JumpPhilox4x32(uint64_t *state, uint64_t delta)
+{
+    struct philox4x32 *philox = (struct philox4x32 *) state;
+    
+    const uint64_t sum = philox->offset + (delta & 1);
+    
+    philox->block += (delta >> 1) + (sum >> 1);
+    philox->offset = sum & 1;
+}
+
+/******************************************************************************/
+
+void spki_AtPhilox4x32(const uint64_t *state, uint64_t index, uint64_t *dest, const size_t n)
+{
+    const struct philox4x32 *philox = (const struct philox4x32 *) state;
+    
+    if (spki_ISA() >= SPK_ISA_AVX2) FillPhilox4x32AVX2(philox, index >> 1, index & 1, dest, n);
+    else FillPhilox4x32SISD(philox, index >> 1, index & 1, dest, n);
+}
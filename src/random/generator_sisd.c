@@ -4,38 +4,93 @@
 * LICS: MIT License
 */
 
+#define _POSIX_C_SOURCE 200112L //posix_memalign under -std=c99
+
 #include "generator_sisd.h"
+#include "generator_simd.h"
+#include "generator_pool.h"
+#include "generator_inline.h"
+#include "generator_internal.h"
 
 #include <assert.h>
-#include <immintrin.h> //rdrand
-#include <stdlib.h> //malloc, free, size_t
+#include <immintrin.h> //rdrand, rdseed
+#include <stdlib.h> //malloc, free, posix_memalign, size_t
+#include <string.h> //memcpy
 #include <math.h> //ldexp
+#include <sys/mman.h> //munmap
+#include <sys/random.h> //getrandom
+#include <errno.h> //errno, EINTR
 
 /*******************************************************************************
 Prototypes
 *******************************************************************************/
-static uint64_t Hash(uint64_t *value);
-static int RdRandRetry(uint64_t *x, size_t limit);
+static size_t StateSize(int identifier);
 
-static int NewPCG64i(spk_generator *rng, uint64_t seed);
+static int InitPCG64i(spk_generator rng, uint64_t seed);
+static void JumpPCG64i(uint64_t *state, uint64_t delta);
 static inline int NextPCG64i(uint64_t *state, uint64_t *dest, const size_t n);
 static int RandPCG64i(struct spk_generator *, uint64_t *, const size_t, const uint64_t, const uint64_t);
 static int BiasPCG64i(struct spk_generator *, uint64_t *, const size_t, const double, const int);
 static int UnidPCG64i(struct spk_generator *, double *, const size_t);
+static int UnifPCG64i(struct spk_generator *, float *, const size_t);
 
-static int NewXSH64(spk_generator *rng, uint64_t seed);
+static int InitXSH64(spk_generator rng, uint64_t seed);
+static void JumpXSH64(uint64_t *state, uint64_t delta);
+static uint64_t MatVecGF2(const uint64_t *matrix, uint64_t vector);
 static inline int NextXSH64(uint64_t *state, uint64_t *dest, const size_t n);
 static int RandXSH64(struct spk_generator *, uint64_t *, const size_t, const uint64_t, const uint64_t);
 static int BiasXSH64(struct spk_generator *, uint64_t *, const size_t, const double, const int);
 static int UnidXSH64(struct spk_generator *, double *, const size_t);
+static int UnifXSH64(struct spk_generator *, float *, const size_t);
+
+static int SeedWords(uint64_t *s, const size_t words, uint64_t seed);
+
+static int InitRdRand(spk_generator rng, uint64_t seed);
+static inline int StepRdRand(unsigned long long *x);
+static inline int StepRdSeed(unsigned long long *x);
+static inline int FillHardware(int (*step)(unsigned long long *), size_t retry, uint64_t *dest, const size_t n);
+static int NextRdRand(uint64_t *state, uint64_t *dest, const size_t n);
+static int RandRdRand(struct spk_generator *, uint64_t *, const size_t, const uint64_t, const uint64_t);
+static int BiasRdRand(struct spk_generator *, uint64_t *, const size_t, const double, const int);
+static int UnidRdRand(struct spk_generator *, double *, const size_t);
+static int UnifRdRand(struct spk_generator *, float *, const size_t);
+
+static int InitXoshiro256(spk_generator rng, uint64_t seed);
+static void JumpXoshiro256(uint64_t *state, uint64_t delta);
+static inline int NextXoshiro256(uint64_t *state, uint64_t *dest, const size_t n);
+static int RandXoshiro256(struct spk_generator *, uint64_t *, const size_t, const uint64_t, const uint64_t);
+static int BiasXoshiro256(struct spk_generator *, uint64_t *, const size_t, const double, const int);
+static int UnidXoshiro256(struct spk_generator *, double *, const size_t);
+static int UnifXoshiro256(struct spk_generator *, float *, const size_t);
+
+static int InitXoroshiro128(spk_generator rng, uint64_t seed);
+static void JumpXoroshiro128(uint64_t *state, uint64_t delta);
+static inline int NextXoroshiro128(uint64_t *state, uint64_t *dest, const size_t n);
+static int RandXoroshiro128(struct spk_generator *, uint64_t *, const size_t, const uint64_t, const uint64_t);
+static int BiasXoroshiro128(struct spk_generator *, uint64_t *, const size_t, const double, const int);
+static int UnidXoroshiro128(struct spk_generator *, double *, const size_t);
+static int UnifXoroshiro128(struct spk_generator *, float *, const size_t);
+
+static void StoreLE(unsigned char *dest, uint64_t value, size_t bytes);
+static uint64_t LoadLE(const unsigned char *src, size_t bytes);
+static void StoreVersion(unsigned char *dest, const char *magic);
+static int CheckVersion(const unsigned char *src, const char *magic);
+static int ParseRecord(const unsigned char *src, size_t size, int *identifier);
+static int RestoreRecord(void *mem, const unsigned char *src, int identifier);
+
+static uint64_t SpreadGF2(uint32_t half);
+static void PowerModGF2(const uint64_t *poly, const size_t words, uint64_t exponent, uint64_t *result);
+static void ApplyXoshiro256(spk_xoshiro256 *xos, const uint64_t *coefficients);
+static void ApplyXoroshiro128(spk_xoroshiro128 *xor, const uint64_t *coefficients);
 
 /*******************************************************************************
 Sebastiano Vigna's version of Java SplittableRandom. This is used as a one-off 
 mixing function for seeding, so the state increment from Vigna's original code
 is removed in favor of an overwriting call by reference. For references, see:
 http://xoshiro.di.unimi.it/splitmix64.c, http://prng.di.unimi.it/splitmix64.c.
+It is shared with the other random submodules via generator_internal.h.
 *******************************************************************************/
-static uint64_t Hash(uint64_t *value)
+uint64_t spki_Hash(uint64_t *value)
 {    
     uint64_t i = *value;
     
@@ -55,14 +110,34 @@ The rdrand instruction is used to seed all generators when non-deterministic
 behavior is requested. Per Intel documentation, the rdrand instruction must be 
 retried ten times on the rare chance that underflow occurs. The limit param is
 available if AMD guidelines differ. The ULL cast is to silence some GCC warnings
-since uint64_t is an unsigned long on some machines.
+since uint64_t is an unsigned long on some machines. The library is not built
+with -mrdrnd, so the instruction is enabled for this function alone.
 
-TODO: see concerns about rdrand here, we may want to replace it with something
-else. https://cr.yp.to/talks/2014.05.16/slides-dan+tanja-20140516-4x3.pdf
-perhaps an internal LCG which uses a high-res counter coupled with ASLR.
+A CPU without rdrand is seeded from the kernel with getrandom instead, which
+blocks only until the entropy pool is first initialized at boot. The kernel
+pool also answers the concerns about trusting a single on-chip source, see
+https://cr.yp.to/talks/2014.05.16/slides-dan+tanja-20140516-4x3.pdf
 *******************************************************************************/
-static int RdRandRetry(uint64_t *x, size_t limit)
-{    
+static int GetRandom(uint64_t *x)
+{
+    unsigned char *bytes = (unsigned char *) x;
+    size_t filled = 0;
+    
+    while (filled < sizeof(uint64_t))
+    {
+        const ssize_t got = getrandom(bytes + filled, sizeof(uint64_t) - filled, 0);
+        
+        if (got > 0) filled += (size_t) got;
+        else if (got == -1 && errno != EINTR) return SPK_ERROR_RDRAND;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+__attribute__((target("rdrnd"))) int spki_EntropyRetry(uint64_t *x, size_t limit)
+{
+    if (!(spki_CPUFeatures() & SPKI_CPU_RDRAND)) return GetRandom(x);
+    
     for (size_t i = 0; i < limit; i++)
     {
         if (_rdrand64_step((unsigned long long *) x))
@@ -75,444 +150,1688 @@ static int RdRandRetry(uint64_t *x, size_t limit)
 }
 
 /*******************************************************************************
-Free a random number generator
+Free a random number generator, a pool also owns the mapping of its file
 *******************************************************************************/
 void spk_GeneratorDelete(spk_generator rng)
 {
+    if (rng && rng->identifier == SPK_GENERATOR_POOL)
+    {
+        struct spki_pool *pool = (struct spki_pool *) rng->state;
+        munmap(pool->map, pool->length);
+    }
+    
     free(rng);
 }
 
 /*******************************************************************************
-Dynamically allocate a new random number generator
+A generator is the interface followed immediately by its state, so the total
+footprint is known from the identifier alone. Placement is up to the caller.
 *******************************************************************************/
 #define SIZEOF_INTERFACE (sizeof(struct spk_generator))
 
-int spk_GeneratorNew(spk_generator *rng, int identifier, uint64_t seed)
+size_t spk_GeneratorSize(int identifier)
 {
+    const size_t size = StateSize(identifier);
+    
+    return size ? SIZEOF_INTERFACE + size : 0;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorInit(void *mem, int identifier, uint64_t seed)
+{
+    assert(mem);
+    assert((uintptr_t) mem % sizeof(uint64_t) == 0);
+    
+    spk_generator rng = mem;
+    
     switch (identifier)
     {
         case SPK_GENERATOR_PCG64i:
-            return NewPCG64i(rng, seed);
+            return InitPCG64i(rng, seed);
             break;
             
         case SPK_GENERATOR_XSH64:
-            return NewXSH64(rng, seed);
+            return InitXSH64(rng, seed);
+            break;
+            
+        case SPK_GENERATOR_XOSHIRO256:
+            return InitXoshiro256(rng, seed);
+            break;
+            
+        case SPK_GENERATOR_XOROSHIRO128:
+            return InitXoroshiro128(rng, seed);
+            break;
+            
+        case SPK_GENERATOR_RDRAND:
+            return InitRdRand(rng, seed);
+            break;
+            
+        case SPK_GENERATOR_XOSHIRO256x4:
+            return spki_InitXoshiro256x4(rng, seed);
+            break;
+            
+        case SPK_GENERATOR_PCG64ix4:
+            return spki_InitPCG64ix4(rng, seed);
+            break;
+            
+        case SPK_GENERATOR_PCG64ix8:
+            return spki_InitPCG64ix8(rng, seed);
+            break;
+            
+        case SPK_GENERATOR_PHILOX4x32:
+            return spki_InitPhilox4x32(rng, seed);
             break;
             
         default:
-            return SPK_ERROR_ARGBOUNDS;
+            return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorInit", "unknown generator %d", identifier);
     }
 }
 
 /*******************************************************************************
-Initialize a pcg64i generator
+Dynamically allocate a new random number generator
 *******************************************************************************/
-struct pcg64i
+int spk_GeneratorNew(spk_generator *rng, int identifier, uint64_t seed)
 {
-    uint64_t state;
-    uint64_t increment;
-};
+    const size_t size = spk_GeneratorSize(identifier);
+    if (size == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorNew", "unknown generator %d", identifier);
+    
+    *rng = malloc(size);
+    if (!(*rng)) return SPK_ERROR_STDMALLOC;
+    
+    int error = spk_GeneratorInit(*rng, identifier, seed);
+    
+    if (error)
+    {
+        free(*rng);
+        *rng = NULL;
+        return error;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
 
-#define SIZEOF_PCG64I (sizeof(struct pcg64i))
+/*******************************************************************************
+Lay out n generators back to back in one cache aligned block. The stride rounds
+each generator up to a whole number of cache lines, so that two generators never
+share a line and threads working on neighbours don't false share.
+*******************************************************************************/
+#define STRIDE(size) (((size) + SPK_GENERATOR_ALIGN - 1) & ~((size_t) SPK_GENERATOR_ALIGN - 1))
 
-static int NewPCG64i(spk_generator *rng, uint64_t seed)
+int spk_GeneratorArrayNew(spk_generator out[], size_t n, int identifier, uint64_t seed)
 {
-    *rng = malloc(SIZEOF_INTERFACE + SIZEOF_PCG64I);
-    if (!(*rng)) return SPK_ERROR_STDMALLOC;
+    const char *where = "spk_GeneratorArrayNew";
     
-    struct pcg64i *pcg = (struct pcg64i *) (*rng)->state;
+    if (n == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "empty array");
     
-    if (seed != 0)
+    const size_t size = spk_GeneratorSize(identifier);
+    if (size == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "unknown generator %d", identifier);
+    
+    const size_t stride = STRIDE(size);
+    if (n > SIZE_MAX / stride) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "%zu generators overflow size_t", n);
+    
+    void *block = NULL;
+    if (posix_memalign(&block, SPK_GENERATOR_ALIGN, n * stride)) return SPK_ERROR_STDMALLOC;
+    
+    int error = spk_GeneratorInit(block, identifier, seed);
+    
+    if (error)
     {
-       pcg->state = Hash(&seed);
-       pcg->increment = Hash(&seed);
+        free(block);
+        return error;
     }
-    else
+    
+    //same placement as spk_GeneratorSplit
+    const uint64_t spacing = UINT64_MAX / (uint64_t) n;
+    
+    for (size_t i = 0; i < n; i++)
     {
-        int error = SPK_ERROR_UNDEFINED;
+        out[i] = (spk_generator) ((char *) block + i * stride);
         
-        error = RdRandRetry(&pcg->state, 10);
-        if (error) return error;
+        if (i == 0) continue;
         
-        error = RdRandRetry(&pcg->increment, 10);
-        if (error) return error;
+        memcpy(out[i], out[0], size);
+        spk_GeneratorJump(out[i], spacing * (uint64_t) i);
     }
     
-    //PCG increment must be odd
-    pcg->increment |= 1;
-    
-    //hook in methods
-    (*rng)->next = NextPCG64i;
-    (*rng)->rand = RandPCG64i;
-    (*rng)->bias = BiasPCG64i;
-    (*rng)->unid = UnidPCG64i;
-    
     return SPK_ERROR_SUCCESS;
 }
 
-/*******************************************************************************
-Initialize a xsh64 generator
-*******************************************************************************/
-struct xsh64
+/******************************************************************************/
+
+void spk_GeneratorArrayDelete(spk_generator arr[])
 {
-    uint64_t state;
-};
+    if (arr) free(arr[0]);
+}
 
-#define SIZEOF_XSH64 (sizeof(struct xsh64))
+/*******************************************************************************
+Seed sequences pay for rdrand at most once. Every further seed is the splitmix64
+output for the next multiple of the golden gamma, i.e. the full Vigna generator
+rather than the bare mixing function in spki_Hash, so the seeds can't fall into
+a short cycle. Each seed then goes through the usual spki_Hash seeding chain.
+*******************************************************************************/
+#define GOLDEN_GAMMA 0x9E3779B97F4A7C15ULL
 
-static int NewXSH64(spk_generator *rng, uint64_t seed)
+int spk_SeedSequenceInit(spk_seed_sequence *seq, uint64_t entropy)
 {
-    *rng = malloc(SIZEOF_INTERFACE + SIZEOF_XSH64);
-    if (!(*rng)) return SPK_ERROR_STDMALLOC;
-    
-    struct xsh64 *xsh = (struct xsh64 *) (*rng)->state;
+    assert(seq);
     
-    if (seed != 0)
-    {
-       xsh->state = Hash(&seed);
-    }
-    else
+    if (entropy == 0)
     {
-        int error = SPK_ERROR_UNDEFINED;
-        
-        error = RdRandRetry(&xsh->state, 10);
+        int error = spki_EntropyRetry(&entropy, 10);
         if (error) return error;
     }
     
-    //hook in methods
-    (*rng)->next = NextXSH64;
-    (*rng)->rand = RandXSH64;
-    (*rng)->bias = BiasXSH64;
-    (*rng)->unid = UnidXSH64;
+    seq->state = entropy;
     
     return SPK_ERROR_SUCCESS;
 }
 
-/*******************************************************************************
-The following function is originally Copyright 2014 Melissa O'Neill, which is
-licensed under the Apache License, Version 2.0. PCG was licensed under the 
-Apache License, Version 2.0 (the "License"); You may obtain a copy of the 
-License at http://www.apache.org/licenses/LICENSE-2.0
+/******************************************************************************/
+
+uint64_t spk_SeedSequenceNext(spk_seed_sequence *seq)
+{
+    assert(seq);
+    
+    uint64_t seed = 0;
+    
+    //zero requests rdrand seeding downstream, so skip it
+    while (seed == 0)
+    {
+        seq->state += GOLDEN_GAMMA;
+        seed = seq->state;
+        spki_Hash(&seed);
+    }
+    
+    return seed;
+}
 
-This block of code is the default insecure 64-bit output PCG denoted commonly 
-as pcg_output_rxs_m_xs_64_64. This function exhibits the following modifications
-from the original source written by Melissa O'Neill.
+/******************************************************************************/
 
-All credit for the design, theory, and innovations of the PCG family is due to
-Melissa O'Neill, you can find a copy of the original source at her website,
-https://www.pcg-random.org/
+int spk_GeneratorNewFromSequence
+(
+    spk_generator *rng,
+    int identifier,
+    spk_seed_sequence *seq
+)
+{
+    return spk_GeneratorNew(rng, identifier, spk_SeedSequenceNext(seq));
+}
 
-1. The original seeding mechanism via either dev/urandom or address space
-layout randomization has been replaced with x86 rdrand and/or seed hashing.
+/******************************************************************************/
 
-2. The preprocssor macros from O'Neill have been replaced, decimal constants
-were swapped for hex, and variable names have been changed. These modifications
-are made to engender simplicity.
+int spk_GeneratorInitFromSequence
+(
+    void *mem,
+    int identifier,
+    spk_seed_sequence *seq
+)
+{
+    return spk_GeneratorInit(mem, identifier, spk_SeedSequenceNext(seq));
+}
 
-3. A data buffer is filled to reduce latency due to static library usage, since
-link time optimization alone does not result in sufficient speed gains.
+/*******************************************************************************
+A pool has its whole stream on disk, so a jump is a cursor move and the cursor
+stops at the end rather than wrapping. Random access takes the index in the
+stream of the source generator, so spk_GeneratorAt on a raw pool returns what
+the same call would have returned on a counter-based source.
 *******************************************************************************/
-static inline int NextPCG64i(uint64_t *state, uint64_t *dest, const size_t n)
+static void JumpPool(uint64_t *state, uint64_t delta)
 {
-    struct pcg64i *pcg = (struct pcg64i *) state;    
-    uint64_t permuted_state = 0;
+    struct spki_pool *pool = (struct spki_pool *) state;
+    const uint64_t remaining = pool->count - pool->cursor;
     
-    for (size_t i = 0; i < n; i++)
+    pool->cursor += delta < remaining ? delta : remaining;
+}
+
+/******************************************************************************/
+
+static int AtPool(const uint64_t *state, uint64_t index, uint64_t *dest, const size_t n)
+{
+    const struct spki_pool *pool = (const struct spki_pool *) state;
+    
+    const char *where = "spk_GeneratorAt";
+    
+    if (pool->kind != SPK_POOL_NEXT) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "a unid pool holds no raw words");
+    
+    const uint64_t offset = index - pool->position;
+    
+    if (index < pool->position || offset > pool->count || n > pool->count - offset)
     {
-        //permute the current state
-        permuted_state = pcg->state >> 59ULL;
-        permuted_state += 5ULL;
-        permuted_state = pcg->state >> permuted_state;
-        permuted_state ^= pcg->state;
-        permuted_state *= 0xAEF17502108EF2D9ULL;
-        permuted_state ^= (permuted_state >> 43ULL);
-        
-        //update internal state
-        pcg->state = pcg->state * 0x5851F42D4C957F2DULL + pcg->increment;
-        
-        //track output
-        dest[i] = permuted_state;
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "%zu words from %" PRIu64 " are not in the pool", n, index);
     }
     
+    memcpy(dest, pool->data + offset, n * sizeof(uint64_t));
+    
     return SPK_ERROR_SUCCESS;
 }
 
 /*******************************************************************************
-* xorshift 64-bit by George Marsaglia
+Jump ahead and split. Every generator implements the jump in O(log delta) by
+composing its state transition with itself, see JumpPCG64i and JumpXSH64. The
+split is then just a series of copies spaced evenly across the period.
 *******************************************************************************/
-static inline int NextXSH64(uint64_t *state, uint64_t *dest, const size_t n)
+int spk_GeneratorJump(spk_generator rng, uint64_t delta)
 {
-    struct xsh64 *xsh = (struct xsh64 *) state;
-    
-    for (size_t i = 0; i < n; i++)
+    switch (rng->identifier)
     {
-        xsh->state ^= xsh->state << 13;
-        xsh->state ^= xsh->state >> 7;
-        xsh->state ^= xsh->state << 17;
-        
-        dest[i] = xsh->state;
+        case SPK_GENERATOR_PCG64i:
+            JumpPCG64i(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_XSH64:
+            JumpXSH64(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_XOSHIRO256:
+            JumpXoshiro256(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_XOROSHIRO128:
+            JumpXoroshiro128(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_RDRAND:
+            break;
+            
+        case SPK_GENERATOR_XOSHIRO256x4:
+            spki_JumpXoshiro256x4(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_PCG64ix4:
+            spki_JumpPCG64ix4(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_PCG64ix8:
+            spki_JumpPCG64ix8(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_PHILOX4x32:
+            spki_JumpPhilox4x32(rng->state, delta);
+            break;
+            
+        case SPK_GENERATOR_POOL:
+            JumpPool(rng->state, delta);
+            break;
+            
+        default:
+            return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorJump", "generator %d cannot jump", rng->identifier);
     }
     
     return SPK_ERROR_SUCCESS;
 }
 
 /*******************************************************************************
-random integers, aka discrete uniform variates. This is an unbiased variant via
-rejection sampling. It includes a variable lower bound.
-
-TODO: attempt to use remaining upper bits after rejection.
-*/
-static int RandPCG64i
+Random access only makes sense for generators whose output is a function of the
+position. Sequential generators would have to replay from the seed, which they
+no longer have, so they are rejected rather than answered relative to now.
+*******************************************************************************/
+int spk_GeneratorAt
 (
-    struct spk_generator *rng,
+    const spk_generator rng,
+    uint64_t index,
     uint64_t *dest,
-    const size_t n,
-    const uint64_t min,
-    const uint64_t max
+    const size_t n
 )
 {
-    uint64_t output = 0;
-    const uint64_t ceil = max - min;
-    const uint64_t mask = ~((uint64_t) 0) >> __builtin_clzll(ceil);
-    uint64_t *rng_state = rng->state;
+    assert(rng);
+    assert(dest);
     
-    for (size_t i = 0; i < n; i++)
+    switch (rng->identifier)
     {
-        do
-        {
-            NextPCG64i(rng_state, &output, 1);
-            output &= mask;
-        }
-        while (output > ceil);
-        
-        dest[i] = output + min;
+        case SPK_GENERATOR_PHILOX4x32:
+            spki_AtPhilox4x32(rng->state, index, dest, n);
+            break;
+            
+        case SPK_GENERATOR_POOL:
+            return AtPool(rng->state, index, dest, n);
+            
+        default:
+            return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorAt", "generator %d has no random access", rng->identifier);
     }
     
-    return SPK_ERROR_SUCCESS;;
+    return SPK_ERROR_SUCCESS;
 }
 
+/******************************************************************************/
 
-
-static int RandXSH64
-(
-    struct spk_generator *rng,
-    uint64_t *dest,
-    const size_t n,
-    const uint64_t min,
-    const uint64_t max
-)
+int spk_GeneratorSplit(spk_generator rng, size_t k, spk_generator out[])
 {
-    uint64_t outp = 0;
-    const uint64_t ceil = max - min;
-    const uint64_t mask = ~((uint64_t) 0) >> __builtin_clzll(ceil);
-    uint64_t *rng_state = rng->state;
+    if (k == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorSplit", "zero copies");
     
-    for (size_t i = 0; i < n; i++)
+    const size_t size = StateSize(rng->identifier);
+    if (size == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorSplit", "generator %d cannot be split", rng->identifier);
+    
+    const uint64_t spacing = UINT64_MAX / (uint64_t) k;
+    
+    for (size_t i = 0; i < k; i++)
     {
-        do
+        out[i] = malloc(SIZEOF_INTERFACE + size);
+        
+        if (!out[i])
         {
-            NextXSH64(rng_state, &outp, 1);
-            outp = outp & mask;
+            while (i--) spk_GeneratorDelete(out[i]);
+            return SPK_ERROR_STDMALLOC;
         }
-        while (outp > ceil);
         
-        dest[i] = outp + min;
+        memcpy(out[i], rng, SIZEOF_INTERFACE + size);
+        spk_GeneratorJump(out[i], spacing * (uint64_t) i);
     }
     
-    return SPK_ERROR_SUCCESS;;
+    return SPK_ERROR_SUCCESS;
 }
 
 /*******************************************************************************
-Use a virtual accumulator machine to simultaneously generate 64 iid bernoulli
-trials without the SIMD instruction set. I wrote a short essay at the following
-url: https://stackoverflow.com/questions/35795110/ (username Ollie) which uses
-256 bit resolution to demonstrate the main concepts.
+Serialization. Every field is written byte by byte with shifts, so the layout is
+little-endian on any host and dest needs no alignment. The state words are the
+state[] member verbatim, which already holds everything a generator needs to
+resume, lane counters and Philox offsets included. Restoring is an ordinary
+init, to hook in the methods, followed by an overwrite of the state.
+*******************************************************************************/
+#define MAGIC_ONE "SPKG"
+#define MAGIC_ARRAY "SPKA"
 
-To give some additional detail on why this works, consider a binary tree with
-double values where all left children are half the value of the parent, and all
-right children are P + (.5 - .5P). With a root value of 0.5, the traversal path
-taken to a desired probability maps precisely to a compact binary representation
-when AND=0 and OR=1.
+static void StoreLE(unsigned char *dest, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) dest[i] = (unsigned char) (value >> (8 * i));
+}
 
-                                    ORI
-                                     |
-                                     v
-                                    0.5
-                                     |
-                  _______AND_________|________OR________
-                 |                                      |
-                .25                                    .75
-                 |                                      |
-      ____AND____|____OR____                 ____AND____|____OR____
-     |                      |               |                      |
-   .125                   .625            .325                   .875
-     |                      |               |                      |
-     |                      |               |                      |
-    ...                    ...             ...                    ...
+static uint64_t LoadLE(const unsigned char *src, size_t bytes)
+{
+    uint64_t value = 0;
     
-Therefore, for some p = n/(2^m), n unpacks from its compact binary and can be
-read from the first nonzero LSB to MSB as the exact traversal starting at the
-root node. Or, alternatively, the bit trie expansion of the numerator n gives
-the very same bitcode.
-
-So given a generator that outputs unbiased bits, we can psuedo-vectorized the
-production of biased bits with at most log2(m) calls to the generator for some
-resolution 2^m. Although this is more wasteful from an information theoretic
-view than running an arithmetic decoder, it is almost certainly faster.
+    for (size_t i = 0; i < bytes; i++) value |= (uint64_t) src[i] << (8 * i);
+    
+    return value;
+}
 
-In probablity, nodes map to some event given a sequence of bernoulli trials.
-i.e,. .875 is the event of at least one success. 0.625 is the event where either
-the first two trials are both successful, or the final trial is successful.
+/******************************************************************************/
 
-Implementation details
-- a probability below 1/2^m collapses to zero, hence the ctzll protection
-- VLA holds total raw output words needed on each inner loop
+static void StoreVersion(unsigned char *dest, const char *magic)
+{
+    memcpy(dest, magic, 4);
+    dest[4] = SPK_GENERATOR_SERIAL_VERSION;
+    dest[5] = SPK_MAJOR;
+    dest[6] = SPK_MINOR;
+    dest[7] = SPK_PATCH;
+}
 
-TODO
-- optimize to jump table over each byte
-- further optimize with mmap just-in-time compilation
-*/
-static int BiasPCG64i
-(
-    spk_generator rng,
-    uint64_t *dest,
-    const size_t n,
-    const double p,
-    const int exp
-)
+//the writer's library version is informational, only the layout must match
+static int CheckVersion(const unsigned char *src, const char *magic)
 {
-    if (p < 0.0 || p >= 1.0) return SPK_ERROR_ARGBOUNDS;
-    if (exp <= 0 || exp >= 65) return SPK_ERROR_ARGBOUNDS;
+    if (memcmp(src, magic, 4) != 0) return SPK_ERROR_FORMAT;
+    if (src[4] != SPK_GENERATOR_SERIAL_VERSION) return SPK_ERROR_FORMAT;
     
-    //registers
-    uint64_t RAX = 0;
-    int PC = 0;
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+size_t spk_GeneratorSerializedSize(int identifier)
+{
+    const size_t size = StateSize(identifier);
     
-    //program instructions - shift out dummy ORI instructions at head
-    const uint64_t path = (uint64_t) ldexp(p, exp);
-    const uint64_t bitcode = path >> __builtin_ctzll(path|1);
-    const int limit = exp - __builtin_ctzll(path|1);
+    return size ? SPK_GENERATOR_SERIAL_HEADER + size : 0;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorSerialize(const spk_generator rng, unsigned char *dest, size_t capacity)
+{
+    assert(rng);
+    assert(dest);
     
-    //program data - populated by generator next method
-    uint64_t *rng_state = rng->state;
-    uint64_t data[limit];
+    const size_t size = StateSize(rng->identifier);
     
-    for (size_t i = 0; i < n; i++)
+    if (size == 0 || capacity < SPK_GENERATOR_SERIAL_HEADER + size)
     {
-        NextPCG64i(rng_state, data, (size_t) limit);
-        
-        while (PC < limit)
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorSerialize", "generator %d in %zu bytes", rng->identifier, capacity);
+    }
+    
+    const size_t words = size / sizeof(uint64_t);
+    
+    StoreVersion(dest, MAGIC_ONE);
+    StoreLE(dest + 8, (uint64_t) (uint32_t) rng->identifier, 4);
+    StoreLE(dest + 12, (uint64_t) words, 4);
+    
+    for (size_t i = 0; i < words; i++)
+    {
+        StoreLE(dest + SPK_GENERATOR_SERIAL_HEADER + 8 * i, rng->state[i], 8);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Validate one record and return its identifier. The word count is redundant with
+the identifier, but checking it catches snapshots from a build where the state
+of some generator had a different size.
+*******************************************************************************/
+static int ParseRecord(const unsigned char *src, size_t size, int *identifier)
+{
+    if (size < SPK_GENERATOR_SERIAL_HEADER) return SPK_ERROR_FORMAT;
+    
+    int error = CheckVersion(src, MAGIC_ONE);
+    if (error) return error;
+    
+    const uint64_t tag = LoadLE(src + 8, 4);
+    const uint64_t words = LoadLE(src + 12, 4);
+    
+    if (tag > INT32_MAX) return SPK_ERROR_FORMAT;
+    
+    const size_t state = StateSize((int) tag);
+    
+    if (state == 0 || words != state / sizeof(uint64_t)) return SPK_ERROR_FORMAT;
+    if (size < SPK_GENERATOR_SERIAL_HEADER + state) return SPK_ERROR_FORMAT;
+    
+    *identifier = (int) tag;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static int RestoreRecord(void *mem, const unsigned char *src, int identifier)
+{
+    spk_generator rng = mem;
+    
+    //any nonzero seed, the state is overwritten and rdrand is never touched
+    int error = spk_GeneratorInit(mem, identifier, 1);
+    if (error) return error;
+    
+    //a hardware source has nothing to resume, keep the unit detected on this CPU
+    if (identifier == SPK_GENERATOR_RDRAND) return SPK_ERROR_SUCCESS;
+    
+    const size_t words = StateSize(identifier) / sizeof(uint64_t);
+    
+    for (size_t i = 0; i < words; i++)
+    {
+        rng->state[i] = LoadLE(src + SPK_GENERATOR_SERIAL_HEADER + 8 * i, 8);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorDeserialize(spk_generator *rng, const unsigned char *src, size_t size)
+{
+    assert(rng);
+    assert(src);
+    
+    int identifier = 0;
+    
+    int error = ParseRecord(src, size, &identifier);
+    if (error) return spki_Fail(error, "spk_GeneratorDeserialize", "%zu bytes are not a generator record", size);
+    
+    *rng = malloc(spk_GeneratorSize(identifier));
+    if (!(*rng)) return SPK_ERROR_STDMALLOC;
+    
+    error = RestoreRecord(*rng, src, identifier);
+    
+    if (error)
+    {
+        free(*rng);
+        *rng = NULL;
+        return error;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+size_t spk_GeneratorArraySerializedSize(int identifier, size_t n)
+{
+    const size_t record = spk_GeneratorSerializedSize(identifier);
+    
+    if (record == 0) return 0;
+    if (n > (SIZE_MAX - SPK_GENERATOR_SERIAL_HEADER) / record) return 0;
+    
+    return SPK_GENERATOR_SERIAL_HEADER + n * record;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorArraySerialize
+(
+    const spk_generator arr[],
+    size_t n,
+    unsigned char *dest,
+    size_t capacity
+)
+{
+    assert(arr);
+    assert(dest);
+    
+    const char *where = "spk_GeneratorArraySerialize";
+    
+    if (n == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "empty array");
+    
+    const int identifier = arr[0]->identifier;
+    const size_t record = spk_GeneratorSerializedSize(identifier);
+    const size_t total = spk_GeneratorArraySerializedSize(identifier, n);
+    
+    if (total == 0 || capacity < total)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "%zu of generator %d in %zu bytes", n, identifier, capacity);
+    }
+    
+    for (size_t i = 1; i < n; i++)
+    {
+        if (arr[i]->identifier != identifier)
         {
-            switch ((bitcode >> PC) & 0x1)
-            {
-                case 0:
-                    RAX &= data[PC++];
-                    break;
-                    
-                case 1:
-                    RAX |= data[PC++];
-                    break;
-            }
+            return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "generator %zu is not a %d", i, identifier);
         }
+    }
+    
+    StoreVersion(dest, MAGIC_ARRAY);
+    StoreLE(dest + 8, (uint64_t) n, 8);
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        unsigned char *slot = dest + SPK_GENERATOR_SERIAL_HEADER + i * record;
         
-        dest[i] = RAX;
-        RAX = 0;
-        PC = 0;
+        int error = spk_GeneratorSerialize(arr[i], slot, record);
+        if (error) return error;
     }
     
     return SPK_ERROR_SUCCESS;
 }
 
-
-
-static int BiasXSH64
+/*******************************************************************************
+The records go into the same cache line strided block as spk_GeneratorArrayNew,
+so the restored array and a freshly built one are interchangeable.
+*******************************************************************************/
+int spk_GeneratorArrayDeserialize
 (
-    spk_generator rng,
-    uint64_t *dest,
-    const size_t n,
-    const double p,
-    const int exp
+    spk_generator out[],
+    size_t n,
+    const unsigned char *src,
+    size_t size
 )
 {
-    if (p < 0.0 || p >= 1.0) return SPK_ERROR_ARGBOUNDS;
-    if (exp <= 0 || exp >= 65) return SPK_ERROR_ARGBOUNDS;
+    assert(out);
+    assert(src);
+    
+    const char *where = "spk_GeneratorArrayDeserialize";
+    
+    if (n == 0) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "empty array");
+    
+    if (size < SPK_GENERATOR_SERIAL_HEADER || CheckVersion(src, MAGIC_ARRAY))
+    {
+        return spki_Fail(SPK_ERROR_FORMAT, where, "%zu bytes are not a generator array", size);
+    }
     
-    //registers
-    uint64_t RAX = 0;
-    int PC = 0;
+    if (LoadLE(src + 8, 8) != (uint64_t) n)
+    {
+        return spki_Fail(SPK_ERROR_FORMAT, where, "array holds %" PRIu64 " generators, not %zu", LoadLE(src + 8, 8), n);
+    }
+    
+    //the first record fixes the identifier and so the size of every record
+    int identifier = 0;
+    
+    int error = ParseRecord(src + SPK_GENERATOR_SERIAL_HEADER, size - SPK_GENERATOR_SERIAL_HEADER, &identifier);
+    if (error) return spki_Fail(error, where, "record 0 is malformed");
+    
+    const size_t record = spk_GeneratorSerializedSize(identifier);
+    const size_t total = spk_GeneratorArraySerializedSize(identifier, n);
+    
+    if (total == 0 || size < total)
+    {
+        return spki_Fail(SPK_ERROR_FORMAT, where, "%zu bytes are short of the %zu needed", size, total);
+    }
     
-    //program instructions - shift out dummy ORI instructions at head
-    const uint64_t path = (uint64_t) ldexp(p, exp);
-    const uint64_t bitcode = path >> __builtin_ctzll(path|1);
-    const int limit = exp - __builtin_ctzll(path|1);
+    for (size_t i = 1; i < n; i++)
+    {
+        int other = 0;
+        
+        error = ParseRecord(src + SPK_GENERATOR_SERIAL_HEADER + i * record, record, &other);
+        
+        if (error || other != identifier)
+        {
+            return spki_Fail(SPK_ERROR_FORMAT, where, "record %zu is malformed or of another generator", i);
+        }
+    }
     
-    //program data - populated by generator next method
-    uint64_t *rng_state = rng->state;
-    uint64_t data[limit];
+    const size_t stride = STRIDE(spk_GeneratorSize(identifier));
+    if (n > SIZE_MAX / stride) return spki_Fail(SPK_ERROR_ARGBOUNDS, where, "%zu generators overflow size_t", n);
+    
+    void *block = NULL;
+    if (posix_memalign(&block, SPK_GENERATOR_ALIGN, n * stride)) return SPK_ERROR_STDMALLOC;
     
     for (size_t i = 0; i < n; i++)
     {
-        NextXSH64(rng_state, data, (size_t) limit);
+        out[i] = (spk_generator) ((char *) block + i * stride);
+        
+        error = RestoreRecord(out[i], src + SPK_GENERATOR_SERIAL_HEADER + i * record, identifier);
         
-        while (PC < limit)
+        if (error)
         {
-            switch ((bitcode >> PC) & 0x1)
-            {
-                case 0:
-                    RAX &= data[PC++];
-                    break;
-                    
-                case 1:
-                    RAX |= data[PC++];
-                    break;
-            }
+            free(block);
+            return error;
         }
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Initialize a pcg64i generator, the state[] member is a spk_pcg64i
+*******************************************************************************/
+#define SIZEOF_PCG64I (sizeof(spk_pcg64i))
+
+static int InitPCG64i(spk_generator rng, uint64_t seed)
+{
+    int error = spk_PCG64iInit((spk_pcg64i *) rng->state, seed);
+    if (error) return error;
+    
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_PCG64i;
+    rng->next = NextPCG64i;
+    rng->rand = RandPCG64i;
+    rng->bias = BiasPCG64i;
+    rng->unid = UnidPCG64i;
+    rng->unif = UnifPCG64i;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_PCG64iInit(spk_pcg64i *pcg, uint64_t seed)
+{
+    assert(pcg);
+    
+    if (seed != 0)
+    {
+       pcg->state = spki_Hash(&seed);
+       pcg->increment = spki_Hash(&seed);
+    }
+    else
+    {
+        int error = SPK_ERROR_UNDEFINED;
+        
+        error = spki_EntropyRetry(&pcg->state, 10);
+        if (error) return error;
         
-        dest[i] = RAX;
-        RAX = 0;
-        PC = 0;
+        error = spki_EntropyRetry(&pcg->increment, 10);
+        if (error) return error;
     }
     
+    //PCG increment must be odd
+    pcg->increment |= 1;
+    
     return SPK_ERROR_SUCCESS;
 }
 
 /*******************************************************************************
-Convert raw generator output to doubles in the unit interval. For speed, we need
-to make just one call to the generator next method. For memory, we should try
-to avoid malloc'ing an entire separate array to hold the raw generator output.
-So, this algorithm: pretend the destination is actually an array of uint64_t,
-fill it up using the generator, then run across the buffer and overwrite each
-element one at a time with an ldexp conversion.
+Initialize a xsh64 generator, the state[] member is a spk_xsh64
 *******************************************************************************/
+#define SIZEOF_XSH64 (sizeof(spk_xsh64))
 
-static int UnidPCG64i(struct spk_generator *rng, double *dest, const size_t n)
+static int InitXSH64(spk_generator rng, uint64_t seed)
 {
-    uint64_t *rng_state = rng->state;
-    uint64_t *target = (uint64_t *) dest;
+    int error = spk_XSH64Init((spk_xsh64 *) rng->state, seed);
+    if (error) return error;
     
-    NextPCG64i(rng_state, target, n);
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_XSH64;
+    rng->next = NextXSH64;
+    rng->rand = RandXSH64;
+    rng->bias = BiasXSH64;
+    rng->unid = UnidXSH64;
+    rng->unif = UnifXSH64;
     
-    for (size_t i = 0; i < n; i++)
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_XSH64Init(spk_xsh64 *xsh, uint64_t seed)
+{
+    assert(xsh);
+    
+    if (seed != 0)
+    {
+       xsh->state = spki_Hash(&seed);
+    }
+    else
+    {
+        int error = SPK_ERROR_UNDEFINED;
+        
+        error = spki_EntropyRetry(&xsh->state, 10);
+        if (error) return error;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Initialize the xoshiro256++ and xoroshiro128+ generators. Every state word comes
+from the splitmix64 chain, as Vigna recommends. The all zero state is a fixed
+point of both, which only an rdrand seed could hit, so it is replaced outright.
+*******************************************************************************/
+#define SIZEOF_XOSHIRO256 (sizeof(spk_xoshiro256))
+#define SIZEOF_XOROSHIRO128 (sizeof(spk_xoroshiro128))
+
+static int SeedWords(uint64_t *s, const size_t words, uint64_t seed)
+{
+    uint64_t any = 0;
+    
+    for (size_t i = 0; i < words; i++)
     {
-        dest[i] = ldexp((double) target[i], -64);
+        if (seed != 0)
+        {
+            s[i] = spki_Hash(&seed);
+        }
+        else
+        {
+            int error = spki_EntropyRetry(&s[i], 10);
+            if (error) return error;
+        }
+        
+        any |= s[i];
     }
     
-    return SPK_ERROR_SUCCESS;    
+    if (any == 0) s[0] = GOLDEN_GAMMA;
+    
+    return SPK_ERROR_SUCCESS;
 }
 
+/******************************************************************************/
+
+static int InitXoshiro256(spk_generator rng, uint64_t seed)
+{
+    int error = spk_Xoshiro256Init((spk_xoshiro256 *) rng->state, seed);
+    if (error) return error;
+    
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_XOSHIRO256;
+    rng->next = NextXoshiro256;
+    rng->rand = RandXoshiro256;
+    rng->bias = BiasXoshiro256;
+    rng->unid = UnidXoshiro256;
+    rng->unif = UnifXoshiro256;
+    
+    return SPK_ERROR_SUCCESS;
+}
 
+/******************************************************************************/
 
-static int UnidXSH64(struct spk_generator *rng, double *dest, const size_t n)
+int spk_Xoshiro256Init(spk_xoshiro256 *xos, uint64_t seed)
 {
-    uint64_t *rng_state = rng->state;
-    uint64_t *target = (uint64_t *) dest;
+    assert(xos);
     
-    NextXSH64(rng_state, target, n);
+    return SeedWords(xos->s, 4, seed);
+}
+
+/******************************************************************************/
+
+static int InitXoroshiro128(spk_generator rng, uint64_t seed)
+{
+    int error = spk_Xoroshiro128Init((spk_xoroshiro128 *) rng->state, seed);
+    if (error) return error;
     
-    for (size_t i = 0; i < n; i++)
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_XOROSHIRO128;
+    rng->next = NextXoroshiro128;
+    rng->rand = RandXoroshiro128;
+    rng->bias = BiasXoroshiro128;
+    rng->unid = UnidXoroshiro128;
+    rng->unif = UnifXoroshiro128;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_Xoroshiro128Init(spk_xoroshiro128 *xor, uint64_t seed)
+{
+    assert(xor);
+    
+    return SeedWords(xor->s, 2, seed);
+}
+
+/*******************************************************************************
+Hardware generator state, rdseed is 1 when the RDSEED instruction is available
+*******************************************************************************/
+struct rdrand
+{
+    uint64_t rdseed;
+};
+
+/*******************************************************************************
+Size of the state[] flexible array member for each generator
+*******************************************************************************/
+static size_t StateSize(int identifier)
+{
+    switch (identifier)
+    {
+        case SPK_GENERATOR_PCG64i:
+            return SIZEOF_PCG64I;
+            
+        case SPK_GENERATOR_XSH64:
+            return SIZEOF_XSH64;
+            
+        case SPK_GENERATOR_XOSHIRO256:
+            return SIZEOF_XOSHIRO256;
+            
+        case SPK_GENERATOR_XOROSHIRO128:
+            return SIZEOF_XOROSHIRO128;
+            
+        case SPK_GENERATOR_RDRAND:
+            return sizeof(struct rdrand);
+            
+        case SPK_GENERATOR_XOSHIRO256x4:
+            return sizeof(struct xoshiro256x4);
+            
+        case SPK_GENERATOR_PCG64ix4:
+            return sizeof(struct pcg64ix4);
+            
+        case SPK_GENERATOR_PCG64ix8:
+            return sizeof(struct pcg64ix8);
+            
+        case SPK_GENERATOR_PHILOX4x32:
+            return sizeof(struct philox4x32);
+            
+        default:
+            return 0;
+    }
+}
+
+/*******************************************************************************
+The following function wraps code originally Copyright 2014 Melissa O'Neill,
+which is licensed under the Apache License, Version 2.0. PCG was licensed under
+the Apache License, Version 2.0 (the "License"); You may obtain a copy of the
+License at http://www.apache.org/licenses/LICENSE-2.0
+
+The inline block of code in generator_inline.h is the default insecure 64-bit
+output PCG denoted commonly as pcg_output_rxs_m_xs_64_64. It exhibits the
+following modifications from the original source written by Melissa O'Neill.
+
+All credit for the design, theory, and innovations of the PCG family is due to
+Melissa O'Neill, you can find a copy of the original source at her website,
+https://www.pcg-random.org/
+
+1. The original seeding mechanism via either dev/urandom or address space
+layout randomization has been replaced with x86 rdrand and/or seed hashing.
+
+2. The preprocssor macros from O'Neill have been replaced, decimal constants
+were swapped for hex, and variable names have been changed. These modifications
+are made to engender simplicity.
+
+3. A data buffer is filled to reduce latency due to static library usage, since
+link time optimization alone does not result in sufficient speed gains. Callers
+who need single words in a hot loop should use generator_inline.h directly.
+*******************************************************************************/
+static inline int NextPCG64i(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    spk_PCG64iFill((spk_pcg64i *) state, dest, n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+PCG jump ahead via Forrest B. Brown's "Random Number Generation with Arbitrary
+Strides" (1994), which is also the method used by O'Neill's pcg_advance. The
+affine map x -> ax + c is squared log2(delta) times, accumulating the powers
+that correspond to the set bits of delta.
+*******************************************************************************/
+void spki_AdvancePCG64i(uint64_t *state, const uint64_t increment, uint64_t delta)
+{
+    uint64_t cur_mult = 0x5851F42D4C957F2DULL;
+    uint64_t cur_plus = increment;
+    uint64_t acc_mult = 1;
+    uint64_t acc_plus = 0;
+    
+    while (delta > 0)
     {
-        dest[i] = ldexp((double) target[i], -64);
+        if (delta & 1)
+        {
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+        delta >>= 1;
     }
     
-    return SPK_ERROR_SUCCESS;   
+    *state = acc_mult * *state + acc_plus;
+}
+
+/******************************************************************************/
+
+static void JumpPCG64i(uint64_t *state, uint64_t delta)
+{
+    spk_pcg64i *pcg = (spk_pcg64i *) state;
+    
+    spki_AdvancePCG64i(&pcg->state, pcg->increment, delta);
+}
+
+/*******************************************************************************
+* xorshift 64-bit by George Marsaglia
+*******************************************************************************/
+static inline int NextXSH64(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    spk_XSH64Fill((spk_xsh64 *) state, dest, n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Xorshift is linear over GF(2), so one step is a 64x64 bit matrix T applied to
+the state. Store matrices by column, i.e. column j is T applied to the unit
+vector 1 << j, then a jump of delta is T^delta built by repeated squaring. Each
+square costs 64 matrix-vector products and there are 64 of them at most.
+*******************************************************************************/
+static uint64_t MatVecGF2(const uint64_t *matrix, uint64_t vector)
+{
+    uint64_t result = 0;
+    
+    while (vector)
+    {
+        result ^= matrix[__builtin_ctzll(vector)];
+        vector &= vector - 1;
+    }
+    
+    return result;
+}
+
+/******************************************************************************/
+
+static void JumpXSH64(uint64_t *state, uint64_t delta)
+{
+    spk_xsh64 *xsh = (spk_xsh64 *) state;
+    uint64_t power[64];
+    uint64_t square[64];
+    
+    //T^1, column by column
+    for (size_t j = 0; j < 64; j++)
+    {
+        spk_xsh64 unit = {(uint64_t) 1 << j};
+        
+        power[j] = spk_XSH64Next(&unit);
+    }
+    
+    while (delta > 0)
+    {
+        if (delta & 1)
+        {
+            xsh->state = MatVecGF2(power, xsh->state);
+        }
+        
+        delta >>= 1;
+        if (delta == 0) break;
+        
+        for (size_t j = 0; j < 64; j++)
+        {
+            square[j] = MatVecGF2(power, power[j]);
+        }
+        
+        memcpy(power, square, sizeof(power));
+    }
+}
+
+/*******************************************************************************
+* xoshiro256++ and xoroshiro128+ by David Blackman and Sebastiano Vigna
+*******************************************************************************/
+static inline int NextXoshiro256(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    spk_Xoshiro256Fill((spk_xoshiro256 *) state, dest, n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static inline int NextXoroshiro128(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    spk_Xoroshiro128Fill((spk_xoroshiro128 *) state, dest, n);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+The xoshiro family is linear over GF(2) like xorshift, but a 256x256 transition
+matrix is too big to square 64 times on every jump. Instead take T^delta modulo
+the characteristic polynomial P(T) of the transition. By Cayley-Hamilton that
+is a polynomial c(T) of degree below 256, and applying it only takes one pass of
+256 steps which accumulates the states at the set coefficients.
+
+x^delta mod P is built by square and multiply. Squaring over GF(2) just spreads
+the bits apart, so each round is a spread, an optional shift, and a reduction.
+The polynomials below are P without its leading term, found by Berlekamp-Massey
+on the output. Vigna's jump and long jump constants are x^(2^128) and x^(2^192)
+mod P for xoshiro256, or x^(2^64) and x^(2^96) for xoroshiro128, which is how
+spk_GeneratorJump was checked against the reference code.
+*******************************************************************************/
+static const uint64_t xoshiro256_poly[4] =
+{
+    0x9D116F2BB0F0F001ULL, 0x0280002BCEFD1A5EULL,
+    0x04B4EDCF26259F85ULL, 0x0003C03C3F3ECB19ULL
+};
+
+static const uint64_t xoshiro256_jump[4] =
+{
+    0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+    0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+};
+
+static const uint64_t xoshiro256_long_jump[4] =
+{
+    0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL,
+    0x77710069854EE241ULL, 0x39109BB02ACBE635ULL
+};
+
+static const uint64_t xoroshiro128_poly[2] =
+{
+    0x095B8F76579AA001ULL, 0x0008828E513B43D5ULL
+};
+
+static const uint64_t xoroshiro128_jump[2] =
+{
+    0xDF900294D8F554A5ULL, 0x170865DF4B3201FCULL
+};
+
+static const uint64_t xoroshiro128_long_jump[2] =
+{
+    0xD2A98B26625EEE7BULL, 0xDDDF9B1090AA7AC1ULL
+};
+
+/******************************************************************************/
+
+static uint64_t SpreadGF2(uint32_t half)
+{
+    uint64_t x = half;
+    
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    
+    return x;
+}
+
+/*******************************************************************************
+The result has the given number of words and the poly is P(x) - x^(64 * words).
+*******************************************************************************/
+static void PowerModGF2
+(
+    const uint64_t *poly,
+    const size_t words,
+    uint64_t exponent,
+    uint64_t *result
+)
+{
+    const size_t degree = 64 * words;
+    uint64_t product[8] = {0};
+    
+    memset(result, 0, words * sizeof(uint64_t));
+    result[0] = 1;
+    
+    for (int bit = 63 - __builtin_clzll(exponent | 1); exponent && bit >= 0; bit--)
+    {
+        for (size_t i = 0; i < words; i++)
+        {
+            product[2 * i] = SpreadGF2((uint32_t) result[i]);
+            product[2 * i + 1] = SpreadGF2((uint32_t) (result[i] >> 32));
+        }
+        
+        //multiply by x, the square has degree 2 * degree - 2 at most so it fits
+        if ((exponent >> bit) & 1)
+        {
+            for (size_t i = 2 * words - 1; i > 0; i--)
+            {
+                product[i] = (product[i] << 1) | (product[i - 1] >> 63);
+            }
+            
+            product[0] <<= 1;
+        }
+        
+        //cancel every term at or above the degree of P with a shifted copy of P
+        for (size_t b = 2 * degree - 1; b >= degree; b--)
+        {
+            if (!((product[b / 64] >> (b % 64)) & 1)) continue;
+            
+            const size_t shift = b - degree;
+            const size_t q = shift / 64;
+            const size_t r = shift % 64;
+            
+            product[b / 64] ^= (uint64_t) 1 << (b % 64);
+            
+            for (size_t i = 0; i < words; i++)
+            {
+                product[i + q] ^= poly[i] << r;
+                if (r) product[i + q + 1] ^= poly[i] >> (64 - r);
+            }
+        }
+        
+        memcpy(result, product, words * sizeof(uint64_t));
+    }
+}
+
+/******************************************************************************/
+
+static void ApplyXoshiro256(spk_xoshiro256 *xos, const uint64_t *coefficients)
+{
+    spk_xoshiro256 acc = {{0, 0, 0, 0}};
+    
+    for (size_t j = 0; j < 256; j++)
+    {
+        if ((coefficients[j / 64] >> (j % 64)) & 1)
+        {
+            for (size_t k = 0; k < 4; k++) acc.s[k] ^= xos->s[k];
+        }
+        
+        spk_Xoshiro256Next(xos);
+    }
+    
+    *xos = acc;
+}
+
+/******************************************************************************/
+
+static void ApplyXoroshiro128(spk_xoroshiro128 *xor, const uint64_t *coefficients)
+{
+    spk_xoroshiro128 acc = {{0, 0}};
+    
+    for (size_t j = 0; j < 128; j++)
+    {
+        if ((coefficients[j / 64] >> (j % 64)) & 1)
+        {
+            acc.s[0] ^= xor->s[0];
+            acc.s[1] ^= xor->s[1];
+        }
+        
+        spk_Xoroshiro128Next(xor);
+    }
+    
+    *xor = acc;
+}
+
+/******************************************************************************/
+
+void spki_AdvanceXoshiro256(uint64_t *state, uint64_t delta)
+{
+    uint64_t coefficients[4];
+    
+    PowerModGF2(xoshiro256_poly, 4, delta, coefficients);
+    ApplyXoshiro256((spk_xoshiro256 *) state, coefficients);
+}
+
+static void JumpXoshiro256(uint64_t *state, uint64_t delta)
+{
+    spki_AdvanceXoshiro256(state, delta);
+}
+
+static void JumpXoroshiro128(uint64_t *state, uint64_t delta)
+{
+    uint64_t coefficients[2];
+    
+    PowerModGF2(xoroshiro128_poly, 2, delta, coefficients);
+    ApplyXoroshiro128((spk_xoroshiro128 *) state, coefficients);
+}
+
+/******************************************************************************/
+
+void spk_Xoshiro256Jump(spk_xoshiro256 *xos)
+{
+    assert(xos);
+    
+    ApplyXoshiro256(xos, xoshiro256_jump);
+}
+
+void spk_Xoshiro256LongJump(spk_xoshiro256 *xos)
+{
+    assert(xos);
+    
+    ApplyXoshiro256(xos, xoshiro256_long_jump);
+}
+
+void spk_Xoroshiro128Jump(spk_xoroshiro128 *xor)
+{
+    assert(xor);
+    
+    ApplyXoroshiro128(xor, xoroshiro128_jump);
+}
+
+void spk_Xoroshiro128LongJump(spk_xoroshiro128 *xor)
+{
+    assert(xor);
+    
+    ApplyXoroshiro128(xor, xoroshiro128_long_jump);
+}
+
+/*******************************************************************************
+random integers, aka discrete uniform variates. This is an unbiased variant via
+Lemire's multiply-shift reduction, which extracts several values per raw word
+for small ranges. See spki_Rand in generator_internal.h for the details.
+*/
+static int RandPCG64i
+(
+    struct spk_generator *rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    return spki_Rand(NextPCG64i, rng->state, dest, n, min, max);
+}
+
+
+
+static int RandXSH64
+(
+    struct spk_generator *rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    return spki_Rand(NextXSH64, rng->state, dest, n, min, max);
+}
+
+
+
+static int RandXoshiro256
+(
+    struct spk_generator *rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    return spki_Rand(NextXoshiro256, rng->state, dest, n, min, max);
+}
+
+
+
+static int RandXoroshiro128
+(
+    struct spk_generator *rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    return spki_Rand(NextXoroshiro128, rng->state, dest, n, min, max);
+}
+
+/*******************************************************************************
+Use a virtual accumulator machine to simultaneously generate 64 iid bernoulli
+trials without the SIMD instruction set. I wrote a short essay at the following
+url: https://stackoverflow.com/questions/35795110/ (username Ollie) which uses
+256 bit resolution to demonstrate the main concepts.
+
+To give some additional detail on why this works, consider a binary tree with
+double values where all left children are half the value of the parent, and all
+right children are P + (.5 - .5P). With a root value of 0.5, the traversal path
+taken to a desired probability maps precisely to a compact binary representation
+when AND=0 and OR=1.
+
+                                    ORI
+                                     |
+                                     v
+                                    0.5
+                                     |
+                  _______AND_________|________OR________
+                 |                                      |
+                .25                                    .75
+                 |                                      |
+      ____AND____|____OR____                 ____AND____|____OR____
+     |                      |               |                      |
+   .125                   .625            .325                   .875
+     |                      |               |                      |
+     |                      |               |                      |
+    ...                    ...             ...                    ...
+
+Therefore, for some p = n/(2^m), n unpacks from its compact binary and can be
+read from the first nonzero LSB to MSB as the exact traversal starting at the
+root node. Or, alternatively, the bit trie expansion of the numerator n gives
+the very same bitcode.
+
+So given a generator that outputs unbiased bits, we can psuedo-vectorized the
+production of biased bits with at most log2(m) calls to the generator for some
+resolution 2^m. Although this is more wasteful from an information theoretic
+view than running an arithmetic decoder, it is almost certainly faster.
+
+In probablity, nodes map to some event given a sequence of bernoulli trials.
+i.e,. .875 is the event of at least one success. 0.625 is the event where either
+the first two trials are both successful, or the final trial is successful.
+
+Implementation details
+- a probability below 1/2^m collapses to zero, hence the ctzll protection
+- trailing zeros of n are AND instructions against an all-zero accumulator, so
+  they are stripped and the program always starts with an OR
+- the bitcode is decoded once into a spk_bias_program, callers that reuse the
+  same p should hold on to the program and call spk_GeneratorBias directly
+- the decoder is spki_BiasCompile and the interpreter is spki_Bias, both in
+  generator_internal.h
+
+TODO
+- further optimize with mmap just-in-time compilation
+*/
+int spk_BiasProgramInit(spk_bias_program *program, const double p, const int exp)
+{
+    //the validate once entry point, checked whatever spk_SetChecking says
+    if (!(p >= 0.0 && p < 1.0) || exp <= 0 || exp >= 65)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_BiasProgramInit", "p %g or exp %d outside [0, 1) and [1, 64]", p, exp);
+    }
+    
+    spki_BiasCompile(program, p, exp);
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+int spk_GeneratorBias
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const spk_bias_program *program
+)
+{
+    return spki_Bias(rng->next, rng->state, dest, n, program);
+}
+
+/******************************************************************************/
+
+int spk_GeneratorRandUnchecked
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    return spki_RandUnchecked(rng->next, rng->state, dest, n, min, max);
+}
+
+/******************************************************************************/
+
+static int BiasPCG64i
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const double p,
+    const int exp
+)
+{
+    return spki_BiasMethod(NextPCG64i, rng->state, dest, n, p, exp);
+}
+
+
+
+static int BiasXSH64
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const double p,
+    const int exp
+)
+{
+    return spki_BiasMethod(NextXSH64, rng->state, dest, n, p, exp);
+}
+
+
+
+static int BiasXoshiro256
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const double p,
+    const int exp
+)
+{
+    return spki_BiasMethod(NextXoshiro256, rng->state, dest, n, p, exp);
+}
+
+
+
+static int BiasXoroshiro128
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const double p,
+    const int exp
+)
+{
+    return spki_BiasMethod(NextXoroshiro128, rng->state, dest, n, p, exp);
+}
+
+/*******************************************************************************
+Convert raw generator output to doubles and floats in the unit interval. For
+speed, we need to make just one call to the generator next method per block.
+For memory, we should try to avoid malloc'ing an entire separate array to hold
+the raw generator output. So, this algorithm: pretend the destination is really
+an array of uint64_t, fill it up using the generator, then run across the buffer
+and overwrite each element by injecting its top bits into the exponent of 1.0.
+See spki_Unid in generator_internal.h for the details.
+*******************************************************************************/
+
+static int UnidPCG64i(struct spk_generator *rng, double *dest, const size_t n)
+{
+    return spki_Unid(NextPCG64i, rng->state, dest, n);
+}
+
+
+
+static int UnidXSH64(struct spk_generator *rng, double *dest, const size_t n)
+{
+    return spki_Unid(NextXSH64, rng->state, dest, n);
+}
+
+
+
+static int UnidXoshiro256(struct spk_generator *rng, double *dest, const size_t n)
+{
+    return spki_Unid(NextXoshiro256, rng->state, dest, n);
+}
+
+
+
+static int UnidXoroshiro128(struct spk_generator *rng, double *dest, const size_t n)
+{
+    return spki_Unid(NextXoroshiro128, rng->state, dest, n);
+}
+
+/******************************************************************************/
+
+static int UnifPCG64i(struct spk_generator *rng, float *dest, const size_t n)
+{
+    return spki_Unif(NextPCG64i, rng->state, dest, n);
+}
+
+
+
+static int UnifXSH64(struct spk_generator *rng, float *dest, const size_t n)
+{
+    return spki_Unif(NextXSH64, rng->state, dest, n);
+}
+
+
+
+static int UnifXoshiro256(struct spk_generator *rng, float *dest, const size_t n)
+{
+    return spki_Unif(NextXoshiro256, rng->state, dest, n);
+}
+
+
+
+static int UnifXoroshiro128(struct spk_generator *rng, float *dest, const size_t n)
+{
+    return spki_Unif(NextXoroshiro128, rng->state, dest, n);
+}
+
+/*******************************************************************************
+Hardware generator. RDSEED returns conditioned entropy straight from the noise
+source and is the right primitive for key material, RDRAND returns the output of
+a DRBG reseeded from that source and is several times faster. We use RDSEED when
+the CPU reports it in CPUID leaf 7 and fall back to RDRAND otherwise. A CPU with
+neither fails spk_GeneratorNew with SPK_ERROR_RDRAND.
+
+Both instructions can underflow when the DRNG is drained, which is common for
+RDSEED under load. Intel recommends 10 retries for RDRAND. RDSEED has no such
+bound, so we retry longer and pause between attempts to let the source refill.
+The steps are unrolled by four, the retry loop only runs for a group in which
+some step came back empty.
+
+Each instruction has hundreds of cycles of latency, so one thread is far from
+the throughput limit of the DRNG. Since the jump is a no-op, bulk fills can be
+spread across cores with spk_GeneratorFillParallel like any other generator.
+*******************************************************************************/
+#define RDRAND_RETRY ((size_t) 10)
+#define RDSEED_RETRY ((size_t) 1000)
+
+static int InitRdRand(spk_generator rng, uint64_t seed)
+{
+    (void) seed;
+    
+    const unsigned int features = spki_CPUFeatures();
+    if (!(features & SPKI_CPU_RDRAND)) return SPK_ERROR_RDRAND;
+    
+    struct rdrand *hw = (struct rdrand *) rng->state;
+    hw->rdseed = (features & SPKI_CPU_RDSEED) != 0;
+    
+    //hook in methods
+    rng->identifier = SPK_GENERATOR_RDRAND;
+    rng->next = NextRdRand;
+    rng->rand = RandRdRand;
+    rng->bias = BiasRdRand;
+    rng->unid = UnidRdRand;
+    rng->unif = UnifRdRand;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static inline __attribute__((target("rdrnd"))) int StepRdRand(unsigned long long *x)
+{
+    return _rdrand64_step(x);
+}
+
+static inline __attribute__((target("rdseed"))) int StepRdSeed(unsigned long long *x)
+{
+    return _rdseed64_step(x);
+}
+
+/******************************************************************************/
+
+static inline int FillHardware
+(
+    int (*step)(unsigned long long *),
+    size_t retry,
+    uint64_t *dest,
+    const size_t n
+)
+{
+    unsigned long long word[4];
+    size_t i = 0;
+    
+    for (; i + 4 <= n; i += 4)
+    {
+        const int ok = step(&word[0]) & step(&word[1]) & step(&word[2]) & step(&word[3]);
+        
+        for (size_t k = 0; k < 4; k++) dest[i + k] = word[k];
+        
+        if (ok) continue;
+        
+        //redo the whole group, the failed steps have already zeroed their word
+        for (size_t k = 0; k < 4; k++)
+        {
+            size_t attempt = 0;
+            
+            while (!step(&word[k]))
+            {
+                if (++attempt == retry) return SPK_ERROR_RDRAND;
+                _mm_pause();
+            }
+            
+            dest[i + k] = word[k];
+        }
+    }
+    
+    for (; i < n; i++)
+    {
+        size_t attempt = 0;
+        
+        while (!step(&word[0]))
+        {
+            if (++attempt == retry) return SPK_ERROR_RDRAND;
+            _mm_pause();
+        }
+        
+        dest[i] = word[0];
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static __attribute__((target("rdrnd,rdseed"))) int NextRdRand(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    const struct rdrand *hw = (const struct rdrand *) state;
+    
+    if (hw->rdseed) return FillHardware(StepRdSeed, RDSEED_RETRY, dest, n);
+    
+    return FillHardware(StepRdRand, RDRAND_RETRY, dest, n);
+}
+
+/******************************************************************************/
+
+static int RandRdRand
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const uint64_t min,
+    const uint64_t max
+)
+{
+    return spki_Rand(NextRdRand, rng->state, dest, n, min, max);
+}
+
+/******************************************************************************/
+
+static int BiasRdRand
+(
+    spk_generator rng,
+    uint64_t *dest,
+    const size_t n,
+    const double p,
+    const int exp
+)
+{
+    return spki_BiasMethod(NextRdRand, rng->state, dest, n, p, exp);
+}
+
+/******************************************************************************/
+
+static int UnidRdRand(struct spk_generator *rng, double *dest, const size_t n)
+{
+    return spki_Unid(NextRdRand, rng->state, dest, n);
+}
+
+/******************************************************************************/
+
+static int UnifRdRand(struct spk_generator *rng, float *dest, const size_t n)
+{
+    return spki_Unif(NextRdRand, rng->state, dest, n);
 }
@@ -0,0 +1,110 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: subroutines for cache-blocked streaming random number generation
+* LICS: MIT License
+*/
+
+#define _POSIX_C_SOURCE 200112L //posix_memalign under -std=c99
+
+#include "generator_stream.h"
+#include "scipack_internal.h"
+
+#include <assert.h>
+#include <stdlib.h> //free, posix_memalign, size_t
+
+/*******************************************************************************
+A fill of dest followed by a pass over dest costs two trips to DRAM once n is
+past the last level cache. Streaming produces one small block, lets the caller
+consume it while it is still in L1, then overwrites it. The bias program is
+compiled once up front rather than once per block.
+
+The scratch buffer is sized for the widest element, 8 bytes, whatever the kind.
+Every method draws its raw words in order, so for next, unid, and unif the
+concatenated blocks are exactly the output of a single call for total elements.
+rand and bias batch their raw words by call, so the blocks have the same
+distribution but not necessarily the same values as a single call.
+*******************************************************************************/
+int spk_GeneratorStream
+(
+    spk_generator rng,
+    const spk_stream_method *method,
+    const size_t total,
+    size_t block,
+    spk_stream_callback callback,
+    void *ctx
+)
+{
+    assert(rng);
+    assert(method);
+    assert(callback);
+    
+    if (block == 0) block = SPK_STREAM_DEFAULT;
+    if (block % SPK_STREAM_MULTIPLE != 0)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorStream", "block %zu is not a multiple of %zu", block, SPK_STREAM_MULTIPLE);
+    }
+    
+    spk_bias_program program;
+    
+    switch (method->kind)
+    {
+        case SPK_STREAM_NEXT:
+        case SPK_STREAM_UNID:
+        case SPK_STREAM_UNIF:
+        case SPK_STREAM_RAND:
+            break;
+            
+        case SPK_STREAM_BIAS:
+        {
+            int error = spk_BiasProgramInit(&program, method->p, method->exp);
+            if (error) return error;
+            break;
+        }
+        
+        default:
+            return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_GeneratorStream", "unknown method kind %d", (int) method->kind);
+    }
+    
+    void *scratch = NULL;
+    
+    if (posix_memalign(&scratch, SPK_STREAM_ALIGN, block * sizeof(uint64_t)))
+    {
+        return SPK_ERROR_STDMALLOC;
+    }
+    
+    int status = SPK_ERROR_SUCCESS;
+    
+    for (size_t i = 0; i < total && status == SPK_ERROR_SUCCESS; i += block)
+    {
+        const size_t n = total - i < block ? total - i : block;
+        
+        switch (method->kind)
+        {
+            case SPK_STREAM_NEXT:
+                status = rng->next(rng->state, scratch, n);
+                break;
+                
+            case SPK_STREAM_UNID:
+                status = rng->unid(rng, scratch, n);
+                break;
+                
+            case SPK_STREAM_UNIF:
+                status = rng->unif(rng, scratch, n);
+                break;
+                
+            case SPK_STREAM_RAND:
+                status = rng->rand(rng, scratch, n, method->min, method->max);
+                break;
+                
+            case SPK_STREAM_BIAS:
+                status = spk_GeneratorBias(rng, scratch, n, &program);
+                break;
+        }
+        
+        if (status == SPK_ERROR_SUCCESS) status = callback(scratch, n, ctx);
+    }
+    
+    free(scratch);
+    
+    return status;
+}
@@ -0,0 +1,97 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: library wide error descriptions, argument checking and logging hooks
+* LICS: MIT License
+*/
+
+#include "scipack_config.h"
+#include "scipack_internal.h"
+
+#include <stdio.h> //fprintf, vfprintf
+
+/*******************************************************************************
+Descriptions are indexed by error code, the codes are dense apart from the
+undefined sentinel which is handled on its own
+*******************************************************************************/
+static const char *descriptions[] =
+{
+    [SPK_ERROR_SUCCESS]     = "no error has occurred",
+    [SPK_ERROR_STDMALLOC]   = "stdlib malloc failed",
+    [SPK_ERROR_STDCALLOC]   = "stdlib calloc failed",
+    [SPK_ERROR_STDREALLOC]  = "stdlib realloc failed",
+    [SPK_ERROR_RDRAND]      = "rdrand, rdseed or getrandom unavailable or empty",
+    [SPK_ERROR_ARGBOUNDS]   = "function argument is out of bounds",
+    [SPK_ERROR_PTHREAD]     = "pthread thread creation failed",
+    [SPK_ERROR_FORMAT]      = "malformed or incompatible serialized data",
+    [SPK_ERROR_TIMER]       = "tsc calibration clock failed",
+    [SPK_ERROR_FILEIO]      = "file open, read or write failed",
+    [SPK_ERROR_COUNTERS]    = "perf_event_open hardware counters failed",
+    [SPK_ERROR_EXHAUSTED]   = "random pool has been used up"
+};
+
+#define DESCRIPTIONS ((int) (sizeof(descriptions) / sizeof(descriptions[0])))
+
+const char *spk_ErrorString(int error)
+{
+    if (error == SPK_ERROR_UNDEFINED) return "no error has been set";
+    if (error < 0 || error >= DESCRIPTIONS || !descriptions[error]) return "unknown error code";
+    
+    return descriptions[error];
+}
+
+/*******************************************************************************
+Both switches are plain globals read on every checked call, a lock or an atomic
+would cost more than the checks they guard. They are meant to be set once at
+startup, see the notes in scipack_config.h.
+*******************************************************************************/
+int spki_checking = 1;
+
+static spk_logger logger = NULL;
+static void *logger_ctx = NULL;
+
+/******************************************************************************/
+
+int spk_SetChecking(int enabled)
+{
+    const int previous = spki_checking;
+    
+    spki_checking = enabled != 0;
+    
+    return previous;
+}
+
+/******************************************************************************/
+
+void spk_SetLogger(spk_logger hook, void *ctx)
+{
+    logger = hook;
+    logger_ctx = ctx;
+}
+
+/*******************************************************************************
+The arguments are forwarded untouched, formatting is left to the logger
+*******************************************************************************/
+int spki_Fail(int error, const char *where, const char *format, ...)
+{
+    if (logger)
+    {
+        va_list args;
+        
+        va_start(args, format);
+        logger(logger_ctx, error, where, format, args);
+        va_end(args);
+    }
+    
+    return error;
+}
+
+/******************************************************************************/
+
+void spk_LogStderr(void *ctx, int error, const char *where, const char *format, va_list args)
+{
+    (void) ctx;
+    
+    fprintf(stderr, "scipack: %s: ", where);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, " (%s)\n", spk_ErrorString(error));
+}
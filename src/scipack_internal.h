@@ -0,0 +1,71 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: library wide internals shared by every module, checks and failures, CPU
+* features and the thread pool
+* LICS: MIT License
+*/
+
+#ifndef SPK_INTERNAL_H
+#define SPK_INTERNAL_H
+
+#include "scipack_config.h"
+
+#include <stddef.h> //size_t
+
+/*******************************************************************************
+* NAME: spki_checking
+* DESC: the runtime switch behind spk_SetChecking, 1 when checks are on
+*******************************************************************************/
+extern int spki_checking;
+
+/*******************************************************************************
+* NAME: SPKI_CHECK
+* DESC: true when an argument check is compiled in, enabled, and fails
+* NOTE: with SPK_CHECKED 0 the whole condition folds away at compile time, else
+* the failing side is marked unlikely so the hot path falls straight through
+*******************************************************************************/
+#define SPKI_CHECK(condition) (SPK_CHECKED && __builtin_expect(spki_checking && (condition), 0))
+
+/*******************************************************************************
+* NAME: spki_Fail
+* DESC: report a failure to the installed logger, if any
+* OUTP: error, so that call sites can return spki_Fail(...)
+* @ where : method or function name for the log line
+* @ format : printf details, only formatted if the logger chooses to
+*******************************************************************************/
+int spki_Fail(int error, const char *where, const char *format, ...) __attribute__((cold, format(printf, 3, 4)));
+
+/*******************************************************************************
+* NAME: spki_CPUFeatures
+* DESC: CPUID and XCR0 feature bits, detected on the first call and then cached
+* OUTP: bitwise OR of the SPKI_CPU_* flags
+* NOTE: AVX2 and AVX512 are only set when the OS also saves the wider registers,
+* AVX512 means the F, DQ and VL subsets together
+*******************************************************************************/
+#define SPKI_CPU_RDRAND     0x01U
+#define SPKI_CPU_RDSEED     0x02U
+#define SPKI_CPU_AVX2       0x04U
+#define SPKI_CPU_AVX512     0x08U
+#define SPKI_CPU_POPCNT     0x10U
+
+unsigned int spki_CPUFeatures(void);
+
+/*******************************************************************************
+* NAME: spki_ISA
+* DESC: instruction set level for new generators and kernels, i.e. the best one
+* the CPU has below the cap of spk_GeneratorSetISA
+* OUTP: one of the SPK_ISA_* levels
+*******************************************************************************/
+int spki_ISA(void);
+
+/*******************************************************************************
+* NAME: spki_ParallelRun
+* DESC: run task(context, i) for i from 0 to tasks - 1 across the thread pool
+* OUTP: scipack error code, only for a pool that could not be started
+* @ where : public entry point reported to the logger if the pool fails to start
+* NOTE: starts a default pool on demand and holds the pool for the whole job, so
+* a task must not submit parallel work of its own
+*******************************************************************************/
+int spki_ParallelRun(void (*task)(void *, size_t), void *context, size_t tasks, const char *where);
+
+#endif
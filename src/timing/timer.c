@@ -4,12 +4,17 @@
 * LICS: MIT License
 */
 
+#define _POSIX_C_SOURCE 199309L //clock_gettime under -std=c99
+
 #include "timer.h"
+#include "scipack_internal.h"
 
 #include <assert.h>
-#include <stdlib.h> //qsort, size_t
-#include <string.h> //strcpy
-#include <time.h> //nanosleep
+#include <cpuid.h> //__get_cpuid_max, __cpuid_count
+#include <math.h> //NAN
+#include <stdio.h> //fopen, fgets, fprintf, sscanf
+#include <string.h> //strcpy, strcmp, strcspn, memcpy, memmove
+#include <time.h> //clock_gettime
 
 /*******************************************************************************
 Reference units for struct spk_timer_result to aid user in text formatting.
@@ -26,82 +31,377 @@ static const char * symbol_lookup[SPK_TIMER_NANOSECONDS + 1] =
 /*******************************************************************************
 Use a global write-once use-everywhere variable for the TSC frequency. This is
 possible since modern hardware uses a stable constant TSC locked to some unknown
-reference frequency.
+reference frequency. Hardcoding a known frequency here skips calibration.
 */
 
 #define INIT_HZ 0
 static unsigned long long tsc_hz = INIT_HZ;
+static enum spk_timer_source tsc_source = SPK_TIMER_UNCALIBRATED;
+
+/*******************************************************************************
+Intel CPUs from Skylake onwards report the TSC as a ratio of the core crystal
+clock in CPUID leaf 0x15, EBX / EAX times the crystal frequency in ECX. Some
+parts leave ECX at zero, and the SDM then derives the crystal from the base
+frequency in leaf 0x16, which works out to a TSC at exactly the base frequency.
+Either way it costs a few hundred cycles.
+*/
+
+static unsigned long long FrequencyFromCPUID(void)
+{
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    
+    const unsigned int max = __get_cpuid_max(0, NULL);
+    if (max < 0x15) return 0;
+    
+    __cpuid_count(0x15, 0, eax, ebx, ecx, edx);
+    if (eax == 0 || ebx == 0) return 0;
+    
+    if (ecx != 0) return (unsigned long long) ecx * ebx / eax;
+    if (max < 0x16) return 0;
+    
+    __cpuid_count(0x16, 0, eax, ebx, ecx, edx);
+    
+    return (unsigned long long) (eax & 0xFFFF) * 1000000ULL;
+}
 
 /*******************************************************************************
-Estimate the TSC frequency. This is just a temporary placeholder that works just
-well enough to continue development on other areas of SCIPACK. For now, we fetch
-an average frequency and then subtract the average overhead due to the nanosleep
-call. I haven't found a good OS-portable method for TSC frequency through online
-or the Intel manuals.
+Elsewhere, including most hypervisors, both leaves read as zero. Then the TSC is
+fit against CLOCK_MONOTONIC_RAW, which is never slewed by NTP. Each sample reads
+the clock between two TSC reads and keeps the tightest of a few attempts, so a
+sample that was preempted mid-read is simply discarded. The frequency is the
+least squares slope over samples spread evenly across CALIBRATE_WINDOW.
+
+With reads good to a few tens of ns over 50 ms the slope is within a few ppm,
+i.e. a few kHz on a GHz TSC. The nanosleep loop this replaced took 200 times as
+long and was only good to about 10 MHz.
 */
 
-#define ULLCAST(x) *((const unsigned long long *) (x))
-#define MAX_NANOSLEEP_ITER ((size_t) 100)
-#define MAX_TICKS_ITER ((size_t) 10)
+#ifdef CLOCK_MONOTONIC_RAW
+    #define CALIBRATE_CLOCK CLOCK_MONOTONIC_RAW
+#else
+    #define CALIBRATE_CLOCK CLOCK_MONOTONIC
+#endif
+
+#define CALIBRATE_WINDOW 50000000LL
+#define CALIBRATE_SAMPLES ((size_t) 500)
+#define CALIBRATE_ATTEMPTS 4
 
-int cmp(const void *a, const void *b)
+static long long Nanoseconds(void)
 {
-    unsigned long long num1 = ULLCAST(a), num2 = ULLCAST(b);
+    struct timespec ts = {0, 0};
     
-    if (num1 < num2) return -1;
-    else if (num1 == num2) return 0;
-    else return 1;
+    if (clock_gettime(CALIBRATE_CLOCK, &ts)) return -1;
+    
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
-static void TimerSetHz(void)
+/******************************************************************************/
+
+static int Sample(long long *ns, unsigned long long *ticks)
 {
-    if (tsc_hz != INIT_HZ) return;
+    unsigned long long best = ~0ULL;
     
-    //establish median nanosleep overhead    
-    unsigned long long overhead_data[MAX_NANOSLEEP_ITER] = {0ULL};
-    unsigned long long overhead = 0ULL;
+    for (int i = 0; i < CALIBRATE_ATTEMPTS; i++)
+    {
+        _mm_lfence();
+        const unsigned long long before = __rdtsc();
+        _mm_lfence();
+        const long long now = Nanoseconds();
+        _mm_lfence();
+        const unsigned long long after = __rdtsc();
+        
+        if (now < 0) return SPK_ERROR_TIMER;
+        
+        if (after - before < best)
+        {
+            best = after - before;
+            *ns = now;
+            *ticks = before + best / 2;
+        }
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+static unsigned long long FrequencyFromRegression(void)
+{
+    long long ns[CALIBRATE_SAMPLES];
+    unsigned long long ticks[CALIBRATE_SAMPLES];
     
-    struct timespec ts = {0, 1};
+    const long long spacing = CALIBRATE_WINDOW / (long long) (CALIBRATE_SAMPLES - 1);
+    const long long start = Nanoseconds();
+    if (start < 0) return 0;
     
-    for (size_t i = 0; i < MAX_NANOSLEEP_ITER; i++)
+    for (size_t i = 0; i < CALIBRATE_SAMPLES; i++)
     {
-        spk_TimerStart();
-        nanosleep(&ts, NULL);
-        spk_TimerStop();
+        const long long target = start + (long long) i * spacing;
+        long long now = 0;
+        
+        do now = Nanoseconds(); while (now >= 0 && now < target);
         
-        assert(spk_TimerElapsedCycles() > 0 && "rdtsc delta is negative");
+        if (Sample(&ns[i], &ticks[i])) return 0;
+    }
+    
+    //offsets from the first sample keep the sums well inside double precision
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    
+    for (size_t i = 0; i < CALIBRATE_SAMPLES; i++)
+    {
+        mean_x += (double) (ns[i] - ns[0]);
+        mean_y += (double) (ticks[i] - ticks[0]);
+    }
+    
+    mean_x /= (double) CALIBRATE_SAMPLES;
+    mean_y /= (double) CALIBRATE_SAMPLES;
+    
+    double sxy = 0.0;
+    double sxx = 0.0;
+    
+    for (size_t i = 0; i < CALIBRATE_SAMPLES; i++)
+    {
+        const double dx = (double) (ns[i] - ns[0]) - mean_x;
+        const double dy = (double) (ticks[i] - ticks[0]) - mean_y;
         
-        overhead_data[i] = spk_TimerElapsedCycles();
+        sxy += dx * dy;
+        sxx += dx * dx;
+    }
+    
+    if (sxx <= 0.0 || sxy <= 0.0) return 0;
+    
+    return (unsigned long long) (sxy / sxx * 1e9 + 0.5);
+}
+
+/*******************************************************************************
+The cache is a text file with one line per CPU model, the CPUID leaf 1 signature
+in hex, the frequency in Hz, and the brand string, e.g.
+
+    000806f8 2000003117 Intel(R) Xeon(R) Processor
+
+A model missing from the file is calibrated and appended. The signature alone
+pins down family, model and stepping, the brand string tells SKUs of the same
+stepping apart since they can run different base clocks.
+*/
+
+#define CACHE_LINE 128
+
+static void CacheKey(unsigned int *signature, char brand[49])
+{
+    unsigned int regs[12] = {0};
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    
+    *signature = 0;
+    __get_cpuid(1, signature, &ebx, &ecx, &edx);
+    
+    if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004)
+    {
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            __get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]);
+        }
     }
     
-    qsort(overhead_data, MAX_NANOSLEEP_ITER, sizeof(unsigned long long), cmp);
-    overhead = overhead_data[MAX_NANOSLEEP_ITER/2];
+    memcpy(brand, regs, 48);
+    brand[48] = '\0';
+    
+    //the brand string is padded with leading spaces on some parts
+    size_t skip = 0;
+    while (brand[skip] == ' ') skip++;
+    memmove(brand, brand + skip, 49 - skip);
     
-    //establish ticks across 1 second, without nanosleep overhead
-    unsigned long long ticks_data[MAX_TICKS_ITER] = {0ULL};
+    for (size_t i = 0; brand[i] != '\0'; i++)
+    {
+        if (brand[i] == '\n' || brand[i] == '\r') brand[i] = ' ';
+    }
+}
+
+/******************************************************************************/
+
+static unsigned long long CacheLookup(const char *path, unsigned int signature, const char *brand)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return 0;
     
-    ts.tv_sec = 1;
-    ts.tv_nsec = 0;
+    char line[CACHE_LINE];
+    unsigned long long hz = 0;
     
-    for (size_t i = 0; i < MAX_TICKS_ITER; i++)
+    while (hz == 0 && fgets(line, sizeof(line), file) != NULL)
     {
-        spk_TimerStart();
-        nanosleep(&ts, NULL);
-        spk_TimerStop();
+        unsigned int key = 0;
+        unsigned long long value = 0;
+        int offset = 0;
         
-        assert(spk_TimerElapsedCycles() > 0 && "rdtsc delta is negative");
+        line[strcspn(line, "\n")] = '\0';
         
-        ticks_data[i] = spk_TimerElapsedCycles() - overhead;
+        if (sscanf(line, "%x %llu %n", &key, &value, &offset) != 2) continue;
+        
+        if (key == signature && strcmp(line + offset, brand) == 0) hz = value;
     }
     
-    qsort(ticks_data, MAX_TICKS_ITER, sizeof(unsigned long long), cmp);
+    fclose(file);
     
-    //estimated frequency is just the median ticks
-    tsc_hz = ticks_data[MAX_TICKS_ITER/2];
-    assert(tsc_hz != INIT_HZ && "estimated TSC frequency is zero");
-    assert(tsc_hz > INIT_HZ && "estimated TSC frequency is negative");
+    return hz;
 }
 
+/******************************************************************************/
+
+static int CacheStore(const char *path, unsigned int signature, const char *brand, unsigned long long hz)
+{
+    FILE *file = fopen(path, "a");
+    if (file == NULL) return SPK_ERROR_FILEIO;
+    
+    const int written = fprintf(file, "%08x %llu %s\n", signature, hz, brand);
+    const int closed = fclose(file);
+    
+    return written < 0 || closed != 0 ? SPK_ERROR_FILEIO : SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+API access to calibration
+*/
+
+int spk_TimerCalibrate(const char *cache)
+{
+    unsigned int signature = 0;
+    char brand[49] = {0};
+    
+    unsigned long long hz = FrequencyFromCPUID();
+    
+    if (hz != 0)
+    {
+        tsc_hz = hz;
+        tsc_source = SPK_TIMER_CPUID;
+        return SPK_ERROR_SUCCESS;
+    }
+    
+    if (cache != NULL)
+    {
+        CacheKey(&signature, brand);
+        hz = CacheLookup(cache, signature, brand);
+        
+        if (hz != 0)
+        {
+            tsc_hz = hz;
+            tsc_source = SPK_TIMER_CACHE;
+            return SPK_ERROR_SUCCESS;
+        }
+    }
+    
+    hz = FrequencyFromRegression();
+    
+    if (hz == 0)
+    {
+        return spki_Fail(SPK_ERROR_TIMER, "spk_TimerCalibrate", "no CPUID frequency and the clock regression failed");
+    }
+    
+    tsc_hz = hz;
+    tsc_source = SPK_TIMER_REGRESSION;
+    
+    if (cache != NULL && CacheStore(cache, signature, brand, hz))
+    {
+        return spki_Fail(SPK_ERROR_FILEIO, "spk_TimerCalibrate", "could not append to %s", cache);
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/******************************************************************************/
+
+enum spk_timer_source spk_TimerGetSource(void)
+{
+    return tsc_source;
+}
+
+/*******************************************************************************
+The overhead is in cycles, so unlike the frequency it does not depend on the
+calibration above. Each fence is measured with its own copy of the loop so that
+the inlined reads are exactly what a caller with a constant fence gets. A short
+warm up brings the loop into the uop cache before anything is kept.
+*/
+
+#define OVERHEAD_WARMUP 64
+#define OVERHEAD_SAMPLES 1000
+#define OVERHEAD_UNSET (~0ULL)
+
+static unsigned long long overhead[SPK_TIMER_UNFENCED + 1] =
+{
+    OVERHEAD_UNSET, OVERHEAD_UNSET, OVERHEAD_UNSET
+};
+
+static inline __attribute__((always_inline)) unsigned long long MeasureOverhead(const enum spk_timer_fence fence)
+{
+    spk_timer timer;
+    unsigned long long best = OVERHEAD_UNSET;
+    
+    for (int i = 0; i < OVERHEAD_WARMUP + OVERHEAD_SAMPLES; i++)
+    {
+        spk_TimerBeginAs(&timer, fence);
+        spk_TimerEndAs(&timer, fence);
+        
+        if (i >= OVERHEAD_WARMUP && timer.cycles < best) best = timer.cycles;
+    }
+    
+    return best;
+}
+
+/*******************************************************************************
+API access to timer overhead
+*/
+
+unsigned long long spk_TimerOverhead(enum spk_timer_fence fence)
+{
+    assert(fence >= SPK_TIMER_SERIALIZE && fence <= SPK_TIMER_UNFENCED);
+    
+    unsigned long long cycles = __atomic_load_n(&overhead[fence], __ATOMIC_RELAXED);
+    if (cycles != OVERHEAD_UNSET) return cycles;
+    
+    switch (fence)
+    {
+        case SPK_TIMER_SERIALIZE:
+            cycles = MeasureOverhead(SPK_TIMER_SERIALIZE);
+            break;
+            
+        case SPK_TIMER_LFENCE:
+            cycles = MeasureOverhead(SPK_TIMER_LFENCE);
+            break;
+            
+        default:
+            cycles = MeasureOverhead(SPK_TIMER_UNFENCED);
+            break;
+    }
+    
+    //racing threads each store their own minimum, any of them is valid
+    __atomic_store_n(&overhead[fence], cycles, __ATOMIC_RELAXED);
+    
+    return cycles;
+}
+
+/******************************************************************************/
+
+unsigned long long spk_TimerNet(unsigned long long cycles, enum spk_timer_fence fence)
+{
+    const unsigned long long floor = spk_TimerOverhead(fence);
+    
+    return cycles > floor ? cycles - floor : 0;
+}
+
+/*******************************************************************************
+Calibrate on first use if the caller did not, without a cache. A failure has
+already been logged by spk_TimerCalibrate and leaves tsc_hz at INIT_HZ, which
+the callers below must check before dividing by it.
+*/
+
+static void TimerSetHz(void)
+{
+    if (tsc_hz == INIT_HZ) (void) spk_TimerCalibrate(NULL);
+}
 
 /*******************************************************************************
 API access to estimated TSC frequency
@@ -122,15 +422,22 @@ spk_timer_result spk_TimerElapsedTime(unsigned long long cycles)
     
     TimerSetHz();
     
-    tr.elapsed = (double) cycles / (double) tsc_hz;
     tr.resolution = SPK_TIMER_SECONDS;
     
-    while (tr.elapsed < 1.0)
+    if (tsc_hz == INIT_HZ)
+    {
+        tr.elapsed = NAN;
+        strcpy(tr.symbol, symbol_lookup[tr.resolution]);
+        return tr;
+    }
+    
+    tr.elapsed = (double) cycles / (double) tsc_hz;
+    
+    //net cycles can be zero or under a nanosecond, those stay in nanoseconds
+    while (tr.elapsed < 1.0 && tr.resolution < SPK_TIMER_NANOSECONDS)
     {
         tr.elapsed *= 1000.0;
         tr.resolution += 1;
-        
-        assert(tr.resolution <= SPK_TIMER_NANOSECONDS && "timer formatting");
     }
     
     strcpy(tr.symbol, symbol_lookup[tr.resolution]);
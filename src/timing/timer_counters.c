@@ -0,0 +1,225 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Hardware performance counters via perf_event_open alongside the TSC
+* LICS: MIT License
+*/
+
+#define _GNU_SOURCE //syscall under -std=c99
+
+#include "timer_counters.h"
+
+#include <assert.h>
+#include <string.h> //memset
+#include <unistd.h> //syscall, read, close
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h> //SYS_perf_event_open
+#endif
+
+/*******************************************************************************
+Every event joins one group led by the first event that opens, so a single read
+returns all of them and the kernel only ever schedules them onto the PMU as a
+unit. The leader is pinned, which means the group is never multiplexed and the
+counts never need scaling: if it cannot stay on the PMU the read fails instead.
+Values come back in the order the events joined, which is enum order.
+*/
+
+static const char *event_names[SPK_COUNTER_EVENTS] =
+{
+    [SPK_COUNTER_CYCLES]        = "cycles",
+    [SPK_COUNTER_REF_CYCLES]    = "ref_cycles",
+    [SPK_COUNTER_INSTRUCTIONS]  = "instructions",
+    [SPK_COUNTER_BRANCH_MISSES] = "branch_misses",
+    [SPK_COUNTER_L1D_MISSES]    = "l1d_misses",
+    [SPK_COUNTER_LLC_MISSES]    = "llc_misses"
+};
+
+static int leader = -1;
+static int fds[SPK_COUNTER_EVENTS] = {-1, -1, -1, -1, -1, -1};
+static unsigned int available = 0;
+
+/******************************************************************************/
+
+#if defined(__linux__)
+
+static const struct
+{
+    unsigned int type;
+    char padding[4];
+    unsigned long long config;
+}
+events[SPK_COUNTER_EVENTS] =
+{
+    [SPK_COUNTER_CYCLES]        = {PERF_TYPE_HARDWARE, {0}, PERF_COUNT_HW_CPU_CYCLES},
+    [SPK_COUNTER_REF_CYCLES]    = {PERF_TYPE_HARDWARE, {0}, PERF_COUNT_HW_REF_CPU_CYCLES},
+    [SPK_COUNTER_INSTRUCTIONS]  = {PERF_TYPE_HARDWARE, {0}, PERF_COUNT_HW_INSTRUCTIONS},
+    [SPK_COUNTER_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, {0}, PERF_COUNT_HW_BRANCH_MISSES},
+    [SPK_COUNTER_L1D_MISSES]    = {PERF_TYPE_HW_CACHE, {0}, PERF_COUNT_HW_CACHE_L1D
+                                    | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    [SPK_COUNTER_LLC_MISSES]    = {PERF_TYPE_HARDWARE, {0}, PERF_COUNT_HW_CACHE_MISSES}
+};
+
+static int OpenEvent(int event, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    
+    attr.type = events[event].type;
+    attr.size = sizeof(attr);
+    attr.config = events[event].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.pinned = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0UL);
+}
+
+/*******************************************************************************
+Read the whole group into dest in enum order, zero for events not in the group
+*/
+
+static int ReadGroup(unsigned long long dest[SPK_COUNTER_EVENTS])
+{
+    unsigned long long buffer[1 + SPK_COUNTER_EVENTS];
+    
+    const ssize_t bytes = read(leader, buffer, sizeof(buffer));
+    if (bytes < (ssize_t) sizeof(buffer[0])) return SPK_ERROR_COUNTERS;
+    
+    const unsigned long long members = buffer[0];
+    unsigned long long k = 0;
+    
+    for (int i = 0; i < SPK_COUNTER_EVENTS; i++)
+    {
+        if (available & (1U << i) && k < members) dest[i] = buffer[1 + k++];
+        else dest[i] = 0;
+    }
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+#else
+
+static int OpenEvent(int event, int group)
+{
+    (void) event;
+    (void) group;
+    
+    return -1;
+}
+
+static int ReadGroup(unsigned long long dest[SPK_COUNTER_EVENTS])
+{
+    (void) dest;
+    
+    return SPK_ERROR_COUNTERS;
+}
+
+#endif
+
+/******************************************************************************/
+
+int spk_CountersOpen(void)
+{
+    if (leader != -1) return SPK_ERROR_SUCCESS;
+    
+    for (int i = 0; i < SPK_COUNTER_EVENTS; i++)
+    {
+        fds[i] = OpenEvent(i, leader);
+        if (fds[i] == -1) continue;
+        
+        if (leader == -1) leader = fds[i];
+        available |= 1U << i;
+    }
+    
+    return leader == -1 ? SPK_ERROR_COUNTERS : SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Members before the leader, although the kernel copes with either order
+*/
+
+void spk_CountersClose(void)
+{
+    for (int i = SPK_COUNTER_EVENTS - 1; i >= 0; i--)
+    {
+        if (fds[i] != -1) close(fds[i]);
+        fds[i] = -1;
+    }
+    
+    leader = -1;
+    available = 0;
+}
+
+/******************************************************************************/
+
+unsigned int spk_CountersAvailable(void)
+{
+    return available;
+}
+
+/******************************************************************************/
+
+void spk_CountersBegin(spk_counters *counters)
+{
+    assert(counters);
+    
+    memset(counters, 0, sizeof(spk_counters));
+    
+    if (leader == -1) return;
+    if (ReadGroup(counters->start)) return;
+    
+    counters->available = available;
+}
+
+/******************************************************************************/
+
+int spk_CountersEnd(spk_counters *counters)
+{
+    assert(counters);
+    
+    if (counters->available == 0) return SPK_ERROR_COUNTERS;
+    
+    unsigned long long now[SPK_COUNTER_EVENTS];
+    
+    if (ReadGroup(now) == SPK_ERROR_SUCCESS)
+    {
+        for (int i = 0; i < SPK_COUNTER_EVENTS; i++)
+        {
+            counters->value[i] = now[i] - counters->start[i];
+        }
+        
+        return SPK_ERROR_SUCCESS;
+    }
+    
+    memset(counters->value, 0, sizeof(counters->value));
+    counters->available = 0;
+    
+    return SPK_ERROR_COUNTERS;
+}
+
+/******************************************************************************/
+
+double spk_CountersRatio(const spk_counters *counters, enum spk_counter_event a, enum spk_counter_event b)
+{
+    assert(counters);
+    assert(a < SPK_COUNTER_EVENTS && b < SPK_COUNTER_EVENTS);
+    
+    const unsigned int needed = (1U << a) | (1U << b);
+    
+    if ((counters->available & needed) != needed) return -1.0;
+    if (counters->value[b] == 0) return -1.0;
+    
+    return (double) counters->value[a] / (double) counters->value[b];
+}
+
+/******************************************************************************/
+
+const char *spk_CountersName(enum spk_counter_event event)
+{
+    assert(event < SPK_COUNTER_EVENTS);
+    
+    return event_names[event];
+}
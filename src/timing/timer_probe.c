@@ -0,0 +1,255 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: Per-thread registry of named TSC probes
+* LICS: MIT License
+*/
+
+#include "timer_probe.h"
+#include "scipack_internal.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h> //calloc
+#include <string.h> //strlen, strcmp, memcpy, memset
+
+/*******************************************************************************
+Every thread gets its own block of counters on its first sample and pushes it
+onto a lock-free list, so the record path never shares a cache line with any
+other thread and needs no atomic read-modify-write. Fields are still written
+with relaxed atomic stores so that a concurrent snapshot never sees a torn
+value. Blocks are never freed, which keeps the samples of exited threads in
+the snapshot and means a snapshot can walk the list without any lock.
+*/
+
+struct probe_counter
+{
+    unsigned long long count;
+    unsigned long long total;
+    unsigned long long min;
+    unsigned long long max;
+    unsigned long long histogram[SPK_PROBE_BUCKETS];
+};
+
+struct probe_block
+{
+    struct probe_block *next;
+    struct probe_counter counters[SPK_PROBE_MAX];
+};
+
+int spk_probe_enabled = 0;
+
+static struct probe_block *blocks = NULL;
+static __thread struct probe_block *local = NULL;
+
+/*******************************************************************************
+Names are only written under the lock, and the probe count is published after
+the name so that an unlocked reader which sees id < probes sees its name too.
+*/
+
+static pthread_mutex_t registry = PTHREAD_MUTEX_INITIALIZER;
+static char names[SPK_PROBE_MAX][SPK_PROBE_NAME];
+static int probes = 0;
+
+/******************************************************************************/
+
+void spk_ProbeEnable(int enabled)
+{
+    __atomic_store_n(&spk_probe_enabled, enabled != 0, __ATOMIC_RELAXED);
+}
+
+/******************************************************************************/
+
+int spk_ProbeRegister(const char *name, int *id)
+{
+    assert(name);
+    assert(id);
+    
+    const size_t len = strlen(name);
+    
+    if (len == 0 || len >= SPK_PROBE_NAME)
+    {
+        return spki_Fail(SPK_ERROR_ARGBOUNDS, "spk_ProbeRegister", "name of %zu bytes outside [1, %d)", len, SPK_PROBE_NAME);
+    }
+    
+    int error = SPK_ERROR_SUCCESS;
+    
+    pthread_mutex_lock(&registry);
+    
+    int i = 0;
+    while (i < probes && strcmp(names[i], name) != 0) i++;
+    
+    if (i == probes)
+    {
+        if (probes == SPK_PROBE_MAX) error = SPK_ERROR_ARGBOUNDS;
+        else
+        {
+            memcpy(names[i], name, len + 1);
+            __atomic_store_n(&probes, probes + 1, __ATOMIC_RELEASE);
+        }
+    }
+    
+    pthread_mutex_unlock(&registry);
+    
+    if (error) return spki_Fail(error, "spk_ProbeRegister", "all %d probes are taken, no room for %s", SPK_PROBE_MAX, name);
+    
+    *id = i;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+Attach the calling thread on its first sample
+*/
+
+static struct probe_block *Attach(void)
+{
+    struct probe_block *block = calloc(1, sizeof(struct probe_block));
+    if (!block) return NULL;
+    
+    block->next = __atomic_load_n(&blocks, __ATOMIC_RELAXED);
+    
+    while (!__atomic_compare_exchange_n(&blocks, &block->next, block, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+        //block->next was refreshed by the failed exchange
+    }
+    
+    local = block;
+    
+    return block;
+}
+
+/*******************************************************************************
+Single writer per counter, so plain load and store pairs are enough
+*/
+
+#define BUMP(field, value) __atomic_store_n(&(field), (field) + (value), __ATOMIC_RELAXED)
+#define SET(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+
+void spk_ProbeRecord(int id, unsigned long long cycles)
+{
+    if (!__atomic_load_n(&spk_probe_enabled, __ATOMIC_RELAXED)) return;
+    if (id < 0 || id >= SPK_PROBE_MAX) return;
+    
+    struct probe_block *block = local;
+    if (!block) block = Attach();
+    if (!block) return;
+    
+    struct probe_counter *counter = &block->counters[id];
+    const int bucket = cycles ? 63 - __builtin_clzll(cycles) : 0;
+    
+    if (counter->count == 0 || cycles < counter->min) SET(counter->min, cycles);
+    if (cycles > counter->max) SET(counter->max, cycles);
+    
+    BUMP(counter->total, cycles);
+    BUMP(counter->histogram[bucket], 1);
+    BUMP(counter->count, 1);
+}
+
+/*******************************************************************************
+Sum probe id over every attached thread
+*/
+
+#define LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+static void Collect(int id, spk_probe_stats *stats)
+{
+    memset(stats, 0, sizeof(spk_probe_stats));
+    memcpy(stats->name, names[id], SPK_PROBE_NAME);
+    
+    const struct probe_block *block = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE);
+    
+    for (; block; block = block->next)
+    {
+        const struct probe_counter *counter = &block->counters[id];
+        const unsigned long long count = LOAD(counter->count);
+        
+        if (count == 0) continue;
+        
+        const unsigned long long min = LOAD(counter->min);
+        const unsigned long long max = LOAD(counter->max);
+        
+        if (stats->count == 0 || min < stats->min) stats->min = min;
+        if (max > stats->max) stats->max = max;
+        
+        stats->count += count;
+        stats->total += LOAD(counter->total);
+        
+        for (int k = 0; k < SPK_PROBE_BUCKETS; k++)
+        {
+            stats->histogram[k] += LOAD(counter->histogram[k]);
+        }
+    }
+}
+
+/******************************************************************************/
+
+int spk_ProbeSnapshot(spk_probe_stats *dest, size_t capacity, size_t *count)
+{
+    assert(dest || capacity == 0);
+    assert(count);
+    
+    const int n = __atomic_load_n(&probes, __ATOMIC_ACQUIRE);
+    
+    for (int i = 0; i < n && (size_t) i < capacity; i++) Collect(i, &dest[i]);
+    
+    *count = (size_t) n;
+    
+    return SPK_ERROR_SUCCESS;
+}
+
+/*******************************************************************************
+One row per probe, followed by its non-empty histogram buckets as 2^k:samples
+*/
+
+void spk_ProbeDump(FILE *stream)
+{
+    assert(stream);
+    
+    spk_probe_stats stats;
+    const int n = __atomic_load_n(&probes, __ATOMIC_ACQUIRE);
+    
+    fprintf(stream, "%-31s %12s %16s %12s %12s %12s\n", "probe", "count", "total", "mean", "min", "max");
+    
+    for (int i = 0; i < n; i++)
+    {
+        Collect(i, &stats);
+        
+        const double mean = stats.count ? (double) stats.total / (double) stats.count : 0.0;
+        
+        fprintf(stream, "%-31s %12llu %16llu %12.1f %12llu %12llu\n",
+            stats.name, stats.count, stats.total, mean, stats.min, stats.max);
+            
+        if (stats.count == 0) continue;
+        
+        fprintf(stream, "   ");
+        
+        for (int k = 0; k < SPK_PROBE_BUCKETS; k++)
+        {
+            if (stats.histogram[k]) fprintf(stream, " 2^%d:%llu", k, stats.histogram[k]);
+        }
+        
+        fprintf(stream, "\n");
+    }
+}
+
+/******************************************************************************/
+
+void spk_ProbeReset(void)
+{
+    struct probe_block *block = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE);
+    
+    for (; block; block = block->next)
+    {
+        for (int i = 0; i < SPK_PROBE_MAX; i++)
+        {
+            struct probe_counter *counter = &block->counters[i];
+            
+            SET(counter->count, 0);
+            SET(counter->total, 0);
+            SET(counter->min, 0);
+            SET(counter->max, 0);
+            
+            for (int k = 0; k < SPK_PROBE_BUCKETS; k++) SET(counter->histogram[k], 0);
+        }
+    }
+}
@@ -0,0 +1,401 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/probability/continuous.c
+* LICS: MIT License
+*/
+
+#include "continuous.h"
+#include "generator_pool.h"
+#include "generator_simd.h"
+#include "test_fixtures.h"
+#include "unity.h"
+
+#include <math.h> //sqrt, exp, NAN
+#include <stdarg.h> //va_list
+#include <stdlib.h> //malloc, free, exit_failure
+#include <stdio.h> //fprintf, remove
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+#define SAMPLES ((size_t) 4000000)
+#define POOL_PATH "./continuous_pool_test.bin"
+
+/*******************************************************************************
+Argument tests
+*******************************************************************************/
+
+void test_negative_or_nan_sigma_is_rejected(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    double dest[1] = {0};
+    
+    //act
+    int negative = spk_Normal(rng, dest, 1, 0.0, -1.0);
+    int not_a_number = spk_Normal(rng, dest, 1, 0.0, NAN);
+    int bad_mean = spk_Normal(rng, dest, 1, NAN, 1.0);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, negative);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, not_a_number);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, bad_mean);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+static void NamingLogger(void *ctx, int error, const char *where, const char *format, va_list args)
+{
+    (void) error;
+    (void) format;
+    (void) args;
+    
+    *(const char **) ctx = where;
+}
+
+void test_rejections_are_logged_under_the_sampler_name(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    double dest[1] = {0};
+    const char *where = NULL;
+    
+    spk_SetLogger(NamingLogger, &where);
+    
+    //act
+    spk_Normal(rng, dest, 1, 0.0, -1.0);
+    const char *normal = where;
+    spk_Exponential(rng, dest, 1, 0.0);
+    const char *exponential = where;
+    
+    spk_SetLogger(NULL, NULL);
+    
+    //assert
+    TEST_ASSERT_EQUAL_STRING("spk_Normal", normal);
+    TEST_ASSERT_EQUAL_STRING("spk_Exponential", exponential);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_nonpositive_lambda_is_rejected(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    double dest[1] = {0};
+    
+    //act
+    int zero = spk_Exponential(rng, dest, 1, 0.0);
+    int negative = spk_Exponential(rng, dest, 1, -2.0);
+    int not_a_number = spk_Exponential(rng, dest, 1, NAN);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, zero);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, negative);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, not_a_number);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_zero_sigma_returns_the_mean(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    double dest[100] = {0};
+    
+    //act
+    int error = spk_Normal(rng, dest, 100, 3.5, 0.0);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    for (size_t i = 0; i < 100; i++) TEST_ASSERT_EQUAL_DOUBLE(3.5, dest[i]);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Stream tests. No raw words are left over at the end of a call, so splitting one
+fill into several calls on a SISD generator must produce the same variates.
+*******************************************************************************/
+
+void test_split_normal_fills_match_one_fill_XSH64(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator reference;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 7));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_XSH64, 7));
+    
+    double expected[1000] = {0};
+    double SUT_output[1000] = {1};
+    
+    //act
+    CHECK(spk_Normal(reference, expected, 1000, 0.0, 1.0));
+    CHECK(spk_Normal(rng, SUT_output, 1, 0.0, 1.0));
+    CHECK(spk_Normal(rng, SUT_output + 1, 300, 0.0, 1.0));
+    CHECK(spk_Normal(rng, SUT_output + 301, 699, 0.0, 1.0));
+    
+    //assert
+    TEST_ASSERT_EQUAL_DOUBLE_ARRAY(expected, SUT_output, 1000);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+    spk_GeneratorDelete(reference);
+}
+
+/******************************************************************************/
+
+void test_split_exponential_fills_match_one_fill_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator reference;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 7));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 7));
+    
+    double expected[1000] = {0};
+    double SUT_output[1000] = {1};
+    
+    //act
+    CHECK(spk_Exponential(reference, expected, 1000, 1.0));
+    CHECK(spk_Exponential(rng, SUT_output, 513, 1.0));
+    CHECK(spk_Exponential(rng, SUT_output + 513, 487, 1.0));
+    
+    //assert
+    TEST_ASSERT_EQUAL_DOUBLE_ARRAY(expected, SUT_output, 1000);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+    spk_GeneratorDelete(reference);
+}
+
+/*******************************************************************************
+Distribution tests. With 4 million samples the standard error of the mean is
+0.0005 sigma, the bounds below sit at roughly 5 standard errors.
+*******************************************************************************/
+
+void test_normal_moments_and_tail_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    double *dest = malloc(SAMPLES * sizeof(double));
+    CHECK(dest == NULL);
+    
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    size_t beyond_3 = 0;
+    size_t beyond_r = 0;
+    
+    //act
+    CHECK(spk_Normal(rng, dest, SAMPLES, 2.0, 3.0));
+    
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        const double z = (dest[i] - 2.0) / 3.0;
+        sum += z;
+        sum_sq += z * z;
+        if (z > 3.0) beyond_3++;
+        if (z > 3.7 || z < -3.7) beyond_r++;
+    }
+    
+    const double mean = sum / (double) SAMPLES;
+    const double variance = sum_sq / (double) SAMPLES - mean * mean;
+    
+    //assert, P(Z > 3) = 0.0013499 and P(|Z| > 3.7) = 0.00021563
+    TEST_ASSERT_DOUBLE_WITHIN(0.0025, 0.0, mean);
+    TEST_ASSERT_DOUBLE_WITHIN(0.005, 1.0, variance);
+    TEST_ASSERT_UINT64_WITHIN(370, 5400, beyond_3);
+    TEST_ASSERT_UINT64_WITHIN(150, 863, beyond_r);
+    
+    //teardown
+    free(dest);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_normal_is_symmetric_PCG64ix8(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64ix8, 1));
+    double *dest = malloc(SAMPLES * sizeof(double));
+    CHECK(dest == NULL);
+    
+    size_t positive = 0;
+    size_t upper = 0;
+    size_t lower = 0;
+    
+    //act
+    CHECK(spk_Normal(rng, dest, SAMPLES, 0.0, 1.0));
+    
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        if (dest[i] > 0.0) positive++;
+        if (dest[i] > 1.0) upper++;
+        if (dest[i] < -1.0) lower++;
+    }
+    
+    //assert, P(Z > 1) = 0.158655
+    TEST_ASSERT_UINT64_WITHIN(5000, SAMPLES / 2, positive);
+    TEST_ASSERT_UINT64_WITHIN(3700, 634620, upper);
+    TEST_ASSERT_UINT64_WITHIN(3700, 634620, lower);
+    
+    //teardown
+    free(dest);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_exponential_moments_and_tail_XSH64(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    double *dest = malloc(SAMPLES * sizeof(double));
+    CHECK(dest == NULL);
+    
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    size_t beyond_1 = 0;
+    size_t beyond_r = 0;
+    size_t negative = 0;
+    
+    //act
+    CHECK(spk_Exponential(rng, dest, SAMPLES, 4.0));
+    
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        const double x = dest[i] * 4.0;
+        sum += x;
+        sum_sq += x * x;
+        if (x < 0.0) negative++;
+        if (x > 1.0) beyond_1++;
+        if (x > 7.7) beyond_r++;
+    }
+    
+    const double mean = sum / (double) SAMPLES;
+    const double variance = sum_sq / (double) SAMPLES - mean * mean;
+    
+    //assert, P(X > 1) = 0.367879 and P(X > 7.7) = 0.00045283
+    TEST_ASSERT_EQUAL_size_t(0, negative);
+    TEST_ASSERT_DOUBLE_WITHIN(0.0025, 1.0, mean);
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 1.0, variance);
+    TEST_ASSERT_UINT64_WITHIN(4900, 1471518, beyond_1);
+    TEST_ASSERT_UINT64_WITHIN(220, 1811, beyond_r);
+    
+    //teardown
+    free(dest);
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Failure tests
+*******************************************************************************/
+
+void test_failing_generator_stops_both_samplers_XSH64(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    double dest[1000] = {0};
+    
+    int (*next)(uint64_t *, uint64_t *, const size_t) = rng->next;
+    rng->next = FailingNext;
+    
+    //act
+    int normal = spk_Normal(rng, dest, 1000, 0.0, 1.0);
+    int exponential = spk_Exponential(rng, dest, 1000, 1.0);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, normal);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, exponential);
+    
+    //teardown
+    rng->next = next;
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_nearly_exhausted_or_unid_pool_fails_the_samplers(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator unid;
+    spk_pool_info info;
+    double dest[100] = {0};
+    uint64_t words[60];
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, 1, 0, 64, SPK_POOL_NEXT));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    CHECK(SUT->next(SUT->state, words, 60));
+    
+    //act, four words left and a block of 100 requested
+    int normal = spk_Normal(SUT, dest, 100, 0.0, 1.0);
+    int exponential = spk_Exponential(SUT, dest, 100, 1.0);
+    CHECK(spk_GeneratorPoolInfo(SUT, &info));
+    spk_GeneratorDelete(SUT);
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, 1, 0, 64, SPK_POOL_UNID));
+    CHECK(spk_GeneratorPoolOpen(&unid, POOL_PATH));
+    int raw = spk_Normal(unid, dest, 10, 0.0, 1.0);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_EXHAUSTED, normal);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_EXHAUSTED, exponential);
+    TEST_ASSERT_TRUE(info.cursor == 60);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, raw);
+    
+    //teardown
+    spk_GeneratorDelete(unid);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //argument tests
+        RUN_TEST(test_negative_or_nan_sigma_is_rejected);
+        RUN_TEST(test_rejections_are_logged_under_the_sampler_name);
+        RUN_TEST(test_nonpositive_lambda_is_rejected);
+        RUN_TEST(test_zero_sigma_returns_the_mean);
+        
+        //stream tests
+        RUN_TEST(test_split_normal_fills_match_one_fill_XSH64);
+        RUN_TEST(test_split_exponential_fills_match_one_fill_PCG64i);
+        
+        //distribution tests
+        RUN_TEST(test_normal_moments_and_tail_PCG64i);
+        RUN_TEST(test_normal_is_symmetric_PCG64ix8);
+        RUN_TEST(test_exponential_moments_and_tail_XSH64);
+        
+        //failure tests
+        RUN_TEST(test_failing_generator_stops_both_samplers_XSH64);
+        RUN_TEST(test_nearly_exhausted_or_unid_pool_fails_the_samplers);
+    return UNITY_END();
+}
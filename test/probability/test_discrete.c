@@ -0,0 +1,751 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/probability/discrete.c
+* LICS: MIT License
+*/
+
+#include "discrete.h"
+#include "generator_simd.h"
+#include "test_fixtures.h"
+#include "unity.h"
+
+#include <math.h> //sqrt, exp, log, lgamma, floor, fabs, NAN, INFINITY
+#include <stdlib.h> //malloc, free, exit_failure
+#include <stdio.h> //fprintf
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+#define SAMPLES ((size_t) 1000000)
+
+/*******************************************************************************
+Construction tests
+*******************************************************************************/
+
+void test_invalid_weights_are_rejected(void)
+{
+    //arrange
+    spk_discrete SUT;
+    const double negative[3] = {1.0, -0.5, 1.0};
+    const double not_a_number[3] = {1.0, NAN, 1.0};
+    const double infinite[3] = {1.0, INFINITY, 1.0};
+    const double zeros[3] = {0.0, 0.0, 0.0};
+    
+    //act
+    int empty_error = spk_DiscreteNew(&SUT, negative, 0);
+    int negative_error = spk_DiscreteNew(&SUT, negative, 3);
+    int nan_error = spk_DiscreteNew(&SUT, not_a_number, 3);
+    int inf_error = spk_DiscreteNew(&SUT, infinite, 3);
+    int zero_error = spk_DiscreteNew(&SUT, zeros, 3);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, empty_error);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, negative_error);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, nan_error);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, inf_error);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, zero_error);
+}
+
+/******************************************************************************/
+
+void test_columns_are_padded_to_a_power_of_two(void)
+{
+    //arrange
+    spk_discrete SUT;
+    const double weights[5] = {1.0, 1.0, 1.0, 1.0, 1.0};
+    
+    //act
+    CHECK(spk_DiscreteNew(&SUT, weights, 5));
+    
+    //assert, 8 columns
+    TEST_ASSERT_EQUAL_size_t(5, SUT->outcomes);
+    TEST_ASSERT_EQUAL_UINT64(61, SUT->shift);
+    
+    //teardown
+    spk_DiscreteDelete(SUT);
+}
+
+/*******************************************************************************
+Sampling tests
+*******************************************************************************/
+
+void test_single_outcome_is_always_drawn(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_discrete SUT;
+    const double weights[1] = {0.25};
+    uint64_t dest[1000] = {0};
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_DiscreteNew(&SUT, weights, 1));
+    
+    for (size_t i = 0; i < 1000; i++) dest[i] = 1;
+    
+    //act
+    CHECK(spk_DiscreteSample(rng, SUT, dest, 1000));
+    
+    //assert
+    for (size_t i = 0; i < 1000; i++) TEST_ASSERT_EQUAL_UINT64(0, dest[i]);
+    
+    //teardown
+    spk_DiscreteDelete(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_zero_weights_and_padding_are_never_drawn(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_discrete SUT;
+    const double weights[5] = {0.0, 3.0, 0.0, 1.0, 0.0};
+    uint64_t *dest = malloc(SAMPLES * sizeof(uint64_t));
+    size_t counts[8] = {0};
+    
+    CHECK(dest == NULL);
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_DiscreteNew(&SUT, weights, 5));
+    
+    //act
+    CHECK(spk_DiscreteSample(rng, SUT, dest, SAMPLES));
+    for (size_t i = 0; i < SAMPLES; i++) counts[dest[i] < 8 ? dest[i] : 7]++;
+    
+    //assert, the 3:1 split has a standard deviation of 433 counts
+    TEST_ASSERT_EQUAL_size_t(0, counts[0]);
+    TEST_ASSERT_EQUAL_size_t(0, counts[2]);
+    TEST_ASSERT_EQUAL_size_t(0, counts[4]);
+    TEST_ASSERT_EQUAL_size_t(0, counts[5] + counts[6] + counts[7]);
+    TEST_ASSERT_UINT64_WITHIN(2200, 750000, counts[1]);
+    TEST_ASSERT_UINT64_WITHIN(2200, 250000, counts[3]);
+    
+    //teardown
+    free(dest);
+    spk_DiscreteDelete(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_frequencies_match_weights_PCG64ix8(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_discrete SUT;
+    double weights[10] = {0};
+    uint64_t *dest = malloc(SAMPLES * sizeof(uint64_t));
+    size_t counts[10] = {0};
+    
+    CHECK(dest == NULL);
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64ix8, 1));
+    
+    for (size_t i = 0; i < 10; i++) weights[i] = (double) (i + 1);
+    CHECK(spk_DiscreteNew(&SUT, weights, 10));
+    
+    //act
+    CHECK(spk_DiscreteSample(rng, SUT, dest, SAMPLES));
+    
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        CHECK(dest[i] >= 10);
+        counts[dest[i]]++;
+    }
+    
+    //assert, outcome i has probability (i + 1) / 55, bounds at 5 sigma
+    for (size_t i = 0; i < 10; i++)
+    {
+        const double p = (double) (i + 1) / 55.0;
+        const double expected = p * (double) SAMPLES;
+        const double sigma = sqrt(expected * (1.0 - p));
+        
+        TEST_ASSERT_DOUBLE_WITHIN(5.0 * sigma, expected, (double) counts[i]);
+    }
+    
+    //teardown
+    free(dest);
+    spk_DiscreteDelete(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_large_table_mean_matches_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_discrete SUT;
+    const size_t outcomes = 100000;
+    double *weights = malloc(outcomes * sizeof(double));
+    uint64_t *dest = malloc(SAMPLES * sizeof(uint64_t));
+    
+    CHECK(weights == NULL);
+    CHECK(dest == NULL);
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    
+    //linearly decreasing weights, the mean index is (outcomes - 1) / 3
+    for (size_t i = 0; i < outcomes; i++) weights[i] = (double) (outcomes - i);
+    CHECK(spk_DiscreteNew(&SUT, weights, outcomes));
+    
+    double sum = 0.0;
+    
+    //act
+    CHECK(spk_DiscreteSample(rng, SUT, dest, SAMPLES));
+    
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        CHECK(dest[i] >= outcomes);
+        sum += (double) dest[i];
+    }
+    
+    //assert, the index standard deviation is about 23570 so 5 sigma is 118
+    TEST_ASSERT_DOUBLE_WITHIN(120.0, 33333.0, sum / (double) SAMPLES);
+    
+    //teardown
+    free(weights);
+    free(dest);
+    spk_DiscreteDelete(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_one_raw_word_is_consumed_per_sample_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator reference;
+    spk_discrete SUT;
+    const double weights[3] = {1.0, 2.0, 3.0};
+    uint64_t dest[1000] = {0};
+    uint64_t expected[1001] = {0};
+    uint64_t SUT_output = 0;
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_DiscreteNew(&SUT, weights, 3));
+    
+    //act
+    CHECK(spk_DiscreteSample(rng, SUT, dest, 1000));
+    CHECK(rng->next(rng->state, &SUT_output, 1));
+    CHECK(reference->next(reference->state, expected, 1001));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64(expected[1000], SUT_output);
+    
+    //teardown
+    spk_DiscreteDelete(SUT);
+    spk_GeneratorDelete(rng);
+    spk_GeneratorDelete(reference);
+}
+
+/*******************************************************************************
+Binomial tests. Every sampling path is checked against the exact probability
+mass function, bin by bin, at 5 standard deviations.
+*******************************************************************************/
+
+static void CheckBinomialPMF(int id, uint64_t trials, double p)
+{
+    spk_generator rng;
+    uint64_t *dest = malloc(SAMPLES * sizeof(uint64_t));
+    size_t *counts = calloc(trials + 1, sizeof(size_t));
+    
+    CHECK(dest == NULL);
+    CHECK(counts == NULL);
+    CHECK(spk_GeneratorNew(&rng, id, 1));
+    CHECK(spk_Binomial(rng, dest, SAMPLES, trials, p));
+    
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        TEST_ASSERT_TRUE(dest[i] <= trials);
+        counts[dest[i]]++;
+    }
+    
+    const double n = (double) trials;
+    
+    for (uint64_t k = 0; k <= trials; k++)
+    {
+        const double x = (double) k;
+        const double log_pmf = lgamma(n + 1.0) - lgamma(x + 1.0) - lgamma(n - x + 1.0)
+                             + x * log(p) + (n - x) * log1p(-p);
+                             
+        const double pmf = exp(log_pmf);
+        const double expected = pmf * (double) SAMPLES;
+        const double sigma = sqrt(expected * (1.0 - pmf));
+        
+        TEST_ASSERT_DOUBLE_WITHIN(5.0 * sigma + 1.0, expected, (double) counts[k]);
+    }
+    
+    free(dest);
+    free(counts);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_binomial_invalid_arguments_are_rejected(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    uint64_t dest[1] = {0};
+    
+    //act
+    int negative = spk_Binomial(rng, dest, 1, 10, -0.1);
+    int above_one = spk_Binomial(rng, dest, 1, 10, 1.1);
+    int not_a_number = spk_Binomial(rng, dest, 1, 10, NAN);
+    int too_many = spk_Binomial(rng, dest, 1, SPK_BINOMIAL_MAX + 1, 0.5);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, negative);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, above_one);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, not_a_number);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, too_many);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_binomial_degenerate_cases_are_constant(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    uint64_t never[100] = {0};
+    uint64_t always[100] = {0};
+    uint64_t no_trials[100] = {0};
+    
+    //act
+    CHECK(spk_Binomial(rng, never, 100, 1000, 0.0));
+    CHECK(spk_Binomial(rng, always, 100, 1000, 1.0));
+    CHECK(spk_Binomial(rng, no_trials, 100, 0, 0.3));
+    
+    //assert
+    for (size_t i = 0; i < 100; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT64(0, never[i]);
+        TEST_ASSERT_EQUAL_UINT64(1000, always[i]);
+        TEST_ASSERT_EQUAL_UINT64(0, no_trials[i]);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_binomial_popcount_path_matches_pmf_PCG64i(void)
+{
+    CheckBinomialPMF(SPK_GENERATOR_PCG64i, 100, 0.25);
+    CheckBinomialPMF(SPK_GENERATOR_PCG64i, 70, 0.625);
+}
+
+/******************************************************************************/
+
+void test_binomial_inversion_path_matches_pmf_XSH64(void)
+{
+    CheckBinomialPMF(SPK_GENERATOR_XSH64, 50, 0.3);
+    CheckBinomialPMF(SPK_GENERATOR_XSH64, 1000, 0.99);
+}
+
+/******************************************************************************/
+
+void test_binomial_btpe_path_matches_pmf_PCG64ix8(void)
+{
+    CheckBinomialPMF(SPK_GENERATOR_PCG64ix8, 200, 0.4);
+    CheckBinomialPMF(SPK_GENERATOR_PCG64ix8, 500, 0.8);
+}
+
+/*******************************************************************************
+Only draws with 20 < |y - m| < npq / 2 - 1 that miss both squeezes reach the
+final Stirling test, and an error in its corrections shifts their acceptance by
+2 * (1 / 12(y + 1) + 1 / 12(n - y + 1)), about 0.1% here. The parameters put the
+most mass in that band for the size of the shift, and 2^28 draws make it a five
+sigma excess in the band count, far past the bin by bin resolution above.
+*******************************************************************************/
+#define BAND_SAMPLES ((size_t) 1 << 28)
+#define BAND_BLOCK ((size_t) 1 << 20)
+
+void test_binomial_btpe_stirling_band_mass_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    uint64_t *dest = malloc(BAND_BLOCK * sizeof(uint64_t));
+    CHECK(dest == NULL);
+    
+    const uint64_t trials = 2680;
+    const double p = 0.05;
+    const double n = (double) trials;
+    const double m = floor((n + 1.0) * p);
+    const double npq = n * p * (1.0 - p);
+    
+    double band = 0.0;
+    
+    //act
+    for (size_t i = 0; i < BAND_SAMPLES; i += BAND_BLOCK)
+    {
+        CHECK(spk_Binomial(rng, dest, BAND_BLOCK, trials, p));
+        
+        for (size_t j = 0; j < BAND_BLOCK; j++)
+        {
+            const double k = fabs((double) dest[j] - m);
+            if (k > 20.0 && k < npq / 2.0 - 1.0) band += 1.0;
+        }
+    }
+    
+    double mass = 0.0;
+    
+    for (uint64_t y = 0; y <= trials; y++)
+    {
+        const double x = (double) y;
+        const double k = fabs(x - m);
+        
+        if (k > 20.0 && k < npq / 2.0 - 1.0)
+        {
+            mass += exp(lgamma(n + 1.0) - lgamma(x + 1.0) - lgamma(n - x + 1.0) + x * log(p) + (n - x) * log1p(-p));
+        }
+    }
+    
+    const double expected = mass * (double) BAND_SAMPLES;
+    const double sigma = sqrt(expected * (1.0 - mass));
+    
+    //assert
+    TEST_ASSERT_DOUBLE_WITHIN(4.0 * sigma, expected, band);
+    
+    //teardown
+    free(dest);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_binomial_large_trial_moments_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    uint64_t *dest = malloc(SAMPLES * sizeof(uint64_t));
+    CHECK(dest == NULL);
+    
+    const double trials = 1e9;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    
+    //act
+    CHECK(spk_Binomial(rng, dest, SAMPLES, (uint64_t) trials, 0.3));
+    
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        const double x = (double) dest[i] - 0.3 * trials;
+        sum += x;
+        sum_sq += x * x;
+    }
+    
+    const double mean = sum / (double) SAMPLES;
+    const double variance = sum_sq / (double) SAMPLES - mean * mean;
+    
+    //assert, npq = 2.1e8 so the mean has a standard error of 14.5
+    TEST_ASSERT_DOUBLE_WITHIN(75.0, 0.0, mean);
+    TEST_ASSERT_DOUBLE_WITHIN(0.01 * 2.1e8, 2.1e8, variance);
+    
+    //teardown
+    free(dest);
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Shuffle and sampling tests
+*******************************************************************************/
+
+void test_shuffle_and_sample_invalid_arguments_are_rejected(void)
+{
+    //arrange
+    spk_generator rng;
+    uint64_t dest[4] = {0};
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    
+    //act and assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_Shuffle(rng, dest, 4, 0));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_SampleWithoutReplacement(rng, 4, 3, dest));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, spk_SampleWithoutReplacement(rng, 0, 0, dest));
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_shuffle_is_a_permutation_of_wide_elements_XSH64(void)
+{
+    //arrange, 100 byte records exercise the chunked swap
+    struct record {unsigned char bytes[100];};
+    
+    spk_generator rng;
+    struct record *SUT = malloc(1000 * sizeof(struct record));
+    size_t seen[1000] = {0};
+    
+    CHECK(SUT == NULL);
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    
+    for (size_t i = 0; i < 1000; i++)
+    {
+        for (size_t j = 0; j < 100; j++) SUT[i].bytes[j] = (unsigned char) (i + j);
+        SUT[i].bytes[99] = (unsigned char) (i >> 8);
+    }
+    
+    //act
+    CHECK(spk_Shuffle(rng, SUT, 1000, sizeof(struct record)));
+    
+    //assert, records move whole and each one appears exactly once
+    size_t moved = 0;
+    
+    for (size_t i = 0; i < 1000; i++)
+    {
+        const size_t id = (size_t) SUT[i].bytes[0] | ((size_t) SUT[i].bytes[99] << 8);
+        
+        TEST_ASSERT_TRUE(id < 1000);
+        TEST_ASSERT_EQUAL_UINT8((unsigned char) (id + 50), SUT[i].bytes[50]);
+        
+        seen[id]++;
+        if (id != i) moved++;
+    }
+    
+    for (size_t i = 0; i < 1000; i++) TEST_ASSERT_EQUAL_size_t(1, seen[i]);
+    TEST_ASSERT_TRUE(moved > 900);
+    
+    //teardown
+    free(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_shuffle_orderings_are_uniform_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    size_t counts[24] = {0};
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    
+    //act, rank each ordering of four 32-bit items by its Lehmer code
+    for (size_t trial = 0; trial < SAMPLES; trial++)
+    {
+        uint32_t SUT[4] = {0, 1, 2, 3};
+        CHECK(spk_Shuffle(rng, SUT, 4, sizeof(uint32_t)));
+        
+        size_t rank = 0;
+        
+        for (size_t i = 0; i < 4; i++)
+        {
+            size_t smaller = 0;
+            for (size_t j = i + 1; j < 4; j++) smaller += SUT[j] < SUT[i];
+            rank = rank * (4 - i) + smaller;
+        }
+        
+        counts[rank]++;
+    }
+    
+    //assert, bounds at 5 sigma
+    const double p = 1.0 / 24.0;
+    const double expected = p * (double) SAMPLES;
+    const double sigma = sqrt(expected * (1.0 - p));
+    
+    for (size_t i = 0; i < 24; i++)
+    {
+        TEST_ASSERT_DOUBLE_WITHIN(5.0 * sigma, expected, (double) counts[i]);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Both sampling paths must give each index the same chance of landing in each
+position of dest, which checks the subset and its order at the same time.
+*******************************************************************************/
+
+static void CheckSamplePositions(size_t k, uint64_t N)
+{
+    spk_generator rng;
+    uint64_t dest[16] = {0};
+    size_t *counts = calloc(k * N, sizeof(size_t));
+    const size_t trials = SAMPLES / k;
+    
+    CHECK(counts == NULL);
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64ix8, 1));
+    
+    for (size_t trial = 0; trial < trials; trial++)
+    {
+        CHECK(spk_SampleWithoutReplacement(rng, k, N, dest));
+        
+        for (size_t i = 0; i < k; i++)
+        {
+            TEST_ASSERT_TRUE(dest[i] < N);
+            for (size_t j = 0; j < i; j++) TEST_ASSERT_TRUE(dest[i] != dest[j]);
+            
+            counts[i * N + dest[i]]++;
+        }
+    }
+    
+    const double p = 1.0 / (double) N;
+    const double expected = p * (double) trials;
+    const double sigma = sqrt(expected * (1.0 - p));
+    
+    for (size_t i = 0; i < k * N; i++)
+    {
+        TEST_ASSERT_DOUBLE_WITHIN(5.0 * sigma, expected, (double) counts[i]);
+    }
+    
+    free(counts);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_dense_sample_positions_are_uniform_PCG64ix8(void)
+{
+    CheckSamplePositions(10, 12);
+    CheckSamplePositions(5, 5);
+}
+
+/******************************************************************************/
+
+void test_floyd_sample_positions_are_uniform_PCG64ix8(void)
+{
+    CheckSamplePositions(3, 40);
+    CheckSamplePositions(16, 100);
+}
+
+/******************************************************************************/
+
+void test_floyd_sample_from_huge_population_is_distinct_Xoshiro256(void)
+{
+    //arrange
+    spk_generator rng;
+    const size_t k = 100000;
+    const uint64_t N = UINT64_MAX;
+    uint64_t *dest = malloc(k * sizeof(uint64_t));
+    
+    CHECK(dest == NULL);
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XOSHIRO256, 1));
+    
+    //act
+    CHECK(spk_SampleWithoutReplacement(rng, k, N, dest));
+    
+    //assert, the mean of the top 16 bits is 32767.5 with standard error 59
+    double sum = 0.0;
+    
+    for (size_t i = 0; i < k; i++)
+    {
+        TEST_ASSERT_TRUE(dest[i] < N);
+        sum += (double) (dest[i] >> 48);
+    }
+    
+    TEST_ASSERT_DOUBLE_WITHIN(300.0, 32767.5, sum / (double) k);
+    
+    //assert, no index repeats
+    uint64_t *set = calloc(1 << 18, sizeof(uint64_t));
+    CHECK(set == NULL);
+    
+    for (size_t i = 0; i < k; i++)
+    {
+        size_t slot = (size_t) (dest[i] >> 46);
+        
+        while (set[slot] != 0)
+        {
+            TEST_ASSERT_TRUE(set[slot] != dest[i] + 1);
+            slot = (slot + 1) & ((1 << 18) - 1);
+        }
+        
+        set[slot] = dest[i] + 1;
+    }
+    
+    //teardown
+    free(set);
+    free(dest);
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Failure tests. The rejection loops in every sampler would spin on the zeroed
+words of a failed refill, so each one has to stop and return the error.
+*******************************************************************************/
+
+void test_failing_generator_stops_every_sampler_XSH64(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    uint64_t dest[1000] = {0};
+    
+    int (*next)(uint64_t *, uint64_t *, const size_t) = rng->next;
+    rng->next = FailingNext;
+    
+    //act
+    int inversion = spk_Binomial(rng, dest, 1000, 10, 0.3);
+    int btpe = spk_Binomial(rng, dest, 1000, 1000, 0.3);
+    int shuffle = spk_Shuffle(rng, dest, 1000, sizeof(uint64_t));
+    int dense = spk_SampleWithoutReplacement(rng, 1000, 1003, dest);
+    int floyd = spk_SampleWithoutReplacement(rng, 10, 1000000, dest);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, inversion);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, btpe);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, shuffle);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, dense);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, floyd);
+    
+    //teardown
+    rng->next = next;
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //construction tests
+        RUN_TEST(test_invalid_weights_are_rejected);
+        RUN_TEST(test_columns_are_padded_to_a_power_of_two);
+        
+        //sampling tests
+        RUN_TEST(test_single_outcome_is_always_drawn);
+        RUN_TEST(test_zero_weights_and_padding_are_never_drawn);
+        RUN_TEST(test_frequencies_match_weights_PCG64ix8);
+        RUN_TEST(test_large_table_mean_matches_PCG64i);
+        RUN_TEST(test_one_raw_word_is_consumed_per_sample_PCG64i);
+        
+        //binomial tests
+        RUN_TEST(test_binomial_invalid_arguments_are_rejected);
+        RUN_TEST(test_binomial_degenerate_cases_are_constant);
+        RUN_TEST(test_binomial_popcount_path_matches_pmf_PCG64i);
+        RUN_TEST(test_binomial_inversion_path_matches_pmf_XSH64);
+        RUN_TEST(test_binomial_btpe_path_matches_pmf_PCG64ix8);
+        RUN_TEST(test_binomial_btpe_stirling_band_mass_PCG64i);
+        RUN_TEST(test_binomial_large_trial_moments_PCG64i);
+        
+        //shuffle and sampling tests
+        RUN_TEST(test_shuffle_and_sample_invalid_arguments_are_rejected);
+        RUN_TEST(test_shuffle_is_a_permutation_of_wide_elements_XSH64);
+        RUN_TEST(test_shuffle_orderings_are_uniform_PCG64i);
+        RUN_TEST(test_dense_sample_positions_are_uniform_PCG64ix8);
+        RUN_TEST(test_floyd_sample_positions_are_uniform_PCG64ix8);
+        RUN_TEST(test_floyd_sample_from_huge_population_is_distinct_Xoshiro256);
+        
+        //failure tests
+        RUN_TEST(test_failing_generator_stops_every_sampler_XSH64);
+    return UNITY_END();
+}
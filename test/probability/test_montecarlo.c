@@ -0,0 +1,357 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/probability/montecarlo.c
+* LICS: MIT License
+*/
+
+#include "montecarlo.h"
+#include "generator_parallel.h"
+#include "generator_simd.h"
+#include "unity.h"
+
+#include <math.h> //sqrt
+#include <stdint.h> //SIZE_MAX
+#include <stdlib.h> //malloc, free, exit_failure
+#include <stdio.h> //fprintf
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+//several chunks plus a ragged last block
+#define POINTS (3 * SPK_MC_CHUNK + 77)
+
+static const double pi = 3.14159265358979323846;
+
+/*******************************************************************************
+Integrands
+*******************************************************************************/
+
+static void Constant(const double *x, double *fx, size_t n, size_t dim, void *ctx)
+{
+    (void) x;
+    (void) dim;
+    
+    for (size_t i = 0; i < n; i++) fx[i] = *(const double *) ctx;
+}
+
+//4 times the indicator of the quarter disc, its integral over [0, 1)^2 is pi
+static void QuarterDisc(const double *x, double *fx, size_t n, size_t dim, void *ctx)
+{
+    (void) ctx;
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        const double *point = x + i * dim;
+        fx[i] = point[0] * point[0] + point[1] * point[1] < 1.0 ? 4.0 : 0.0;
+    }
+}
+
+//sum of the coordinates plus a constant offset from ctx
+static void Offset(const double *x, double *fx, size_t n, size_t dim, void *ctx)
+{
+    const double offset = *(const double *) ctx;
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        double value = 0.0;
+        for (size_t j = 0; j < dim; j++) value += x[i * dim + j];
+        fx[i] = offset + value;
+    }
+}
+
+//records how it was called, ctx points to the record
+struct calls
+{
+    size_t points;
+    size_t largest;
+    size_t dim;
+};
+
+static void Recorder(const double *x, double *fx, size_t n, size_t dim, void *ctx)
+{
+    struct calls *record = ctx;
+    
+    record->points += n;
+    record->dim = dim;
+    if (n > record->largest) record->largest = n;
+    
+    for (size_t i = 0; i < n; i++) fx[i] = x[i * dim];
+}
+
+/*******************************************************************************
+Argument tests
+*******************************************************************************/
+
+void test_invalid_dimensions_and_counts_are_rejected(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    double value = 1.0;
+    double estimate = 0.0;
+    double std_error = 0.0;
+    
+    //act
+    int no_dim = spk_MCIntegrate(rng, Constant, &value, 0, 100, &estimate, &std_error);
+    int one_point = spk_MCIntegrate(rng, Constant, &value, 1, 1, &estimate, &std_error);
+    int too_many = spk_MCIntegrate(rng, Constant, &value, 2, SIZE_MAX, &estimate, &std_error);
+    int wide = spk_MCIntegrateParallel(rng, Constant, &value, SIZE_MAX, 100, &estimate, &std_error);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, no_dim);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, one_point);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, too_many);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, wide);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Accuracy tests
+*******************************************************************************/
+
+void test_constant_integrand_is_exact_with_no_error_XSH64(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    double value = 3.0;
+    double estimate = 0.0;
+    double std_error = 1.0;
+    
+    //act
+    int error = spk_MCIntegrate(rng, Constant, &value, 3, POINTS, &estimate, &std_error);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_TRUE(estimate == 3.0);
+    TEST_ASSERT_TRUE(std_error == 0.0);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_quarter_disc_estimates_pi_XOSHIRO256(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XOSHIRO256, 1));
+    double estimate = 0.0;
+    double std_error = 0.0;
+    
+    const double expected_error = sqrt(pi * (4.0 - pi) / (double) POINTS);
+    
+    //act
+    int error = spk_MCIntegrate(rng, QuarterDisc, NULL, 2, POINTS, &estimate, &std_error);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_DOUBLE_WITHIN(5.0 * expected_error, pi, estimate);
+    TEST_ASSERT_DOUBLE_WITHIN(0.05 * expected_error, expected_error, std_error);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+The reference materializes every coordinate with one unid call and runs the
+textbook two-pass mean and variance over it. The integral of the offset sum is
+dominated by the offset, so a plain sum of squares would cancel completely.
+*******************************************************************************/
+
+static void AssertMatchesTwoPass(int identifier, const size_t dim, double offset, const double tolerance)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    CHECK(spk_GeneratorNew(&SUT, identifier, 7));
+    CHECK(spk_GeneratorNew(&reference, identifier, 7));
+    
+    double *x = malloc(POINTS * dim * sizeof(double)); CHECK(x == NULL);
+    double *fx = malloc(POINTS * sizeof(double)); CHECK(fx == NULL);
+    double estimate = 0.0;
+    double std_error = 0.0;
+    uint64_t SUT_after[8] = {0};
+    uint64_t expected_after[8] = {1};
+    
+    //act
+    int error = spk_MCIntegrate(SUT, Offset, &offset, dim, POINTS, &estimate, &std_error);
+    
+    CHECK(reference->unid(reference, x, POINTS * dim));
+    Offset(x, fx, POINTS, dim, &offset);
+    
+    double mean = 0.0;
+    double squares = 0.0;
+    
+    for (size_t i = 0; i < POINTS; i++) mean += fx[i] - offset;
+    mean /= (double) POINTS;
+    
+    for (size_t i = 0; i < POINTS; i++) squares += (fx[i] - offset - mean) * (fx[i] - offset - mean);
+    const double expected_error = sqrt(squares / (double) (POINTS - 1) / (double) POINTS);
+    
+    CHECK(SUT->next(SUT->state, SUT_after, 8));
+    CHECK(reference->next(reference->state, expected_after, 8));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_DOUBLE_WITHIN(tolerance, mean, estimate - offset);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6 * expected_error, expected_error, std_error);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected_after, SUT_after, 8);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    free(x);
+    free(fx);
+}
+
+/******************************************************************************/
+
+void test_estimate_matches_two_pass_reference_PCG64i(void)
+{
+    AssertMatchesTwoPass(SPK_GENERATOR_PCG64i, 3, 0.0, 1e-12);
+}
+
+/******************************************************************************/
+
+void test_large_offset_keeps_the_spread_XOSHIRO256x4(void)
+{
+    //the offset alone costs the estimate its last 1.5e-8
+    AssertMatchesTwoPass(SPK_GENERATOR_XOSHIRO256x4, 1, 1e8, 1e-7);
+}
+
+/******************************************************************************/
+
+void test_integrand_sees_every_point_in_blocks_PHILOX4x32(void)
+{
+    //arrange
+    spk_generator rng;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PHILOX4x32, 1));
+    struct calls record = {0, 0, 0};
+    double estimate = 0.0;
+    double std_error = 0.0;
+    
+    //act
+    int error = spk_MCIntegrate(rng, Recorder, &record, 5, POINTS, &estimate, &std_error);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_EQUAL_UINT64(POINTS, record.points);
+    TEST_ASSERT_EQUAL_UINT64(SPK_MC_BLOCK, record.largest);
+    TEST_ASSERT_EQUAL_UINT64(5, record.dim);
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 0.5, estimate);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Reproducibility tests. The chunking depends on n alone and the lanes of the
+moments kernel are fixed, so thread count and instruction set cannot change a
+single bit of the result.
+*******************************************************************************/
+
+void test_parallel_matches_serial_on_any_thread_count_PCG64ix8(void)
+{
+    //arrange
+    spk_generator serial;
+    spk_generator one;
+    spk_generator three;
+    CHECK(spk_GeneratorNew(&serial, SPK_GENERATOR_PCG64ix8, 1));
+    CHECK(spk_GeneratorNew(&one, SPK_GENERATOR_PCG64ix8, 1));
+    CHECK(spk_GeneratorNew(&three, SPK_GENERATOR_PCG64ix8, 1));
+    
+    double estimate[3] = {0.0, 1.0, 2.0};
+    double std_error[3] = {0.0, 1.0, 2.0};
+    uint64_t after[3] = {0, 1, 2};
+    
+    //act
+    CHECK(spk_MCIntegrate(serial, QuarterDisc, NULL, 2, POINTS, &estimate[0], &std_error[0]));
+    
+    CHECK(spk_ParallelInit(1));
+    CHECK(spk_MCIntegrateParallel(one, QuarterDisc, NULL, 2, POINTS, &estimate[1], &std_error[1]));
+    
+    CHECK(spk_ParallelInit(3));
+    CHECK(spk_MCIntegrateParallel(three, QuarterDisc, NULL, 2, POINTS, &estimate[2], &std_error[2]));
+    
+    CHECK(serial->next(serial->state, &after[0], 1));
+    CHECK(one->next(one->state, &after[1], 1));
+    CHECK(three->next(three->state, &after[2], 1));
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY(&estimate[0], &estimate[1], sizeof(double));
+    TEST_ASSERT_EQUAL_MEMORY(&estimate[0], &estimate[2], sizeof(double));
+    TEST_ASSERT_EQUAL_MEMORY(&std_error[0], &std_error[1], sizeof(double));
+    TEST_ASSERT_EQUAL_MEMORY(&std_error[0], &std_error[2], sizeof(double));
+    TEST_ASSERT_EQUAL_UINT64(after[0], after[1]);
+    TEST_ASSERT_EQUAL_UINT64(after[0], after[2]);
+    
+    //teardown
+    spk_ParallelDelete();
+    spk_GeneratorDelete(serial);
+    spk_GeneratorDelete(one);
+    spk_GeneratorDelete(three);
+}
+
+/******************************************************************************/
+
+void test_result_is_the_same_on_every_isa_XOROSHIRO128(void)
+{
+    //arrange
+    double offset = 10.0;
+    double estimate[3] = {0.0, 0.0, 0.0};
+    double std_error[3] = {0.0, 0.0, 0.0};
+    const int native = spk_GeneratorISA();
+    
+    //act
+    for (int isa = SPK_ISA_SISD; isa <= native; isa++)
+    {
+        spk_generator rng;
+        
+        CHECK(spk_GeneratorSetISA(isa));
+        CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XOROSHIRO128, 3));
+        CHECK(spk_MCIntegrate(rng, Offset, &offset, 4, POINTS, &estimate[isa], &std_error[isa]));
+        
+        spk_GeneratorDelete(rng);
+    }
+    
+    CHECK(spk_GeneratorSetISA(SPK_ISA_NATIVE));
+    
+    //assert
+    for (int isa = SPK_ISA_SISD + 1; isa <= native; isa++)
+    {
+        TEST_ASSERT_EQUAL_MEMORY(&estimate[0], &estimate[isa], sizeof(double));
+        TEST_ASSERT_EQUAL_MEMORY(&std_error[0], &std_error[isa], sizeof(double));
+    }
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //argument tests
+        RUN_TEST(test_invalid_dimensions_and_counts_are_rejected);
+        
+        //accuracy tests
+        RUN_TEST(test_constant_integrand_is_exact_with_no_error_XSH64);
+        RUN_TEST(test_quarter_disc_estimates_pi_XOSHIRO256);
+        RUN_TEST(test_estimate_matches_two_pass_reference_PCG64i);
+        RUN_TEST(test_large_offset_keeps_the_spread_XOSHIRO256x4);
+        RUN_TEST(test_integrand_sees_every_point_in_blocks_PHILOX4x32);
+        
+        //reproducibility tests
+        RUN_TEST(test_parallel_matches_serial_on_any_thread_count_PCG64ix8);
+        RUN_TEST(test_result_is_the_same_on_every_isa_XOROSHIRO128);
+    return UNITY_END();
+}
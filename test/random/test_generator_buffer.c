@@ -0,0 +1,291 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/random/generator_buffer.c
+* LICS: MIT License
+*/
+
+#include "generator_buffer.h"
+#include "generator_simd.h"
+#include "test_fixtures.h"
+#include "unity.h"
+
+#include <stdlib.h> //malloc, exit_failure
+#include <stdio.h> //fprintf
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+/*******************************************************************************
+Construction tests
+*******************************************************************************/
+
+void test_capacity_outside_limits_is_rejected(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator_buffer SUT;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    
+    //act
+    int small = spk_BufferNew(&SUT, rng, SPK_BUFFER_MIN - 8);
+    int large = spk_BufferNew(&SUT, rng, SPK_BUFFER_MAX + 8);
+    int unaligned = spk_BufferNew(&SUT, rng, SPK_BUFFER_MIN + 1);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, small);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, large);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, unaligned);
+    
+    //teardown
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_ring_is_cache_aligned(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator_buffer SUT;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_BufferNew(&SUT, rng, SPK_BUFFER_DEFAULT));
+    
+    //act
+    uintptr_t address = (uintptr_t) SUT->data;
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64(0, address % SPK_BUFFER_ALIGN);
+    
+    //teardown
+    spk_BufferDelete(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/*******************************************************************************
+Pop tests. Scalar pops across several refills must reproduce the bulk stream of
+the wrapped generator, including the interleaved lanes of the SIMD generators.
+*******************************************************************************/
+
+void test_scalar_pops_match_bulk_next_across_refills_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator reference;
+    spk_generator_buffer SUT;
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_BufferNew(&SUT, rng, SPK_BUFFER_MIN));
+    
+    uint64_t expected[1000] = {0};
+    uint64_t SUT_output[1000] = {1};
+    
+    //act
+    CHECK(reference->next(reference->state, expected, 1000));
+    for (size_t i = 0; i < 1000; i++) SUT_output[i] = spk_BufferNext(SUT);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_output, 1000);
+    
+    //teardown
+    spk_BufferDelete(SUT);
+    spk_GeneratorDelete(rng);
+    spk_GeneratorDelete(reference);
+}
+
+/******************************************************************************/
+
+void test_scalar_pops_match_bulk_next_across_refills_PCG64ix8(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator reference;
+    spk_generator_buffer SUT;
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64ix8, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64ix8, 1));
+    CHECK(spk_BufferNew(&SUT, rng, SPK_BUFFER_MIN + 8));
+    
+    uint64_t expected[1056] = {0};
+    uint64_t SUT_output[1056] = {1};
+    
+    //act
+    CHECK(reference->next(reference->state, expected, 1056));
+    for (size_t i = 0; i < 1056; i++) SUT_output[i] = spk_BufferNext(SUT);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_output, 1056);
+    
+    //teardown
+    spk_BufferDelete(SUT);
+    spk_GeneratorDelete(rng);
+    spk_GeneratorDelete(reference);
+}
+
+/*******************************************************************************
+Rand tests
+*******************************************************************************/
+
+void test_scalar_rand_covers_dice_faces_uniformly_XSH64(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator_buffer SUT;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_BufferNew(&SUT, rng, SPK_BUFFER_DEFAULT));
+    
+    size_t faces[7] = {0};
+    
+    //act
+    for (size_t i = 0; i < 600000; i++)
+    {
+        uint64_t roll = spk_BufferRand(SUT, 1, 6);
+        CHECK(roll < 1 || roll > 6);
+        faces[roll]++;
+    }
+    
+    //assert, 3 sigma is roughly 870 counts
+    TEST_ASSERT_EQUAL_size_t(0, faces[0]);
+    
+    for (size_t i = 1; i <= 6; i++)
+    {
+        TEST_ASSERT_UINT64_WITHIN(900, 100000, faces[i]);
+    }
+    
+    //teardown
+    spk_BufferDelete(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+void test_scalar_rand_edge_cases_match_rand_method_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator reference;
+    spk_generator_buffer SUT;
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_BufferNew(&SUT, rng, SPK_BUFFER_MIN));
+    
+    uint64_t expected[2] = {0};
+    
+    //act
+    CHECK(reference->rand(reference, expected, 2, 0, UINT64_MAX));
+    uint64_t full_first = spk_BufferRand(SUT, 0, UINT64_MAX);
+    uint64_t equal = spk_BufferRand(SUT, 42, 42);
+    uint64_t full_second = spk_BufferRand(SUT, 0, UINT64_MAX);
+    
+    //assert, equal limits must not consume a word
+    TEST_ASSERT_EQUAL_UINT64(expected[0], full_first);
+    TEST_ASSERT_EQUAL_UINT64(42, equal);
+    TEST_ASSERT_EQUAL_UINT64(expected[1], full_second);
+    
+    //teardown
+    spk_BufferDelete(SUT);
+    spk_GeneratorDelete(rng);
+    spk_GeneratorDelete(reference);
+}
+
+/*******************************************************************************
+Unid tests
+*******************************************************************************/
+
+void test_scalar_unid_matches_unid_method_PCG64i(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator reference;
+    spk_generator_buffer SUT;
+    
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_BufferNew(&SUT, rng, SPK_BUFFER_MIN));
+    
+    double expected[1000] = {0};
+    double SUT_output[1000] = {1};
+    
+    //act
+    CHECK(reference->unid(reference, expected, 1000));
+    for (size_t i = 0; i < 1000; i++) SUT_output[i] = spk_BufferUnid(SUT);
+    
+    //assert
+    for (size_t i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(SUT_output[i] >= 0.0 && SUT_output[i] < 1.0);
+        TEST_ASSERT_EQUAL_DOUBLE(expected[i], SUT_output[i]);
+    }
+    
+    //teardown
+    spk_BufferDelete(SUT);
+    spk_GeneratorDelete(rng);
+    spk_GeneratorDelete(reference);
+}
+
+/*******************************************************************************
+Failure tests
+*******************************************************************************/
+
+void test_failed_refill_is_recorded_and_pops_zero_XSH64(void)
+{
+    //arrange
+    spk_generator rng;
+    spk_generator_buffer SUT;
+    CHECK(spk_GeneratorNew(&rng, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_BufferNew(&SUT, rng, SPK_BUFFER_MIN));
+    
+    int (*next)(uint64_t *, uint64_t *, const size_t) = rng->next;
+    rng->next = FailingNext;
+    
+    //act, a range of 6 would reject zeroed words forever
+    int before = SUT->error;
+    uint64_t word = spk_BufferNext(SUT);
+    uint64_t face = spk_BufferRand(SUT, 1, 6);
+    int refill = spk_BufferRefill(SUT);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, before);
+    TEST_ASSERT_EQUAL_UINT64(0, word);
+    TEST_ASSERT_EQUAL_UINT64(1, face);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, refill);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_RDRAND, SUT->error);
+    
+    //teardown
+    rng->next = next;
+    spk_BufferDelete(SUT);
+    spk_GeneratorDelete(rng);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //construction tests
+        RUN_TEST(test_capacity_outside_limits_is_rejected);
+        RUN_TEST(test_ring_is_cache_aligned);
+        
+        //pop tests
+        RUN_TEST(test_scalar_pops_match_bulk_next_across_refills_PCG64i);
+        RUN_TEST(test_scalar_pops_match_bulk_next_across_refills_PCG64ix8);
+        
+        //rand tests
+        RUN_TEST(test_scalar_rand_covers_dice_faces_uniformly_XSH64);
+        RUN_TEST(test_scalar_rand_edge_cases_match_rand_method_PCG64i);
+        
+        //unid tests
+        RUN_TEST(test_scalar_unid_matches_unid_method_PCG64i);
+        
+        //failure tests
+        RUN_TEST(test_failed_refill_is_recorded_and_pops_zero_XSH64);
+    return UNITY_END();
+}
@@ -0,0 +1,342 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/random/generator_parallel.c
+* LICS: MIT License
+*/
+
+#include "generator_parallel.h"
+#include "generator_simd.h"
+#include "unity.h"
+
+#include <stdlib.h> //malloc, exit_failure
+#include <stdio.h> //fprintf
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+//several spans plus a ragged tail, run on more threads than spans
+#define LENGTH (3 * SPK_PARALLEL_CHUNK + 5)
+#define THREADS 5
+
+/*******************************************************************************
+Serial equivalence tests. A parallel fill must write exactly what the serial
+method writes and leave the generator in the same state.
+*******************************************************************************/
+
+static void AssertNextMatchesSerial(int identifier)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    spk_fill_method method = {.kind = SPK_FILL_NEXT};
+    
+    CHECK(spk_GeneratorNew(&SUT, identifier, 1));
+    CHECK(spk_GeneratorNew(&reference, identifier, 1));
+    
+    uint64_t *SUT_output = malloc(LENGTH * sizeof(uint64_t)); CHECK(SUT_output == NULL);
+    uint64_t *expected = malloc(LENGTH * sizeof(uint64_t)); CHECK(expected == NULL);
+    uint64_t SUT_after[16] = {0};
+    uint64_t expected_after[16] = {1};
+    
+    //act
+    CHECK(spk_GeneratorFillParallel(SUT, SUT_output, LENGTH, &method));
+    CHECK(reference->next(reference->state, expected, LENGTH));
+    
+    CHECK(SUT->next(SUT->state, SUT_after, 16));
+    CHECK(reference->next(reference->state, expected_after, 16));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_output, LENGTH);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected_after, SUT_after, 16);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    free(SUT_output);
+    free(expected);
+}
+
+/******************************************************************************/
+
+void test_parallel_next_matches_serial_next_PCG64i(void)
+{
+    AssertNextMatchesSerial(SPK_GENERATOR_PCG64i);
+}
+
+/******************************************************************************/
+
+void test_parallel_next_matches_serial_next_XSH64(void)
+{
+    AssertNextMatchesSerial(SPK_GENERATOR_XSH64);
+}
+
+/******************************************************************************/
+
+void test_parallel_next_matches_serial_next_PCG64ix8(void)
+{
+    AssertNextMatchesSerial(SPK_GENERATOR_PCG64ix8);
+}
+
+/******************************************************************************/
+
+void test_parallel_next_matches_serial_next_Philox4x32(void)
+{
+    AssertNextMatchesSerial(SPK_GENERATOR_PHILOX4x32);
+}
+
+/******************************************************************************/
+
+void test_parallel_unid_matches_serial_unid_PCG64ix4(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    spk_fill_method method = {.kind = SPK_FILL_UNID};
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64ix4, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64ix4, 1));
+    
+    double *SUT_output = malloc(LENGTH * sizeof(double)); CHECK(SUT_output == NULL);
+    double *expected = malloc(LENGTH * sizeof(double)); CHECK(expected == NULL);
+    
+    //act
+    CHECK(spk_GeneratorFillParallel(SUT, SUT_output, LENGTH, &method));
+    CHECK(reference->unid(reference, expected, LENGTH));
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY(expected, SUT_output, LENGTH * sizeof(double));
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    free(SUT_output);
+    free(expected);
+}
+
+/******************************************************************************/
+
+void test_parallel_unif_matches_serial_unif_with_odd_length_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    spk_fill_method method = {.kind = SPK_FILL_UNIF};
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 1));
+    
+    float *SUT_output = malloc(LENGTH * sizeof(float)); CHECK(SUT_output == NULL);
+    float *expected = malloc(LENGTH * sizeof(float)); CHECK(expected == NULL);
+    uint64_t SUT_after = 0;
+    uint64_t expected_after = 1;
+    
+    //act
+    CHECK(spk_GeneratorFillParallel(SUT, SUT_output, LENGTH, &method));
+    CHECK(reference->unif(reference, expected, LENGTH));
+    
+    CHECK(SUT->next(SUT->state, &SUT_after, 1));
+    CHECK(reference->next(reference->state, &expected_after, 1));
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY(expected, SUT_output, LENGTH * sizeof(float));
+    TEST_ASSERT_EQUAL_UINT64(expected_after, SUT_after);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    free(SUT_output);
+    free(expected);
+}
+
+/*******************************************************************************
+Rand tests. Rand output is defined chunk by chunk, so it can't depend on how
+many threads happened to run it.
+*******************************************************************************/
+
+void test_parallel_rand_is_independent_of_thread_count_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    spk_fill_method method = {.min = 10, .max = 15, .kind = SPK_FILL_RAND};
+    
+    const size_t n = 2 * SPK_PARALLEL_RAND_CHUNK + 7;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t *SUT1_output = malloc(n * sizeof(uint64_t)); CHECK(SUT1_output == NULL);
+    uint64_t *SUT2_output = malloc(n * sizeof(uint64_t)); CHECK(SUT2_output == NULL);
+    
+    //act
+    CHECK(spk_ParallelInit(1));
+    CHECK(spk_GeneratorFillParallel(SUT1, SUT1_output, n, &method));
+    
+    CHECK(spk_ParallelInit(3));
+    CHECK(spk_GeneratorFillParallel(SUT2, SUT2_output, n, &method));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, n);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1->state, SUT2->state, 2);
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        TEST_ASSERT_TRUE(SUT1_output[i] >= 10 && SUT1_output[i] <= 15);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+    free(SUT1_output);
+    free(SUT2_output);
+}
+
+/******************************************************************************/
+
+void test_parallel_rand_chunk_matches_jumped_serial_rand_XSH64(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    spk_fill_method method = {.min = 0, .max = 999, .kind = SPK_FILL_RAND};
+    
+    const size_t n = SPK_PARALLEL_RAND_CHUNK + 100;
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_XSH64, 1));
+    
+    uint64_t *SUT_output = malloc(n * sizeof(uint64_t)); CHECK(SUT_output == NULL);
+    uint64_t expected[100] = {0};
+    
+    //act
+    CHECK(spk_GeneratorFillParallel(SUT, SUT_output, n, &method));
+    
+    CHECK(spk_GeneratorJump(reference, SPK_PARALLEL_RAND_STRIDE));
+    CHECK(reference->rand(reference, expected, 100, 0, 999));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_output + SPK_PARALLEL_RAND_CHUNK, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    free(SUT_output);
+}
+
+/*******************************************************************************
+Pool tests
+*******************************************************************************/
+
+void test_fill_restarts_pool_on_demand_after_delete(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    spk_fill_method method = {.kind = SPK_FILL_NEXT};
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t SUT_output[100] = {0};
+    uint64_t expected[100] = {1};
+    
+    //act
+    spk_ParallelDelete();
+    int error = spk_GeneratorFillParallel(SUT, SUT_output, 100, &method);
+    CHECK(reference->next(reference->state, expected, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+}
+
+/******************************************************************************/
+
+void test_parallel_hardware_fill_covers_every_span_RdRand(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_fill_method method = {.kind = SPK_FILL_NEXT};
+    const size_t n = 4 * SPK_PARALLEL_CHUNK + 5;
+    uint64_t *SUT_output = calloc(n, sizeof(uint64_t));
+    
+    CHECK(SUT_output == NULL);
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_RDRAND, 0));
+    
+    //act
+    int error = spk_GeneratorFillParallel(SUT, SUT_output, n, &method);
+    
+    //assert, a skipped span would leave a long run of zeros
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    
+    size_t zeros = 0;
+    for (size_t i = 0; i < n; i++) zeros += SUT_output[i] == 0;
+    
+    TEST_ASSERT_TRUE(zeros < 4);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(SUT_output);
+}
+
+/******************************************************************************/
+
+void test_unknown_fill_kind_is_rejected(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_fill_method method = {.kind = (enum spk_fill_kind) 42};
+    uint64_t SUT_output[10] = {0};
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    
+    //act
+    int error = spk_GeneratorFillParallel(SUT, SUT_output, 10, &method);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, error);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    CHECK(spk_ParallelInit(THREADS));
+    
+    UNITY_BEGIN();
+        //serial equivalence tests
+        RUN_TEST(test_parallel_next_matches_serial_next_PCG64i);
+        RUN_TEST(test_parallel_next_matches_serial_next_XSH64);
+        RUN_TEST(test_parallel_next_matches_serial_next_PCG64ix8);
+        RUN_TEST(test_parallel_next_matches_serial_next_Philox4x32);
+        RUN_TEST(test_parallel_unid_matches_serial_unid_PCG64ix4);
+        RUN_TEST(test_parallel_unif_matches_serial_unif_with_odd_length_PCG64i);
+        
+        //rand tests
+        RUN_TEST(test_parallel_rand_is_independent_of_thread_count_PCG64i);
+        RUN_TEST(test_parallel_rand_chunk_matches_jumped_serial_rand_XSH64);
+        
+        //pool tests
+        RUN_TEST(test_fill_restarts_pool_on_demand_after_delete);
+        RUN_TEST(test_unknown_fill_kind_is_rejected);
+        RUN_TEST(test_parallel_hardware_fill_covers_every_span_RdRand);
+    int failures = UNITY_END();
+    
+    spk_ParallelDelete();
+    
+    return failures;
+}
@@ -0,0 +1,467 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/random/generator_pool.c
+* LICS: MIT License
+*/
+
+#include "generator_pool.h"
+#include "generator_parallel.h"
+#include "generator_simd.h"
+#include "unity.h"
+
+#include <stdarg.h> //va_list
+#include <stdlib.h> //malloc, exit_failure
+#include <stdio.h> //fprintf, fopen, remove
+#include <string.h> //memcmp
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+//several parallel spans plus a ragged tail, read from an arbitrary position
+#define POOL_PATH "./pool_test.bin"
+#define LENGTH (3 * SPK_PARALLEL_CHUNK + 5)
+#define POSITION 1000
+#define SEED 42
+
+/*******************************************************************************
+Replay tests. A pool must hold exactly what the source generator writes after
+a jump of the recorded position, and its methods must match the source.
+*******************************************************************************/
+
+void test_raw_pool_replays_the_source_stream(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    uint64_t *SUT_output = malloc(LENGTH * sizeof(uint64_t)); CHECK(SUT_output == NULL);
+    uint64_t *expected = malloc(LENGTH * sizeof(uint64_t)); CHECK(expected == NULL);
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, SEED, POSITION, LENGTH, SPK_POOL_NEXT));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_XOSHIRO256, SEED));
+    CHECK(spk_GeneratorJump(reference, POSITION));
+    
+    //act, in two uneven pieces to cross a block boundary
+    CHECK(SUT->next(SUT->state, SUT_output, 777));
+    CHECK(SUT->next(SUT->state, SUT_output + 777, LENGTH - 777));
+    CHECK(reference->next(reference->state, expected, LENGTH));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_output, LENGTH);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    free(SUT_output);
+    free(expected);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_unid_pool_replays_the_source_unid(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    double *SUT_output = malloc(LENGTH * sizeof(double)); CHECK(SUT_output == NULL);
+    double *expected = malloc(LENGTH * sizeof(double)); CHECK(expected == NULL);
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_PHILOX4x32, SEED, POSITION, LENGTH, SPK_POOL_UNID));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PHILOX4x32, SEED));
+    CHECK(spk_GeneratorJump(reference, POSITION));
+    
+    //act
+    CHECK(SUT->unid(SUT, SUT_output, LENGTH));
+    CHECK(reference->unid(reference, expected, LENGTH));
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY(expected, SUT_output, LENGTH * sizeof(double));
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    free(SUT_output);
+    free(expected);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_raw_pool_methods_match_the_sisd_source(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    uint64_t SUT_rand[300];
+    uint64_t expected_rand[300];
+    uint64_t SUT_bias[50];
+    uint64_t expected_bias[50];
+    double SUT_unid[600];
+    double expected_unid[600];
+    float SUT_unif[601];
+    float expected_unif[601];
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_PCG64i, SEED, 0, 8192, SPK_POOL_NEXT));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, SEED));
+    
+    //act
+    CHECK(SUT->rand(SUT, SUT_rand, 300, 3, 1000));
+    CHECK(reference->rand(reference, expected_rand, 300, 3, 1000));
+    CHECK(SUT->bias(SUT, SUT_bias, 50, 0.3, 8));
+    CHECK(reference->bias(reference, expected_bias, 50, 0.3, 8));
+    CHECK(SUT->unid(SUT, SUT_unid, 600));
+    CHECK(reference->unid(reference, expected_unid, 600));
+    CHECK(SUT->unif(SUT, SUT_unif, 601));
+    CHECK(reference->unif(reference, expected_unif, 601));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected_rand, SUT_rand, 300);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected_bias, SUT_bias, 50);
+    TEST_ASSERT_EQUAL_MEMORY(expected_unid, SUT_unid, sizeof(SUT_unid));
+    TEST_ASSERT_EQUAL_MEMORY(expected_unif, SUT_unif, sizeof(SUT_unif));
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_pool_file_is_independent_of_thread_count(void)
+{
+    //arrange
+    const size_t bytes = SPK_POOL_HEADER + LENGTH * sizeof(uint64_t);
+    unsigned char *single = malloc(bytes); CHECK(single == NULL);
+    unsigned char *several = malloc(bytes); CHECK(several == NULL);
+    
+    //act
+    CHECK(spk_ParallelInit(1));
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256x4, SEED, POSITION, LENGTH, SPK_POOL_NEXT));
+    FILE *file = fopen(POOL_PATH, "rb"); CHECK(file == NULL);
+    CHECK(fread(single, 1, bytes, file) != bytes);
+    fclose(file);
+    
+    CHECK(spk_ParallelInit(4));
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256x4, SEED, POSITION, LENGTH, SPK_POOL_NEXT));
+    file = fopen(POOL_PATH, "rb"); CHECK(file == NULL);
+    CHECK(fread(several, 1, bytes, file) != bytes);
+    fclose(file);
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY(single, several, bytes);
+    
+    //teardown
+    spk_ParallelDelete();
+    free(single);
+    free(several);
+    remove(POOL_PATH);
+}
+
+/*******************************************************************************
+Cursor tests
+*******************************************************************************/
+
+void test_exhausted_pool_fails_without_consuming(void)
+{
+    //arrange
+    spk_generator SUT;
+    uint64_t output[64];
+    spk_pool_info info;
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, SEED, 0, 64, SPK_POOL_NEXT));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    CHECK(SUT->next(SUT->state, output, 60));
+    
+    //act
+    int too_many = SUT->next(SUT->state, output, 5);
+    CHECK(spk_GeneratorPoolInfo(SUT, &info));
+    uint64_t cursor = info.cursor;
+    int rest = SUT->next(SUT->state, output, 4);
+    int empty = SUT->next(SUT->state, output, 1);
+    int unid = SUT->unid(SUT, (double *) output, 1);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_EXHAUSTED, too_many);
+    TEST_ASSERT_TRUE(cursor == 60);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, rest);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_EXHAUSTED, empty);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_EXHAUSTED, unid);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_jump_and_at_use_source_stream_positions(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    uint64_t SUT_next[8];
+    uint64_t SUT_at[8];
+    uint64_t expected[8];
+    spk_pool_info info;
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_PCG64i, SEED, POSITION, 4096, SPK_POOL_NEXT));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, SEED));
+    CHECK(spk_GeneratorJump(reference, POSITION + 500));
+    CHECK(reference->next(reference->state, expected, 8));
+    
+    //act
+    CHECK(spk_GeneratorJump(SUT, 500));
+    CHECK(SUT->next(SUT->state, SUT_next, 8));
+    int at = spk_GeneratorAt(SUT, POSITION + 500, SUT_at, 8);
+    int before = spk_GeneratorAt(SUT, POSITION - 1, SUT_at + 7, 1);
+    int beyond = spk_GeneratorAt(SUT, POSITION + 4090, SUT_at + 7, 7);
+    CHECK(spk_GeneratorJump(SUT, UINT64_MAX));
+    CHECK(spk_GeneratorPoolInfo(SUT, &info));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, at);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_next, 8);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expected, SUT_at, 8);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, before);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, beyond);
+    TEST_ASSERT_TRUE(info.cursor == info.count);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_view_points_into_the_mapping(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator reference;
+    const void *view = NULL;
+    double expected[256];
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOROSHIRO128, SEED, 0, 512, SPK_POOL_UNID));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_XOROSHIRO128, SEED));
+    CHECK(reference->unid(reference, expected, 256));
+    CHECK(reference->unid(reference, expected, 256));
+    
+    //act
+    CHECK(spk_GeneratorPoolView(SUT, &view, 256));
+    CHECK(spk_GeneratorPoolView(SUT, &view, 256));
+    int empty = spk_GeneratorPoolView(SUT, &view, 1);
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY(expected, view, sizeof(expected));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_EXHAUSTED, empty);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(reference);
+    remove(POOL_PATH);
+}
+
+/*******************************************************************************
+Header and contract tests
+*******************************************************************************/
+
+void test_info_reports_the_header(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_pool_info info;
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_PHILOX4x32, SEED, POSITION, 128, SPK_POOL_UNID));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    
+    //act
+    int error = spk_GeneratorPoolInfo(SUT, &info);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_EQUAL_INT(SPK_GENERATOR_POOL, SUT->identifier);
+    TEST_ASSERT_EQUAL_INT(SPK_GENERATOR_PHILOX4x32, info.identifier);
+    TEST_ASSERT_EQUAL_INT(SPK_POOL_UNID, info.kind);
+    TEST_ASSERT_TRUE(info.seed == SEED);
+    TEST_ASSERT_TRUE(info.position == POSITION);
+    TEST_ASSERT_TRUE(info.count == 128);
+    TEST_ASSERT_TRUE(info.cursor == 0);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_unid_pool_rejects_the_raw_methods(void)
+{
+    //arrange
+    spk_generator SUT;
+    uint64_t words[4];
+    float floats[4];
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, SEED, 0, 128, SPK_POOL_UNID));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    
+    //act
+    int next = SUT->next(SUT->state, words, 4);
+    int rand = SUT->rand(SUT, words, 4, 0, 9);
+    int unif = SUT->unif(SUT, floats, 4);
+    int at = spk_GeneratorAt(SUT, 0, words, 4);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, next);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, rand);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, unif);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, at);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_pool_identifier_has_no_state_to_create_or_copy(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator copies[2] = {NULL, NULL};
+    unsigned char buffer[256];
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, SEED, 0, 128, SPK_POOL_NEXT));
+    CHECK(spk_GeneratorPoolOpen(&SUT, POOL_PATH));
+    
+    //act
+    int create = spk_GeneratorNew(&copies[0], SPK_GENERATOR_POOL, SEED);
+    int split = spk_GeneratorSplit(SUT, 2, copies);
+    int serialize = spk_GeneratorSerialize(SUT, buffer, sizeof(buffer));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, create);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, split);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, serialize);
+    TEST_ASSERT_TRUE(spk_GeneratorSize(SPK_GENERATOR_POOL) == 0);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+void test_open_rejects_missing_truncated_and_foreign_files(void)
+{
+    //arrange
+    spk_generator SUT = NULL;
+    unsigned char header[SPK_POOL_HEADER + 16];
+    
+    CHECK(spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, SEED, 0, 128, SPK_POOL_NEXT));
+    FILE *file = fopen(POOL_PATH, "rb"); CHECK(file == NULL);
+    CHECK(fread(header, 1, sizeof(header), file) != sizeof(header));
+    fclose(file);
+    
+    //act
+    remove(POOL_PATH);
+    int missing = spk_GeneratorPoolOpen(&SUT, POOL_PATH);
+    
+    file = fopen(POOL_PATH, "wb"); CHECK(file == NULL);
+    CHECK(fwrite(header, 1, sizeof(header), file) != sizeof(header));
+    fclose(file);
+    int truncated = spk_GeneratorPoolOpen(&SUT, POOL_PATH);
+    
+    header[0] = 'X';
+    header[32] = 2;
+    header[33] = 0;
+    file = fopen(POOL_PATH, "wb"); CHECK(file == NULL);
+    CHECK(fwrite(header, 1, sizeof(header), file) != sizeof(header));
+    fclose(file);
+    int foreign = spk_GeneratorPoolOpen(&SUT, POOL_PATH);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FILEIO, missing);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, truncated);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, foreign);
+    TEST_ASSERT_NULL(SUT);
+    
+    //teardown
+    remove(POOL_PATH);
+}
+
+/******************************************************************************/
+
+static int logged = 0;
+
+static void CountingLogger(void *ctx, int error, const char *where, const char *format, va_list args)
+{
+    (void) error;
+    (void) format;
+    (void) args;
+    
+    logged += ctx == &logged && strcmp(where, "spk_GeneratorPoolWrite") == 0;
+}
+
+/******************************************************************************/
+
+void test_write_rejects_bad_arguments_and_leaves_no_file(void)
+{
+    //arrange
+    spk_SetLogger(CountingLogger, &logged);
+    logged = 0;
+    
+    //act
+    int kind = spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, SEED, 0, 16, (enum spk_pool_kind) 7);
+    int empty = spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_XOSHIRO256, SEED, 0, 0, SPK_POOL_NEXT);
+    int source = spk_GeneratorPoolWrite(POOL_PATH, SPK_GENERATOR_POOL, SEED, 0, 16, SPK_POOL_NEXT);
+    int directory = spk_GeneratorPoolWrite("./no/such/dir/pool.bin", SPK_GENERATOR_PCG64i, SEED, 0, 16, SPK_POOL_NEXT);
+    FILE *file = fopen(POOL_PATH, "rb");
+    spk_SetLogger(NULL, NULL);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(4, logged);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, kind);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, empty);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, source);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FILEIO, directory);
+    TEST_ASSERT_NULL(file);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //replay tests
+        RUN_TEST(test_raw_pool_replays_the_source_stream);
+        RUN_TEST(test_unid_pool_replays_the_source_unid);
+        RUN_TEST(test_raw_pool_methods_match_the_sisd_source);
+        RUN_TEST(test_pool_file_is_independent_of_thread_count);
+        
+        //cursor tests
+        RUN_TEST(test_exhausted_pool_fails_without_consuming);
+        RUN_TEST(test_jump_and_at_use_source_stream_positions);
+        RUN_TEST(test_view_points_into_the_mapping);
+        
+        //header and contract tests
+        RUN_TEST(test_info_reports_the_header);
+        RUN_TEST(test_unid_pool_rejects_the_raw_methods);
+        RUN_TEST(test_pool_identifier_has_no_state_to_create_or_copy);
+        RUN_TEST(test_open_rejects_missing_truncated_and_foreign_files);
+        RUN_TEST(test_write_rejects_bad_arguments_and_leaves_no_file);
+    return UNITY_END();
+}
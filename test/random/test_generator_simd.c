@@ -0,0 +1,870 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/random/generator_simd.c
+* LICS: MIT License
+*/
+
+#include "generator_simd.h"
+#include "generator_inline.h"
+#include "unity.h"
+
+#include <math.h> //inverse cosine
+#include <stdlib.h> //malloc, exit_failure
+#include <stdio.h> //fprintf
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+/*******************************************************************************
+Seeding tests
+*******************************************************************************/
+
+void test_deterministic_seed_for_PCG64ix4(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64ix4, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64ix4, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_deterministic_seed_for_PCG64ix8(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64ix8, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64ix8, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/*******************************************************************************
+Lane tests. Each lane must be bit-for-bit identical to a SISD pcg64i generator
+that starts from the same state and increment. The lane state is laid out as
+all lane states followed by all lane increments, while the SISD state is a
+single state/increment pair, so we can transplant one lane into a SISD generator
+and compare the strided output.
+*/
+
+static void CompareLanesToSISD(const int identifier, const size_t lanes)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator ref;
+    
+    CHECK(spk_GeneratorNew(&SUT, identifier, 42));
+    CHECK(spk_GeneratorNew(&ref, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t lane_state[8] = {0};
+    uint64_t lane_increment[8] = {0};
+    
+    for (size_t k = 0; k < lanes; k++)
+    {
+        lane_state[k] = SUT->state[k];
+        lane_increment[k] = SUT->state[lanes + k];
+    }
+    
+    uint64_t SUT_output[800] = {0};
+    uint64_t ref_output[100] = {0};
+    
+    //act
+    CHECK(SUT->next(SUT->state, SUT_output, 100 * lanes));
+    
+    //assert
+    for (size_t k = 0; k < lanes; k++)
+    {
+        ref->state[0] = lane_state[k];
+        ref->state[1] = lane_increment[k];
+        
+        CHECK(ref->next(ref->state, ref_output, 100));
+        
+        for (size_t i = 0; i < 100; i++)
+        {
+            TEST_ASSERT_EQUAL_UINT64(ref_output[i], SUT_output[k + i * lanes]);
+        }
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(ref);
+}
+
+void test_each_lane_matches_SISD_PCG64i_for_PCG64ix4(void)
+{
+    CompareLanesToSISD(SPK_GENERATOR_PCG64ix4, 4);
+}
+
+void test_each_lane_matches_SISD_PCG64i_for_PCG64ix8(void)
+{
+    CompareLanesToSISD(SPK_GENERATOR_PCG64ix8, 8);
+}
+
+/*******************************************************************************
+Lane 0 of the xoshiro lanes is seeded like the SISD generator and every further
+lane is one long jump past the previous one.
+*/
+
+void test_each_lane_is_a_long_jump_of_SISD_Xoshiro256_for_Xoshiro256x4(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_xoshiro256 ref;
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XOSHIRO256x4, 42));
+    CHECK(spk_Xoshiro256Init(&ref, 42));
+    
+    uint64_t SUT_output[400] = {0};
+    
+    //act
+    CHECK(SUT->next(SUT->state, SUT_output, 400));
+    
+    //assert
+    for (size_t k = 0; k < 4; k++)
+    {
+        spk_xoshiro256 lane = ref;
+        
+        for (size_t i = 0; i < 100; i++)
+        {
+            TEST_ASSERT_EQUAL_UINT64(spk_Xoshiro256Next(&lane), SUT_output[k + i * 4]);
+        }
+        
+        spk_Xoshiro256LongJump(&ref);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_partial_lane_fill_is_prefix_of_full_fill_PCG64ix8(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64ix8, 7));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64ix8, 7));
+    
+    uint64_t SUT1_output[21] = {0};
+    uint64_t SUT2_output[24] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 21));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 24));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 21);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/*******************************************************************************
+Jump tests. A partial lane fill advances every lane by a full step, so a jump
+which is not a multiple of the lane count must behave the same way.
+*******************************************************************************/
+
+static void CompareJumpToDiscard(const int identifier, const size_t delta)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, identifier, 3));
+    CHECK(spk_GeneratorNew(&SUT2, identifier, 3));
+    
+    uint64_t discard[1000] = {0};
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, discard, delta));
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    
+    CHECK(spk_GeneratorJump(SUT2, delta));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+void test_jump_matches_discarded_output_PCG64ix4(void)
+{
+    CompareJumpToDiscard(SPK_GENERATOR_PCG64ix4, 1000);
+    CompareJumpToDiscard(SPK_GENERATOR_PCG64ix4, 13);
+}
+
+void test_jump_matches_discarded_output_PCG64ix8(void)
+{
+    CompareJumpToDiscard(SPK_GENERATOR_PCG64ix8, 1000);
+    CompareJumpToDiscard(SPK_GENERATOR_PCG64ix8, 13);
+}
+
+void test_jump_matches_discarded_output_Xoshiro256x4(void)
+{
+    CompareJumpToDiscard(SPK_GENERATOR_XOSHIRO256x4, 1000);
+    CompareJumpToDiscard(SPK_GENERATOR_XOSHIRO256x4, 13);
+}
+
+/*******************************************************************************
+Rand tests
+*******************************************************************************/
+
+void test_bounded_random_integers_in_zero_one_stay_in_zero_one_PCG64ix4(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64ix4, 0));
+    uint64_t SUT_output[1000] = {2};
+    
+    //act
+    CHECK(SUT->rand(SUT, SUT_output, 1000, 0, 1));
+    
+    //assert
+    for (size_t i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64(1, SUT_output[i]);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_bounded_random_integers_stay_in_bounds_with_offset_PCG64ix8(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64ix8, 0));
+    uint64_t SUT_output[1001] = {0};
+    uint64_t hits[5] = {0};
+    
+    //act
+    CHECK(SUT->rand(SUT, SUT_output, 1001, 10, 14));
+    
+    //assert
+    for (size_t i = 0; i < 1001; i++)
+    {
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64(10, SUT_output[i]);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64(14, SUT_output[i]);
+        hits[SUT_output[i] - 10]++;
+    }
+    
+    for (size_t i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_GREATER_THAN_UINT64(0, hits[i]);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_bounded_with_max_limits_is_identical_to_raw_output_PCG64ix4(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64ix4, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64ix4, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->rand(SUT2, SUT2_output, 100, 0, UINT64_MAX));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/*******************************************************************************
+Unid tests, see test_generator_sisd.c for the rationale behind the pi estimate
+*******************************************************************************/
+
+void test_unid_values_stay_in_unit_interval_PCG64ix8(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64ix8, 0));
+    double SUT_output[1003] = {2.0, -2.0, 3.14159, - 3.14159, 998529.2398745452};
+    
+    //act
+    CHECK(SUT->unid(SUT, SUT_output, 1003));
+    
+    //assert
+    for (size_t i = 0; i < 1003; i++)
+    {
+        TEST_ASSERT_TRUE(SUT_output[i] >= 0.0);
+        TEST_ASSERT_TRUE(SUT_output[i] <= 1.0);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_pairs_of_unid_values_can_estimate_value_of_pi_PCG64ix4(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64ix4, 0));
+    
+    double *x = malloc(sizeof(double) * 10000000); CHECK(x == NULL);
+    double *y = malloc(sizeof(double) * 10000000); CHECK(y == NULL);
+    
+    uint64_t inside = 0;
+    double pi_approx = 0.0;
+    
+    //act (on the unit circle radius = 1)
+    CHECK(SUT->unid(SUT, x, 10000000));
+    CHECK(SUT->unid(SUT, y, 10000000));
+    
+    for (size_t i = 0; i < 10000000; i++)
+    {
+        if ((x[i] * x[i]) + (y[i] * y[i]) <= 1.0) inside++;
+    };
+    
+    pi_approx = 4.0 * ((double) inside / 10000000.0);
+    
+    //assert
+    TEST_ASSERT_DOUBLE_WITHIN(5.0E-3, acos(-1.0), pi_approx);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(x);
+    free(y);
+}
+
+/******************************************************************************/
+
+void test_unif_values_stay_in_half_open_unit_interval_PCG64ix8(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64ix8, 0));
+    float SUT_output[1003] = {2.0f, -2.0f, 3.14159f, - 3.14159f, 998529.2398f};
+    SUT_output[1002] = 2.0f;
+    
+    //act
+    CHECK(SUT->unif(SUT, SUT_output, 1003));
+    
+    //assert
+    for (size_t i = 0; i < 1003; i++)
+    {
+        TEST_ASSERT_TRUE(SUT_output[i] >= 0.0f);
+        TEST_ASSERT_TRUE(SUT_output[i] < 1.0f);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/*******************************************************************************
+Bias tests. The SISD suite sweeps all 256 probabilities, here we only need to
+confirm that the lane buffering feeds the bias program correctly, so a handful
+of short and long programs are enough.
+*/
+
+void test_bias_at_selected_probabilities_in_8bit_resolution_PCG64ix8(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64ix8, 0));
+    
+    const double prob[6] = {0.0, 0.00390625, 0.25, 0.5, 0.6640625, 0.99609375};
+    uint64_t bitpos[64] = {0};
+    
+    uint64_t *raw = malloc(sizeof(uint64_t) * 1000000); CHECK(raw == NULL);
+    
+    //act + assert
+    for (size_t i = 0; i < 6; i++)
+    {
+        CHECK(SUT->bias(SUT, raw, 1000000, prob[i], 8));
+        
+        for (size_t j = 0; j < 1000000; j++)
+        {
+            for (size_t k = 0; k < 64; k++)
+            {
+                if ((raw[j] >> k) & 0x1ULL)
+                {
+                    bitpos[k]++;
+                }
+            }
+        }
+        
+        for (size_t k = 0; k < 64; k++)
+        {
+            TEST_ASSERT_DOUBLE_WITHIN(5.0E-3, prob[i], (double) bitpos[k]/1000000.0);
+            bitpos[k] = 0;
+        }
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(raw);
+}
+
+/*******************************************************************************
+Counter-based tests
+*******************************************************************************/
+
+//load a raw key, stream, and block, bypassing the seed hash
+static void SetPhilox4x32(spk_generator rng, uint64_t key, uint64_t stream, uint64_t block)
+{
+    rng->state[0] = key;
+    rng->state[1] = stream;
+    rng->state[2] = block;
+    rng->state[3] = 0;
+}
+
+/******************************************************************************/
+
+void test_known_answers_from_random123_for_Philox4x32(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PHILOX4x32, 1));
+    
+    const uint64_t expect[6] =
+    {
+        0xE169C58D6627E8D5ULL, 0x9B00DBD8BC57AC4CULL,
+        0x41C83B0E408F276DULL, 0x6D5451FDA20BC7C6ULL,
+        0x94FDCCEBD16CFE09ULL, 0x24126EA15001E420ULL
+    };
+    
+    uint64_t output[6] = {0};
+    
+    //act
+    SetPhilox4x32(SUT, 0, 0, 0);
+    CHECK(SUT->next(SUT->state, output, 2));
+    
+    SetPhilox4x32(SUT, UINT64_MAX, UINT64_MAX, UINT64_MAX);
+    CHECK(SUT->next(SUT->state, output + 2, 2));
+    
+    SetPhilox4x32(SUT, 0x299F31D0A4093822ULL, 0x0370734413198A2EULL, 0x85A308D3243F6A88ULL);
+    CHECK(SUT->next(SUT->state, output + 4, 2));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expect, output, 6);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/*******************************************************************************
+Fills of 1000 words at every word offset in a small window mix the scalar head,
+the AVX2 groups, and the scalar tail, so every path is checked against the one
+block at a time reference built from two word fills.
+*******************************************************************************/
+void test_vector_groups_match_scalar_blocks_for_Philox4x32(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PHILOX4x32, 1));
+    
+    //the low counter word wraps inside the groups starting near the top
+    SetPhilox4x32(SUT, 0x0123456789ABCDEFULL, 42, 0xFFFFFFFFULL - 100);
+    
+    const size_t n = 1000;
+    uint64_t *expect = malloc(n * sizeof(uint64_t));
+    uint64_t *output = malloc(n * sizeof(uint64_t));
+    uint64_t *ref = malloc((n + 40) * sizeof(uint64_t));
+    CHECK(expect == NULL || output == NULL || ref == NULL);
+    
+    for (size_t i = 0; i < n + 40; i += 2)
+    {
+        CHECK(SUT->next(SUT->state, ref + i, 2));
+    }
+    
+    //act and assert
+    for (uint64_t start = 0; start < 40; start++)
+    {
+        const uint64_t base = (0xFFFFFFFFULL - 100) * 2;
+        CHECK(spk_GeneratorAt(SUT, base + start, output, n));
+        
+        for (size_t i = 0; i < n; i++) expect[i] = ref[start + i];
+        
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(expect, output, n);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(expect);
+    free(output);
+    free(ref);
+}
+
+/******************************************************************************/
+
+void test_at_matches_next_and_leaves_state_untouched_for_Philox4x32(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PHILOX4x32, 1));
+    
+    uint64_t before[4] = {0};
+    for (size_t i = 0; i < 4; i++) before[i] = SUT->state[i];
+    
+    uint64_t from_at[100] = {0};
+    uint64_t from_next[300] = {1};
+    
+    //act
+    CHECK(spk_GeneratorAt(SUT, 201, from_at, 100));
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(before, SUT->state, 4);
+    
+    CHECK(SUT->next(SUT->state, from_next, 300));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(from_next + 201, from_at, 99);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_split_fill_at_odd_offsets_matches_single_fill_for_Philox4x32(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PHILOX4x32, 7));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PHILOX4x32, 7));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 1));
+    CHECK(SUT2->next(SUT2->state, SUT2_output + 1, 33));
+    CHECK(SUT2->next(SUT2->state, SUT2_output + 34, 3));
+    CHECK(SUT2->next(SUT2->state, SUT2_output + 37, 63));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_jump_matches_discarded_output_Philox4x32(void)
+{
+    CompareJumpToDiscard(SPK_GENERATOR_PHILOX4x32, 1000);
+    CompareJumpToDiscard(SPK_GENERATOR_PHILOX4x32, 13);
+}
+
+/******************************************************************************/
+
+void test_at_is_rejected_by_sequential_generators(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t output[10] = {0};
+    
+    //act
+    int error = spk_GeneratorAt(SUT, 0, output, 10);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, error);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/*******************************************************************************
+Dispatch tests. Every variant a generator has must produce the SISD stream bit
+for bit, through every method. The odd lengths leave partial lane groups and
+partial conversion vectors at the tail.
+*******************************************************************************/
+#define ISA_WORDS 1002
+
+struct isa_output
+{
+    uint64_t next[ISA_WORDS];
+    uint64_t rand[ISA_WORDS];
+    uint64_t bias[ISA_WORDS];
+    uint64_t at[ISA_WORDS];
+    double unid[ISA_WORDS];
+    float unif[ISA_WORDS];
+};
+
+static void FillAtISA(int identifier, int isa, struct isa_output *out)
+{
+    spk_generator rng;
+    
+    CHECK(spk_GeneratorSetISA(isa));
+    CHECK(spk_GeneratorNew(&rng, identifier, 42));
+    
+    CHECK(rng->next(rng->state, out->next, ISA_WORDS));
+    CHECK(rng->rand(rng, out->rand, ISA_WORDS, 3, 1000));
+    CHECK(rng->bias(rng, out->bias, ISA_WORDS, 0.3, 8));
+    CHECK(rng->unid(rng, out->unid, ISA_WORDS));
+    CHECK(rng->unif(rng, out->unif, ISA_WORDS));
+    
+    if (identifier == SPK_GENERATOR_PHILOX4x32)
+    {
+        CHECK(spk_GeneratorAt(rng, 12345, out->at, ISA_WORDS));
+    }
+    
+    spk_GeneratorDelete(rng);
+}
+
+static void CompareAcrossISA(int identifier)
+{
+    //arrange
+    struct isa_output *reference = calloc(1, sizeof(struct isa_output));
+    struct isa_output *variant = calloc(1, sizeof(struct isa_output));
+    TEST_ASSERT_NOT_NULL(reference);
+    TEST_ASSERT_NOT_NULL(variant);
+    
+    CHECK(spk_GeneratorSetISA(SPK_ISA_NATIVE));
+    const int native = spk_GeneratorISA();
+    
+    FillAtISA(identifier, SPK_ISA_SISD, reference);
+    
+    for (int isa = SPK_ISA_SISD + 1; isa <= native; isa++)
+    {
+        //act
+        FillAtISA(identifier, isa, variant);
+        
+        //assert
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(reference->next, variant->next, ISA_WORDS);
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(reference->rand, variant->rand, ISA_WORDS);
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(reference->bias, variant->bias, ISA_WORDS);
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(reference->at, variant->at, ISA_WORDS);
+        TEST_ASSERT_EQUAL_MEMORY(reference->unid, variant->unid, sizeof(reference->unid));
+        TEST_ASSERT_EQUAL_MEMORY(reference->unif, variant->unif, sizeof(reference->unif));
+    }
+    
+    //teardown
+    CHECK(spk_GeneratorSetISA(SPK_ISA_NATIVE));
+    free(reference);
+    free(variant);
+}
+
+void test_every_isa_matches_SISD_output_PCG64ix4(void)
+{
+    CompareAcrossISA(SPK_GENERATOR_PCG64ix4);
+}
+
+void test_every_isa_matches_SISD_output_PCG64ix8(void)
+{
+    CompareAcrossISA(SPK_GENERATOR_PCG64ix8);
+}
+
+void test_every_isa_matches_SISD_output_Xoshiro256x4(void)
+{
+    CompareAcrossISA(SPK_GENERATOR_XOSHIRO256x4);
+}
+
+void test_every_isa_matches_SISD_output_Philox4x32(void)
+{
+    CompareAcrossISA(SPK_GENERATOR_PHILOX4x32);
+}
+
+/*******************************************************************************
+Serialization tests. Odd discards leave the lanes out of step with a multiple of
+the lane count and Philox part way through a counter block.
+*******************************************************************************/
+
+static void RoundTripContinuesStream(int identifier)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator restored;
+    CHECK(spk_GeneratorNew(&SUT, identifier, 42));
+    
+    uint64_t SUT_output[100] = {0};
+    uint64_t restored_output[100] = {1};
+    unsigned char snapshot[1024] = {0};
+    
+    const size_t size = spk_GeneratorSerializedSize(identifier);
+    TEST_ASSERT_TRUE(size > SPK_GENERATOR_SERIAL_HEADER && size <= sizeof(snapshot));
+    
+    //act
+    CHECK(SUT->next(SUT->state, SUT_output, 37));
+    CHECK(spk_GeneratorSerialize(SUT, snapshot, size));
+    CHECK(spk_GeneratorDeserialize(&restored, snapshot, size));
+    
+    CHECK(SUT->next(SUT->state, SUT_output, 100));
+    CHECK(restored->next(restored->state, restored_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(identifier, restored->identifier);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT_output, restored_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(restored);
+}
+
+void test_round_trip_continues_stream_Philox4x32(void)
+{
+    RoundTripContinuesStream(SPK_GENERATOR_PHILOX4x32);
+}
+
+void test_round_trip_continues_stream_Xoshiro256x4(void)
+{
+    RoundTripContinuesStream(SPK_GENERATOR_XOSHIRO256x4);
+}
+
+void test_round_trip_continues_stream_PCG64ix8(void)
+{
+    RoundTripContinuesStream(SPK_GENERATOR_PCG64ix8);
+}
+
+void test_array_round_trip_continues_every_stream_PCG64ix4(void)
+{
+    //arrange
+    spk_generator SUT[5];
+    spk_generator restored[5];
+    CHECK(spk_GeneratorArrayNew(SUT, 5, SPK_GENERATOR_PCG64ix4, 7));
+    
+    const size_t size = spk_GeneratorArraySerializedSize(SPK_GENERATOR_PCG64ix4, 5);
+    unsigned char *snapshot = malloc(size);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    
+    uint64_t SUT_output[100] = {0};
+    uint64_t restored_output[100] = {1};
+    
+    for (size_t i = 0; i < 5; i++)
+    {
+        CHECK(SUT[i]->next(SUT[i]->state, SUT_output, 10 + i));
+    }
+    
+    //act
+    CHECK(spk_GeneratorArraySerialize(SUT, 5, snapshot, size));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, spk_GeneratorArrayDeserialize(restored, 4, snapshot, size));
+    CHECK(spk_GeneratorArrayDeserialize(restored, 5, snapshot, size));
+    
+    //assert
+    for (size_t i = 0; i < 5; i++)
+    {
+        CHECK(SUT[i]->next(SUT[i]->state, SUT_output, 100));
+        CHECK(restored[i]->next(restored[i]->state, restored_output, 100));
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT_output, restored_output, 100);
+        TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t) restored[i] % SPK_GENERATOR_ALIGN);
+    }
+    
+    //teardown
+    spk_GeneratorArrayDelete(SUT);
+    spk_GeneratorArrayDelete(restored);
+    free(snapshot);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //seeding tests
+        RUN_TEST(test_deterministic_seed_for_PCG64ix4);
+        RUN_TEST(test_deterministic_seed_for_PCG64ix8);
+        
+        //lane tests
+        RUN_TEST(test_each_lane_matches_SISD_PCG64i_for_PCG64ix4);
+        RUN_TEST(test_each_lane_matches_SISD_PCG64i_for_PCG64ix8);
+        RUN_TEST(test_each_lane_is_a_long_jump_of_SISD_Xoshiro256_for_Xoshiro256x4);
+        RUN_TEST(test_partial_lane_fill_is_prefix_of_full_fill_PCG64ix8);
+        
+        //jump tests
+        RUN_TEST(test_jump_matches_discarded_output_PCG64ix4);
+        RUN_TEST(test_jump_matches_discarded_output_PCG64ix8);
+        RUN_TEST(test_jump_matches_discarded_output_Xoshiro256x4);
+        
+        //rand tests
+        RUN_TEST(test_bounded_random_integers_in_zero_one_stay_in_zero_one_PCG64ix4);
+        RUN_TEST(test_bounded_random_integers_stay_in_bounds_with_offset_PCG64ix8);
+        RUN_TEST(test_bounded_with_max_limits_is_identical_to_raw_output_PCG64ix4);
+        
+        //unid tests
+        RUN_TEST(test_unid_values_stay_in_unit_interval_PCG64ix8);
+        RUN_TEST(test_pairs_of_unid_values_can_estimate_value_of_pi_PCG64ix4);
+        RUN_TEST(test_unif_values_stay_in_half_open_unit_interval_PCG64ix8);
+        
+        //bias tests
+        RUN_TEST(test_bias_at_selected_probabilities_in_8bit_resolution_PCG64ix8);
+        
+        //counter-based tests
+        RUN_TEST(test_known_answers_from_random123_for_Philox4x32);
+        RUN_TEST(test_vector_groups_match_scalar_blocks_for_Philox4x32);
+        RUN_TEST(test_at_matches_next_and_leaves_state_untouched_for_Philox4x32);
+        RUN_TEST(test_split_fill_at_odd_offsets_matches_single_fill_for_Philox4x32);
+        RUN_TEST(test_jump_matches_discarded_output_Philox4x32);
+        RUN_TEST(test_at_is_rejected_by_sequential_generators);
+        
+        //dispatch tests
+        RUN_TEST(test_every_isa_matches_SISD_output_PCG64ix4);
+        RUN_TEST(test_every_isa_matches_SISD_output_PCG64ix8);
+        RUN_TEST(test_every_isa_matches_SISD_output_Xoshiro256x4);
+        RUN_TEST(test_every_isa_matches_SISD_output_Philox4x32);
+        
+        //serialization tests
+        RUN_TEST(test_round_trip_continues_stream_Philox4x32);
+        RUN_TEST(test_round_trip_continues_stream_Xoshiro256x4);
+        RUN_TEST(test_round_trip_continues_stream_PCG64ix8);
+        RUN_TEST(test_array_round_trip_continues_every_stream_PCG64ix4);
+    return UNITY_END();
+}
@@ -5,11 +5,14 @@
 */
 
 #include "generator_sisd.h"
+#include "generator_inline.h"
 #include "unity.h"
 
-#include <math.h> //inverse cosine
+#include <math.h> //inverse cosine, NAN
 #include <stdlib.h> //malloc, exit_failure
+#include <stdarg.h> //va_list
 #include <stdio.h> //fprintf
+#include <string.h> //memcpy
 
 /******************************************************************************/
 
@@ -76,6 +79,1063 @@ void test_deterministic_seed_for_XSH64(void)
     spk_GeneratorDelete(SUT2);
 }
 
+/*******************************************************************************
+Seed sequence tests
+*******************************************************************************/
+
+void test_seed_sequence_is_deterministic_and_matches_explicit_seeds(void)
+{
+    //arrange
+    spk_seed_sequence seq1;
+    spk_seed_sequence seq2;
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_SeedSequenceInit(&seq1, 1));
+    CHECK(spk_SeedSequenceInit(&seq2, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    spk_SeedSequenceNext(&seq2);
+    uint64_t seed = spk_SeedSequenceNext(&seq2);
+    
+    spk_SeedSequenceNext(&seq1);
+    CHECK(spk_GeneratorNewFromSequence(&SUT1, SPK_GENERATOR_PCG64i, &seq1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, seed));
+    
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    TEST_ASSERT_EQUAL_UINT64(seq1.state, seq2.state);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_seed_sequence_yields_distinct_nonzero_seeds(void)
+{
+    //arrange
+    spk_seed_sequence seq;
+    CHECK(spk_SeedSequenceInit(&seq, 0));
+    
+    uint64_t seeds[1000] = {0};
+    
+    //act
+    for (size_t i = 0; i < 1000; i++) seeds[i] = spk_SeedSequenceNext(&seq);
+    
+    //assert
+    for (size_t i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(seeds[i] != 0);
+        
+        for (size_t j = 0; j < i; j++)
+        {
+            TEST_ASSERT_TRUE(seeds[i] != seeds[j]);
+        }
+    }
+}
+
+/******************************************************************************/
+
+void test_init_from_sequence_is_deterministic_XSH64(void)
+{
+    //arrange
+    spk_seed_sequence seq1;
+    spk_seed_sequence seq2;
+    uint64_t storage1[8] = {0};
+    uint64_t storage2[8] = {0};
+    
+    TEST_ASSERT_TRUE(spk_GeneratorSize(SPK_GENERATOR_XSH64) <= sizeof(storage1));
+    
+    CHECK(spk_SeedSequenceInit(&seq1, 7));
+    CHECK(spk_SeedSequenceInit(&seq2, 7));
+    
+    uint64_t SUT1_output[64] = {0};
+    uint64_t SUT2_output[64] = {1};
+    
+    //act
+    CHECK(spk_GeneratorInitFromSequence(storage1, SPK_GENERATOR_XSH64, &seq1));
+    CHECK(spk_GeneratorInitFromSequence(storage2, SPK_GENERATOR_XSH64, &seq2));
+    
+    spk_generator SUT1 = (spk_generator) storage1;
+    spk_generator SUT2 = (spk_generator) storage2;
+    
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 64));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 64));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 64);
+}
+
+/*******************************************************************************
+Inline tests. The header-inline generators must be bit-for-bit identical to the
+generic interface when seeded the same way, and must interoperate with state[].
+*******************************************************************************/
+
+void test_inline_next_matches_generic_next_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_pcg64i SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_PCG64iInit(&SUT2, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    for (size_t i = 0; i < 100; i++) SUT2_output[i] = spk_PCG64iNext(&SUT2);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+}
+
+/******************************************************************************/
+
+void test_inline_next_matches_generic_next_XSH64(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_xsh64 SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_XSH64Init(&SUT2, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    for (size_t i = 0; i < 100; i++) SUT2_output[i] = spk_XSH64Next(&SUT2);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+}
+
+/******************************************************************************/
+
+void test_inline_fill_continues_stream_of_generic_state_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    spk_PCG64iFill((spk_pcg64i *) SUT2->state, SUT2_output, 37);
+    CHECK(SUT2->next(SUT2->state, SUT2_output + 37, 63));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_inline_fill_continues_stream_of_generic_state_XSH64(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_XSH64, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    spk_XSH64Fill((spk_xsh64 *) SUT2->state, SUT2_output, 37);
+    CHECK(SUT2->next(SUT2->state, SUT2_output + 37, 63));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/*******************************************************************************
+Jump and split tests
+*******************************************************************************/
+
+void test_jump_matches_discarded_output_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t discard[1000] = {0};
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, discard, 1000));
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    
+    CHECK(spk_GeneratorJump(SUT2, 1000));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_jump_matches_discarded_output_XSH64(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_XSH64, 1));
+    
+    uint64_t discard[1000] = {0};
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, discard, 1000));
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    
+    CHECK(spk_GeneratorJump(SUT2, 1000));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/*******************************************************************************
+The PCG period is 2^64 and the xorshift period is 2^64 - 1, so jumping by the
+full period must be the identity. This exercises every bit of the jump.
+*/
+
+void test_jump_by_full_period_is_identity_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(spk_GeneratorJump(SUT2, (uint64_t) 1 << 63));
+    CHECK(spk_GeneratorJump(SUT2, (uint64_t) 1 << 63));
+    
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_jump_by_full_period_is_identity_XSH64(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_XSH64, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(spk_GeneratorJump(SUT2, UINT64_MAX));
+    
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/*******************************************************************************
+Since 3 divides 2^64 - 1, splitting xorshift three ways spaces the substreams
+exactly one third of the period apart. Jumping the last substream by one more
+spacing must then wrap around to the first substream, which is the original.
+*/
+
+void test_split_substreams_are_evenly_spaced_across_period_XSH64(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator out[3];
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 1));
+    
+    uint64_t SUT_output[100] = {0};
+    uint64_t first_output[100] = {1};
+    uint64_t last_output[100] = {2};
+    
+    //act
+    CHECK(spk_GeneratorSplit(SUT, 3, out));
+    CHECK(spk_GeneratorJump(out[2], UINT64_MAX / 3));
+    
+    CHECK(SUT->next(SUT->state, SUT_output, 100));
+    CHECK(out[0]->next(out[0]->state, first_output, 100));
+    CHECK(out[2]->next(out[2]->state, last_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT_output, first_output, 100);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT_output, last_output, 100);
+    TEST_ASSERT_EQUAL_INT(SPK_GENERATOR_XSH64, out[1]->identifier);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    
+    for (size_t i = 0; i < 3; i++)
+    {
+        spk_GeneratorDelete(out[i]);
+    }
+}
+
+/*******************************************************************************
+Xoshiro tests. The known answers come from the reference code by Blackman and
+Vigna with the states loaded directly, bypassing the seed hash.
+*******************************************************************************/
+
+void test_known_answers_from_reference_code_Xoshiro256(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XOSHIRO256, 1));
+    
+    for (size_t i = 0; i < 4; i++) SUT->state[i] = i + 1;
+    
+    const uint64_t expect[6] =
+    {
+        0x0000000002800001ULL, 0x0000000003800067ULL, 0x000CC00003800067ULL,
+        0x000CC201994400B2ULL, 0x8012A2019AC433CDULL, 0x8A69978ACDEE33BAULL
+    };
+    
+    uint64_t output[6] = {0};
+    
+    //act
+    CHECK(SUT->next(SUT->state, output, 6));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expect, output, 6);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_known_answers_from_reference_code_Xoroshiro128(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XOROSHIRO128, 1));
+    
+    SUT->state[0] = 1;
+    SUT->state[1] = 2;
+    
+    const uint64_t expect[6] =
+    {
+        0x0000000000000003ULL, 0x0000006001030003ULL, 0x20C102C302000C03ULL,
+        0x810180670D23AD61ULL, 0x26D13A4941333A42ULL, 0x538A501C02F58B2EULL
+    };
+    
+    uint64_t output[6] = {0};
+    
+    //act
+    CHECK(SUT->next(SUT->state, output, 6));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(expect, output, 6);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_inline_fill_continues_stream_of_generic_state_Xoshiro256(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_xoshiro256 SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XOSHIRO256, 1));
+    CHECK(spk_Xoshiro256Init(&SUT2, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    spk_Xoshiro256Fill(&SUT2, SUT2_output, 37);
+    for (size_t i = 37; i < 100; i++) SUT2_output[i] = spk_Xoshiro256Next(&SUT2);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+}
+
+/******************************************************************************/
+
+void test_inline_fill_continues_stream_of_generic_state_Xoroshiro128(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_xoroshiro128 SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XOROSHIRO128, 1));
+    CHECK(spk_Xoroshiro128Init(&SUT2, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    spk_Xoroshiro128Fill(&SUT2, SUT2_output, 37);
+    for (size_t i = 37; i < 100; i++) SUT2_output[i] = spk_Xoroshiro128Next(&SUT2);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+}
+
+/******************************************************************************/
+
+static void CompareJumpToDiscard(const int identifier, const uint64_t delta)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, identifier, 1));
+    CHECK(spk_GeneratorNew(&SUT2, identifier, 1));
+    
+    uint64_t discard[1000] = {0};
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, discard, (size_t) delta));
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    
+    CHECK(spk_GeneratorJump(SUT2, delta));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+void test_jump_matches_discarded_output_Xoshiro256(void)
+{
+    CompareJumpToDiscard(SPK_GENERATOR_XOSHIRO256, 1000);
+    CompareJumpToDiscard(SPK_GENERATOR_XOSHIRO256, 1);
+    CompareJumpToDiscard(SPK_GENERATOR_XOSHIRO256, 0);
+}
+
+void test_jump_matches_discarded_output_Xoroshiro128(void)
+{
+    CompareJumpToDiscard(SPK_GENERATOR_XOROSHIRO128, 1000);
+    CompareJumpToDiscard(SPK_GENERATOR_XOROSHIRO128, 255);
+}
+
+/*******************************************************************************
+Two generic jumps of 2^63 are a jump of 2^64, which must agree with the reference
+jump constant for xoroshiro128+. It ties the polynomial jump to Vigna's tables.
+*******************************************************************************/
+
+void test_generic_jump_agrees_with_reference_jump_Xoroshiro128(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_xoroshiro128 SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XOROSHIRO128, 1));
+    CHECK(spk_Xoroshiro128Init(&SUT2, 1));
+    
+    //act
+    CHECK(spk_GeneratorJump(SUT1, (uint64_t) 1 << 63));
+    CHECK(spk_GeneratorJump(SUT1, (uint64_t) 1 << 63));
+    spk_Xoroshiro128Jump(&SUT2);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT2.s, SUT1->state, 2);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+}
+
+/******************************************************************************/
+
+void test_reference_jumps_match_known_states_Xoshiro256(void)
+{
+    //arrange
+    spk_xoshiro256 SUT1 = {{1, 2, 3, 4}};
+    spk_xoshiro256 SUT2 = {{1, 2, 3, 4}};
+    
+    const uint64_t jump[4] =
+    {
+        0x8C7A153956B5F3D1ULL, 0x701F1A713401D85EULL,
+        0x6527F66A65469085ULL, 0x8386B786C4408050ULL
+    };
+    
+    const uint64_t long_jump[4] =
+    {
+        0x096A8EB71295A400ULL, 0xDBF84991E50F4516ULL,
+        0x534EE745810D2A0EULL, 0x31655CA1A2215BF1ULL
+    };
+    
+    //act
+    spk_Xoshiro256Jump(&SUT1);
+    spk_Xoshiro256LongJump(&SUT2);
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(jump, SUT1.s, 4);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(long_jump, SUT2.s, 4);
+}
+
+/******************************************************************************/
+
+void test_unid_values_stay_in_unit_interval_Xoroshiro128(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XOROSHIRO128, 1));
+    
+    const size_t n = 100000;
+    double *output = malloc(n * sizeof(double));
+    CHECK(output == NULL);
+    
+    double sum = 0.0;
+    
+    //act
+    CHECK(SUT->unid(SUT, output, n));
+    
+    //assert
+    for (size_t i = 0; i < n; i++)
+    {
+        TEST_ASSERT_TRUE(output[i] >= 0.0 && output[i] < 1.0);
+        sum += output[i];
+    }
+    
+    TEST_ASSERT_DOUBLE_WITHIN(0.005, 0.5, sum / (double) n);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(output);
+}
+
+/*******************************************************************************
+Placement tests. Generators in caller storage must behave exactly like the ones
+from spk_GeneratorNew, and arrays must not let two generators share a line.
+*******************************************************************************/
+
+void test_size_is_zero_only_for_unknown_identifiers(void)
+{
+    //arrange
+    const size_t interface = sizeof(struct spk_generator);
+    
+    //act
+    size_t pcg = spk_GeneratorSize(SPK_GENERATOR_PCG64i);
+    size_t xsh = spk_GeneratorSize(SPK_GENERATOR_XSH64);
+    size_t unknown = spk_GeneratorSize(0x7FFFFFFF);
+    
+    //assert
+    TEST_ASSERT_EQUAL_size_t(interface + 2 * sizeof(uint64_t), pcg);
+    TEST_ASSERT_EQUAL_size_t(interface + sizeof(uint64_t), xsh);
+    TEST_ASSERT_EQUAL_size_t(0, unknown);
+}
+
+/******************************************************************************/
+
+void test_init_in_caller_storage_matches_new_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    uint64_t storage[16] = {0};
+    
+    TEST_ASSERT_TRUE(spk_GeneratorSize(SPK_GENERATOR_PCG64i) <= sizeof(storage));
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorInit(storage, SPK_GENERATOR_PCG64i, 1));
+    spk_generator SUT2 = (spk_generator) storage;
+    
+    uint64_t SUT1_output[100] = {0};
+    double SUT1_unid[10] = {0.0};
+    uint64_t SUT2_output[100] = {1};
+    double SUT2_unid[10] = {1.0};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->next(SUT2->state, SUT2_output, 100));
+    CHECK(SUT1->unid(SUT1, SUT1_unid, 10));
+    CHECK(SUT2->unid(SUT2, SUT2_unid, 10));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    TEST_ASSERT_EQUAL_DOUBLE_ARRAY(SUT1_unid, SUT2_unid, 10);
+    TEST_ASSERT_EQUAL_INT(SPK_GENERATOR_PCG64i, SUT2->identifier);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+}
+
+/******************************************************************************/
+
+void test_init_with_unknown_identifier_is_rejected(void)
+{
+    //arrange
+    uint64_t storage[16] = {0};
+    
+    //act
+    int error = spk_GeneratorInit(storage, 0x7FFFFFFF, 1);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, error);
+}
+
+/******************************************************************************/
+
+void test_array_generators_are_aligned_and_do_not_share_lines_XSH64(void)
+{
+    //arrange
+    spk_generator SUT[5];
+    
+    //act
+    CHECK(spk_GeneratorArrayNew(SUT, 5, SPK_GENERATOR_XSH64, 1));
+    
+    //assert
+    for (size_t i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t) SUT[i] % SPK_GENERATOR_ALIGN);
+        
+        if (i > 0)
+        {
+            uintptr_t gap = (uintptr_t) SUT[i] - (uintptr_t) SUT[i - 1];
+            TEST_ASSERT_TRUE(gap >= spk_GeneratorSize(SPK_GENERATOR_XSH64));
+        }
+    }
+    
+    //teardown
+    spk_GeneratorArrayDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_array_substreams_match_split_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT[3];
+    spk_generator reference;
+    spk_generator split[3];
+    
+    CHECK(spk_GeneratorArrayNew(SUT, 3, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&reference, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorSplit(reference, 3, split));
+    
+    uint64_t SUT_output[100] = {0};
+    uint64_t split_output[100] = {1};
+    
+    //act and assert
+    for (size_t i = 0; i < 3; i++)
+    {
+        CHECK(SUT[i]->next(SUT[i]->state, SUT_output, 100));
+        CHECK(split[i]->next(split[i]->state, split_output, 100));
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(split_output, SUT_output, 100);
+    }
+    
+    //teardown
+    spk_GeneratorArrayDelete(SUT);
+    spk_GeneratorDelete(reference);
+    
+    for (size_t i = 0; i < 3; i++)
+    {
+        spk_GeneratorDelete(split[i]);
+    }
+}
+
+/*******************************************************************************
+Serialization tests
+*******************************************************************************/
+
+static void RoundTripContinuesStream(int identifier)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator restored;
+    CHECK(spk_GeneratorNew(&SUT, identifier, 42));
+    
+    uint64_t SUT_output[100] = {0};
+    uint64_t restored_output[100] = {1};
+    unsigned char snapshot[1024] = {0};
+    
+    const size_t size = spk_GeneratorSerializedSize(identifier);
+    TEST_ASSERT_TRUE(size > SPK_GENERATOR_SERIAL_HEADER && size <= sizeof(snapshot));
+    
+    //act
+    CHECK(SUT->next(SUT->state, SUT_output, 37));
+    CHECK(spk_GeneratorSerialize(SUT, snapshot, size));
+    CHECK(spk_GeneratorDeserialize(&restored, snapshot, size));
+    
+    CHECK(SUT->next(SUT->state, SUT_output, 100));
+    CHECK(restored->next(restored->state, restored_output, 100));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(identifier, restored->identifier);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT_output, restored_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(restored);
+}
+
+void test_round_trip_continues_stream_PCG64i(void)
+{
+    RoundTripContinuesStream(SPK_GENERATOR_PCG64i);
+}
+
+void test_round_trip_continues_stream_XSH64(void)
+{
+    RoundTripContinuesStream(SPK_GENERATOR_XSH64);
+}
+
+void test_round_trip_continues_stream_Xoshiro256(void)
+{
+    RoundTripContinuesStream(SPK_GENERATOR_XOSHIRO256);
+}
+
+void test_serialized_layout_is_little_endian_at_fixed_offsets(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    SUT->state[0] = 0x0123456789ABCDEFULL;
+    
+    const size_t size = spk_GeneratorSerializedSize(SPK_GENERATOR_PCG64i);
+    unsigned char *snapshot = malloc(size);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    
+    //act
+    CHECK(spk_GeneratorSerialize(SUT, snapshot, size));
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY("SPKG", snapshot, 4);
+    TEST_ASSERT_EQUAL_UINT8(SPK_GENERATOR_SERIAL_VERSION, snapshot[4]);
+    TEST_ASSERT_EQUAL_UINT8(SPK_MAJOR, snapshot[5]);
+    TEST_ASSERT_EQUAL_UINT8(SPK_MINOR, snapshot[6]);
+    TEST_ASSERT_EQUAL_UINT8(SPK_PATCH, snapshot[7]);
+    TEST_ASSERT_EQUAL_UINT8(SPK_GENERATOR_PCG64i & 0xFF, snapshot[8]);
+    TEST_ASSERT_EQUAL_UINT8(SPK_GENERATOR_PCG64i >> 8, snapshot[9]);
+    TEST_ASSERT_EQUAL_UINT8((size - SPK_GENERATOR_SERIAL_HEADER) / 8, snapshot[12]);
+    TEST_ASSERT_EQUAL_UINT8(0xEF, snapshot[16]);
+    TEST_ASSERT_EQUAL_UINT8(0x01, snapshot[23]);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(snapshot);
+}
+
+void test_malformed_snapshots_are_rejected(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator restored = NULL;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XOSHIRO256, 1));
+    
+    const size_t size = spk_GeneratorSerializedSize(SPK_GENERATOR_XOSHIRO256);
+    unsigned char snapshot[256] = {0};
+    unsigned char corrupt[256] = {0};
+    
+    CHECK(spk_GeneratorSerialize(SUT, snapshot, size));
+    
+    //act and assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_GeneratorSerialize(SUT, corrupt, size - 1));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, spk_GeneratorDeserialize(&restored, snapshot, size - 1));
+    
+    memcpy(corrupt, snapshot, size);
+    corrupt[0] = 'X';
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, spk_GeneratorDeserialize(&restored, corrupt, size));
+    
+    memcpy(corrupt, snapshot, size);
+    corrupt[4] = SPK_GENERATOR_SERIAL_VERSION + 1;
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, spk_GeneratorDeserialize(&restored, corrupt, size));
+    
+    memcpy(corrupt, snapshot, size);
+    corrupt[8] = 0xFF;
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, spk_GeneratorDeserialize(&restored, corrupt, size));
+    
+    memcpy(corrupt, snapshot, size);
+    corrupt[12] = (unsigned char) (corrupt[12] + 1);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, spk_GeneratorDeserialize(&restored, corrupt, size));
+    
+    //a different library version is accepted
+    memcpy(corrupt, snapshot, size);
+    corrupt[7] = (unsigned char) (corrupt[7] + 1);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, spk_GeneratorDeserialize(&restored, corrupt, size));
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(restored);
+}
+
+void test_array_round_trip_continues_every_stream_XSH64(void)
+{
+    //arrange
+    spk_generator SUT[5];
+    spk_generator restored[5];
+    CHECK(spk_GeneratorArrayNew(SUT, 5, SPK_GENERATOR_XSH64, 7));
+    
+    const size_t size = spk_GeneratorArraySerializedSize(SPK_GENERATOR_XSH64, 5);
+    unsigned char *snapshot = malloc(size);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    
+    uint64_t SUT_output[100] = {0};
+    uint64_t restored_output[100] = {1};
+    
+    for (size_t i = 0; i < 5; i++)
+    {
+        CHECK(SUT[i]->next(SUT[i]->state, SUT_output, 10 + i));
+    }
+    
+    //act
+    CHECK(spk_GeneratorArraySerialize(SUT, 5, snapshot, size));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, spk_GeneratorArrayDeserialize(restored, 4, snapshot, size));
+    CHECK(spk_GeneratorArrayDeserialize(restored, 5, snapshot, size));
+    
+    //assert
+    for (size_t i = 0; i < 5; i++)
+    {
+        CHECK(SUT[i]->next(SUT[i]->state, SUT_output, 100));
+        CHECK(restored[i]->next(restored[i]->state, restored_output, 100));
+        TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT_output, restored_output, 100);
+        TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t) restored[i] % SPK_GENERATOR_ALIGN);
+    }
+    
+    //teardown
+    spk_GeneratorArrayDelete(SUT);
+    spk_GeneratorArrayDelete(restored);
+    free(snapshot);
+}
+
+/*******************************************************************************
+Hardware generator tests. The output can't be compared against anything, so
+these only check the plumbing and a few loose statistics at 5 sigma.
+*******************************************************************************/
+
+void test_hardware_words_have_balanced_bits_RdRand(void)
+{
+    //arrange
+    spk_generator SUT;
+    uint64_t *SUT_output = malloc(10003 * sizeof(uint64_t));
+    
+    CHECK(SUT_output == NULL);
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_RDRAND, 0));
+    
+    //act, an odd count exercises the scalar tail after the unrolled groups
+    int error = SUT->next(SUT->state, SUT_output, 10003);
+    
+    double ones = 0.0;
+    for (size_t i = 0; i < 10003; i++) ones += (double) __builtin_popcountll(SUT_output[i]);
+    
+    //assert, 320096 expected ones with a standard deviation of 400
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_EQUAL_INT(SPK_GENERATOR_RDRAND, SUT->identifier);
+    TEST_ASSERT_DOUBLE_WITHIN(2000.0, 320096.0, ones);
+    
+    //teardown
+    free(SUT_output);
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_hardware_methods_stay_in_range_RdRand(void)
+{
+    //arrange
+    spk_generator SUT;
+    uint64_t rolls[1000] = {0};
+    uint64_t biased[1000] = {0};
+    double uniform[1000] = {0};
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_RDRAND, 0));
+    
+    //act
+    CHECK(SUT->rand(SUT, rolls, 1000, 1, 6));
+    CHECK(SUT->bias(SUT, biased, 1000, 0.25, 8));
+    CHECK(SUT->unid(SUT, uniform, 1000));
+    
+    //assert, p = 0.25 gives 16000 expected ones with a standard deviation of 110
+    double ones = 0.0;
+    
+    for (size_t i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(rolls[i] >= 1 && rolls[i] <= 6);
+        TEST_ASSERT_TRUE(uniform[i] >= 0.0 && uniform[i] < 1.0);
+        ones += (double) __builtin_popcountll(biased[i]);
+    }
+    
+    TEST_ASSERT_DOUBLE_WITHIN(550.0, 16000.0, ones);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_hardware_jump_split_and_restore_succeed_RdRand(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator split[2];
+    spk_generator restored;
+    unsigned char snapshot[64] = {0};
+    uint64_t output[2] = {0};
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_RDRAND, 0));
+    
+    //act
+    int jump = spk_GeneratorJump(SUT, 1000);
+    int divide = spk_GeneratorSplit(SUT, 2, split);
+    int save = spk_GeneratorSerialize(SUT, snapshot, sizeof(snapshot));
+    int load = spk_GeneratorDeserialize(&restored, snapshot, sizeof(snapshot));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, jump);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, divide);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, save);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, load);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, split[1]->next(split[1]->state, output, 2));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, restored->next(restored->state, output, 2));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_GeneratorAt(SUT, 0, output, 2));
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(split[0]);
+    spk_GeneratorDelete(split[1]);
+    spk_GeneratorDelete(restored);
+}
+
+/*******************************************************************************
+Dispatch tests. The SISD generators only dispatch their conversion kernels, so
+unid, unif, and bias must not change with the cap either.
+*******************************************************************************/
+
+void test_isa_cap_limits_level_and_rejects_unsupported_levels(void)
+{
+    //arrange
+    CHECK(spk_GeneratorSetISA(SPK_ISA_NATIVE));
+    const int native = spk_GeneratorISA();
+    
+    //act
+    int low = spk_GeneratorSetISA(SPK_ISA_SISD);
+    int capped = spk_GeneratorISA();
+    int above = spk_GeneratorSetISA(native + 1);
+    int below = spk_GeneratorSetISA(-2);
+    int unchanged = spk_GeneratorISA();
+    int lift = spk_GeneratorSetISA(SPK_ISA_NATIVE);
+    
+    //assert
+    TEST_ASSERT_TRUE(native >= SPK_ISA_SISD && native <= SPK_ISA_AVX512);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, low);
+    TEST_ASSERT_EQUAL_INT(SPK_ISA_SISD, capped);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, above);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, below);
+    TEST_ASSERT_EQUAL_INT(SPK_ISA_SISD, unchanged);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, lift);
+    TEST_ASSERT_EQUAL_INT(native, spk_GeneratorISA());
+}
+
+/******************************************************************************/
+
+void test_conversion_kernels_match_across_isa_Xoshiro256(void)
+{
+    //arrange
+    double unid[2][1001];
+    float unif[2][1001];
+    uint64_t bias[2][1001];
+    
+    CHECK(spk_GeneratorSetISA(SPK_ISA_NATIVE));
+    
+    //act
+    for (int k = 0; k < 2; k++)
+    {
+        spk_generator SUT;
+        
+        CHECK(spk_GeneratorSetISA(k == 0 ? SPK_ISA_SISD : SPK_ISA_NATIVE));
+        CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XOSHIRO256, 42));
+        
+        CHECK(SUT->unid(SUT, unid[k], 1001));
+        CHECK(SUT->unif(SUT, unif[k], 1001));
+        CHECK(SUT->bias(SUT, bias[k], 1001, 0.3, 8));
+        
+        spk_GeneratorDelete(SUT);
+    }
+    
+    //assert
+    TEST_ASSERT_EQUAL_MEMORY(unid[0], unid[1], sizeof(unid[0]));
+    TEST_ASSERT_EQUAL_MEMORY(unif[0], unif[1], sizeof(unif[0]));
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(bias[0], bias[1], 1001);
+}
+
 /*******************************************************************************
 Rand tests
 *******************************************************************************/
@@ -135,101 +1195,267 @@ void test_bounded_random_integers_upper_bound_is_inclusive_PCG64i(void)
     uint64_t sum = 0;
     
     //act
-    CHECK(SUT->rand(SUT, SUT_output, 1000, 0, 1));
+    CHECK(SUT->rand(SUT, SUT_output, 1000, 0, 1));
+    
+    for (size_t i = 0; i < 1000; i++)
+    {
+        sum += SUT_output[i];
+    }
+    
+    //assert
+    TEST_ASSERT_LESS_OR_EQUAL_UINT64(1000, sum);
+    TEST_ASSERT_GREATER_THAN_UINT64(0, sum);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);  
+}
+
+/******************************************************************************/
+
+void test_bounded_random_integers_upper_bound_is_inclusive_XSH64(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 0));
+    uint64_t SUT_output[1000] = {0};
+    uint64_t sum = 0;
+    
+    //act
+    CHECK(SUT->rand(SUT, SUT_output, 1000, 0, 1));
+    
+    for (size_t i = 0; i < 1000; i++)
+    {
+        sum += SUT_output[i];
+    }
+    
+    //assert
+    TEST_ASSERT_LESS_OR_EQUAL_UINT64(1000, sum);
+    TEST_ASSERT_GREATER_THAN_UINT64(0, sum);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);  
+}
+
+
+/******************************************************************************/
+
+void test_bounded_with_max_limits_is_identical_to_raw_output_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->rand(SUT2, SUT2_output, 100, 0, UINT64_MAX));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_bounded_with_max_limits_is_identical_to_raw_output_XSH64(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_XSH64, 1));
+    
+    uint64_t SUT1_output[100] = {0};
+    uint64_t SUT2_output[100] = {1};
+    
+    //act
+    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
+    CHECK(SUT2->rand(SUT2, SUT2_output, 100, 0, UINT64_MAX));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+
+/******************************************************************************/
+
+void test_bounded_random_integers_on_die_faces_are_uniform_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 0));
+    uint64_t *SUT_output = malloc(sizeof(uint64_t) * 600000); CHECK(!SUT_output);
+    uint64_t faces[6] = {0};
+    
+    //act
+    CHECK(SUT->rand(SUT, SUT_output, 600000, 1, 6));
+    
+    for (size_t i = 0; i < 600000; i++)
+    {
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64(1, SUT_output[i]);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64(6, SUT_output[i]);
+        faces[SUT_output[i] - 1]++;
+    }
+    
+    //assert each face is within 1% of its expected count
+    for (size_t i = 0; i < 6; i++)
+    {
+        TEST_ASSERT_UINT64_WITHIN(1000, 100000, faces[i]);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(SUT_output);
+}
+
+/*******************************************************************************
+A range of 2^63 + 1 rejects almost half of all draws under mask-and-reject and
+is the worst case for the multiply-shift method as well.
+*/
+
+void test_bounded_random_integers_just_above_power_of_two_stay_in_bounds_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 0));
+    uint64_t SUT_output[1000] = {0};
+    const uint64_t max = (uint64_t) 1 << 63;
+    uint64_t upper_half = 0;
+    
+    //act
+    CHECK(SUT->rand(SUT, SUT_output, 1000, 0, max));
+    
+    //assert
+    for (size_t i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64(max, SUT_output[i]);
+        if (SUT_output[i] >= max / 2) upper_half++;
+    }
+    
+    TEST_ASSERT_UINT64_WITHIN(100, 500, upper_half);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_bounded_random_integers_with_equal_limits_return_the_limit_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 0));
+    uint64_t SUT_output[100] = {0};
+    
+    //act
+    CHECK(SUT->rand(SUT, SUT_output, 100, 42, 42));
     
-    for (size_t i = 0; i < 1000; i++)
+    //assert
+    for (size_t i = 0; i < 100; i++)
     {
-        sum += SUT_output[i];
+        TEST_ASSERT_EQUAL_UINT64(42, SUT_output[i]);
     }
     
-    //assert
-    TEST_ASSERT_LESS_OR_EQUAL_UINT64(1000, sum);
-    TEST_ASSERT_GREATER_THAN_UINT64(0, sum);
-    
     //teardown
-    spk_GeneratorDelete(SUT);  
+    spk_GeneratorDelete(SUT);
 }
 
 /******************************************************************************/
 
-void test_bounded_random_integers_upper_bound_is_inclusive_XSH64(void)
+void test_bounded_random_integers_on_die_faces_are_uniform_XSH64(void)
 {
     //arrange
     spk_generator SUT;
     CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 0));
-    uint64_t SUT_output[1000] = {0};
-    uint64_t sum = 0;
+    uint64_t *SUT_output = malloc(sizeof(uint64_t) * 600000); CHECK(!SUT_output);
+    uint64_t faces[6] = {0};
     
     //act
-    CHECK(SUT->rand(SUT, SUT_output, 1000, 0, 1));
+    CHECK(SUT->rand(SUT, SUT_output, 600000, 1, 6));
     
-    for (size_t i = 0; i < 1000; i++)
+    for (size_t i = 0; i < 600000; i++)
     {
-        sum += SUT_output[i];
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64(1, SUT_output[i]);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64(6, SUT_output[i]);
+        faces[SUT_output[i] - 1]++;
     }
     
-    //assert
-    TEST_ASSERT_LESS_OR_EQUAL_UINT64(1000, sum);
-    TEST_ASSERT_GREATER_THAN_UINT64(0, sum);
+    //assert each face is within 1% of its expected count
+    for (size_t i = 0; i < 6; i++)
+    {
+        TEST_ASSERT_UINT64_WITHIN(1000, 100000, faces[i]);
+    }
     
     //teardown
-    spk_GeneratorDelete(SUT);  
+    spk_GeneratorDelete(SUT);
+    free(SUT_output);
 }
 
+/*******************************************************************************
+A range of 2^63 + 1 rejects almost half of all draws under mask-and-reject and
+is the worst case for the multiply-shift method as well.
+*/
 
-/******************************************************************************/
-
-void test_bounded_with_max_limits_is_identical_to_raw_output_PCG64i(void)
+void test_bounded_random_integers_just_above_power_of_two_stay_in_bounds_XSH64(void)
 {
     //arrange
-    spk_generator SUT1;
-    spk_generator SUT2;
-    
-    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
-    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, 1));
-    
-    uint64_t SUT1_output[100] = {0};
-    uint64_t SUT2_output[100] = {1};
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 0));
+    uint64_t SUT_output[1000] = {0};
+    const uint64_t max = (uint64_t) 1 << 63;
+    uint64_t upper_half = 0;
     
     //act
-    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
-    CHECK(SUT2->rand(SUT2, SUT2_output, 100, 0, UINT64_MAX));
+    CHECK(SUT->rand(SUT, SUT_output, 1000, 0, max));
     
     //assert
-    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64(max, SUT_output[i]);
+        if (SUT_output[i] >= max / 2) upper_half++;
+    }
+    
+    TEST_ASSERT_UINT64_WITHIN(100, 500, upper_half);
     
     //teardown
-    spk_GeneratorDelete(SUT1);
-    spk_GeneratorDelete(SUT2);
+    spk_GeneratorDelete(SUT);
 }
 
 /******************************************************************************/
 
-void test_bounded_with_max_limits_is_identical_to_raw_output_XSH64(void)
+void test_bounded_random_integers_with_equal_limits_return_the_limit_XSH64(void)
 {
     //arrange
-    spk_generator SUT1;
-    spk_generator SUT2;
-    
-    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XSH64, 1));
-    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_XSH64, 1));
-    
-    uint64_t SUT1_output[100] = {0};
-    uint64_t SUT2_output[100] = {1};
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 0));
+    uint64_t SUT_output[100] = {0};
     
     //act
-    CHECK(SUT1->next(SUT1->state, SUT1_output, 100));
-    CHECK(SUT2->rand(SUT2, SUT2_output, 100, 0, UINT64_MAX));
+    CHECK(SUT->rand(SUT, SUT_output, 100, 42, 42));
     
     //assert
-    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 100);
+    for (size_t i = 0; i < 100; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT64(42, SUT_output[i]);
+    }
     
     //teardown
-    spk_GeneratorDelete(SUT1);
-    spk_GeneratorDelete(SUT2);
+    spk_GeneratorDelete(SUT);
 }
 
-
 /******************************************************************************/
 
 void test_unid_values_stay_in_unit_interval_PCG64i(void)
@@ -360,6 +1586,118 @@ void test_pairs_of_unid_values_can_estimate_value_of_pi_XSH64(void)
     free(y);
 }
 
+/******************************************************************************/
+
+void test_unif_values_stay_in_half_open_unit_interval_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 0));
+    float SUT_output[1001] = {2.0f, -2.0f, 3.14159f, - 3.14159f, 998529.2398f};
+    SUT_output[1000] = 2.0f;
+    
+    //act
+    CHECK(SUT->unif(SUT, SUT_output, 1001));
+    
+    //assert
+    for (size_t i = 0; i < 1001; i++)
+    {
+        TEST_ASSERT_TRUE(SUT_output[i] >= 0.0f);
+        TEST_ASSERT_TRUE(SUT_output[i] < 1.0f);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_unif_mean_and_variance_match_standard_uniform_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 0));
+    float *SUT_output = malloc(sizeof(float) * 1000000); CHECK(!SUT_output);
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    
+    //act
+    CHECK(SUT->unif(SUT, SUT_output, 1000000));
+    
+    for (size_t i = 0; i < 1000000; i++)
+    {
+        sum += (double) SUT_output[i];
+        sum_squares += (double) SUT_output[i] * (double) SUT_output[i];
+    }
+    
+    const double mean = sum / 1000000.0;
+    const double variance = sum_squares / 1000000.0 - mean * mean;
+    
+    //assert
+    TEST_ASSERT_DOUBLE_WITHIN(2.0E-3, 0.5, mean);
+    TEST_ASSERT_DOUBLE_WITHIN(2.0E-3, 1.0 / 12.0, variance);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(SUT_output);
+}
+
+/******************************************************************************/
+
+void test_unif_values_stay_in_half_open_unit_interval_XSH64(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 0));
+    float SUT_output[1001] = {2.0f, -2.0f, 3.14159f, - 3.14159f, 998529.2398f};
+    SUT_output[1000] = 2.0f;
+    
+    //act
+    CHECK(SUT->unif(SUT, SUT_output, 1001));
+    
+    //assert
+    for (size_t i = 0; i < 1001; i++)
+    {
+        TEST_ASSERT_TRUE(SUT_output[i] >= 0.0f);
+        TEST_ASSERT_TRUE(SUT_output[i] < 1.0f);
+    }
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_unif_mean_and_variance_match_standard_uniform_XSH64(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_XSH64, 0));
+    float *SUT_output = malloc(sizeof(float) * 1000000); CHECK(!SUT_output);
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    
+    //act
+    CHECK(SUT->unif(SUT, SUT_output, 1000000));
+    
+    for (size_t i = 0; i < 1000000; i++)
+    {
+        sum += (double) SUT_output[i];
+        sum_squares += (double) SUT_output[i] * (double) SUT_output[i];
+    }
+    
+    const double mean = sum / 1000000.0;
+    const double variance = sum_squares / 1000000.0 - mean * mean;
+    
+    //assert
+    TEST_ASSERT_DOUBLE_WITHIN(2.0E-3, 0.5, mean);
+    TEST_ASSERT_DOUBLE_WITHIN(2.0E-3, 1.0 / 12.0, variance);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(SUT_output);
+}
+
 /*******************************************************************************
 Another complicated and long monte carlo unit test. Like the unit circle test,
 we need to confirm within some delta that the bias method is actually generating
@@ -486,6 +1824,198 @@ void test_bias_at_all_256_probabilities_in_8bit_resolution_XSH64(void)
     free(raw);
 }
 
+/*******************************************************************************
+Bias program tests. The program path must be identical to the bias method since
+the bias method is just a program compiled on the fly.
+*/
+
+void test_bias_program_matches_bias_method_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    spk_bias_program program;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_PCG64i, 1));
+    CHECK(spk_BiasProgramInit(&program, 0.3, 12));
+    
+    uint64_t SUT1_output[1001] = {0};
+    uint64_t SUT2_output[1001] = {1};
+    
+    //act
+    CHECK(SUT1->bias(SUT1, SUT1_output, 1001, 0.3, 12));
+    CHECK(spk_GeneratorBias(SUT2, SUT2_output, 1001, &program));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_BIAS_GENERAL, program.kind);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 1001);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
+/******************************************************************************/
+
+void test_bias_program_selects_fast_paths(void)
+{
+    //arrange
+    spk_bias_program zero;
+    spk_bias_program copy;
+    spk_bias_program invalid;
+    
+    //act
+    CHECK(spk_BiasProgramInit(&zero, 0.003, 8));
+    CHECK(spk_BiasProgramInit(&copy, 0.5, 16));
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_BIAS_ZERO, zero.kind);
+    TEST_ASSERT_EQUAL_INT(SPK_BIAS_COPY, copy.kind);
+    TEST_ASSERT_EQUAL_INT(1, copy.limit);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_BiasProgramInit(&invalid, 1.0, 8));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_BiasProgramInit(&invalid, 0.5, 65));
+}
+
+/*******************************************************************************
+Argument check tests. The checked methods reject bad arguments and report them
+to the logger, the unchecked variants and a disabled check trust the caller.
+*/
+
+static int logged = 0;
+static int logged_error = 0;
+static const char *logged_where = NULL;
+
+static void CountingLogger(void *ctx, int error, const char *where, const char *format, va_list args)
+{
+    (void) format;
+    (void) args;
+    
+    logged += ctx == &logged;
+    logged_error = error;
+    logged_where = where;
+}
+
+/******************************************************************************/
+
+void test_checked_methods_reject_and_log_bad_arguments_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    uint64_t output[8];
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    spk_SetLogger(CountingLogger, &logged);
+    logged = 0;
+    
+    //act
+    int reversed = SUT->rand(SUT, output, 8, 10, 9);
+    int probability = SUT->bias(SUT, output, 8, 1.5, 8);
+    int resolution = SUT->bias(SUT, output, 8, 0.5, 0);
+    int nan = SUT->bias(SUT, output, 8, (double) NAN, 8);
+    spk_SetLogger(NULL, NULL);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, reversed);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, probability);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, resolution);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, nan);
+    TEST_ASSERT_EQUAL_INT(4, logged);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, logged_error);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_failures_are_logged_under_the_public_name_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator restored = NULL;
+    uint64_t output[8];
+    unsigned char snapshot[64] = {0};
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    spk_SetLogger(CountingLogger, &logged);
+    
+    //act
+    SUT->rand(SUT, output, 8, 10, 9);
+    const char *rand = logged_where;
+    SUT->bias(SUT, output, 8, 1.5, 8);
+    const char *bias = logged_where;
+    int format = spk_GeneratorDeserialize(&restored, snapshot, sizeof(snapshot));
+    const char *deserialize = logged_where;
+    int unknown = spk_GeneratorNew(&restored, -1, 1);
+    const char *identifier = logged_where;
+    
+    spk_SetLogger(NULL, NULL);
+    
+    //assert
+    TEST_ASSERT_EQUAL_STRING("spk_generator->rand", rand);
+    TEST_ASSERT_EQUAL_STRING("spk_generator->bias", bias);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, format);
+    TEST_ASSERT_EQUAL_STRING("spk_GeneratorDeserialize", deserialize);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, unknown);
+    TEST_ASSERT_EQUAL_STRING("spk_GeneratorNew", identifier);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_disabled_checks_skip_validation_PCG64i(void)
+{
+    //arrange
+    spk_generator SUT;
+    uint64_t output[8];
+    
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_PCG64i, 1));
+    
+    //act
+    int previous = spk_SetChecking(0);
+    int reversed = SUT->rand(SUT, output, 8, 10, 9);
+    int program = spk_BiasProgramInit(&(spk_bias_program) {0}, 1.5, 8);
+    int restored = spk_SetChecking(previous);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(1, previous);
+    TEST_ASSERT_EQUAL_INT(0, restored);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, reversed);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, program);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_unchecked_rand_matches_rand_method_XSH64(void)
+{
+    //arrange
+    spk_generator SUT1;
+    spk_generator SUT2;
+    
+    CHECK(spk_GeneratorNew(&SUT1, SPK_GENERATOR_XSH64, 1));
+    CHECK(spk_GeneratorNew(&SUT2, SPK_GENERATOR_XSH64, 1));
+    
+    uint64_t SUT1_output[1001] = {0};
+    uint64_t SUT2_output[1001] = {1};
+    
+    //act
+    CHECK(SUT1->rand(SUT1, SUT1_output, 1001, 1, 6));
+    CHECK(spk_GeneratorRandUnchecked(SUT2, SUT2_output, 1001, 1, 6));
+    
+    //assert
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(SUT1_output, SUT2_output, 1001);
+    
+    //teardown
+    spk_GeneratorDelete(SUT1);
+    spk_GeneratorDelete(SUT2);
+}
+
 /******************************************************************************/
 
 int main(void)
@@ -495,6 +2025,59 @@ int main(void)
         RUN_TEST(test_deterministic_seed_for_PCG64i);
         RUN_TEST(test_deterministic_seed_for_XSH64);
         
+        //seed sequence tests
+        RUN_TEST(test_seed_sequence_is_deterministic_and_matches_explicit_seeds);
+        RUN_TEST(test_seed_sequence_yields_distinct_nonzero_seeds);
+        RUN_TEST(test_init_from_sequence_is_deterministic_XSH64);
+        
+        //inline tests
+        RUN_TEST(test_inline_next_matches_generic_next_PCG64i);
+        RUN_TEST(test_inline_next_matches_generic_next_XSH64);
+        RUN_TEST(test_inline_fill_continues_stream_of_generic_state_PCG64i);
+        RUN_TEST(test_inline_fill_continues_stream_of_generic_state_XSH64);
+        
+        //jump and split tests
+        RUN_TEST(test_jump_matches_discarded_output_PCG64i);
+        RUN_TEST(test_jump_matches_discarded_output_XSH64);
+        RUN_TEST(test_jump_by_full_period_is_identity_PCG64i);
+        RUN_TEST(test_jump_by_full_period_is_identity_XSH64);
+        RUN_TEST(test_split_substreams_are_evenly_spaced_across_period_XSH64);
+        
+        //xoshiro tests
+        RUN_TEST(test_known_answers_from_reference_code_Xoshiro256);
+        RUN_TEST(test_known_answers_from_reference_code_Xoroshiro128);
+        RUN_TEST(test_inline_fill_continues_stream_of_generic_state_Xoshiro256);
+        RUN_TEST(test_inline_fill_continues_stream_of_generic_state_Xoroshiro128);
+        RUN_TEST(test_jump_matches_discarded_output_Xoshiro256);
+        RUN_TEST(test_jump_matches_discarded_output_Xoroshiro128);
+        RUN_TEST(test_generic_jump_agrees_with_reference_jump_Xoroshiro128);
+        RUN_TEST(test_reference_jumps_match_known_states_Xoshiro256);
+        RUN_TEST(test_unid_values_stay_in_unit_interval_Xoroshiro128);
+        
+        //placement tests
+        RUN_TEST(test_size_is_zero_only_for_unknown_identifiers);
+        RUN_TEST(test_init_in_caller_storage_matches_new_PCG64i);
+        RUN_TEST(test_init_with_unknown_identifier_is_rejected);
+        RUN_TEST(test_array_generators_are_aligned_and_do_not_share_lines_XSH64);
+        RUN_TEST(test_array_substreams_match_split_PCG64i);
+        
+        //serialization tests
+        RUN_TEST(test_round_trip_continues_stream_PCG64i);
+        RUN_TEST(test_round_trip_continues_stream_XSH64);
+        RUN_TEST(test_round_trip_continues_stream_Xoshiro256);
+        RUN_TEST(test_serialized_layout_is_little_endian_at_fixed_offsets);
+        RUN_TEST(test_malformed_snapshots_are_rejected);
+        RUN_TEST(test_array_round_trip_continues_every_stream_XSH64);
+        
+        //hardware generator tests
+        RUN_TEST(test_hardware_words_have_balanced_bits_RdRand);
+        RUN_TEST(test_hardware_methods_stay_in_range_RdRand);
+        RUN_TEST(test_hardware_jump_split_and_restore_succeed_RdRand);
+        
+        //dispatch tests
+        RUN_TEST(test_isa_cap_limits_level_and_rejects_unsupported_levels);
+        RUN_TEST(test_conversion_kernels_match_across_isa_Xoshiro256);
+        
         //rand tests
         RUN_TEST(test_bounded_random_integers_in_zero_one_stay_in_zero_one_PCG64i);
         RUN_TEST(test_bounded_random_integers_in_zero_one_stay_in_zero_one_XSH64);        
@@ -502,6 +2085,12 @@ int main(void)
         RUN_TEST(test_bounded_random_integers_upper_bound_is_inclusive_XSH64);
         RUN_TEST(test_bounded_with_max_limits_is_identical_to_raw_output_PCG64i);
         RUN_TEST(test_bounded_with_max_limits_is_identical_to_raw_output_XSH64);
+        RUN_TEST(test_bounded_random_integers_on_die_faces_are_uniform_PCG64i);
+        RUN_TEST(test_bounded_random_integers_just_above_power_of_two_stay_in_bounds_PCG64i);
+        RUN_TEST(test_bounded_random_integers_with_equal_limits_return_the_limit_PCG64i);
+        RUN_TEST(test_bounded_random_integers_on_die_faces_are_uniform_XSH64);
+        RUN_TEST(test_bounded_random_integers_just_above_power_of_two_stay_in_bounds_XSH64);
+        RUN_TEST(test_bounded_random_integers_with_equal_limits_return_the_limit_XSH64);
         
         //unid tests
         RUN_TEST(test_unid_values_stay_in_unit_interval_PCG64i);
@@ -509,8 +2098,22 @@ int main(void)
         RUN_TEST(test_pairs_of_unid_values_can_estimate_value_of_pi_PCG64i);
         RUN_TEST(test_pairs_of_unid_values_can_estimate_value_of_pi_XSH64);
         
+        //unif tests
+        RUN_TEST(test_unif_values_stay_in_half_open_unit_interval_PCG64i);
+        RUN_TEST(test_unif_values_stay_in_half_open_unit_interval_XSH64);
+        RUN_TEST(test_unif_mean_and_variance_match_standard_uniform_PCG64i);
+        RUN_TEST(test_unif_mean_and_variance_match_standard_uniform_XSH64);
+        
         //bias tests
         RUN_TEST(test_bias_at_all_256_probabilities_in_8bit_resolution_PCG64i);
         RUN_TEST(test_bias_at_all_256_probabilities_in_8bit_resolution_XSH64);
+        RUN_TEST(test_bias_program_matches_bias_method_PCG64i);
+        RUN_TEST(test_bias_program_selects_fast_paths);
+        
+        //argument check tests
+        RUN_TEST(test_checked_methods_reject_and_log_bad_arguments_PCG64i);
+        RUN_TEST(test_failures_are_logged_under_the_public_name_PCG64i);
+        RUN_TEST(test_disabled_checks_skip_validation_PCG64i);
+        RUN_TEST(test_unchecked_rand_matches_rand_method_XSH64);
     return UNITY_END();
 }
@@ -0,0 +1,266 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/random/generator_stream.c
+* LICS: MIT License
+*/
+
+#include "generator_stream.h"
+#include "generator_simd.h"
+#include "unity.h"
+
+#include <stdlib.h> //malloc, exit_failure
+#include <stdio.h> //fprintf
+#include <string.h> //memcpy
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+/*******************************************************************************
+Callbacks. Collect copies every block into a flat array so that the streamed
+output can be compared with a single large call, Sum folds the blocks away.
+*******************************************************************************/
+struct collector
+{
+    char *dest;
+    size_t width;
+    size_t received;
+    size_t blocks;
+    size_t largest;
+};
+
+static int Collect(const void *block, size_t n, void *ctx)
+{
+    struct collector *c = ctx;
+    
+    memcpy(c->dest + c->received * c->width, block, n * c->width);
+    c->received += n;
+    c->blocks++;
+    if (n > c->largest) c->largest = n;
+    
+    return 0;
+}
+
+static int StopAfterTwo(const void *block, size_t n, void *ctx)
+{
+    size_t *calls = ctx;
+    (void) block;
+    (void) n;
+    
+    return ++*calls == 2 ? 7 : 0;
+}
+
+/*******************************************************************************
+Equivalence tests
+*******************************************************************************/
+
+static void CompareStreamToSingleCall(const int identifier, const enum spk_stream_kind kind)
+{
+    //arrange
+    spk_generator SUT;
+    spk_generator ref;
+    
+    CHECK(spk_GeneratorNew(&SUT, identifier, 1));
+    CHECK(spk_GeneratorNew(&ref, identifier, 1));
+    
+    const size_t n = 10000;
+    const size_t width = kind == SPK_STREAM_UNIF ? sizeof(float) : sizeof(uint64_t);
+    spk_stream_method method = {.kind = kind};
+    
+    char *streamed = malloc(n * width);
+    char *expect = malloc(n * width);
+    CHECK(streamed == NULL || expect == NULL);
+    
+    struct collector c = {.dest = streamed, .width = width};
+    
+    //act
+    CHECK(spk_GeneratorStream(SUT, &method, n, 528, Collect, &c));
+    
+    switch (kind)
+    {
+        case SPK_STREAM_NEXT: CHECK(ref->next(ref->state, (uint64_t *) expect, n)); break;
+        case SPK_STREAM_UNID: CHECK(ref->unid(ref, (double *) expect, n)); break;
+        case SPK_STREAM_UNIF: CHECK(ref->unif(ref, (float *) expect, n)); break;
+        default: CHECK(1);
+    }
+    
+    //assert
+    TEST_ASSERT_EQUAL_size_t(n, c.received);
+    TEST_ASSERT_EQUAL_size_t((n + 527) / 528, c.blocks);
+    TEST_ASSERT_EQUAL_MEMORY(expect, streamed, n * width);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    spk_GeneratorDelete(ref);
+    free(streamed);
+    free(expect);
+}
+
+void test_streamed_next_matches_single_next_PCG64i(void)
+{
+    CompareStreamToSingleCall(SPK_GENERATOR_PCG64i, SPK_STREAM_NEXT);
+}
+
+void test_streamed_next_matches_single_next_PCG64ix8(void)
+{
+    CompareStreamToSingleCall(SPK_GENERATOR_PCG64ix8, SPK_STREAM_NEXT);
+}
+
+void test_streamed_unid_matches_single_unid_Xoshiro256(void)
+{
+    CompareStreamToSingleCall(SPK_GENERATOR_XOSHIRO256, SPK_STREAM_UNID);
+}
+
+void test_streamed_unif_matches_single_unif_PCG64ix8(void)
+{
+    CompareStreamToSingleCall(SPK_GENERATOR_PCG64ix8, SPK_STREAM_UNIF);
+}
+
+/*******************************************************************************
+Distribution tests for the methods which are not value for value equivalent
+*******************************************************************************/
+
+void test_streamed_rand_stays_in_bounds_and_hits_both_ends(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_DEFAULT, 1));
+    
+    const size_t n = 100000;
+    uint64_t *streamed = malloc(n * sizeof(uint64_t));
+    CHECK(streamed == NULL);
+    
+    struct collector c = {.dest = (char *) streamed, .width = sizeof(uint64_t)};
+    spk_stream_method method = {.kind = SPK_STREAM_RAND, .min = 10, .max = 15};
+    
+    size_t low = 0;
+    size_t high = 0;
+    
+    //act
+    CHECK(spk_GeneratorStream(SUT, &method, n, 0, Collect, &c));
+    
+    //assert
+    TEST_ASSERT_EQUAL_size_t(SPK_STREAM_DEFAULT, c.largest);
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        TEST_ASSERT_TRUE(streamed[i] >= 10 && streamed[i] <= 15);
+        low += streamed[i] == 10;
+        high += streamed[i] == 15;
+    }
+    
+    TEST_ASSERT_UINT64_WITHIN(1000, n / 6, low);
+    TEST_ASSERT_UINT64_WITHIN(1000, n / 6, high);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(streamed);
+}
+
+/******************************************************************************/
+
+void test_streamed_bias_has_expected_bit_density(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_DEFAULT, 1));
+    
+    const size_t n = 10000;
+    uint64_t *streamed = malloc(n * sizeof(uint64_t));
+    CHECK(streamed == NULL);
+    
+    struct collector c = {.dest = (char *) streamed, .width = sizeof(uint64_t)};
+    spk_stream_method method = {.kind = SPK_STREAM_BIAS, .p = 0.125, .exp = 8};
+    
+    uint64_t bits = 0;
+    
+    //act
+    CHECK(spk_GeneratorStream(SUT, &method, n, 1024, Collect, &c));
+    
+    //assert
+    for (size_t i = 0; i < n; i++) bits += (uint64_t) __builtin_popcountll(streamed[i]);
+    
+    TEST_ASSERT_DOUBLE_WITHIN(0.005, 0.125, (double) bits / (64.0 * (double) n));
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+    free(streamed);
+}
+
+/*******************************************************************************
+Control flow tests
+*******************************************************************************/
+
+void test_nonzero_callback_return_stops_stream_and_is_returned(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_DEFAULT, 1));
+    
+    spk_stream_method method = {.kind = SPK_STREAM_NEXT};
+    size_t calls = 0;
+    
+    //act
+    int status = spk_GeneratorStream(SUT, &method, 100000, 64, StopAfterTwo, &calls);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(7, status);
+    TEST_ASSERT_EQUAL_size_t(2, calls);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+void test_invalid_block_kind_and_bias_arguments_are_rejected(void)
+{
+    //arrange
+    spk_generator SUT;
+    CHECK(spk_GeneratorNew(&SUT, SPK_GENERATOR_DEFAULT, 1));
+    
+    spk_stream_method next = {.kind = SPK_STREAM_NEXT};
+    spk_stream_method bias = {.kind = SPK_STREAM_BIAS, .p = 1.5, .exp = 8};
+    spk_stream_method unknown = {.kind = (enum spk_stream_kind) 99};
+    size_t calls = 0;
+    
+    //act and assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_GeneratorStream(SUT, &next, 100, 24, StopAfterTwo, &calls));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_GeneratorStream(SUT, &bias, 100, 0, StopAfterTwo, &calls));
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, spk_GeneratorStream(SUT, &unknown, 100, 0, StopAfterTwo, &calls));
+    TEST_ASSERT_EQUAL_size_t(0, calls);
+    
+    //an empty stream never calls back
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, spk_GeneratorStream(SUT, &next, 0, 0, StopAfterTwo, &calls));
+    TEST_ASSERT_EQUAL_size_t(0, calls);
+    
+    //teardown
+    spk_GeneratorDelete(SUT);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //equivalence tests
+        RUN_TEST(test_streamed_next_matches_single_next_PCG64i);
+        RUN_TEST(test_streamed_next_matches_single_next_PCG64ix8);
+        RUN_TEST(test_streamed_unid_matches_single_unid_Xoshiro256);
+        RUN_TEST(test_streamed_unif_matches_single_unif_PCG64ix8);
+        
+        //distribution tests
+        RUN_TEST(test_streamed_rand_stays_in_bounds_and_hits_both_ends);
+        RUN_TEST(test_streamed_bias_has_expected_bit_density);
+        
+        //control flow tests
+        RUN_TEST(test_nonzero_callback_return_stops_stream_and_is_returned);
+        RUN_TEST(test_invalid_block_kind_and_bias_arguments_are_rejected);
+    return UNITY_END();
+}
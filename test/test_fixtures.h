@@ -0,0 +1,30 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: fixtures shared by the unit tests of several modules
+* LICS: MIT License
+*/
+
+#ifndef SPK_TEST_FIXTURES_H
+#define SPK_TEST_FIXTURES_H
+
+#include "scipack_config.h"
+
+#include <stddef.h> //size_t
+#include <stdint.h> //uint64_t
+
+/*******************************************************************************
+* NAME: FailingNext
+* DESC: stand in for a generator whose raw output has run out, e.g. RDRAND on a
+* starved core, swapped into a real generator so that callers see a failing next
+* OUTP: SPK_ERROR_RDRAND, with dest filled with all ones
+*******************************************************************************/
+static inline int FailingNext(uint64_t *state, uint64_t *dest, const size_t n)
+{
+    (void) state;
+    
+    for (size_t i = 0; i < n; i++) dest[i] = 0xFFFFFFFFFFFFFFFFULL;
+    
+    return SPK_ERROR_RDRAND;
+}
+
+#endif
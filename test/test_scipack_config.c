@@ -0,0 +1,170 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/scipack_config.c
+* LICS: MIT License
+*/
+
+#include "scipack_config.h"
+#include "scipack_internal.h"
+#include "unity.h"
+
+#include <stdio.h> //vsnprintf
+#include <string.h> //strcmp, strlen
+
+/*******************************************************************************
+The logger under test formats lazily like a real one would, into a fixed buffer,
+so that the tests can see both the raw arguments and the formatted message
+*/
+
+static struct
+{
+    int calls;
+    int error;
+    const char *where;
+    char message[128];
+} record;
+
+static void RecordingLogger(void *ctx, int error, const char *where, const char *format, va_list args)
+{
+    (void) ctx;
+    
+    record.calls++;
+    record.error = error;
+    record.where = where;
+    vsnprintf(record.message, sizeof(record.message), format, args);
+}
+
+/*******************************************************************************
+Error string tests
+*******************************************************************************/
+
+void test_every_error_code_has_a_distinct_description(void)
+{
+    //arrange
+    const int codes[] =
+    {
+        SPK_ERROR_SUCCESS, SPK_ERROR_STDMALLOC, SPK_ERROR_STDCALLOC,
+        SPK_ERROR_STDREALLOC, SPK_ERROR_RDRAND, SPK_ERROR_ARGBOUNDS,
+        SPK_ERROR_PTHREAD, SPK_ERROR_FORMAT, SPK_ERROR_TIMER, SPK_ERROR_FILEIO,
+        SPK_ERROR_COUNTERS, SPK_ERROR_EXHAUSTED, SPK_ERROR_UNDEFINED
+    };
+    
+    const size_t n = sizeof(codes) / sizeof(codes[0]);
+    const char *unknown = spk_ErrorString(-1);
+    
+    //assert
+    for (size_t i = 0; i < n; i++)
+    {
+        TEST_ASSERT_TRUE(strlen(spk_ErrorString(codes[i])) > 0);
+        TEST_ASSERT_TRUE(strcmp(unknown, spk_ErrorString(codes[i])) != 0);
+        
+        for (size_t j = 0; j < i; j++)
+        {
+            TEST_ASSERT_TRUE(strcmp(spk_ErrorString(codes[i]), spk_ErrorString(codes[j])) != 0);
+        }
+    }
+}
+
+/******************************************************************************/
+
+void test_unlisted_error_codes_are_unknown(void)
+{
+    //assert
+    TEST_ASSERT_EQUAL_STRING("unknown error code", spk_ErrorString(-1));
+    TEST_ASSERT_EQUAL_STRING("unknown error code", spk_ErrorString(12));
+    TEST_ASSERT_EQUAL_STRING("unknown error code", spk_ErrorString(998));
+    TEST_ASSERT_EQUAL_STRING("unknown error code", spk_ErrorString(1000));
+}
+
+/*******************************************************************************
+Checking tests
+*******************************************************************************/
+
+void test_set_checking_returns_the_previous_setting(void)
+{
+    //act
+    int first = spk_SetChecking(0);
+    int second = spk_SetChecking(7);
+    int third = spk_SetChecking(1);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(1, first);
+    TEST_ASSERT_EQUAL_INT(0, second);
+    TEST_ASSERT_EQUAL_INT(1, third);
+}
+
+/******************************************************************************/
+
+void test_check_macro_follows_the_runtime_switch(void)
+{
+    //act
+    int on = SPKI_CHECK(1);
+    int holds = SPKI_CHECK(0);
+    spk_SetChecking(0);
+    int off = SPKI_CHECK(1);
+    spk_SetChecking(1);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_CHECKED, on);
+    TEST_ASSERT_EQUAL_INT(0, holds);
+    TEST_ASSERT_EQUAL_INT(0, off);
+}
+
+/*******************************************************************************
+Logging tests
+*******************************************************************************/
+
+void test_failures_without_a_logger_just_return_the_error(void)
+{
+    //arrange
+    record.calls = 0;
+    spk_SetLogger(NULL, NULL);
+    
+    //act
+    int error = spki_Fail(SPK_ERROR_FORMAT, "test", "value %d", 42);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_FORMAT, error);
+    TEST_ASSERT_EQUAL_INT(0, record.calls);
+}
+
+/******************************************************************************/
+
+void test_logger_receives_the_error_and_its_arguments(void)
+{
+    //arrange
+    record.calls = 0;
+    spk_SetLogger(RecordingLogger, NULL);
+    
+    //act
+    int error = spki_Fail(SPK_ERROR_ARGBOUNDS, "rand", "min %d exceeds max %d", 10, 9);
+    spk_SetLogger(NULL, NULL);
+    int silent = spki_Fail(SPK_ERROR_ARGBOUNDS, "rand", "min %d exceeds max %d", 10, 9);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, error);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, silent);
+    TEST_ASSERT_EQUAL_INT(1, record.calls);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, record.error);
+    TEST_ASSERT_EQUAL_STRING("rand", record.where);
+    TEST_ASSERT_EQUAL_STRING("min 10 exceeds max 9", record.message);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //error string tests
+        RUN_TEST(test_every_error_code_has_a_distinct_description);
+        RUN_TEST(test_unlisted_error_codes_are_unknown);
+        
+        //checking tests
+        RUN_TEST(test_set_checking_returns_the_previous_setting);
+        RUN_TEST(test_check_macro_follows_the_runtime_switch);
+        
+        //logging tests
+        RUN_TEST(test_failures_without_a_logger_just_return_the_error);
+        RUN_TEST(test_logger_receives_the_error_and_its_arguments);
+    return UNITY_END();
+}
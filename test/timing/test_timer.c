@@ -4,9 +4,12 @@
 * LICS: MIT License
 */
 
+#define _POSIX_C_SOURCE 199309L //nanosleep, clock_gettime under -std=c99
+
 #include "timer.h"
 #include "unity.h"
 
+#include <stdio.h>
 #include <time.h>
 
 /*******************************************************************************
@@ -18,7 +21,16 @@ necessary.
 
 #define THRESHOLD 0.05
 #define DELTA(x) (x * THRESHOLD)
+#define CACHE_PATH "test_tsc_cache"
+
+/******************************************************************************/
 
+static double Seconds(void)
+{
+    struct timespec ts = {0, 0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
 
 /******************************************************************************/
 
@@ -118,6 +130,179 @@ void test_timer_for_nanoseconds_task(void)
     TEST_ASSERT_EQUAL_STRING("ns", tr.symbol);
 }
 
+/*******************************************************************************
+Every fence should time a sleep the same as the macros, and its overhead should
+be measured once and then reused
+*/
+
+static void AssertFenceTimesSleep(enum spk_timer_fence fence)
+{
+    //arrange
+    struct timespec ts = {0, 20000000};
+    spk_timer timer;
+    
+    //act
+    spk_TimerBeginAs(&timer, fence);
+    nanosleep(&ts, NULL);
+    unsigned long long cycles = spk_TimerEndAs(&timer, fence);
+    struct spk_timer_result tr = spk_TimerElapsedTime(cycles);
+    
+    unsigned long long first = spk_TimerOverhead(fence);
+    unsigned long long second = spk_TimerOverhead(fence);
+    
+    //assert
+    TEST_ASSERT_TRUE(cycles == timer.cycles);
+    TEST_ASSERT_DOUBLE_WITHIN(DELTA(20), 20, tr.elapsed);
+    TEST_ASSERT_EQUAL_STRING("ms", tr.symbol);
+    TEST_ASSERT_TRUE(first > 0);
+    TEST_ASSERT_TRUE(first < 10000);
+    TEST_ASSERT_TRUE(first == second);
+}
+
+/******************************************************************************/
+
+void test_fence_serialize_times_sleep(void)
+{
+    AssertFenceTimesSleep(SPK_TIMER_SERIALIZE);
+}
+
+/******************************************************************************/
+
+void test_fence_lfence_times_sleep(void)
+{
+    AssertFenceTimesSleep(SPK_TIMER_LFENCE);
+}
+
+/******************************************************************************/
+
+void test_fence_unfenced_times_sleep(void)
+{
+    AssertFenceTimesSleep(SPK_TIMER_UNFENCED);
+}
+
+/******************************************************************************/
+
+void test_net_cycles_subtract_overhead_and_clamp_at_zero(void)
+{
+    //arrange
+    unsigned long long floor = spk_TimerOverhead(SPK_TIMER_SERIALIZE);
+    
+    //act
+    spk_TimerStart();
+    spk_TimerStop();
+    spk_tsc_start = 0;
+    spk_tsc_end = floor + 100;
+    unsigned long long net = spk_TimerElapsedNetCycles();
+    
+    //assert
+    TEST_ASSERT_TRUE(net == 100);
+    TEST_ASSERT_TRUE(spk_TimerNet(floor, SPK_TIMER_SERIALIZE) == 0);
+    TEST_ASSERT_TRUE(spk_TimerNet(floor / 2, SPK_TIMER_SERIALIZE) == 0);
+}
+
+/*******************************************************************************
+Zero net cycles stay at nanosecond resolution instead of running off the table
+*/
+
+void test_timer_for_zero_cycles(void)
+{
+    //act
+    struct spk_timer_result tr = spk_TimerElapsedTime(0);
+    
+    //assert
+    TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, tr.elapsed);
+    TEST_ASSERT_EQUAL_INT(SPK_TIMER_NANOSECONDS, tr.resolution);
+    TEST_ASSERT_EQUAL_STRING("ns", tr.symbol);
+}
+
+/*******************************************************************************
+Calibration should take well under a second and agree with the TSC rate over a
+longer sleep to a fraction of a percent, which the old nanosleep loop could not.
+*/
+
+void test_calibration_is_fast_and_agrees_with_monotonic_clock(void)
+{
+    //arrange
+    struct timespec ts = {0, 300000000};
+    
+    //act
+    double t0 = Seconds();
+    int error = spk_TimerCalibrate(NULL);
+    double t1 = Seconds();
+    
+    unsigned long long c0 = __rdtsc();
+    double s0 = Seconds();
+    nanosleep(&ts, NULL);
+    unsigned long long c1 = __rdtsc();
+    double s1 = Seconds();
+    
+    double reference = (double) (c1 - c0) / (s1 - s0);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_TRUE(spk_TimerGetSource() != SPK_TIMER_UNCALIBRATED);
+    TEST_ASSERT_TRUE(t1 - t0 < 0.5);
+    TEST_ASSERT_DOUBLE_WITHIN(reference * 0.005, reference, (double) spk_TimerGetFrequency());
+}
+
+/*******************************************************************************
+CPUs that report the frequency in CPUID bypass the cache entirely
+*/
+
+void test_calibration_cache_round_trip(void)
+{
+    //arrange
+    remove(CACHE_PATH);
+    
+    //act
+    int first_error = spk_TimerCalibrate(CACHE_PATH);
+    enum spk_timer_source first_source = spk_TimerGetSource();
+    unsigned long long first_hz = spk_TimerGetFrequency();
+    
+    int second_error = spk_TimerCalibrate(CACHE_PATH);
+    enum spk_timer_source second_source = spk_TimerGetSource();
+    unsigned long long second_hz = spk_TimerGetFrequency();
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, first_error);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, second_error);
+    TEST_ASSERT_TRUE(first_hz == second_hz);
+    
+    if (first_source == SPK_TIMER_CPUID)
+    {
+        TEST_ASSERT_EQUAL_INT(SPK_TIMER_CPUID, second_source);
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL_INT(SPK_TIMER_REGRESSION, first_source);
+        TEST_ASSERT_EQUAL_INT(SPK_TIMER_CACHE, second_source);
+    }
+    
+    //teardown
+    remove(CACHE_PATH);
+}
+
+/******************************************************************************/
+
+void test_calibration_reports_unwritable_cache(void)
+{
+    //act
+    int error = spk_TimerCalibrate("no/such/directory/tsc_cache");
+    
+    //assert
+    if (spk_TimerGetSource() == SPK_TIMER_CPUID)
+    {
+        TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL_INT(SPK_ERROR_FILEIO, error);
+        TEST_ASSERT_EQUAL_INT(SPK_TIMER_REGRESSION, spk_TimerGetSource());
+    }
+    
+    TEST_ASSERT_TRUE(spk_TimerGetFrequency() != 0);
+}
+
 /******************************************************************************/
 
 int main(void)
@@ -128,5 +313,17 @@ int main(void)
         RUN_TEST(test_timer_for_milliseconds_task);
         RUN_TEST(test_timer_for_microseconds_task);
         RUN_TEST(test_timer_for_nanoseconds_task);
+        RUN_TEST(test_timer_for_zero_cycles);
+        
+        //fence and overhead tests
+        RUN_TEST(test_fence_serialize_times_sleep);
+        RUN_TEST(test_fence_lfence_times_sleep);
+        RUN_TEST(test_fence_unfenced_times_sleep);
+        RUN_TEST(test_net_cycles_subtract_overhead_and_clamp_at_zero);
+        
+        //calibration tests
+        RUN_TEST(test_calibration_is_fast_and_agrees_with_monotonic_clock);
+        RUN_TEST(test_calibration_cache_round_trip);
+        RUN_TEST(test_calibration_reports_unwritable_cache);
     return UNITY_END();
 }
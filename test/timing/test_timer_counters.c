@@ -0,0 +1,174 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/timing/timer_counters.c
+* LICS: MIT License
+*/
+
+#include "timer_counters.h"
+#include "unity.h"
+
+#include <string.h> //strlen, strcmp
+
+/*******************************************************************************
+Virtual machines rarely expose a PMU, so tests that need real counts are ignored
+when spk_CountersOpen fails, while the failure contract is tested everywhere.
+*/
+
+#define LOOPS 100000
+
+/*******************************************************************************
+Closed counter tests
+*******************************************************************************/
+
+void test_closed_counters_count_nothing(void)
+{
+    //arrange
+    spk_counters counters;
+    spk_CountersClose();
+    
+    //act
+    spk_CountersBegin(&counters);
+    int error = spk_CountersEnd(&counters);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_COUNTERS, error);
+    TEST_ASSERT_EQUAL_UINT(0, spk_CountersAvailable());
+    TEST_ASSERT_EQUAL_UINT(0, counters.available);
+    
+    for (int i = 0; i < SPK_COUNTER_EVENTS; i++)
+    {
+        TEST_ASSERT_TRUE(counters.value[i] == 0);
+    }
+}
+
+/******************************************************************************/
+
+void test_scoped_macros_mirror_the_timer_macros(void)
+{
+    //act
+    spk_CountersStart();
+    int error = spk_CountersStop();
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_COUNTERS, error);
+    TEST_ASSERT_TRUE(spk_CountersElapsed(SPK_COUNTER_INSTRUCTIONS) == 0);
+}
+
+/*******************************************************************************
+Open and close tests
+*******************************************************************************/
+
+void test_open_either_succeeds_with_events_or_fails_with_none(void)
+{
+    //act
+    int error = spk_CountersOpen();
+    unsigned int mask = spk_CountersAvailable();
+    int again = spk_CountersOpen();
+    unsigned int mask_again = spk_CountersAvailable();
+    spk_CountersClose();
+    
+    //assert
+    if (error == SPK_ERROR_SUCCESS) TEST_ASSERT_TRUE(mask != 0);
+    else
+    {
+        TEST_ASSERT_EQUAL_INT(SPK_ERROR_COUNTERS, error);
+        TEST_ASSERT_EQUAL_UINT(0, mask);
+    }
+    
+    TEST_ASSERT_EQUAL_INT(error, again);
+    TEST_ASSERT_EQUAL_UINT(mask, mask_again);
+    TEST_ASSERT_TRUE(mask < (1U << SPK_COUNTER_EVENTS));
+    TEST_ASSERT_EQUAL_UINT(0, spk_CountersAvailable());
+}
+
+/******************************************************************************/
+
+void test_counted_loop_retires_at_least_one_instruction_per_pass(void)
+{
+    //arrange
+    spk_counters counters;
+    volatile unsigned long long sink = 0;
+    
+    if (spk_CountersOpen()) TEST_IGNORE_MESSAGE("no hardware counters");
+    if (!(spk_CountersAvailable() & (1U << SPK_COUNTER_INSTRUCTIONS)))
+    {
+        spk_CountersClose();
+        TEST_IGNORE_MESSAGE("no instruction counter");
+    }
+    
+    //act
+    spk_CountersBegin(&counters);
+    for (int i = 0; i < LOOPS; i++) sink += (unsigned long long) i;
+    int error = spk_CountersEnd(&counters);
+    spk_CountersClose();
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_TRUE(counters.value[SPK_COUNTER_INSTRUCTIONS] >= LOOPS);
+    TEST_ASSERT_TRUE(counters.value[SPK_COUNTER_BRANCH_MISSES] < LOOPS);
+    TEST_ASSERT_TRUE(sink == (unsigned long long) LOOPS * (LOOPS - 1) / 2);
+}
+
+/*******************************************************************************
+Reporting tests
+*******************************************************************************/
+
+void test_ratio_needs_both_events_and_a_nonzero_denominator(void)
+{
+    //arrange
+    spk_counters counters;
+    memset(&counters, 0, sizeof(counters));
+    counters.value[SPK_COUNTER_INSTRUCTIONS] = 300;
+    counters.value[SPK_COUNTER_CYCLES] = 100;
+    counters.available = (1U << SPK_COUNTER_INSTRUCTIONS) | (1U << SPK_COUNTER_CYCLES);
+    counters.available |= 1U << SPK_COUNTER_LLC_MISSES;
+    
+    //act
+    double ipc = spk_CountersRatio(&counters, SPK_COUNTER_INSTRUCTIONS, SPK_COUNTER_CYCLES);
+    double missing = spk_CountersRatio(&counters, SPK_COUNTER_BRANCH_MISSES, SPK_COUNTER_INSTRUCTIONS);
+    double zero = spk_CountersRatio(&counters, SPK_COUNTER_CYCLES, SPK_COUNTER_LLC_MISSES);
+    
+    //assert
+    TEST_ASSERT_EQUAL_DOUBLE(3.0, ipc);
+    TEST_ASSERT_TRUE(missing < 0.0);
+    TEST_ASSERT_TRUE(zero < 0.0);
+}
+
+/******************************************************************************/
+
+void test_event_names_are_distinct(void)
+{
+    //assert
+    TEST_ASSERT_EQUAL_STRING("branch_misses", spk_CountersName(SPK_COUNTER_BRANCH_MISSES));
+    
+    for (int i = 0; i < SPK_COUNTER_EVENTS; i++)
+    {
+        TEST_ASSERT_TRUE(strlen(spk_CountersName((enum spk_counter_event) i)) > 0);
+        
+        for (int j = 0; j < i; j++)
+        {
+            const char *a = spk_CountersName((enum spk_counter_event) i);
+            const char *b = spk_CountersName((enum spk_counter_event) j);
+            TEST_ASSERT_TRUE(strcmp(a, b) != 0);
+        }
+    }
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //closed counter tests
+        RUN_TEST(test_closed_counters_count_nothing);
+        RUN_TEST(test_scoped_macros_mirror_the_timer_macros);
+        
+        //open and close tests
+        RUN_TEST(test_open_either_succeeds_with_events_or_fails_with_none);
+        RUN_TEST(test_counted_loop_retires_at_least_one_instruction_per_pass);
+        
+        //reporting tests
+        RUN_TEST(test_ratio_needs_both_events_and_a_nonzero_denominator);
+        RUN_TEST(test_event_names_are_distinct);
+    return UNITY_END();
+}
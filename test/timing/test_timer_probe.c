@@ -0,0 +1,348 @@
+/*
+* NAME: Copyright (C) 2021, Biren Patel
+* DESC: Unit tests for src/timing/timer_probe.c
+* LICS: MIT License
+*/
+
+#include "timer_probe.h"
+#include "unity.h"
+
+#include <pthread.h>
+#include <stdarg.h> //va_list
+#include <stdlib.h> //exit_failure
+#include <stdio.h> //fprintf, tmpfile
+#include <string.h> //strstr, strcmp
+
+/******************************************************************************/
+
+//simplify unit test readability
+#define CHECK(x)                                                               \
+        if ((x))                                                               \
+        {                                                                      \
+            fprintf(stderr, "error %s, %d, %s", __FILE__, __LINE__, __func__); \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+
+#define THREADS 4
+#define SAMPLES 10000
+
+/******************************************************************************/
+
+static spk_probe_stats Stats(int id)
+{
+    static spk_probe_stats stats[SPK_PROBE_MAX];
+    size_t count = 0;
+    
+    CHECK(spk_ProbeSnapshot(stats, SPK_PROBE_MAX, &count));
+    CHECK((size_t) id >= count);
+    
+    return stats[id];
+}
+
+/*******************************************************************************
+Timer object tests
+*******************************************************************************/
+
+void test_timer_objects_nest_in_one_scope(void)
+{
+    //arrange
+    spk_timer outer;
+    spk_timer inner;
+    volatile unsigned long long sink = 0;
+    
+    //act
+    spk_TimerBegin(&outer);
+    spk_TimerBegin(&inner);
+    for (int i = 0; i < 1000; i++) sink += (unsigned long long) i;
+    spk_TimerEnd(&inner);
+    unsigned long long cycles = spk_TimerEnd(&outer);
+    
+    //assert
+    TEST_ASSERT_TRUE(inner.cycles > 0);
+    TEST_ASSERT_TRUE(outer.cycles > inner.cycles);
+    TEST_ASSERT_TRUE(cycles == outer.cycles);
+    TEST_ASSERT_TRUE(sink == 499500);
+}
+
+/*******************************************************************************
+Registry tests
+*******************************************************************************/
+
+static int logged = 0;
+
+static void CountingLogger(void *ctx, int error, const char *where, const char *format, va_list args)
+{
+    (void) error;
+    (void) format;
+    (void) args;
+    
+    logged += ctx == &logged && strcmp(where, "spk_ProbeRegister") == 0;
+}
+
+/******************************************************************************/
+
+void test_register_is_idempotent_and_rejects_bad_names(void)
+{
+    //arrange
+    int first = -1;
+    int second = -1;
+    int other = -1;
+    int unused = -1;
+    
+    spk_SetLogger(CountingLogger, &logged);
+    logged = 0;
+    
+    //act
+    int error_first = spk_ProbeRegister("register", &first);
+    int error_second = spk_ProbeRegister("register", &second);
+    int error_other = spk_ProbeRegister("register other", &other);
+    int error_empty = spk_ProbeRegister("", &unused);
+    int error_long = spk_ProbeRegister("0123456789012345678901234567890123", &unused);
+    spk_SetLogger(NULL, NULL);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error_first);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error_second);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error_other);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, error_empty);
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_ARGBOUNDS, error_long);
+    TEST_ASSERT_EQUAL_INT(2, logged);
+    TEST_ASSERT_EQUAL_INT(first, second);
+    TEST_ASSERT_TRUE(first != other);
+    TEST_ASSERT_EQUAL_INT(-1, unused);
+    TEST_ASSERT_EQUAL_STRING("register", Stats(first).name);
+}
+
+/******************************************************************************/
+
+void test_disabled_probes_record_nothing(void)
+{
+    //arrange
+    int id = -1;
+    spk_timer timer;
+    CHECK(spk_ProbeRegister("disabled", &id));
+    spk_ProbeEnable(0);
+    
+    //act
+    spk_ProbeRecord(id, 100);
+    spk_ProbeBegin(&timer);
+    spk_ProbeEnd(id, &timer);
+    
+    //assert
+    TEST_ASSERT_TRUE(Stats(id).count == 0);
+    TEST_ASSERT_TRUE(timer.start == 0);
+}
+
+/*******************************************************************************
+1 lands in bucket 0, 5 and 6 in bucket 2, 1000 in bucket 9
+*/
+
+void test_record_accumulates_count_total_range_and_histogram(void)
+{
+    //arrange
+    int id = -1;
+    CHECK(spk_ProbeRegister("accumulate", &id));
+    spk_ProbeEnable(1);
+    
+    //act
+    spk_ProbeRecord(id, 5);
+    spk_ProbeRecord(id, 1000);
+    spk_ProbeRecord(id, 1);
+    spk_ProbeRecord(id, 6);
+    spk_ProbeRecord(SPK_PROBE_MAX, 6);
+    spk_ProbeRecord(-1, 6);
+    spk_probe_stats stats = Stats(id);
+    
+    //assert
+    TEST_ASSERT_TRUE(stats.count == 4);
+    TEST_ASSERT_TRUE(stats.total == 1012);
+    TEST_ASSERT_TRUE(stats.min == 1);
+    TEST_ASSERT_TRUE(stats.max == 1000);
+    TEST_ASSERT_TRUE(stats.histogram[0] == 1);
+    TEST_ASSERT_TRUE(stats.histogram[2] == 2);
+    TEST_ASSERT_TRUE(stats.histogram[9] == 1);
+    
+    //teardown
+    spk_ProbeEnable(0);
+}
+
+/******************************************************************************/
+
+void test_begin_and_end_record_net_elapsed_cycles(void)
+{
+    //arrange
+    int id = -1;
+    spk_timer timer;
+    unsigned long long expected = 0;
+    CHECK(spk_ProbeRegister("scoped", &id));
+    spk_ProbeEnable(1);
+    
+    //act
+    for (int i = 0; i < 10; i++)
+    {
+        spk_ProbeBegin(&timer);
+        spk_ProbeEnd(id, &timer);
+        expected += spk_TimerNet(timer.cycles, SPK_TIMER_SERIALIZE);
+    }
+    
+    spk_probe_stats stats = Stats(id);
+    
+    //assert
+    TEST_ASSERT_TRUE(stats.count == 10);
+    TEST_ASSERT_TRUE(stats.total == expected);
+    TEST_ASSERT_TRUE(stats.max >= stats.min);
+    
+    //teardown
+    spk_ProbeEnable(0);
+}
+
+/*******************************************************************************
+Thread k records SAMPLES samples of k + 1 cycles, the snapshot sums all of them
+*/
+
+static int shared_id = -1;
+
+static void *Worker(void *arg)
+{
+    const unsigned long long cycles = (unsigned long long) *(int *) arg + 1;
+    
+    for (int i = 0; i < SAMPLES; i++) spk_ProbeRecord(shared_id, cycles);
+    
+    return NULL;
+}
+
+void test_threads_record_independently_into_one_snapshot(void)
+{
+    //arrange
+    pthread_t threads[THREADS];
+    int ranks[THREADS];
+    CHECK(spk_ProbeRegister("threads", &shared_id));
+    spk_ProbeEnable(1);
+    
+    //act
+    for (int k = 0; k < THREADS; k++)
+    {
+        ranks[k] = k;
+        CHECK(pthread_create(&threads[k], NULL, Worker, &ranks[k]));
+    }
+    
+    for (int k = 0; k < THREADS; k++) CHECK(pthread_join(threads[k], NULL));
+    
+    spk_probe_stats stats = Stats(shared_id);
+    
+    //assert
+    TEST_ASSERT_TRUE(stats.count == THREADS * SAMPLES);
+    TEST_ASSERT_TRUE(stats.total == SAMPLES * (1 + 2 + 3 + 4));
+    TEST_ASSERT_TRUE(stats.min == 1);
+    TEST_ASSERT_TRUE(stats.max == THREADS);
+    TEST_ASSERT_TRUE(stats.histogram[0] == SAMPLES);
+    TEST_ASSERT_TRUE(stats.histogram[1] == 2 * SAMPLES);
+    TEST_ASSERT_TRUE(stats.histogram[2] == SAMPLES);
+    
+    //teardown
+    spk_ProbeEnable(0);
+}
+
+/*******************************************************************************
+Snapshot and dump tests
+*******************************************************************************/
+
+void test_snapshot_reports_count_beyond_capacity(void)
+{
+    //arrange
+    int id = -1;
+    size_t count = 0;
+    spk_probe_stats one;
+    CHECK(spk_ProbeRegister("capacity a", &id));
+    CHECK(spk_ProbeRegister("capacity b", &id));
+    
+    //act
+    int error = spk_ProbeSnapshot(&one, 1, &count);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(SPK_ERROR_SUCCESS, error);
+    TEST_ASSERT_TRUE(count > 1);
+    TEST_ASSERT_TRUE((size_t) id < count);
+    TEST_ASSERT_EQUAL_STRING("register", one.name);
+}
+
+/******************************************************************************/
+
+void test_dump_lists_probes_and_buckets(void)
+{
+    //arrange
+    int id = -1;
+    char text[8192] = {0};
+    FILE *stream = tmpfile();
+    CHECK(!stream);
+    CHECK(spk_ProbeRegister("dumped", &id));
+    spk_ProbeEnable(1);
+    spk_ProbeRecord(id, 300);
+    
+    //act
+    spk_ProbeDump(stream);
+    rewind(stream);
+    size_t length = fread(text, 1, sizeof(text) - 1, stream);
+    
+    //assert
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_NOT_NULL(strstr(text, "dumped"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "2^8:1"));
+    
+    //teardown
+    fclose(stream);
+    spk_ProbeEnable(0);
+}
+
+/******************************************************************************/
+
+void test_reset_zeroes_counters_but_keeps_ids(void)
+{
+    //arrange
+    int id = -1;
+    int again = -1;
+    CHECK(spk_ProbeRegister("reset", &id));
+    spk_ProbeEnable(1);
+    spk_ProbeRecord(id, 42);
+    
+    //act
+    spk_ProbeReset();
+    CHECK(spk_ProbeRegister("reset", &again));
+    spk_probe_stats cleared = Stats(id);
+    spk_ProbeRecord(id, 7);
+    spk_probe_stats after = Stats(id);
+    
+    //assert
+    TEST_ASSERT_EQUAL_INT(id, again);
+    TEST_ASSERT_TRUE(cleared.count == 0);
+    TEST_ASSERT_TRUE(cleared.total == 0);
+    TEST_ASSERT_TRUE(Stats(shared_id).count == 0);
+    TEST_ASSERT_TRUE(after.count == 1);
+    TEST_ASSERT_TRUE(after.min == 7);
+    TEST_ASSERT_TRUE(after.max == 7);
+    
+    //teardown
+    spk_ProbeEnable(0);
+}
+
+/******************************************************************************/
+
+int main(void)
+{
+    UNITY_BEGIN();
+        //timer object tests
+        RUN_TEST(test_timer_objects_nest_in_one_scope);
+        
+        //registry tests
+        RUN_TEST(test_register_is_idempotent_and_rejects_bad_names);
+        RUN_TEST(test_disabled_probes_record_nothing);
+        RUN_TEST(test_record_accumulates_count_total_range_and_histogram);
+        RUN_TEST(test_begin_and_end_record_net_elapsed_cycles);
+        RUN_TEST(test_threads_record_independently_into_one_snapshot);
+        
+        //snapshot and dump tests
+        RUN_TEST(test_snapshot_reports_count_beyond_capacity);
+        RUN_TEST(test_dump_lists_probes_and_buckets);
+        RUN_TEST(test_reset_zeroes_counters_but_keeps_ids);
+    return UNITY_END();
+}
@@ -0,0 +1,80 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: generator names shared by the SCIPACK command line tools
+* LICS: MIT License
+*/
+
+#ifndef SPK_TOOLS_ENGINES_H
+#define SPK_TOOLS_ENGINES_H
+
+#include "scipack.h"
+
+#include <stddef.h> //size_t
+#include <string.h> //strcmp, strrchr, memcpy
+#include <unistd.h> //readlink
+
+/*******************************************************************************
+* NAME: tool_engines
+* DESC: every SPK_GENERATOR_* under the same short names as the benchmarks
+*******************************************************************************/
+static const struct tool_engine
+{
+    const char *name;
+    int identifier;
+    char padding[4];
+}
+tool_engines[] =
+{
+    {"pcg64i",          SPK_GENERATOR_PCG64i,         {0}},
+    {"xsh64",           SPK_GENERATOR_XSH64,          {0}},
+    {"xoshiro256",      SPK_GENERATOR_XOSHIRO256,     {0}},
+    {"xoroshiro128",    SPK_GENERATOR_XOROSHIRO128,   {0}},
+    {"pcg64ix4",        SPK_GENERATOR_PCG64ix4,       {0}},
+    {"pcg64ix8",        SPK_GENERATOR_PCG64ix8,       {0}},
+    {"xoshiro256x4",    SPK_GENERATOR_XOSHIRO256x4,   {0}},
+    {"philox4x32",      SPK_GENERATOR_PHILOX4x32,     {0}},
+    {"rdrand",          SPK_GENERATOR_RDRAND,         {0}},
+};
+
+#define TOOL_ENGINES (sizeof(tool_engines) / sizeof(tool_engines[0]))
+
+/*******************************************************************************
+* NAME: tool_Lookup
+* DESC: index of the named engine in tool_engines, or -1 if there is none
+*******************************************************************************/
+static inline int tool_Lookup(const char *name)
+{
+    for (size_t i = 0; i < TOOL_ENGINES; i++)
+    {
+        if (strcmp(tool_engines[i].name, name) == 0) return (int) i;
+    }
+    
+    return -1;
+}
+
+/*******************************************************************************
+* NAME: tool_TscCache
+* DESC: path of the TSC frequency cache, tsc_cache next to the running program
+* OUTP: the path in a static buffer, or NULL to calibrate without a cache when
+* /proc/self/exe cannot be read
+* NOTE: the tools and the benchmarks all land in ./build, so they share one file
+*******************************************************************************/
+static inline const char *tool_TscCache(void)
+{
+    static const char name[] = "tsc_cache";
+    static char path[4096];
+    
+    const ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - sizeof(name));
+    if (len <= 0 || (size_t) len >= sizeof(path) - sizeof(name)) return NULL;
+    
+    path[len] = '\0';
+    
+    char *slash = strrchr(path, '/');
+    if (slash == NULL) return NULL;
+    
+    memcpy(slash + 1, name, sizeof(name));
+    
+    return path;
+}
+
+#endif
@@ -0,0 +1,545 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: fast parallel statistical battery for the SCIPACK generators
+* LICS: MIT License
+*/
+
+#define _GNU_SOURCE //sysconf(_SC_NPROCESSORS_ONLN)
+
+#include "engines.h"
+
+#include <math.h>       //log, exp, lgamma, fabs
+#include <pthread.h>
+#include <stdio.h>      //printf, fprintf
+#include <stdlib.h>     //malloc, calloc, free, strtoull, exit
+#include <unistd.h>     //sysconf
+
+/*******************************************************************************
+Usage
+
+    ./build/rngbattery --generator all --words 1073741824
+
+    --generator NAME    any name from tools/engines.h or all, default all
+    --seed N            generator seed, default 1
+    --words N           64-bit words tested per generator, default 2^26
+    --threads N         worker threads, default one per online CPU
+
+The words are split into contiguous chunks, one per thread, and each thread
+jumps its own copy of the generator to the start of its chunk. Together they
+test exactly the stream that rngstream would write, just in parallel. Every
+test yields a p-value that should be uniform on (0, 1) for a good generator,
+and as in PractRand either tail counts: below 1e-4 or above 1 - 1e-4 is
+unusual and below 1e-10 or above 1 - 1e-10 is a failure. Any failure makes the
+program exit with a failure status. RDRAND costs over a thousand cycles per
+word, use fewer words for it.
+*/
+
+static struct
+{
+    const char *generator;
+    unsigned long long seed;
+    unsigned long long words;
+    size_t threads;
+} options = {"all", 1, 1ULL << 26, 0};
+
+/*******************************************************************************
+The tests all consume a block of words at a time
+@ bytes : chi-square of the 256 byte values at each of the 8 byte positions of
+a word, catches weak low bits and any bias in a fixed position
+@ gap : Knuth's gap test on the stream of 4-bit nibbles, counting the nibbles
+between successive zero nibbles, which catches short range dependence
+@ birthday : Marsaglia's birthday spacings, samples of 2^12 birthdays in a year
+of 2^32 days, once from the top 32 bits of each word and once from the bottom
+32. Spacing collisions are Poisson with mean m^3 / 4n = 4 per sample, and
+lattice structure inflates them
+*/
+
+#define BLOCK               ((size_t) 1 << 16)
+#define BIRTHDAYS           ((size_t) 1 << 12)
+#define BIRTHDAY_LAMBDA     4.0
+#define GAP_BINS            64
+#define GAP_P               (1.0 / 16.0)
+#define UNUSUAL             1e-4
+#define FAILURE             1e-10
+
+enum battery_test
+{
+    TEST_BYTES = 0,
+    TEST_GAP = 1,
+    TEST_BIRTHDAY_HI = 2,
+    TEST_BIRTHDAY_LO = 3,
+    TESTS = 4,
+};
+
+static const char *test_names[TESTS] = {"bytes", "gap", "birthday_hi", "birthday_lo"};
+
+struct tally
+{
+    unsigned long long bytes[8][256];
+    unsigned long long gaps[GAP_BINS + 1];
+    unsigned long long collisions[2];
+    unsigned long long samples;
+    unsigned long long words;
+};
+
+struct worker
+{
+    pthread_t thread;
+    spk_generator rng;
+    size_t blocks;
+    uint64_t *buffer;
+    struct tally tally;
+    uint32_t keys[BIRTHDAYS];
+    uint32_t scratch[BIRTHDAYS];
+    int error;
+    char padding[4];
+};
+
+/******************************************************************************/
+
+static void Usage(void)
+{
+    fputs("usage: rngbattery [--generator NAME|all] [--seed N] [--words N] [--threads N]\n", stderr);
+    fputs("generators:", stderr);
+    for (size_t i = 0; i < TOOL_ENGINES; i++) fprintf(stderr, " %s", tool_engines[i].name);
+    fputs("\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+/*******************************************************************************
+LSD radix sort of one sample of 32-bit keys in four passes of 8 bits, small
+enough that the keys, the scratch copy, and the counts all stay in L1
+*/
+
+static void RadixSort(uint32_t *keys, uint32_t *scratch, size_t n)
+{
+    size_t counts[256];
+    
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) counts[(keys[i] >> shift) & 0xFF]++;
+        
+        size_t offset = 0;
+        for (size_t k = 0; k < 256; k++)
+        {
+            const size_t count = counts[k];
+            counts[k] = offset;
+            offset += count;
+        }
+        
+        for (size_t i = 0; i < n; i++) scratch[counts[(keys[i] >> shift) & 0xFF]++] = keys[i];
+        
+        uint32_t *swap = keys;
+        keys = scratch;
+        scratch = swap;
+    }
+}
+
+/*******************************************************************************
+Sort the birthdays, take the spacings between neighbours, sort those, and count
+how many spacings equal the one before them
+*/
+
+static unsigned long long Birthdays(uint32_t *days, uint32_t *scratch, size_t n)
+{
+    RadixSort(days, scratch, n);
+    
+    for (size_t i = n - 1; i > 0; i--) days[i] -= days[i - 1];
+    
+    RadixSort(days, scratch, n);
+    
+    unsigned long long collisions = 0;
+    for (size_t i = 1; i < n; i++) collisions += days[i] == days[i - 1];
+    
+    return collisions;
+}
+
+/*******************************************************************************
+The gap run carries over from block to block within a thread, the run before the
+first zero nibble of a thread is never counted since its start is unknown. Zero
+nibbles are found a word at a time: a nibble of the complement is all ones only
+where the nibble was zero, which leaves a flag in its lowest bit.
+*/
+
+#define NIBBLE_LOW 0x1111111111111111ULL
+
+static void Gaps(struct tally *tally, const uint64_t *words, size_t n, long long *run)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        const uint64_t inverse = ~words[i];
+        uint64_t zeros = inverse & (inverse >> 1) & (inverse >> 2) & (inverse >> 3) & NIBBLE_LOW;
+        long long position = 0;
+        
+        while (zeros)
+        {
+            const long long next = __builtin_ctzll(zeros) / 4;
+            
+            if (*run >= 0)
+            {
+                const long long gap = *run + next - position;
+                tally->gaps[gap < GAP_BINS ? gap : GAP_BINS]++;
+            }
+            
+            *run = 0;
+            position = next + 1;
+            zeros &= zeros - 1;
+        }
+        
+        if (*run >= 0) *run += 16 - position;
+    }
+}
+
+/******************************************************************************/
+
+static void *Work(void *arg)
+{
+    struct worker *worker = arg;
+    struct tally *tally = &worker->tally;
+    long long run = -1;
+    
+    for (size_t b = 0; b < worker->blocks; b++)
+    {
+        worker->error = worker->rng->next(worker->rng->state, worker->buffer, BLOCK);
+        if (worker->error) break;
+        
+        const uint64_t *words = worker->buffer;
+        
+        for (size_t i = 0; i < BLOCK; i++)
+        {
+            for (int k = 0; k < 8; k++) tally->bytes[k][(words[i] >> (8 * k)) & 0xFF]++;
+        }
+        
+        Gaps(tally, words, BLOCK, &run);
+        
+        for (size_t j = 0; j < BLOCK; j += BIRTHDAYS)
+        {
+            for (size_t i = 0; i < BIRTHDAYS; i++) worker->keys[i] = (uint32_t) (words[j + i] >> 32);
+            tally->collisions[0] += Birthdays(worker->keys, worker->scratch, BIRTHDAYS);
+            
+            for (size_t i = 0; i < BIRTHDAYS; i++) worker->keys[i] = (uint32_t) words[j + i];
+            tally->collisions[1] += Birthdays(worker->keys, worker->scratch, BIRTHDAYS);
+            
+            tally->samples++;
+        }
+        
+        tally->words += BLOCK;
+    }
+    
+    return NULL;
+}
+
+/*******************************************************************************
+Regularized upper incomplete gamma function Q(a, x), by the power series for P
+below x = a + 1 and by the Lentz continued fraction for Q above it
+*/
+
+static double GammaQ(double a, double x)
+{
+    if (x <= 0.0) return 1.0;
+    
+    const double lead = a * log(x) - x - lgamma(a);
+    
+    if (x < a + 1.0)
+    {
+        double term = 1.0 / a;
+        double sum = term;
+        
+        for (int n = 1; n < 100000 && fabs(term) > fabs(sum) * 1e-16; n++)
+        {
+            term *= x / (a + n);
+            sum += term;
+        }
+        
+        return 1.0 - sum * exp(lead);
+    }
+    
+    double b = x + 1.0 - a;
+    double c = 1e300;
+    double d = 1.0 / b;
+    double h = d;
+    
+    for (int n = 1; n < 100000; n++)
+    {
+        const double an = -n * (n - a);
+        b += 2.0;
+        
+        d = an * d + b;
+        if (fabs(d) < 1e-300) d = 1e-300;
+        
+        c = b + an / c;
+        if (fabs(c) < 1e-300) c = 1e-300;
+        
+        d = 1.0 / d;
+        h *= d * c;
+        
+        if (fabs(d * c - 1.0) < 1e-16) break;
+    }
+    
+    return exp(lead) * h;
+}
+
+/*******************************************************************************
+Upper tail of the chi-square statistic, so a p-value near 1 is a suspiciously
+good fit
+*/
+
+static double ChiSquare(const double *observed, const double *expected, size_t bins, double df)
+{
+    double stat = 0.0;
+    
+    for (size_t i = 0; i < bins; i++)
+    {
+        const double delta = observed[i] - expected[i];
+        stat += delta * delta / expected[i];
+    }
+    
+    return GammaQ(df / 2.0, stat / 2.0);
+}
+
+/*******************************************************************************
+Mid p-value P(X < k) + P(X = k) / 2 of a Poisson count, using P(X < k) = Q(k, λ)
+*/
+
+static double Poisson(unsigned long long k, double lambda)
+{
+    const double below = k ? GammaQ((double) k, lambda) : 0.0;
+    const double at = exp((double) k * log(lambda) - lambda - lgamma((double) k + 1.0));
+    
+    return below + 0.5 * at;
+}
+
+/******************************************************************************/
+
+static void Evaluate(const struct tally *tally, double p[TESTS])
+{
+    static double observed[8 * 256];
+    static double expected[8 * 256];
+    
+    for (size_t k = 0; k < 8; k++)
+    {
+        for (size_t v = 0; v < 256; v++)
+        {
+            observed[256 * k + v] = (double) tally->bytes[k][v];
+            expected[256 * k + v] = (double) tally->words / 256.0;
+        }
+    }
+    
+    p[TEST_BYTES] = ChiSquare(observed, expected, 8 * 256, 8.0 * 255.0);
+    
+    double gaps = 0.0;
+    for (size_t r = 0; r <= GAP_BINS; r++) gaps += (double) tally->gaps[r];
+    
+    for (size_t r = 0; r <= GAP_BINS; r++)
+    {
+        const double tail = pow(1.0 - GAP_P, (double) r);
+        
+        observed[r] = (double) tally->gaps[r];
+        expected[r] = gaps * (r < GAP_BINS ? GAP_P * tail : tail);
+    }
+    
+    p[TEST_GAP] = ChiSquare(observed, expected, GAP_BINS + 1, (double) GAP_BINS);
+    
+    const double lambda = BIRTHDAY_LAMBDA * (double) tally->samples;
+    
+    p[TEST_BIRTHDAY_HI] = Poisson(tally->collisions[0], lambda);
+    p[TEST_BIRTHDAY_LO] = Poisson(tally->collisions[1], lambda);
+}
+
+/******************************************************************************/
+
+static const char *Verdict(double p)
+{
+    if (p < FAILURE || p > 1.0 - FAILURE) return "FAIL";
+    if (p < UNUSUAL || p > 1.0 - UNUSUAL) return "unusual";
+    
+    return "pass";
+}
+
+/*******************************************************************************
+Single thread next throughput over 64 blocks, for the speed side of the tradeoff
+*/
+
+static double Throughput(spk_generator rng, uint64_t *buffer)
+{
+    spk_timer timer;
+    
+    if (rng->next(rng->state, buffer, BLOCK)) return 0.0;
+    
+    spk_TimerBegin(&timer);
+    for (int i = 0; i < 64; i++) rng->next(rng->state, buffer, BLOCK);
+    const double seconds = (double) spk_TimerEnd(&timer) / (double) spk_TimerGetFrequency();
+    
+    return seconds > 0.0 ? 64.0 * BLOCK * sizeof(uint64_t) / seconds * 1e-9 : 0.0;
+}
+
+/*******************************************************************************
+Returns 1 if any test failed, -1 if the generator could not run, for example
+RDRAND on a processor without it
+*/
+
+static int Battery(size_t engine, struct worker *workers, size_t threads)
+{
+    const int identifier = tool_engines[engine].identifier;
+    const size_t blocks = (size_t) (options.words / BLOCK);
+    size_t start = 0;
+    int status = 0;
+    
+    for (size_t t = 0; t < threads; t++)
+    {
+        struct worker *worker = &workers[t];
+        
+        memset(&worker->tally, 0, sizeof(worker->tally));
+        worker->blocks = blocks / threads + (t < blocks % threads);
+        worker->error = SPK_ERROR_SUCCESS;
+        worker->rng = NULL;
+        
+        if (spk_GeneratorNew(&worker->rng, identifier, options.seed)) status = -1;
+        else if (spk_GeneratorJump(worker->rng, (uint64_t) (start * BLOCK))) status = -1;
+        
+        start += worker->blocks;
+    }
+    
+    spk_timer timer = {0, 0};
+    double gigabytes = 0.0;
+    
+    if (status == 0)
+    {
+        spk_generator probe = NULL;
+        
+        if (spk_GeneratorNew(&probe, identifier, options.seed) == SPK_ERROR_SUCCESS)
+        {
+            gigabytes = Throughput(probe, workers[0].buffer);
+            spk_GeneratorDelete(probe);
+        }
+        
+        spk_TimerBegin(&timer);
+        
+        for (size_t t = 1; t < threads; t++)
+        {
+            if (pthread_create(&workers[t].thread, NULL, Work, &workers[t])) workers[t].error = SPK_ERROR_PTHREAD;
+        }
+        
+        Work(&workers[0]);
+        
+        for (size_t t = 1; t < threads; t++)
+        {
+            if (workers[t].error != SPK_ERROR_PTHREAD) pthread_join(workers[t].thread, NULL);
+        }
+        
+        spk_TimerEnd(&timer);
+    }
+    
+    struct tally *sum = &workers[0].tally;
+    
+    for (size_t t = 0; t < threads; t++)
+    {
+        if (workers[t].error) status = -1;
+        spk_GeneratorDelete(workers[t].rng);
+        
+        if (t == 0) continue;
+        
+        for (size_t k = 0; k < 8; k++)
+        {
+            for (size_t v = 0; v < 256; v++) sum->bytes[k][v] += workers[t].tally.bytes[k][v];
+        }
+        
+        for (size_t r = 0; r <= GAP_BINS; r++) sum->gaps[r] += workers[t].tally.gaps[r];
+        
+        sum->collisions[0] += workers[t].tally.collisions[0];
+        sum->collisions[1] += workers[t].tally.collisions[1];
+        sum->samples += workers[t].tally.samples;
+        sum->words += workers[t].tally.words;
+    }
+    
+    if (status)
+    {
+        printf("%-14s could not run\n", tool_engines[engine].name);
+        return -1;
+    }
+    
+    double p[TESTS];
+    const char *verdict = "pass";
+    
+    Evaluate(sum, p);
+    
+    printf("%-14s %9.3f %9.2f", tool_engines[engine].name, gigabytes,
+        (double) timer.cycles / (double) spk_TimerGetFrequency());
+        
+    for (int i = 0; i < TESTS; i++)
+    {
+        const char *v = Verdict(p[i]);
+        
+        if (strcmp(v, "FAIL") == 0 || (strcmp(v, "unusual") == 0 && strcmp(verdict, "pass") == 0)) verdict = v;
+        printf("  %-12.4g", p[i]);
+    }
+    
+    printf("  %s\n", verdict);
+    fflush(stdout);
+    
+    if (strcmp(verdict, "FAIL") == 0) status = 1;
+    
+    return status;
+}
+
+/******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (i + 1 == argc) Usage();
+        
+        const char *arg = argv[i];
+        const char *value = argv[i + 1];
+        
+        if (strcmp(arg, "--generator") == 0) options.generator = value;
+        else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, NULL, 0);
+        else if (strcmp(arg, "--words") == 0) options.words = strtoull(value, NULL, 0);
+        else if (strcmp(arg, "--threads") == 0) options.threads = (size_t) strtoull(value, NULL, 0);
+        else Usage();
+    }
+    
+    const int all = strcmp(options.generator, "all") == 0;
+    const int engine = all ? 0 : tool_Lookup(options.generator);
+    
+    if (engine < 0) Usage();
+    if (options.words < BLOCK) options.words = BLOCK;
+    
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = options.threads ? options.threads : (online > 0 ? (size_t) online : 1);
+    if (threads > options.words / BLOCK) threads = (size_t) (options.words / BLOCK);
+    
+    struct worker *workers = calloc(threads, sizeof(struct worker));
+    if (!workers) return EXIT_FAILURE;
+    
+    for (size_t t = 0; t < threads; t++)
+    {
+        workers[t].buffer = malloc(BLOCK * sizeof(uint64_t));
+        if (!workers[t].buffer) return EXIT_FAILURE;
+    }
+    
+    spk_TimerCalibrate(tool_TscCache());
+    
+    printf("%llu words per generator, %zu threads, seed %llu\n\n", options.words / BLOCK * BLOCK, threads, options.seed);
+    printf("%-14s %9s %9s", "generator", "next GB/s", "seconds");
+    for (int i = 0; i < TESTS; i++) printf("  %-12s", test_names[i]);
+    printf("  verdict\n");
+    
+    int failed = 0;
+    
+    for (size_t e = (size_t) engine; e < (all ? TOOL_ENGINES : (size_t) engine + 1); e++)
+    {
+        if (Battery(e, workers, threads) == 1) failed = 1;
+    }
+    
+    for (size_t t = 0; t < threads; t++)
+    {
+        free(workers[t].buffer);
+    }
+    
+    free(workers);
+    
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
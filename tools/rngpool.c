@@ -0,0 +1,186 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: write a pre-generated random pool file, or describe an existing one
+* LICS: MIT License
+*/
+
+#define _POSIX_C_SOURCE 200112L //readlink
+
+#include "engines.h"
+
+#include <limits.h>     //ULLONG_MAX
+#include <stdio.h>      //fprintf, printf
+#include <stdlib.h>     //strtoull, exit
+
+/*******************************************************************************
+Usage
+
+    ./build/rngpool --generator xoshiro256 --seed 42 --count 1e9 --output u.pool
+    ./build/rngpool --info u.pool
+
+    --generator NAME    any name from tools/engines.h, default xoshiro256
+    --seed N            generator seed, default 0 draws one and records it
+    --position N        stream words to skip before the first element, default 0
+    --count N           elements to write, default 2^24
+    --kind next|unid    raw words or doubles on [0, 1), default unid
+    --threads N         fill threads, default all online cores
+    --output PATH       pool file to create, required when writing
+    --info PATH         print the header of PATH and exit
+
+The pool is read back with spk_GeneratorPoolOpen. Counts accept a plain integer
+or a power of ten such as 1e10.
+*/
+
+static struct
+{
+    const char *generator;
+    const char *output;
+    const char *info;
+    unsigned long long seed;
+    unsigned long long position;
+    unsigned long long count;
+    unsigned long long threads;
+    enum spk_pool_kind kind;
+    char padding[4];
+} options = {"xoshiro256", NULL, NULL, 0, 0, 1ULL << 24, 0, SPK_POOL_UNID, {0}};
+
+/******************************************************************************/
+
+static void Usage(void)
+{
+    fputs("usage: rngpool [--generator NAME] [--seed N] [--position N] [--count N]\n", stderr);
+    fputs("               [--kind next|unid] [--threads N] --output PATH\n", stderr);
+    fputs("       rngpool --info PATH\n", stderr);
+    fputs("generators:", stderr);
+    for (size_t i = 0; i < TOOL_ENGINES; i++) fprintf(stderr, " %s", tool_engines[i].name);
+    fputs("\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+/*******************************************************************************
+Integer argument, either plain or as 1eK, anything else is a usage error
+*/
+
+static unsigned long long Count(const char *value)
+{
+    char *end = NULL;
+    unsigned long long count = strtoull(value, &end, 0);
+    
+    if (*end == 'e' || *end == 'E')
+    {
+        const unsigned long long exponent = strtoull(end + 1, &end, 10);
+        
+        for (unsigned long long i = 0; i < exponent; i++)
+        {
+            if (count > ULLONG_MAX / 10) Usage();
+            count *= 10;
+        }
+    }
+    
+    if (*end != '\0') Usage();
+    
+    return count;
+}
+
+/******************************************************************************/
+
+static const char *EngineName(int identifier)
+{
+    for (size_t i = 0; i < TOOL_ENGINES; i++)
+    {
+        if (tool_engines[i].identifier == identifier) return tool_engines[i].name;
+    }
+    
+    return "unknown";
+}
+
+/******************************************************************************/
+
+static int Info(const char *path)
+{
+    spk_generator pool = NULL;
+    spk_pool_info info;
+    
+    int error = spk_GeneratorPoolOpen(&pool, path);
+    
+    if (error)
+    {
+        fprintf(stderr, "rngpool: %s is not a readable pool, error %d\n", path, error);
+        return EXIT_FAILURE;
+    }
+    
+    spk_GeneratorPoolInfo(pool, &info);
+    
+    printf("generator: %s\n", EngineName(info.identifier));
+    printf("kind:      %s\n", info.kind == SPK_POOL_NEXT ? "next" : "unid");
+    printf("seed:      %llu\n", (unsigned long long) info.seed);
+    printf("position:  %llu\n", (unsigned long long) info.position);
+    printf("count:     %llu\n", (unsigned long long) info.count);
+    
+    spk_GeneratorDelete(pool);
+    
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 == argc) Usage();
+        
+        const char *value = argv[++i];
+        
+        if (strcmp(argv[i - 1], "--generator") == 0) options.generator = value;
+        else if (strcmp(argv[i - 1], "--output") == 0) options.output = value;
+        else if (strcmp(argv[i - 1], "--info") == 0) options.info = value;
+        else if (strcmp(argv[i - 1], "--seed") == 0) options.seed = strtoull(value, NULL, 0);
+        else if (strcmp(argv[i - 1], "--position") == 0) options.position = Count(value);
+        else if (strcmp(argv[i - 1], "--count") == 0) options.count = Count(value);
+        else if (strcmp(argv[i - 1], "--threads") == 0) options.threads = strtoull(value, NULL, 0);
+        else if (strcmp(argv[i - 1], "--kind") == 0)
+        {
+            if (strcmp(value, "next") == 0) options.kind = SPK_POOL_NEXT;
+            else if (strcmp(value, "unid") == 0) options.kind = SPK_POOL_UNID;
+            else Usage();
+        }
+        else Usage();
+    }
+    
+    if (options.info) return Info(options.info);
+    if (!options.output || options.count > SIZE_MAX) Usage();
+    
+    const int engine = tool_Lookup(options.generator);
+    if (engine < 0) Usage();
+    
+    if (spk_ParallelInit((size_t) options.threads))
+    {
+        fputs("rngpool: could not start the thread pool\n", stderr);
+        return EXIT_FAILURE;
+    }
+    
+    spk_TimerCalibrate(tool_TscCache());
+    
+    spk_timer timer = {0, 0};
+    spk_TimerBegin(&timer);
+    
+    const int error = spk_GeneratorPoolWrite(options.output, tool_engines[engine].identifier,
+        options.seed, options.position, (size_t) options.count, options.kind);
+        
+    const double seconds = (double) spk_TimerEnd(&timer) / (double) spk_TimerGetFrequency();
+    const double bytes = (double) options.count * 8.0;
+    
+    spk_ParallelDelete();
+    
+    if (error)
+    {
+        fprintf(stderr, "rngpool: could not write %s, error %d\n", options.output, error);
+        return EXIT_FAILURE;
+    }
+    
+    fprintf(stderr, "rngpool: %s, %llu elements in %.2f s, %.3f GB/s\n", options.generator,
+        options.count, seconds, seconds > 0.0 ? bytes / seconds * 1e-9 : 0.0);
+        
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+* NAME: Copyright (c) 2021, Biren Patel
+* DESC: stream raw generator output to stdout, e.g. for PractRand RNG_test
+* LICS: MIT License
+*/
+
+#define _GNU_SOURCE //vmsplice, F_SETPIPE_SZ, posix_memalign
+
+#include "engines.h"
+
+#include <errno.h>
+#include <fcntl.h>      //fcntl, vmsplice
+#include <signal.h>     //signal, SIGPIPE
+#include <stdio.h>      //fprintf
+#include <stdlib.h>     //posix_memalign, strtoull, exit
+#include <sys/stat.h>   //fstat, S_ISFIFO
+#include <sys/uio.h>    //struct iovec
+#include <unistd.h>     //write, sysconf
+
+/*******************************************************************************
+Usage
+
+    ./build/rngstream --generator xoshiro256 --seed 42 | RNG_test stdin64
+
+    --generator NAME    any name from tools/engines.h, default xoshiro256
+    --seed N            generator seed, default 1
+    --words N           stop after N words, default unlimited
+    --write             always use write(2), never vmsplice(2)
+
+Output is native endian 64-bit words exactly as next produces them. The stream
+ends cleanly when the reader closes the pipe, then the rate goes to stderr.
+*/
+
+#define STREAM_BUFFER ((size_t) 1 << 20)
+
+static struct
+{
+    const char *generator;
+    unsigned long long seed;
+    unsigned long long words;
+    int write;
+    char padding[4];
+} options = {"xoshiro256", 1, 0, 0, {0}};
+
+/******************************************************************************/
+
+static void Usage(void)
+{
+    fputs("usage: rngstream [--generator NAME] [--seed N] [--words N] [--write]\n", stderr);
+    fputs("generators:", stderr);
+    for (size_t i = 0; i < TOOL_ENGINES; i++) fprintf(stderr, " %s", tool_engines[i].name);
+    fputs("\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+/*******************************************************************************
+Plain write path, any descriptor. Returns nonzero once the reader is gone.
+*/
+
+static int Write(const unsigned char *buffer, size_t bytes)
+{
+    while (bytes)
+    {
+        const ssize_t done = write(STDOUT_FILENO, buffer, bytes);
+        
+        if (done < 0 && errno == EINTR) continue;
+        if (done <= 0) return 1;
+        
+        buffer += done;
+        bytes -= (size_t) done;
+    }
+    
+    return 0;
+}
+
+/*******************************************************************************
+Zero-copy path for pipes. vmsplice hands the buffer pages to the pipe without
+copying them, so a page must not be refilled until the reader has consumed it.
+The pipe is sized to exactly one buffer and there are two buffers: once all of
+one buffer has been spliced the pipe can hold nothing else, so the other buffer
+has been read in full and is safe to reuse.
+*/
+
+static int Splice(unsigned char *buffer, size_t bytes)
+{
+    while (bytes)
+    {
+        struct iovec iov = {buffer, bytes};
+        const ssize_t done = vmsplice(STDOUT_FILENO, &iov, 1, 0);
+        
+        if (done < 0 && errno == EINTR) continue;
+        if (done <= 0) return 1;
+        
+        buffer += done;
+        bytes -= (size_t) done;
+    }
+    
+    return 0;
+}
+
+/*******************************************************************************
+Buffer size for the zero-copy path, or zero to use the write path
+*/
+
+static size_t PipeBuffer(void)
+{
+    struct stat info;
+    
+    if (options.write) return 0;
+    if (fstat(STDOUT_FILENO, &info) || !S_ISFIFO(info.st_mode)) return 0;
+    
+    fcntl(STDOUT_FILENO, F_SETPIPE_SZ, (int) STREAM_BUFFER);
+    
+    const int size = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+    const long page = sysconf(_SC_PAGESIZE);
+    
+    if (size <= 0 || page <= 0 || (size_t) size % (size_t) page) return 0;
+    
+    return (size_t) size;
+}
+
+/******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--write") == 0)
+        {
+            options.write = 1;
+            continue;
+        }
+        
+        if (i + 1 == argc) Usage();
+        
+        const char *value = argv[++i];
+        
+        if (strcmp(argv[i - 1], "--generator") == 0) options.generator = value;
+        else if (strcmp(argv[i - 1], "--seed") == 0) options.seed = strtoull(value, NULL, 0);
+        else if (strcmp(argv[i - 1], "--words") == 0) options.words = strtoull(value, NULL, 0);
+        else Usage();
+    }
+    
+    const int engine = tool_Lookup(options.generator);
+    if (engine < 0) Usage();
+    
+    spk_generator rng = NULL;
+    unsigned char *buffers[2] = {NULL, NULL};
+    
+    if (spk_GeneratorNew(&rng, tool_engines[engine].identifier, options.seed))
+    {
+        fprintf(stderr, "rngstream: could not create %s\n", options.generator);
+        return EXIT_FAILURE;
+    }
+    
+    //the pipe size is a whole number of pages, so of words and of SIMD lanes
+    const size_t pipe = PipeBuffer();
+    const size_t size = pipe ? pipe : STREAM_BUFFER;
+    const size_t words = size / sizeof(uint64_t);
+    
+    for (int k = 0; k < 2; k++)
+    {
+        if (posix_memalign((void **) &buffers[k], 4096, size))
+        {
+            fputs("rngstream: buffer allocation failure\n", stderr);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    //a closed reader is the normal way for the stream to end
+    signal(SIGPIPE, SIG_IGN);
+    spk_TimerCalibrate(tool_TscCache());
+    
+    unsigned long long remaining = options.words;
+    unsigned long long bytes = 0;
+    int error = SPK_ERROR_SUCCESS;
+    spk_timer timer;
+    
+    spk_TimerBegin(&timer);
+    
+    for (int k = 0; ; k ^= 1)
+    {
+        size_t n = words;
+        if (options.words && remaining < n) n = (size_t) remaining;
+        if (n == 0) break;
+        
+        uint64_t *block = (uint64_t *) (void *) buffers[k];
+        error = rng->next(rng->state, block, n);
+        if (error) break;
+        
+        const size_t length = n * sizeof(uint64_t);
+        if (pipe ? Splice(buffers[k], length) : Write(buffers[k], length)) break;
+        
+        bytes += length;
+        remaining -= n;
+    }
+    
+    const double seconds = (double) spk_TimerEnd(&timer) / (double) spk_TimerGetFrequency();
+    
+    fprintf(stderr, "rngstream: %s, %llu bytes in %.2f s, %.3f GB/s via %s\n", options.generator,
+        bytes, seconds, seconds > 0.0 ? (double) bytes / seconds * 1e-9 : 0.0, pipe ? "vmsplice" : "write");
+        
+    free(buffers[0]);
+    free(buffers[1]);
+    spk_GeneratorDelete(rng);
+    
+    return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}